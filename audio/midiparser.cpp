@@ -45,6 +45,10 @@ _centerPitchWheelOnUnload(false),
 _sendSustainOffOnNotesOff(false),
 _disableAllNotesOffMidiEvents(false),
 _disableAutoStartPlayback(false),
+_canCompileTracks(false),
+_compileTracks(false),
+_compiledTracks(nullptr),
+_compiledPos(0),
 _numTracks(0),
 _activeTrack(255),
 _abortParse(false),
@@ -53,6 +57,7 @@ _doParse(true),
 _pause(false) {
 	memset(_activeNotes, 0, sizeof(_activeNotes));
 	memset(_tracks, 0, sizeof(_tracks));
+	memset(_trackEnds, 0, sizeof(_trackEnds));
 	_nextEvent.start = nullptr;
 	_nextEvent.delta = 0;
 	_nextEvent.event = 0;
@@ -79,6 +84,11 @@ void MidiParser::property(int prop, int value) {
 	case mpDisableAutoStartPlayback:
 		_disableAutoStartPlayback = (value != 0);
 		break;
+	case mpCompileTracks:
+		_compileTracks = (value != 0) && _canCompileTracks;
+		if (!_compileTracks)
+			clearCompiledTracks();
+		break;
 	default:
 		break;
 	}
@@ -256,7 +266,7 @@ void MidiParser::onTimer() {
 		if (!_abortParse) {
 			_position._lastEventTime = eventTime;
 			_position._lastEventTick += info.delta;
-			parseNextEvent(_nextEvent);
+			fetchNextEvent(_nextEvent);
 		}
 	}
 
@@ -324,6 +334,143 @@ bool MidiParser::processEvent(const EventInfo &info, bool fireEvents) {
 }
 
 
+void MidiParser::fetchNextEvent(EventInfo &info) {
+	if (_compileTracks && _activeTrack < _numTracks && _position._playPos) {
+		if (!_compiledTracks || !_compiledTracks[_activeTrack].compiled)
+			compileTrack(_activeTrack);
+
+		const Common::Array<CompiledEvent> &events = _compiledTracks[_activeTrack].events;
+		if (_compiledPos >= events.size() || events[_compiledPos].info.start != _position._playPos) {
+			// The position was changed by something else than fetching the
+			// previous event, e.g. a jump. Look up the event starting at the
+			// new position; events are ordered by their position in the data.
+			uint32 low = 0, high = events.size();
+			while (low < high) {
+				uint32 mid = (low + high) / 2;
+				if (events[mid].info.start < _position._playPos)
+					low = mid + 1;
+				else
+					high = mid;
+			}
+			_compiledPos = low;
+		}
+
+		if (_compiledPos < events.size() && events[_compiledPos].info.start == _position._playPos) {
+			const CompiledEvent &event = events[_compiledPos++];
+			info = event.info;
+			_position._playPos = event.nextPos;
+			_position._runningStatus = event.runningStatus;
+			return;
+		}
+	}
+
+	parseNextEvent(info);
+}
+
+void MidiParser::compileTrack(uint8 track) {
+	if (!_compiledTracks)
+		_compiledTracks = new CompiledTrack[MAXIMUM_TRACKS];
+
+	CompiledTrack &compiled = _compiledTracks[track];
+	compiled.events.clear();
+	compiled.metaEvents.clear();
+	compiled.compiled = true;
+
+	// Without its end, the parser could run past the data of the track
+	const byte *end = _trackEnds[track];
+	if (!end)
+		return;
+
+	// Run the parser over the whole track. The position is saved and
+	// restored, so this can be done at any time during playback.
+	Tracker savedPosition(_position);
+	_position.clear();
+	_position._playPos = _tracks[track];
+
+	CompiledEvent event;
+	event.tick = 0;
+	while (true) {
+		if (_position._playPos >= end) {
+			// The track is truncated. Leave it to parseNextEvent during
+			// playback, which handles it like before.
+			compiled.events.clear();
+			compiled.metaEvents.clear();
+			break;
+		}
+
+		parseNextEvent(event.info);
+		if (_position._playPos > end)
+			continue;
+		event.tick += event.info.delta;
+		event.nextPos = _position._playPos;
+		event.runningStatus = _position._runningStatus;
+
+		if (event.info.event == 0xFF)
+			compiled.metaEvents.push_back(compiled.events.size());
+		compiled.events.push_back(event);
+
+		// Stop at the end of the track, and at invalid events which would
+		// stop playback as well.
+		if (event.info.event < 0x80 || (event.info.event == 0xFF && event.info.ext.type == 0x2F))
+			break;
+	}
+
+	_position = savedPosition;
+	_compiledPos = 0;
+}
+
+void MidiParser::clearCompiledTracks() {
+	delete[] _compiledTracks;
+	_compiledTracks = nullptr;
+	_compiledPos = 0;
+}
+
+bool MidiParser::jumpToTickCompiled(uint32 tick) {
+	const CompiledTrack &compiled = _compiledTracks[_activeTrack];
+
+	// Find the first event at or after the target tick.
+	uint32 low = 0, high = compiled.events.size();
+	while (low < high) {
+		uint32 mid = (low + high) / 2;
+		if (compiled.events[mid].tick < tick)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	// Without firing events, only META events (i.e. tempo changes) have an
+	// effect on the parser state, so the other events can be skipped. The
+	// last event of the track is the End of Track event, which is never
+	// processed here.
+	const uint32 end = MIN<uint32>(low, compiled.events.size() - 1);
+	for (uint32 i = 0; i < compiled.metaEvents.size() && compiled.metaEvents[i] < end; i++) {
+		const CompiledEvent &meta = compiled.events[compiled.metaEvents[i]];
+		_position._lastEventTime += (meta.tick - _position._lastEventTick) * _psecPerTick;
+		_position._lastEventTick = meta.tick;
+		processEvent(meta.info, false);
+	}
+
+	if (low == compiled.events.size())
+		// The end of the track is before the target tick. Like the regular
+		// jump, this leaves the tempo changes on the way applied.
+		return false;
+
+	if (low > 0) {
+		const CompiledEvent &last = compiled.events[low - 1];
+		_position._lastEventTime += (last.tick - _position._lastEventTick) * _psecPerTick;
+		_position._lastEventTick = last.tick;
+	}
+	_position._playTime = _position._lastEventTime + (tick - _position._lastEventTick) * _psecPerTick;
+	_position._playTick = tick;
+
+	const CompiledEvent &next = compiled.events[low];
+	_nextEvent = next.info;
+	_position._playPos = next.nextPos;
+	_position._runningStatus = next.runningStatus;
+	_compiledPos = low + 1;
+	return true;
+}
+
 void MidiParser::allNotesOff() {
 	if (!_driver)
 		return;
@@ -393,7 +540,7 @@ bool MidiParser::setTrack(int track) {
 
 	_activeTrack = track;
 	_position._playPos = _tracks[track];
-	parseNextEvent(_nextEvent);
+	fetchNextEvent(_nextEvent);
 	return true;
 }
 
@@ -409,7 +556,7 @@ bool MidiParser::startPlaying() {
 		return false;
 	if (!_position._playPos) {
 		_position._playPos = _tracks[_activeTrack];
-		parseNextEvent(_nextEvent);
+		fetchNextEvent(_nextEvent);
 	}
 	_doParse = true;
 	return true;
@@ -440,7 +587,7 @@ void MidiParser::hangAllActiveNotes() {
 				break;
 		if (i == 128)
 			break;
-		parseNextEvent(_nextEvent);
+		fetchNextEvent(_nextEvent);
 		advanceTick += _nextEvent.delta;
 		if (_nextEvent.command() == 0x8) {
 			if (tempActive[_nextEvent.basic.param1] & (1 << _nextEvent.channel())) {
@@ -474,8 +621,16 @@ bool MidiParser::jumpToTick(uint32 tick, bool fireEvents, bool stopNotes, bool d
 
 	resetTracking();
 	_position._playPos = _tracks[_activeTrack];
-	parseNextEvent(_nextEvent);
-	if (tick > 0) {
+	fetchNextEvent(_nextEvent);
+	if (tick > 0 && !fireEvents && _compiledTracks && !_compiledTracks[_activeTrack].events.empty()) {
+		if (!jumpToTickCompiled(tick)) {
+			// End of track; we failed to find the right tick.
+			_position = currentPos;
+			_nextEvent = currentEvent;
+			_jumpingToTick = false;
+			return false;
+		}
+	} else if (tick > 0) {
 		while (true) {
 			EventInfo &info = _nextEvent;
 			if (_position._lastEventTick + info.delta >= tick) {
@@ -504,7 +659,7 @@ bool MidiParser::jumpToTick(uint32 tick, bool fireEvents, bool stopNotes, bool d
 				processEvent(info, fireEvents);
 			}
 
-			parseNextEvent(_nextEvent);
+			fetchNextEvent(_nextEvent);
 		}
 	}
 
@@ -535,9 +690,11 @@ void MidiParser::unloadMusic() {
 		return;
 
 	stopPlaying();
+	clearCompiledTracks();
 	_numTracks = 0;
 	_activeTrack = 255;
 	_abortParse = true;
+	memset(_trackEnds, 0, sizeof(_trackEnds));
 
 	if (_centerPitchWheelOnUnload) {
 		// Center the pitch wheels in preparation for the next piece of
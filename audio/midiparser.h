@@ -25,6 +25,7 @@
 #define AUDIO_MIDIPARSER_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
 #include "common/endian.h"
 #include "common/stream.h"
 
@@ -290,6 +291,29 @@ class MidiParser {
 protected:
 	static const uint8 MAXIMUM_TRACKS = 120;
 
+	/**
+	 * A pre-parsed event of a compiled track, together with the parser state
+	 * directly after parsing it. See mpCompileTracks.
+	 */
+	struct CompiledEvent {
+		EventInfo info;       ///< The parsed event
+		uint32 tick;          ///< Absolute tick at which the event occurs
+		byte *nextPos;        ///< Value of _position._playPos after parsing the event
+		byte runningStatus;   ///< Value of _position._runningStatus after parsing the event
+	};
+
+	/**
+	 * A flat array of all events in a track, ordered by position in the
+	 * track data (and thereby by tick), plus the indices of its META events.
+	 */
+	struct CompiledTrack {
+		Common::Array<CompiledEvent> events;
+		Common::Array<uint32> metaEvents;
+		bool compiled; ///< Whether compiling was attempted; events is empty if the track could not be compiled
+
+		CompiledTrack() : compiled(false) {}
+	};
+
 	uint16    _activeNotes[128];   ///< Each uint16 is a bit mask for channels that have that note on.
 	NoteTimer _hangingNotes[32];   ///< Maintains expiration info for up to 32 notes.
 	                                ///< Used for "Smart Jump" and MIDI formats that do not include explicit Note Off events.
@@ -307,7 +331,12 @@ protected:
 	bool   _sendSustainOffOnNotesOff;   ///< Send a sustain off on a notes off event, stopping hanging notes
 	bool   _disableAllNotesOffMidiEvents;   ///< Don't send All Notes Off MIDI messages
 	bool   _disableAutoStartPlayback;  ///< Do not automatically start playback after parsing MIDI data or setting the track
+	bool   _canCompileTracks; ///< Set by subclasses whose parseNextEvent has no side effects beyond _position
+	bool   _compileTracks;    ///< Pre-parse tracks into CompiledTrack event arrays
+	CompiledTrack *_compiledTracks; ///< Compiled event arrays, one per track; allocated on demand
+	uint32 _compiledPos;      ///< Index of the next event to fetch from the compiled active track
 	byte  *_tracks[MAXIMUM_TRACKS];    ///< Multi-track MIDI formats are supported, up to 120 tracks.
+	byte  *_trackEnds[MAXIMUM_TRACKS]; ///< End of the data of each track, if known. Only tracks with a known end are compiled.
 	byte   _numTracks;     ///< Count of total tracks for multi-track MIDI formats. 1 for single-track formats.
 	byte   _activeTrack;   ///< Keeps track of the currently active track, in multi-track formats.
 
@@ -336,6 +365,16 @@ protected:
 	virtual void parseNextEvent(EventInfo &info) = 0;
 	virtual bool processEvent(const EventInfo &info, bool fireEvents = true);
 
+	/**
+	 * Retrieves the event at the current position of the active track. This
+	 * returns the pre-parsed event if the track has been compiled and
+	 * otherwise calls parseNextEvent.
+	 */
+	void fetchNextEvent(EventInfo &info);
+	void compileTrack(uint8 track);
+	void clearCompiledTracks();
+	bool jumpToTickCompiled(uint32 tick);
+
 	void activeNote(byte channel, byte note, bool active);
 	void hangingNote(byte channel, byte note, uint32 ticksLeft, bool recycle = true);
 	void hangAllActiveNotes();
@@ -423,14 +462,26 @@ public:
 		  * or setting the track. Use startPlaying to start playback.
 		  * Note that not every parser implementation might support this.
 		  */
-		 mpDisableAutoStartPlayback = 7
+		 mpDisableAutoStartPlayback = 7,
+
+		 /**
+		  * Parses each track once into a flat array of events with absolute
+		  * ticks, so playback no longer decodes the raw track data and
+		  * looping or jumpToTick without firing events does not need to
+		  * rescan the track. The track is compiled the first time it is
+		  * played. Only parsers which do not keep parsing state outside
+		  * of the tracker and know where their tracks end (currently the
+		  * SMF parser) support this, and enable it by default; it is
+		  * ignored by the others.
+		  */
+		 mpCompileTracks = 8
 	};
 
 public:
 	typedef void (*XMidiCallbackProc)(byte eventData, void *refCon);
 
 	MidiParser(int8 source = -1);
-	virtual ~MidiParser() { stopPlaying(); }
+	virtual ~MidiParser() { stopPlaying(); clearCompiledTracks(); }
 
 	virtual bool loadMusic(byte *data, uint32 size) = 0;
 	virtual void unloadMusic();
@@ -30,6 +30,8 @@ static const byte commandLengths[8] = { 3, 3, 3, 3, 2, 2, 3, 0 };
 static const byte specialLengths[16] = { 0, 2, 3, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0 };
 
 MidiParser_SMF::MidiParser_SMF(int8 source) : MidiParser(source), _buffer(nullptr) {
+	_canCompileTracks = true;
+	_compileTracks = true;
 	for (int i = 0; i < ARRAYSIZE(_noteChannelToTrack); i++)
 		_noteChannelToTrack[i] = -1;
 }
@@ -176,6 +178,7 @@ bool MidiParser_SMF::loadMusic(byte *data, uint32 size) {
 		pos += 4;
 		len = read4high(pos);
 		pos += len;
+		_trackEnds[tracksRead] = MIN(pos, data + size);
 		++tracksRead;
 	}
 
@@ -189,9 +192,10 @@ bool MidiParser_SMF::loadMusic(byte *data, uint32 size) {
 		// Inherit the Earth MIDIs. Jamieson630 said something about a
 		// better fix, but this will have to do in the meantime.
 		_buffer = (byte *)malloc(size * 2);
-		compressToType0(_tracks, _numTracks, _buffer, false);
+		const uint32 bufferSize = compressToType0(_tracks, _numTracks, _buffer, false);
 		_numTracks = 1;
 		_tracks[0] = _buffer;
+		_trackEnds[0] = _buffer + bufferSize;
 	}
 
 	// Note that we assume the original data passed in
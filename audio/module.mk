@@ -8,6 +8,7 @@ MODULE_OBJS := \
 	cms.o \
 	fmopl.o \
 	mididrv.o \
+	mididrv_base.o \
 	mididrv_ms.o \
 	midiparser_qt.o \
 	midiparser_smf.o \
@@ -70,6 +71,7 @@ MODULE_OBJS := \
 	softsynth/fluidsynth.o \
 	softsynth/mt32.o \
 	softsynth/eas.o \
+	softsynth/emumidi.o \
 	softsynth/pcspk.o \
 	softsynth/sid.o \
 	softsynth/wave6581.o \
@@ -0,0 +1,203 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "audio/softsynth/emumidi.h"
+
+#include "common/debug.h"
+#include "common/system.h"
+#include "common/timer.h"
+#include "common/util.h"
+
+// Size of the blocks the render-ahead timer proc synthesizes, in frames
+#define RENDER_AHEAD_CHUNK 512
+
+// Interval of the render-ahead timer proc, in microseconds
+#define RENDER_AHEAD_INTERVAL 10000
+
+// Maximum number of chunks synthesized per call of the render-ahead timer
+// proc. The timer procs of all the other subsystems run on the same thread,
+// so a call must not take much longer than the interval even while the ring
+// buffer is filled up. Two chunks are still more than an interval's worth of
+// audio at the usual output rates, so the ring buffer fills up over time.
+#define RENDER_AHEAD_CHUNKS_PER_CALL 2
+
+MidiDriver_Emulated *MidiDriver_Emulated::_renderAheadDriver = nullptr;
+
+MidiDriver_Emulated::~MidiDriver_Emulated() {
+	stopRenderAhead();
+}
+
+int MidiDriver_Emulated::readBuffer(int16 *data, const int numSamples) {
+	const int stereoFactor = isStereo() ? 2 : 1;
+	int len = numSamples / stereoFactor;
+
+	if (_renderAheadBuffer) {
+		int read = readRenderAhead(data, len);
+		data += read * stereoFactor;
+		len -= read;
+		if (!len)
+			return numSamples;
+
+		// The timer proc did not keep up, so synthesize the rest here. The
+		// ring buffer is checked again once we own the synthesizer, since a
+		// chunk may have been completed in the meantime.
+		Common::StackLock lock(_renderMutex);
+		read = readRenderAhead(data, len);
+		data += read * stereoFactor;
+		len -= read;
+		if (len) {
+			debug(5, "MidiDriver_Emulated: Render-ahead underrun of %d frames", len);
+			renderTicked(data, len);
+		}
+		return numSamples;
+	}
+
+	renderTicked(data, len);
+	return numSamples;
+}
+
+void MidiDriver_Emulated::renderTicked(int16 *data, int len) {
+	const int stereoFactor = isStereo() ? 2 : 1;
+	int step;
+
+	do {
+		step = len;
+		if (step > (_nextTick >> FIXP_SHIFT))
+			step = (_nextTick >> FIXP_SHIFT);
+
+		generateSamples(data, step);
+
+		_nextTick -= step << FIXP_SHIFT;
+		if (!(_nextTick >> FIXP_SHIFT)) {
+			if (_timerProc)
+				(*_timerProc)(_timerParam);
+
+			onTimer();
+
+			_nextTick += _samplesPerTick;
+		}
+
+		data += step * stereoFactor;
+		len -= step;
+	} while (len);
+}
+
+void MidiDriver_Emulated::startRenderAhead(uint ms) {
+	stopRenderAhead();
+
+	if (!ms || _renderAheadDriver)
+		return;
+
+	const int stereoFactor = isStereo() ? 2 : 1;
+	_renderAheadSize = MAX<uint>((uint)getRate() * ms / 1000, RENDER_AHEAD_CHUNK);
+	_renderAheadStart = 0;
+	_renderAheadAvailable = 0;
+	_renderAheadStopping = false;
+	_renderAheadBuffer = new int16[_renderAheadSize * stereoFactor];
+	_renderAheadChunk = new int16[RENDER_AHEAD_CHUNK * stereoFactor];
+
+	_renderAheadDriver = this;
+	g_system->getTimerManager()->installTimerProc(renderAheadTimerProc, RENDER_AHEAD_INTERVAL, this, "MidiDriver_Emulated");
+}
+
+void MidiDriver_Emulated::stopRenderAhead() {
+	if (_renderAheadDriver != this)
+		return;
+
+	// Make a pending call of the timer proc return without synthesizing
+	// anything, then remove the timer proc. No lock may be held while
+	// removing it, since removeTimerProc() waits for the timer proc to
+	// return, and the timer proc takes the locks. Once removeTimerProc()
+	// returns the timer proc is guaranteed not to be running anymore, so the
+	// buffers can be released safely.
+	{
+		Common::StackLock lock(_renderAheadMutex);
+		_renderAheadStopping = true;
+	}
+	g_system->getTimerManager()->removeTimerProc(renderAheadTimerProc);
+	_renderAheadDriver = nullptr;
+
+	Common::StackLock lock(_renderAheadMutex);
+	delete[] _renderAheadBuffer;
+	_renderAheadBuffer = nullptr;
+	delete[] _renderAheadChunk;
+	_renderAheadChunk = nullptr;
+	_renderAheadSize = 0;
+	_renderAheadStart = 0;
+	_renderAheadAvailable = 0;
+}
+
+int MidiDriver_Emulated::readRenderAhead(int16 *data, int len) {
+	const int stereoFactor = isStereo() ? 2 : 1;
+	Common::StackLock lock(_renderAheadMutex);
+
+	int read = 0;
+	while (read < len && _renderAheadAvailable) {
+		uint step = MIN<uint>(len - read, _renderAheadAvailable);
+		step = MIN<uint>(step, _renderAheadSize - _renderAheadStart);
+
+		memcpy(data + read * stereoFactor, _renderAheadBuffer + _renderAheadStart * stereoFactor, step * stereoFactor * sizeof(int16));
+
+		_renderAheadStart = (_renderAheadStart + step) % _renderAheadSize;
+		_renderAheadAvailable -= step;
+		read += step;
+	}
+
+	return read;
+}
+
+void MidiDriver_Emulated::fillRenderAhead() {
+	const int stereoFactor = isStereo() ? 2 : 1;
+
+	for (int i = 0; i < RENDER_AHEAD_CHUNKS_PER_CALL; i++) {
+		// The synthesizer lock is only held for a single chunk, so that an
+		// underrunning readBuffer() never has to wait for long.
+		Common::StackLock lock(_renderMutex);
+
+		uint chunk;
+		{
+			Common::StackLock ringLock(_renderAheadMutex);
+			if (_renderAheadStopping)
+				break;
+			chunk = MIN<uint>(_renderAheadSize - _renderAheadAvailable, RENDER_AHEAD_CHUNK);
+		}
+		if (!chunk)
+			break;
+
+		renderTicked(_renderAheadChunk, chunk);
+
+		Common::StackLock ringLock(_renderAheadMutex);
+		uint written = 0;
+		while (written < chunk) {
+			uint end = (_renderAheadStart + _renderAheadAvailable) % _renderAheadSize;
+			uint step = MIN<uint>(chunk - written, _renderAheadSize - end);
+
+			memcpy(_renderAheadBuffer + end * stereoFactor, _renderAheadChunk + written * stereoFactor, step * stereoFactor * sizeof(int16));
+
+			_renderAheadAvailable += step;
+			written += step;
+		}
+	}
+}
+
+void MidiDriver_Emulated::renderAheadTimerProc(void *refCon) {
+	static_cast<MidiDriver_Emulated *>(refCon)->fillRenderAhead();
+}
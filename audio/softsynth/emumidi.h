@@ -25,6 +25,7 @@
 #include "audio/audiostream.h"
 #include "audio/mididrv.h"
 #include "audio/mixer.h"
+#include "common/mutex.h"
 
 class MidiDriver_Emulated : public Audio::AudioStream, public MidiDriver {
 protected:
@@ -43,12 +44,59 @@ private:
 	int _nextTick;
 	int _samplesPerTick;
 
+	/**
+	 * Render-ahead state. The synthesizer is driven from a timer proc which
+	 * keeps a ring buffer of up to _renderAheadSize frames filled, and
+	 * readBuffer() only copies from that ring buffer. When the ring runs dry
+	 * the missing frames are synthesized inline, as without render-ahead.
+	 */
+	Common::Mutex _renderMutex;      ///< Serializes access to the synthesizer
+	Common::Mutex _renderAheadMutex; ///< Protects the ring buffer positions
+	int16 *_renderAheadBuffer;
+	int16 *_renderAheadChunk;
+	uint _renderAheadSize;
+	uint _renderAheadStart;
+	uint _renderAheadAvailable;
+	bool _renderAheadStopping;       ///< Set once stopRenderAhead() was called
+
+	static MidiDriver_Emulated *_renderAheadDriver;
+
+	void renderTicked(int16 *data, int len);
+	int readRenderAhead(int16 *data, int len);
+	void fillRenderAhead();
+	static void renderAheadTimerProc(void *refCon);
+
 protected:
 	int _baseFreq;
 
 	virtual void generateSamples(int16 *buf, int len) = 0;
 	virtual void onTimer() {}
 
+	/**
+	 * Start synthesizing ahead of the mixer on a timer proc. The synthesizer
+	 * must be fully initialized when this is called, and stopRenderAhead()
+	 * must be called before it is torn down.
+	 *
+	 * Only one driver can render ahead at a time; other drivers keep
+	 * synthesizing in the mixer callback.
+	 *
+	 * @param ms	Amount of audio to keep rendered ahead, in milliseconds.
+	 *			Larger values survive longer synthesis spikes at the cost
+	 *			of a higher latency for MIDI events not sent from the
+	 *			timer callback. 0 disables render-ahead.
+	 */
+	void startRenderAhead(uint ms);
+
+	/**
+	 * Stop synthesizing ahead of the mixer and discard any audio which was
+	 * rendered but not yet played.
+	 *
+	 * This waits for the render-ahead timer proc to return, which may be
+	 * running the timer callback. It must thus be called before locking
+	 * anything the timer callback or generateSamples() lock as well.
+	 */
+	void stopRenderAhead();
+
 public:
 	MidiDriver_Emulated(Audio::Mixer *mixer) :
 		_mixer(mixer),
@@ -57,9 +105,17 @@ public:
 		_timerParam(0),
 		_nextTick(0),
 		_samplesPerTick(0),
+		_renderAheadBuffer(nullptr),
+		_renderAheadChunk(nullptr),
+		_renderAheadSize(0),
+		_renderAheadStart(0),
+		_renderAheadAvailable(0),
+		_renderAheadStopping(false),
 		_baseFreq(250) {
 	}
 
+	virtual ~MidiDriver_Emulated();
+
 	// MidiDriver API
 	virtual int open() {
 		_isOpen = true;
@@ -87,34 +143,7 @@ public:
 	}
 
 	// AudioStream API
-	virtual int readBuffer(int16 *data, const int numSamples) {
-		const int stereoFactor = isStereo() ? 2 : 1;
-		int len = numSamples / stereoFactor;
-		int step;
-
-		do {
-			step = len;
-			if (step > (_nextTick >> FIXP_SHIFT))
-				step = (_nextTick >> FIXP_SHIFT);
-
-			generateSamples(data, step);
-
-			_nextTick -= step << FIXP_SHIFT;
-			if (!(_nextTick >> FIXP_SHIFT)) {
-				if (_timerProc)
-					(*_timerProc)(_timerParam);
-
-				onTimer();
-
-				_nextTick += _samplesPerTick;
-			}
-
-			data += step * stereoFactor;
-			len -= step;
-		} while (len);
-
-		return numSamples;
-	}
+	virtual int readBuffer(int16 *data, const int numSamples);
 
 	virtual bool endOfData() const {
 		return false;
@@ -459,6 +459,8 @@ int MidiDriver_FluidSynth::open() {
 
 	MidiDriver_Emulated::open();
 
+	startRenderAhead(ConfMan.getInt("midi_renderahead"));
+
 	_mixer->playStream(Audio::Mixer::kPlainSoundType, &_mixerSoundHandle, this, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, true);
 
 	return 0;
@@ -469,6 +471,7 @@ void MidiDriver_FluidSynth::close() {
 		return;
 	_isOpen = false;
 
+	stopRenderAhead();
 	_mixer->stopHandle(_mixerSoundHandle);
 
 	if (_soundFont != -1)
@@ -215,6 +215,8 @@ int MidiDriver_MT32::open() {
 
 	MidiDriver_Emulated::open();
 
+	startRenderAhead(ConfMan.getInt("midi_renderahead"));
+
 	_mixer->playStream(Audio::Mixer::kPlainSoundType, &_mixerSoundHandle, this, -1, Audio::Mixer::kMaxChannelVolume, 0, DisposeAfterUse::NO, true);
 
 	return 0;
@@ -263,6 +265,9 @@ void MidiDriver_MT32::close() {
 		return;
 	_isOpen = false;
 
+	// Stop the render-ahead timer proc, which may be running the player
+	// callback handler, before anything is locked
+	stopRenderAhead();
 	// Detach the player callback handler
 	setTimerCallback(nullptr, nullptr);
 	// Detach the mixer callback handler
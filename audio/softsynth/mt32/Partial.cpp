@@ -19,6 +19,12 @@
 
 #include "internals.h"
 
+#if defined(MT32EMU_MIXER_SSE2)
+#include <emmintrin.h>
+#elif defined(MT32EMU_MIXER_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "Partial.h"
 #include "Part.h"
 #include "PartialManager.h"
@@ -356,6 +362,93 @@ void Partial::produceAndMixSample(FloatSample *&leftBuf, FloatSample *&rightBuf,
 	*(rightBuf++) += rightOut;
 }
 
+void Partial::mixPannedBlock(IntSample *buf, const IntSample *block, Bit32u length, Bit32s panValue) {
+	Bit32u i = 0;
+#if defined(MT32EMU_MIXER_SSE2)
+	// Pan values are within [-8192, 8192], so both multiplicands fit 16 bits and the full 32-bit product
+	// is recovered from the low and high halves. The final saturating pack does the same as clipSampleEx().
+	const __m128i pan = _mm_set1_epi16(Bit16s(panValue));
+	for (; i + 8 <= length; i += 8) {
+		__m128i samples = _mm_loadu_si128((const __m128i *)(block + i));
+		__m128i productLo = _mm_mullo_epi16(samples, pan);
+		__m128i productHi = _mm_mulhi_epi16(samples, pan);
+		__m128i out0 = _mm_srai_epi32(_mm_unpacklo_epi16(productLo, productHi), 13);
+		__m128i out1 = _mm_srai_epi32(_mm_unpackhi_epi16(productLo, productHi), 13);
+		__m128i dst = _mm_loadu_si128((const __m128i *)(buf + i));
+		out0 = _mm_add_epi32(out0, _mm_srai_epi32(_mm_unpacklo_epi16(dst, dst), 16));
+		out1 = _mm_add_epi32(out1, _mm_srai_epi32(_mm_unpackhi_epi16(dst, dst), 16));
+		_mm_storeu_si128((__m128i *)(buf + i), _mm_packs_epi32(out0, out1));
+	}
+#elif defined(MT32EMU_MIXER_NEON)
+	const int16x4_t pan = vdup_n_s16(Bit16s(panValue));
+	for (; i + 8 <= length; i += 8) {
+		int16x8_t samples = vld1q_s16(block + i);
+		int16x8_t dst = vld1q_s16(buf + i);
+		int32x4_t out0 = vaddw_s16(vshrq_n_s32(vmull_s16(vget_low_s16(samples), pan), 13), vget_low_s16(dst));
+		int32x4_t out1 = vaddw_s16(vshrq_n_s32(vmull_s16(vget_high_s16(samples), pan), 13), vget_high_s16(dst));
+		vst1q_s16(buf + i, vcombine_s16(vqmovn_s32(out0), vqmovn_s32(out1)));
+	}
+#endif
+	for (; i < length; i++) {
+		buf[i] = Synth::clipSampleEx(((IntSampleEx(block[i]) * panValue) >> 13) + IntSampleEx(buf[i]));
+	}
+}
+
+void Partial::mixPannedBlock(FloatSample *buf, const FloatSample *block, Bit32u length, Bit32s panValue) {
+	const FloatSample pan = FloatSample(panValue);
+	Bit32u i = 0;
+#if defined(MT32EMU_MIXER_SSE2)
+	// Dividing rather than multiplying by a reciprocal keeps the results identical to the scalar code.
+	const __m128 panVec = _mm_set1_ps(pan);
+	const __m128 divisor = _mm_set1_ps(14.0f);
+	for (; i + 4 <= length; i += 4) {
+		__m128 out = _mm_div_ps(_mm_mul_ps(_mm_loadu_ps(block + i), panVec), divisor);
+		_mm_storeu_ps(buf + i, _mm_add_ps(_mm_loadu_ps(buf + i), out));
+	}
+#endif
+	for (; i < length; i++) {
+		buf[i] += (block[i] * pan) / 14.0f;
+	}
+}
+
+#if MT32EMU_USE_SIMD_MIXER
+
+template <class Sample, class LA32PairImpl>
+bool Partial::doProduceOutput(Sample *leftBuf, Sample *rightBuf, Bit32u length, LA32PairImpl *la32PairImpl) {
+	if (!canProduceOutput()) return false;
+	alreadyOutputed = true;
+
+	// The LA32 state machines (ramps, TVA / TVF interrupts) are inherently sequential, so the samples are still
+	// generated one by one. Only panning and mixing into the output buffers is carried out per block.
+	static const Bit32u MIX_BLOCK_SIZE = 128;
+	Sample block[MIX_BLOCK_SIZE];
+
+	sampleNum = 0;
+	while (sampleNum < length) {
+		Bit32u blockLength = 0;
+		Bit32u blockSize = length - sampleNum;
+		if (blockSize > MIX_BLOCK_SIZE) blockSize = MIX_BLOCK_SIZE;
+		bool stopped = false;
+		while (blockLength < blockSize) {
+			if (!generateNextSample(la32PairImpl)) {
+				stopped = true;
+				break;
+			}
+			block[blockLength++] = la32PairImpl->nextOutSample();
+			sampleNum++;
+		}
+		mixPannedBlock(leftBuf, block, blockLength, leftPanValue);
+		mixPannedBlock(rightBuf, block, blockLength, rightPanValue);
+		leftBuf += blockLength;
+		rightBuf += blockLength;
+		if (stopped) break;
+	}
+	sampleNum = 0;
+	return true;
+}
+
+#else // #if MT32EMU_USE_SIMD_MIXER
+
 template <class Sample, class LA32PairImpl>
 bool Partial::doProduceOutput(Sample *leftBuf, Sample *rightBuf, Bit32u length, LA32PairImpl *la32PairImpl) {
 	if (!canProduceOutput()) return false;
@@ -369,6 +462,8 @@ bool Partial::doProduceOutput(Sample *leftBuf, Sample *rightBuf, Bit32u length,
 	return true;
 }
 
+#endif // #if MT32EMU_USE_SIMD_MIXER
+
 bool Partial::produceOutput(IntSample *leftBuf, IntSample *rightBuf, Bit32u length) {
 	if (floatMode) {
 		synth->printDebug("Partial: Invalid call to produceOutput()! Renderer = %d\n", synth->getSelectedRendererType());
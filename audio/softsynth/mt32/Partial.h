@@ -124,6 +124,11 @@ public:
 	// made from combining this single partial with its pair, if it has one.
 	bool produceOutput(IntSample *leftBuf, IntSample *rightBuf, Bit32u length);
 	bool produceOutput(FloatSample *leftBuf, FloatSample *rightBuf, Bit32u length);
+
+	// Pans a block of partial output samples and mixes them into a single channel buffer.
+	// The result is identical to what produceAndMixSample() computes for each sample.
+	static void mixPannedBlock(IntSample *buf, const IntSample *block, Bit32u length, Bit32s panValue);
+	static void mixPannedBlock(FloatSample *buf, const FloatSample *block, Bit32u length, Bit32s panValue);
 }; // class Partial
 
 } // namespace MT32Emu
@@ -87,6 +87,21 @@
 #define MT32EMU_BOSS_REVERB_PRECISE_MODE 0
 #endif
 
+// 0: Partial output is panned and mixed into the stereo buffers one sample at a time.
+// 1: Partial output is rendered in blocks which are panned and mixed using SSE2 / NEON instructions when available.
+//    The integer renderer produces bit-exact results in both modes.
+#ifndef MT32EMU_USE_SIMD_MIXER
+#define MT32EMU_USE_SIMD_MIXER 1
+#endif
+
+// SSE2 is part of the x86-64 baseline and NEON of the AArch64 one, so the block mixer uses them without
+// requiring any extra compiler flag.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MT32EMU_MIXER_SSE2
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define MT32EMU_MIXER_NEON
+#endif
+
 namespace MT32Emu {
 
 typedef Bit16s IntSample;
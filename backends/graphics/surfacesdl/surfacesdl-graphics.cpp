@@ -25,6 +25,7 @@
 #include "backends/graphics/surfacesdl/surfacesdl-graphics.h"
 #include "backends/events/sdl/sdl-events.h"
 #include "common/config-manager.h"
+#include "common/debug.h"
 #include "common/mutex.h"
 #include "common/textconsole.h"
 #include "common/translation.h"
@@ -136,6 +137,10 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 #endif
 	_transactionMode(kTransactionNone),
 	_scalerPlugins(ScalerMan.getPlugins()), _scalerPlugin(nullptr), _scaler(nullptr),
+	_scalerPool(nullptr),
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	_scalerTicks(0), _scalerFrames(0),
+#endif
 	_needRestoreAfterOverlay(false), _isInOverlayPalette(false), _isDoubleBuf(false), _prevForceRedraw(false), _numPrevDirtyRects(0),
 	_prevCursorNeedsRedraw(false),
 	_mouseKeyColor(0) {
@@ -158,6 +163,9 @@ SurfaceSdlGraphicsManager::SurfaceSdlGraphicsManager(SdlEventSource *sdlEventSou
 	_mouseLastRect.x = _mouseLastRect.y = _mouseLastRect.w = _mouseLastRect.h = 0;
 	_mouseNextRect.x = _mouseNextRect.y = _mouseNextRect.w = _mouseNextRect.h = 0;
 
+	_numDirtyRects = 0;
+	_dirtyRegion.setMaxRects(NUM_DIRTY_RECT);
+
 #ifdef USE_SDL_DEBUG_FOCUSRECT
 	if (ConfMan.hasKey("use_sdl_debug_focusrect"))
 		_enableFocusRectDebugCode = ConfMan.getBool("use_sdl_debug_focusrect");
@@ -190,6 +198,7 @@ SurfaceSdlGraphicsManager::~SurfaceSdlGraphicsManager() {
 	unloadGFXMode();
 	delete _scaler;
 	delete _mouseScaler;
+	delete _scalerPool;
 	if (_mouseOrigSurface) {
 		SDL_FreeSurface(_mouseOrigSurface);
 		if (_mouseOrigSurface == _mouseSurface) {
@@ -652,8 +661,17 @@ void SurfaceSdlGraphicsManager::setGraphicsModeIntern() {
 
 		_scalerPlugin = &_scalerPlugins[_videoMode.scalerIndex]->get<ScalerPluginObject>();
 		_scaler = _scalerPlugin->createInstance(format);
+
+		// The threads are only started once a scaler can make use of them
+		if (_scalerPlugin->isReentrant() && !_scalerPool)
+			_scalerPool = new ScalerThreadPool();
 	}
 
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	_scalerTicks = 0;
+	_scalerFrames = 0;
+#endif
+
 	_scaler->setFactor(_videoMode.scaleFactor);
 	_extraPixels = _scalerPlugin->extraPixels();
 	_useOldSrc = _scalerPlugin->useOldSource();
@@ -1146,6 +1164,24 @@ void SurfaceSdlGraphicsManager::updateScreen(SDL_Rect *dirtyRectList, int actual
 	SDL_UpdateRects(_hwScreen, actualDirtyRects, dirtyRectList);
 }
 
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+void SurfaceSdlGraphicsManager::updateScalerTimings(Uint64 ticks) {
+	// Number of scaled frames to average the timings over
+	const uint kScalerTimingFrames = 300;
+
+	_scalerTicks += ticks;
+	if (++_scalerFrames < kScalerTimingFrames)
+		return;
+
+	const double msPerFrame = 1000.0 * _scalerTicks / SDL_GetPerformanceFrequency() / _scalerFrames;
+	const uint numThreads = (_scalerPool && _scalerPlugin->isReentrant()) ? _scalerPool->getNumThreads() : 1;
+	debug(2, "Scaler %s %dx: %.3f ms per scaled frame, %d thread(s)", _scalerPlugin->getName(), _videoMode.scaleFactor, msPerFrame, numThreads);
+
+	_scalerTicks = 0;
+	_scalerFrames = 0;
+}
+#endif
+
 void SurfaceSdlGraphicsManager::internUpdateScreen() {
 	SDL_Surface *srcSurf, *origSurf;
 	int height, width;
@@ -1277,6 +1313,41 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 		_isInOverlayPalette = _overlayVisible;
 	}
 
+	// Coalesce the dirty areas into the rects to update, unless they are so
+	// fragmented that redrawing everything is cheaper
+	_numDirtyRects = 0;
+	if (!_forceRedraw && !_dirtyRegion.isEmpty()) {
+		if (!_dirtyRegion.getRects(_dirtyRegionRects)) {
+			_forceRedraw = true;
+		} else {
+			for (uint i = 0; i < _dirtyRegionRects.size(); ++i) {
+				// The region covers both the game screen and the overlay
+				Common::Rect rect = _dirtyRegionRects[i];
+				rect.clip(Common::Rect(width, height));
+				if (rect.isEmpty())
+					continue;
+
+				int x = rect.left;
+				int y = rect.top;
+				int w = rect.width();
+				int h = rect.height();
+
+#ifdef USE_ASPECT
+				// The tiles are not aligned on the stretched lines
+				if (_videoMode.aspectRatioCorrection && !_overlayInGUI)
+					makeRectStretchable(x, y, w, h, _videoMode.filtering);
+#endif
+
+				SDL_Rect *r = &_dirtyRectList[_numDirtyRects++];
+				r->x = x;
+				r->y = y;
+				r->w = w;
+				r->h = h;
+			}
+		}
+	}
+	_dirtyRegion.clear();
+
 	// In case of double buferring partially good version may be on another page,
 	// so we need to fully redraw
 	if (_isDoubleBuf && _numDirtyRects)
@@ -1328,6 +1399,11 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 		srcPitch = srcSurf->pitch;
 		dstPitch = _hwScreen->pitch;
 
+		const bool useScalerPool = _scalerPool && _scalerPlugin->isReentrant();
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+		const Uint64 scaleStart = SDL_GetPerformanceCounter();
+#endif
+
 		for (r = _dirtyRectList; r != lastRect; ++r) {
 			int src_x = r->x;
 			int src_y = r->y;
@@ -1372,8 +1448,12 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 				if (_videoMode.aspectRatioCorrection && !_overlayInGUI)
 					dst_y = real2Aspect(dst_y);
 
-				_scaler->scale((byte *)srcSurf->pixels + (src_x + _maxExtraPixels) * bpp + (src_y + _maxExtraPixels) * srcPitch, srcPitch,
-						(byte *)_hwScreen->pixels + dst_x * bpp + dst_y * dstPitch, dstPitch, dst_w, dst_h, src_x, src_y);
+				const byte *srcPtr = (byte *)srcSurf->pixels + (src_x + _maxExtraPixels) * bpp + (src_y + _maxExtraPixels) * srcPitch;
+				byte *dstPtr = (byte *)_hwScreen->pixels + dst_x * bpp + dst_y * dstPitch;
+				if (useScalerPool && _scalerPool->shouldSplit(dst_w, dst_h))
+					_scalerPool->scale(_scaler, srcPtr, srcPitch, dstPtr, dstPitch, dst_w, dst_h, src_x, src_y);
+				else
+					_scaler->scale(srcPtr, srcPitch, dstPtr, dstPitch, dst_w, dst_h, src_x, src_y);
 
 				r->x = dst_x;
 				r->y = dst_y;
@@ -1386,6 +1466,10 @@ void SurfaceSdlGraphicsManager::internUpdateScreen() {
 			}
 #endif
 		}
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+		if (actualDirtyRects > 0)
+			updateScalerTimings(SDL_GetPerformanceCounter() - scaleStart);
+#endif
 		SDL_UnlockSurface(srcSurf);
 		SDL_UnlockSurface(_hwScreen);
 
@@ -1689,11 +1773,6 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool in
 	if (_forceRedraw)
 		return;
 
-	if (_numDirtyRects == NUM_DIRTY_RECT) {
-		_forceRedraw = true;
-		return;
-	}
-
 	int height, width;
 
 	if (!inOverlay && !realCoordinates) {
@@ -1745,12 +1824,9 @@ void SurfaceSdlGraphicsManager::addDirtyRect(int x, int y, int w, int h, bool in
 	}
 
 	if (w > 0 && h > 0) {
-		SDL_Rect *r = &_dirtyRectList[_numDirtyRects++];
-
-		r->x = x;
-		r->y = y;
-		r->w = w;
-		r->h = h;
+		_dirtyRegion.setSize(MAX(_videoMode.screenWidth, _videoMode.overlayWidth),
+		                     MAX(_videoMode.screenHeight, _videoMode.overlayHeight));
+		_dirtyRegion.addRect(Common::Rect(x, y, x + w, y + h));
 	}
 }
 
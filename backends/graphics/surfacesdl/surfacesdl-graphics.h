@@ -24,6 +24,8 @@
 
 #include "backends/graphics/graphics.h"
 #include "backends/graphics/sdl/sdl-graphics.h"
+#include "backends/graphics/surfacesdl/surfacesdl-scaler-pool.h"
+#include "graphics/dirty_region.h"
 #include "graphics/pixelformat.h"
 #include "graphics/scaler.h"
 #include "graphics/scalerplugin.h"
@@ -332,6 +334,17 @@ protected:
 	uint _maxExtraPixels;
 	uint _extraPixels;
 
+	/** Threads for scaling large rects with re-entrant scalers */
+	ScalerThreadPool *_scalerPool;
+
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	// Time spent scaling, reported at debug level 2
+	Uint64 _scalerTicks;
+	uint _scalerFrames;
+
+	void updateScalerTimings(Uint64 ticks);
+#endif
+
 	bool _screenIsLocked;
 	Graphics::Surface _framebuffer;
 
@@ -349,6 +362,11 @@ protected:
 	SDL_Rect _dirtyRectList[2 * NUM_DIRTY_RECT];
 	int _numDirtyRects;
 
+	// Areas marked dirty since the last update, turned into the rects of
+	// _dirtyRectList when updating
+	Graphics::DirtyRegion _dirtyRegion;
+	Common::Array<Common::Rect> _dirtyRegionRects;
+
 	SDL_Rect _prevDirtyRectList[NUM_DIRTY_RECT];
 	int _numPrevDirtyRects;
 
@@ -0,0 +1,147 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "backends/graphics/surfacesdl/surfacesdl-scaler-pool.h"
+#include "common/textconsole.h"
+
+enum {
+	// Smallest band worth handing to a thread, in source rows
+	kMinBandHeight = 16,
+	// Smallest rect worth splitting, in source pixels
+	kMinSplitArea = 320 * 64,
+	kMaxWorkers = 7
+};
+
+void ScalerThreadPool::Band::scale() const {
+	scaler->scale(srcPtr, srcPitch, dstPtr, dstPitch, width, height, x, y);
+}
+
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+
+ScalerThreadPool::ScalerThreadPool() : _workers(nullptr), _done(nullptr), _quit(false), _numWorkers(0) {
+	const int numWorkers = CLIP<int>(SDL_GetCPUCount() - 1, 0, kMaxWorkers);
+	if (numWorkers == 0)
+		return;
+
+	_done = SDL_CreateSemaphore(0);
+	if (!_done)
+		return;
+
+	_workers = new Worker[numWorkers];
+	for (int i = 0; i < numWorkers; ++i) {
+		Worker &worker = _workers[i];
+		worker.pool = this;
+		worker.thread = nullptr;
+		worker.start = SDL_CreateSemaphore(0);
+		if (worker.start)
+			worker.thread = SDL_CreateThread(workerProc, "ScummVM scaler", &worker);
+		if (!worker.thread) {
+			warning("Could not create scaler thread: %s", SDL_GetError());
+			if (worker.start)
+				SDL_DestroySemaphore(worker.start);
+			break;
+		}
+		_numWorkers++;
+	}
+}
+
+ScalerThreadPool::~ScalerThreadPool() {
+	_quit = true;
+	for (uint i = 0; i < _numWorkers; ++i) {
+		SDL_SemPost(_workers[i].start);
+		SDL_WaitThread(_workers[i].thread, nullptr);
+		SDL_DestroySemaphore(_workers[i].start);
+	}
+	delete[] _workers;
+
+	if (_done)
+		SDL_DestroySemaphore(_done);
+}
+
+int SDLCALL ScalerThreadPool::workerProc(void *data) {
+	Worker *worker = (Worker *)data;
+
+	while (true) {
+		SDL_SemWait(worker->start);
+		if (worker->pool->_quit)
+			break;
+
+		worker->band.scale();
+		SDL_SemPost(worker->pool->_done);
+	}
+
+	return 0;
+}
+
+#else
+
+ScalerThreadPool::ScalerThreadPool() : _numWorkers(0) {
+}
+
+ScalerThreadPool::~ScalerThreadPool() {
+}
+
+#endif
+
+bool ScalerThreadPool::shouldSplit(int width, int height) const {
+	return _numWorkers > 0 && height >= 2 * kMinBandHeight && width * height >= kMinSplitArea;
+}
+
+void ScalerThreadPool::scale(Scaler *scaler, const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
+                             uint32 dstPitch, int width, int height, int x, int y) {
+	const uint numBands = MIN<uint>(getNumThreads(), height / kMinBandHeight);
+	if (numBands < 2) {
+		scaler->scale(srcPtr, srcPitch, dstPtr, dstPitch, width, height, x, y);
+		return;
+	}
+
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	const uint factor = scaler->getFactor();
+
+	// Hand out the bands from the top to the workers, and scale the last
+	// one on this thread.
+	int bandY = 0;
+	for (uint i = 0; i < numBands; ++i) {
+		Band band;
+		band.scaler = scaler;
+		band.srcPtr = srcPtr + bandY * srcPitch;
+		band.srcPitch = srcPitch;
+		band.dstPtr = dstPtr + bandY * factor * dstPitch;
+		band.dstPitch = dstPitch;
+		band.width = width;
+		band.height = height * (i + 1) / numBands - bandY;
+		band.x = x;
+		band.y = y + bandY;
+		bandY += band.height;
+
+		if (i + 1 < numBands) {
+			_workers[i].band = band;
+			SDL_SemPost(_workers[i].start);
+		} else {
+			band.scale();
+		}
+	}
+
+	for (uint i = 0; i + 1 < numBands; ++i)
+		SDL_SemWait(_done);
+#endif
+}
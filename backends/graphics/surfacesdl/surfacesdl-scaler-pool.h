@@ -0,0 +1,94 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef BACKENDS_GRAPHICS_SURFACESDL_SCALER_POOL_H
+#define BACKENDS_GRAPHICS_SURFACESDL_SCALER_POOL_H
+
+#include "backends/platform/sdl/sdl-sys.h"
+#include "graphics/scalerplugin.h"
+
+/**
+ * Pool of worker threads used to scale large rects in parallel.
+ *
+ * The rect is split into horizontal bands, one per thread including the
+ * calling one. Scalers read up to extraPixels() around each pixel from the
+ * source, which is left untouched while scaling, so bands do not need to be
+ * copied with an overlap; each band reads its neighbours' rows directly.
+ * Bands write to disjoint parts of the destination.
+ *
+ * Only scalers whose plugin declares them re-entrant may be used with the
+ * pool. Threads are only available with SDL 2; otherwise all scaling is
+ * done on the calling thread.
+ */
+class ScalerThreadPool {
+public:
+	ScalerThreadPool();
+	~ScalerThreadPool();
+
+	/**
+	 * Return whether a rect of the given size is worth splitting into
+	 * bands.
+	 */
+	bool shouldSplit(int width, int height) const;
+
+	/**
+	 * Scale a rect, see Scaler::scale(). The call returns once the whole
+	 * rect has been scaled.
+	 */
+	void scale(Scaler *scaler, const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
+	           uint32 dstPitch, int width, int height, int x, int y);
+
+	/** Return the number of threads scaling, including the calling one. */
+	uint getNumThreads() const { return _numWorkers + 1; }
+
+private:
+	struct Band {
+		Scaler *scaler;
+		const uint8 *srcPtr;
+		uint32 srcPitch;
+		uint8 *dstPtr;
+		uint32 dstPitch;
+		int width, height;
+		int x, y;
+
+		void scale() const;
+	};
+
+#if SDL_VERSION_ATLEAST(2, 0, 0)
+	struct Worker {
+		ScalerThreadPool *pool;
+		SDL_Thread *thread;
+		SDL_sem *start;
+		Band band;
+	};
+
+	static int SDLCALL workerProc(void *data);
+
+	Worker *_workers;
+	SDL_sem *_done;
+	bool _quit;
+#endif
+
+	uint _numWorkers;
+};
+
+#endif
@@ -0,0 +1,134 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "backends/mixer/offline/offline-mixer.h"
+#include "common/config-manager.h"
+#include "common/endian.h"
+#include "common/file.h"
+#include "common/textconsole.h"
+
+OfflineMixerManager::OfflineMixerManager(const Common::String &fileName) : MixerManager() {
+	_fileName = fileName;
+	_file = nullptr;
+	_wave = fileName.hasSuffixIgnoreCase(".wav");
+
+	_outputRate = 44100;
+	if (ConfMan.hasKey("output_rate") && ConfMan.getInt("output_rate") > 0)
+		_outputRate = ConfMan.getInt("output_rate");
+
+	_samplesRendered = 0;
+	_samples = 1024;
+	_samplesBuf = new int16[_samples * 2];
+}
+
+OfflineMixerManager::~OfflineMixerManager() {
+	finish();
+	delete[] _samplesBuf;
+}
+
+void OfflineMixerManager::init() {
+	_file = new Common::DumpFile();
+	if (!_file->open(_fileName)) {
+		warning("Could not open '%s' for rendering audio", _fileName.c_str());
+		delete _file;
+		_file = nullptr;
+	} else if (_wave) {
+		// Write a placeholder header; the sizes are filled in by finish().
+		writeWaveHeader();
+	}
+
+	_mixer = new Audio::MixerImpl(_outputRate, true, _samples);
+	assert(_mixer);
+	_mixer->setReady(true);
+}
+
+void OfflineMixerManager::update(uint32 millis) {
+	const uint64 target = (uint64)millis * _outputRate / 1000;
+
+	while (_samplesRendered < target) {
+		const uint32 len = (uint32)MIN<uint64>(_samples, target - _samplesRendered);
+
+		if (_audioSuspended) {
+			memset(_samplesBuf, 0, len * 4);
+		} else {
+			assert(_mixer);
+			_mixer->mixCallback((byte *)_samplesBuf, len * 4);
+		}
+
+		if (_file) {
+#ifndef SCUMM_LITTLE_ENDIAN
+			for (uint32 i = 0; i < len * 2; ++i)
+				_samplesBuf[i] = TO_LE_16(_samplesBuf[i]);
+#endif
+			_file->write(_samplesBuf, len * 4);
+		}
+
+		_samplesRendered += len;
+	}
+}
+
+void OfflineMixerManager::finish() {
+	if (!_file)
+		return;
+
+	if (_wave) {
+		_file->seek(0);
+		writeWaveHeader();
+	}
+	_file->finalize();
+	if (_file->err())
+		warning("Could not write rendered audio to '%s'", _fileName.c_str());
+
+	delete _file;
+	_file = nullptr;
+}
+
+void OfflineMixerManager::writeWaveHeader() {
+	// WAV files can't hold more than 4 GB of samples
+	const uint32 dataSize = (uint32)MIN<uint64>(_samplesRendered * 4, 0xFFFFFFFF - 36);
+
+	_file->writeUint32BE(MKTAG('R', 'I', 'F', 'F'));
+	_file->writeUint32LE(dataSize + 36);
+	_file->writeUint32BE(MKTAG('W', 'A', 'V', 'E'));
+	_file->writeUint32BE(MKTAG('f', 'm', 't', ' '));
+	_file->writeUint32LE(16);
+	_file->writeUint16LE(1);
+	_file->writeUint16LE(2);
+	_file->writeUint32LE(_outputRate);
+	_file->writeUint32LE(_outputRate * 4);
+	_file->writeUint16LE(4);
+	_file->writeUint16LE(16);
+	_file->writeUint32BE(MKTAG('d', 'a', 't', 'a'));
+	_file->writeUint32LE(dataSize);
+}
+
+void OfflineMixerManager::suspendAudio() {
+	_audioSuspended = true;
+}
+
+int OfflineMixerManager::resumeAudio() {
+	if (!_audioSuspended) {
+		return -2;
+	}
+	_audioSuspended = false;
+	return 0;
+}
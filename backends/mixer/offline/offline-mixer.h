@@ -0,0 +1,80 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef BACKENDS_MIXER_OFFLINE_H
+#define BACKENDS_MIXER_OFFLINE_H
+
+#include "backends/mixer/mixer.h"
+#include "common/str.h"
+
+namespace Common {
+class DumpFile;
+}
+
+/**
+ * Audio mixer which renders the audio into a file instead of playing it.
+ *
+ * There is no sound card pulling the samples, so the output is produced
+ * whenever the owner advances the output clock by calling update(). This is
+ * done by the null backend while it runs on its virtual clock, and by the
+ * events recorder during playback, so audio can be rendered faster than
+ * real time.
+ *
+ * The output is 16-bit signed stereo PCM. It is written as a WAV file if the
+ * file name ends with ".wav", and as raw little endian samples otherwise.
+ */
+class OfflineMixerManager : public MixerManager {
+public:
+	OfflineMixerManager(const Common::String &fileName);
+	virtual ~OfflineMixerManager();
+
+	virtual void init();
+
+	/**
+	 * Render the output up to the given time, in milliseconds since the
+	 * mixer was initialized. While the audio is suspended, silence is
+	 * written instead, so that the output stays in sync with the clock.
+	 */
+	void update(uint32 millis);
+
+	/**
+	 * Finish the output file. This is done automatically when the mixer
+	 * manager is destroyed.
+	 */
+	void finish();
+
+	virtual void suspendAudio();
+	virtual int resumeAudio();
+
+private:
+	void writeWaveHeader();
+
+	Common::String _fileName;
+	Common::DumpFile *_file;
+	bool _wave;
+	uint32 _outputRate;
+	uint64 _samplesRendered;
+	uint32 _samples;
+	int16 *_samplesBuf;
+};
+
+#endif
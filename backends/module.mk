@@ -169,6 +169,7 @@ MODULE_OBJS += \
 	events/sdl/sdl-events.o \
 	graphics/sdl/sdl-graphics.o \
 	graphics/surfacesdl/surfacesdl-graphics.o \
+	graphics/surfacesdl/surfacesdl-scaler-pool.o \
 	mixer/sdl/sdl-mixer.o \
 	mutex/sdl/sdl-mutex.o \
 	timer/sdl/sdl-timer.o
@@ -400,7 +401,8 @@ endif
 
 ifeq ($(BACKEND),null)
 MODULE_OBJS += \
-	mixer/null/null-mixer.o
+	mixer/null/null-mixer.o \
+	mixer/offline/offline-mixer.o
 endif
 
 ifdef MIYOO
@@ -461,6 +463,7 @@ endif
 ifdef ENABLE_EVENTRECORDER
 MODULE_OBJS += \
 	mixer/null/null-mixer.o \
+	mixer/offline/offline-mixer.o \
 	saves/recorder/recorder-saves.o
 endif
 
@@ -56,6 +56,8 @@ typedef void (*sighandler_t)(int);
 #include "backends/timer/default/default-timer.h"
 #include "backends/events/default/default-events.h"
 #include "backends/mixer/null/null-mixer.h"
+#include "backends/mixer/offline/offline-mixer.h"
+#include "common/config-manager.h"
 #include "backends/graphics/null/null-graphics.h"
 #include "gui/debugger.h"
 #endif
@@ -75,6 +77,8 @@ typedef void (*sighandler_t)(int);
 	#include "backends/fs/windows/windows-fs-factory.h"
 #endif
 
+class OfflineMixerManager;
+
 class OSystem_NULL : public ModularMixerBackend, public ModularGraphicsBackend, Common::EventSource {
 public:
 	OSystem_NULL();
@@ -96,14 +100,21 @@ public:
 	virtual void addSysArchivesToSearchSet(Common::SearchSet &s, int priority);
 
 private:
+	void advanceVirtualClock(uint msecs);
+
 #ifdef POSIX
 	timeval _startTime;
 #elif defined(WIN32)
 	DWORD _startTime;
 #endif
+
+	// When rendering audio to a file, the backend runs on a virtual clock
+	// which only advances when delayMillis() is called.
+	OfflineMixerManager *_offlineMixer;
+	uint32 _virtualMillis;
 };
 
-OSystem_NULL::OSystem_NULL() {
+OSystem_NULL::OSystem_NULL() : _offlineMixer(nullptr), _virtualMillis(0) {
 	#if defined(__amigaos4__)
 		_fsFactory = new AmigaOSFilesystemFactory();
 	#elif defined(__MORPHOS__)
@@ -120,6 +131,11 @@ OSystem_NULL::OSystem_NULL() {
 }
 
 OSystem_NULL::~OSystem_NULL() {
+#ifndef NULL_DRIVER_USE_FOR_TEST
+	// Finish the output while the backend can still log errors
+	if (_offlineMixer)
+		_offlineMixer->finish();
+#endif
 }
 
 #if defined(POSIX) && !defined(NULL_DRIVER_USE_FOR_TEST)
@@ -149,7 +165,12 @@ void OSystem_NULL::initBackend() {
 	_eventManager = new DefaultEventManager(this);
 	_savefileManager = new DefaultSaveFileManager();
 	_graphicsManager = new NullGraphicsManager();
-	_mixerManager = new NullMixerManager();
+	if (ConfMan.hasKey("render_audio")) {
+		_offlineMixer = new OfflineMixerManager(ConfMan.get("render_audio"));
+		_mixerManager = _offlineMixer;
+	} else {
+		_mixerManager = new NullMixerManager();
+	}
 	// Setup and start mixer
 	_mixerManager->init();
 #endif
@@ -160,7 +181,10 @@ void OSystem_NULL::initBackend() {
 bool OSystem_NULL::pollEvent(Common::Event &event) {
 #ifndef NULL_DRIVER_USE_FOR_TEST
 	((DefaultTimerManager *)getTimerManager())->checkTimers();
-	((NullMixerManager *)_mixerManager)->update(1);
+	if (_offlineMixer)
+		_offlineMixer->update(_virtualMillis);
+	else
+		((NullMixerManager *)_mixerManager)->update(1);
 
 #ifdef POSIX
 	if (intReceived) {
@@ -189,6 +213,9 @@ Common::MutexInternal *OSystem_NULL::createMutex() {
 }
 
 uint32 OSystem_NULL::getMillis(bool skipRecord) {
+	if (_offlineMixer)
+		return _virtualMillis;
+
 #ifdef POSIX
 	timeval curTime;
 
@@ -204,6 +231,11 @@ uint32 OSystem_NULL::getMillis(bool skipRecord) {
 }
 
 void OSystem_NULL::delayMillis(uint msecs) {
+	if (_offlineMixer) {
+		advanceVirtualClock(msecs);
+		return;
+	}
+
 #ifdef POSIX
 	usleep(msecs * 1000);
 #elif defined(WIN32)
@@ -211,6 +243,18 @@ void OSystem_NULL::delayMillis(uint msecs) {
 #endif
 }
 
+void OSystem_NULL::advanceVirtualClock(uint msecs) {
+#ifndef NULL_DRIVER_USE_FOR_TEST
+	// Advance one millisecond at a time, so that timers and audio
+	// interleave the same way as they would in real time.
+	for (uint i = 0; i < msecs; i++) {
+		_virtualMillis++;
+		((DefaultTimerManager *)getTimerManager())->checkTimers(1);
+		_offlineMixer->update(_virtualMillis);
+	}
+#endif
+}
+
 void OSystem_NULL::getTimeAndDate(TimeDate &td, bool skipRecord) const {
 	time_t curTime = time(0);
 	struct tm t = *localtime(&curTime);
@@ -224,6 +268,10 @@ void OSystem_NULL::getTimeAndDate(TimeDate &td, bool skipRecord) const {
 }
 
 void OSystem_NULL::quit() {
+#ifndef NULL_DRIVER_USE_FOR_TEST
+	if (_offlineMixer)
+		_offlineMixer->finish();
+#endif
 	exit(0);
 }
 
@@ -144,6 +144,10 @@ static const char HELP_STRING4[] =
 	"  -r, --speech-volume=NUM  Set the speech volume, 0-255 (default: 192)\n"
 	"  --midi-gain=NUM          Set the gain for MIDI playback, 0-1000 (default:\n"
 	"                           100) (only supported by some MIDI drivers)\n"
+	"  --midi-renderahead=MS    Synthesize MIDI music this many milliseconds ahead\n"
+	"                           of playback, trading latency for fewer dropouts\n"
+	"                           (default: 0 = disabled) (only supported by the\n"
+	"                           MT-32 emulator and FluidSynth)\n"
 	"  -n, --subtitles          Enable subtitles (use with games that have voice)\n"
 	"  -b, --boot-param=NUM     Pass number to the boot script (boot param)\n"
 	"  -d, --debuglevel=NUM     Set debug verbosity level\n"
@@ -169,6 +173,13 @@ static const char HELP_STRING4[] =
 	"  --enable-gs              Enable Roland GS mode for MIDI playback\n"
 	"  --output-channels=CHANNELS Select output channel count (e.g. 2 for stereo)\n"
 	"  --output-rate=RATE       Select output sample rate in Hz (e.g. 22050)\n"
+	"  --render-audio=FILE      Render the audio output to FILE instead of playing it,\n"
+	"                           as WAV if FILE ends with '.wav' and as raw samples\n"
+	"                           otherwise (only supported by the null backend, which\n"
+	"                           then runs faster than real time, and by Event Recorder\n"
+	"                           playback)\n"
+	"  --render-midi=FILE       Play the MIDI file FILE through the selected music driver\n"
+	"                           and quit, e.g. to render it with --render-audio\n"
 	"  --opl-driver=DRIVER      Select AdLib (OPL) emulator (db, mame"
 #ifndef DISABLE_NUKED_OPL
 																	 ", nuked"
@@ -316,6 +327,7 @@ void registerDefaults() {
 	ConfMan.registerDefault("dump_midi", false);
 	ConfMan.registerDefault("enable_gs", false);
 	ConfMan.registerDefault("midi_gain", 100);
+	ConfMan.registerDefault("midi_renderahead", 0);
 
 	ConfMan.registerDefault("music_driver", "auto");
 	ConfMan.registerDefault("mt32_device", "null");
@@ -693,6 +705,18 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			DO_LONG_OPTION_INT("output-rate")
 			END_OPTION
 
+			DO_LONG_OPTION("render-audio")
+			END_OPTION
+
+			DO_LONG_OPTION("render-midi")
+				Common::FSNode path(option);
+				if (!path.exists()) {
+					usage("Non-existent MIDI file path '%s'", option);
+				} else if (!path.isReadable()) {
+					usage("Non-readable MIDI file path '%s'", option);
+				}
+			END_OPTION
+
 			DO_OPTION_BOOL('f', "fullscreen")
 			END_OPTION
 
@@ -782,6 +806,9 @@ Common::String parseCommandLine(Common::StringMap &settings, int argc, const cha
 			DO_LONG_OPTION_INT("midi-gain")
 			END_OPTION
 
+			DO_LONG_OPTION_INT("midi-renderahead")
+			END_OPTION
+
 			DO_OPTION_BOOL('u', "dump-scripts")
 			END_OPTION
 
@@ -1942,6 +1969,7 @@ bool processSettings(Common::String &command, Common::StringMap &settings, Commo
 		"sfx-volume",
 		"speech-volume",
 		"midi-gain",
+		"midi-renderahead",
 		"subtitles",
 		"savepath",
 		"extrapath",
@@ -33,6 +33,7 @@
 #include "engines/engine.h"
 #include "engines/metaengine.h"
 #include "base/commandLine.h"
+#include "base/midirender.h"
 #include "base/plugins.h"
 #include "base/version.h"
 
@@ -58,10 +59,12 @@
 #include "gui/message.h"
 
 #include "audio/mididrv.h"
+#include "audio/midiparser.h"
 #include "audio/musicplugin.h"  /* for music manager */
 
 #include "graphics/cursorman.h"
 #include "graphics/fontman.h"
+#include "graphics/svg.h"
 #include "graphics/yuv_to_rgb.h"
 #ifdef USE_FREETYPE2
 #include "graphics/fonts/ttf.h"
@@ -405,6 +408,55 @@ static void setupKeymapper(OSystem &system) {
 	}
 }
 
+static Common::Error renderMidiFile(OSystem &system, const Common::String &fileName) {
+	Common::FSNode node(fileName);
+	Common::SeekableReadStream *stream = node.createReadStream();
+	if (!stream)
+		return Common::Error(Common::kReadingFailed, fileName);
+
+	uint32 size = stream->size();
+	byte *data = new byte[size];
+	stream->read(data, size);
+	delete stream;
+
+	int flags = MDT_MIDI | MDT_ADLIB | (ConfMan.getBool("native_mt32") ? MDT_PREFER_MT32 : MDT_PREFER_GM);
+	MidiDriver *driver = MidiDriver::createMidi(MidiDriver::detectDevice(flags));
+	if (!driver || driver->open() != 0) {
+		delete driver;
+		delete[] data;
+		return Common::kAudioDeviceInitFailed;
+	}
+
+	MidiParser *parser;
+	if (size >= 4 && READ_BE_UINT32(data) == MKTAG('F', 'O', 'R', 'M'))
+		parser = MidiParser::createParser_XMIDI();
+	else
+		parser = MidiParser::createParser_SMF();
+	parser->setMidiDriver(driver);
+	parser->setTimerRate(driver->getBaseTempo());
+
+	Common::Error result = Common::kNoError;
+	if (parser->loadMusic(data, size)) {
+		driver->setTimerCallback(parser, &MidiParser::timerCallback);
+
+		// Play until the end of the music, and then some more to let the
+		// last notes fade out.
+		Base::playMidiToEnd(system, parser, 2000);
+
+		driver->setTimerCallback(nullptr, nullptr);
+		parser->unloadMusic();
+	} else {
+		result = Common::Error(Common::kUnknownError, "Unsupported MIDI file " + fileName);
+	}
+
+	delete parser;
+	driver->close();
+	delete driver;
+	delete[] data;
+
+	return result;
+}
+
 extern "C" int scummvm_main(int argc, const char * const argv[]) {
 	Common::String specialDebug;
 	Common::String command;
@@ -699,9 +751,16 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 	CloudMan.syncSaves();
 #endif
 
-	// Unless a game was specified, show the launcher dialog
-	if (nullptr == ConfMan.getActiveDomain())
+	if (settings.contains("render-midi")) {
+		// Play the given MIDI file instead of running a game
+		Common::Error result = renderMidiFile(system, settings["render-midi"]);
+		if (result.getCode() != Common::kNoError)
+			warning("%s", result.getDesc().c_str());
+		ConfMan.setActiveDomain("");
+	} else if (nullptr == ConfMan.getActiveDomain()) {
+		// Unless a game was specified, show the launcher dialog
 		launcherDialog();
+	}
 
 	// FIXME: We're now looping the launcher. This, of course, doesn't
 	// work as well as it should. In theory everything should be destroyed
@@ -865,6 +924,7 @@ extern "C" int scummvm_main(int argc, const char * const argv[]) {
 	MusicManager::destroy();
 	Graphics::CursorManager::destroy();
 	Graphics::FontManager::destroy();
+	Graphics::SVGBitmap::clearCache();
 #ifdef USE_FREETYPE2
 	Graphics::shutdownTTF();
 #endif
@@ -0,0 +1,50 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "base/midirender.h"
+
+#include "audio/midiparser.h"
+#include "common/events.h"
+#include "common/system.h"
+
+namespace Base {
+
+bool playMidiToEnd(OSystem &system, MidiParser *parser, uint32 tailMillis) {
+	// The parser may stop during any delay, so the end time is set before
+	// checking whether to go on
+	uint32 endTime = 0;
+	for (;;) {
+		Common::Event event;
+		while (system.getEventManager()->pollEvent(event)) {
+			if (event.type == Common::EVENT_QUIT || event.type == Common::EVENT_RETURN_TO_LAUNCHER)
+				return false;
+		}
+
+		if (!endTime && !parser->isPlaying())
+			endTime = system.getMillis() + tailMillis;
+		if (endTime && system.getMillis() >= endTime)
+			return true;
+
+		system.delayMillis(10);
+	}
+}
+
+} // End of namespace Base
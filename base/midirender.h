@@ -0,0 +1,44 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef BASE_MIDIRENDER_H
+#define BASE_MIDIRENDER_H
+
+#include "common/scummsys.h"
+
+class MidiParser;
+class OSystem;
+
+namespace Base {
+
+/**
+ * Play the music loaded into a parser until its end, and then for
+ * tailMillis more to let the last notes fade out. The parser is driven
+ * by the timer of its driver, while the time passes with
+ * OSystem::delayMillis().
+ *
+ * @return false if a quit event stopped the playback early.
+ */
+bool playMidiToEnd(OSystem &system, MidiParser *parser, uint32 tailMillis);
+
+} // End of namespace Base
+
+#endif
@@ -3,6 +3,7 @@ MODULE := base
 MODULE_OBJS := \
 	test_new_standards.o \
 	main.o \
+	midirender.o \
 	commandLine.o \
 	plugins.o \
 	version.o
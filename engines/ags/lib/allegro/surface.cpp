@@ -26,6 +26,7 @@
 #include "ags/globals.h"
 #include "common/textconsole.h"
 #include "graphics/screen.h"
+#include "graphics/scaler/simd.h"
 
 namespace AGS3 {
 
@@ -104,6 +105,221 @@ void BITMAP::floodfill(int x, int y, int color) {
 	AGS3::floodfill(this, x, y, color);
 }
 
+/*-------------------------------------------------------------------*/
+
+// The 32 bpp format of the AGS bitmaps, which the vectorized blenders use
+static const Graphics::PixelFormat &argb8888Format() {
+	static const Graphics::PixelFormat format(4, 8, 8, 8, 8, 16, 8, 0, 24);
+	return format;
+}
+
+#ifdef USE_SCALER_SIMD
+// Vectors of four 32 bpp pixels
+#if defined(SCALER_SIMD_SSE2)
+typedef __m128i PixelVec;
+
+static inline PixelVec pixLoad(const uint32 *p) { return _mm_loadu_si128((const __m128i *)p); }
+static inline void pixStore(uint32 *p, PixelVec v) { _mm_storeu_si128((__m128i *)p, v); }
+static inline PixelVec pixSet(uint32 v) { return _mm_set1_epi32(v); }
+static inline PixelVec pixAnd(PixelVec a, PixelVec b) { return _mm_and_si128(a, b); }
+static inline PixelVec pixOr(PixelVec a, PixelVec b) { return _mm_or_si128(a, b); }
+static inline PixelVec pixAdd(PixelVec a, PixelVec b) { return _mm_add_epi32(a, b); }
+static inline PixelVec pixSub(PixelVec a, PixelVec b) { return _mm_sub_epi32(a, b); }
+static inline PixelVec pixShr8(PixelVec a) { return _mm_srli_epi32(a, 8); }
+static inline PixelVec pixShr24(PixelVec a) { return _mm_srli_epi32(a, 24); }
+static inline PixelVec pixEq(PixelVec a, PixelVec b) { return _mm_cmpeq_epi32(a, b); }
+static inline PixelVec pixAddSatBytes(PixelVec a, PixelVec b) { return _mm_adds_epu8(a, b); }
+static inline PixelVec pixSelect(PixelVec mask, PixelVec a, PixelVec b) {
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+// Low 32 bits of the products, which SSE2 only has for even lanes
+static inline PixelVec pixMul(PixelVec a, PixelVec b) {
+	const __m128i even = _mm_mul_epu32(a, b);
+	const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+	return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+#elif defined(SCALER_SIMD_NEON)
+typedef uint32x4_t PixelVec;
+
+static inline PixelVec pixLoad(const uint32 *p) { return vld1q_u32(p); }
+static inline void pixStore(uint32 *p, PixelVec v) { vst1q_u32(p, v); }
+static inline PixelVec pixSet(uint32 v) { return vdupq_n_u32(v); }
+static inline PixelVec pixAnd(PixelVec a, PixelVec b) { return vandq_u32(a, b); }
+static inline PixelVec pixOr(PixelVec a, PixelVec b) { return vorrq_u32(a, b); }
+static inline PixelVec pixAdd(PixelVec a, PixelVec b) { return vaddq_u32(a, b); }
+static inline PixelVec pixSub(PixelVec a, PixelVec b) { return vsubq_u32(a, b); }
+static inline PixelVec pixShr8(PixelVec a) { return vshrq_n_u32(a, 8); }
+static inline PixelVec pixShr24(PixelVec a) { return vshrq_n_u32(a, 24); }
+static inline PixelVec pixEq(PixelVec a, PixelVec b) { return vceqq_u32(a, b); }
+static inline PixelVec pixAddSatBytes(PixelVec a, PixelVec b) {
+	return vreinterpretq_u32_u8(vqaddq_u8(vreinterpretq_u8_u32(a), vreinterpretq_u8_u32(b)));
+}
+static inline PixelVec pixSelect(PixelVec mask, PixelVec a, PixelVec b) { return vbslq_u32(mask, a, b); }
+static inline PixelVec pixMul(PixelVec a, PixelVec b) { return vmulq_u32(a, b); }
+#endif
+
+// Same as BITMAP::rgbBlend, on the rgb of four pixels
+static inline PixelVec rgbBlendSimd(PixelVec x, PixelVec y, PixelVec alpha) {
+	const PixelVec rbMask = pixSet(0xFF00FF);
+	const PixelVec gMask = pixSet(0xFF00);
+	// The alpha is incremented when it is not 0
+	alpha = pixAdd(alpha, pixSelect(pixEq(alpha, pixSet(0)), pixSet(0), pixSet(1)));
+
+	const PixelVec yg = pixAnd(y, gMask);
+	const PixelVec res = pixAdd(pixShr8(pixMul(pixSub(pixAnd(x, rbMask), pixAnd(y, rbMask)), alpha)), pixAnd(y, pixSet(0xFFFFFF)));
+	const PixelVec g = pixAdd(pixShr8(pixMul(pixSub(pixAnd(x, gMask), yg), alpha)), yg);
+	return pixOr(pixAnd(res, rbMask), pixAnd(g, gMask));
+}
+
+/**
+ * Blends as many groups of four pixels of a row as possible, and returns
+ * the number of pixels drawn. Blender modes using floating point math are
+ * left to the C++ code, which they would not give the same results as.
+ */
+template<int BlenderMode>
+static int drawRow32Simd(uint32 *destP, const uint32 *srcP, int count, bool skipTrans, int srcAlpha) {
+	if (BlenderMode == kArgbToArgbBlender || BlenderMode == kRgbToArgbBlender ||
+	        BlenderMode == kTintBlenderMode || BlenderMode == kTintLightBlenderMode)
+		return 0;
+
+	const PixelVec alphaMask = pixSet(0xFF000000);
+	const PixelVec rgbMask = pixSet(0x00FFFFFF);
+	const PixelVec transColor = pixSet(0x00FF00FF);
+	const PixelVec blendAlpha = pixSet(srcAlpha);
+	const PixelVec argbAlpha = pixSet((srcAlpha & 0xff) + 1);
+
+	int x = 0;
+	for (; x + 4 <= count; x += 4) {
+		const PixelVec src = pixLoad(srcP + x);
+		const PixelVec dest = pixLoad(destP + x);
+		PixelVec res;
+
+		switch (BlenderMode) {
+		case kSourceAlphaBlender:
+			res = rgbBlendSimd(src, dest, pixShr24(src));
+			break;
+		case kArgbToRgbBlender:
+			if (srcAlpha == 0)
+				res = rgbBlendSimd(src, dest, pixShr24(src));
+			else
+				res = rgbBlendSimd(src, dest, pixShr8(pixMul(pixShr24(src), argbAlpha)));
+			break;
+		case kRgbToRgbBlender:
+			res = rgbBlendSimd(src, dest, blendAlpha);
+			break;
+		case kAlphaPreservedBlenderMode:
+			res = pixOr(rgbBlendSimd(src, dest, blendAlpha), pixAnd(dest, alphaMask));
+			break;
+		case kOpaqueBlenderMode:
+			res = pixOr(src, alphaMask);
+			break;
+		case kAdditiveBlenderMode:
+			res = pixOr(pixAnd(src, rgbMask), pixAddSatBytes(pixAnd(src, alphaMask), pixAnd(dest, alphaMask)));
+			break;
+		default:
+			res = src;
+			break;
+		}
+
+		if (skipTrans)
+			res = pixSelect(pixEq(pixAnd(src, rgbMask), transColor), dest, res);
+		pixStore(destP + x, res);
+	}
+	return x;
+}
+#endif
+
+template<int BlenderMode>
+void BITMAP::drawRow32(uint32 *destP, const uint32 *srcP, int count, bool skipTrans, int srcAlpha) const {
+	int x = 0;
+#ifdef USE_SCALER_SIMD
+	x = drawRow32Simd<BlenderMode>(destP, srcP, count, skipTrans, srcAlpha);
+#endif
+
+	for (; x < count; ++x) {
+		const uint32 srcCol = srcP[x];
+
+		// Check if this is a transparent color we should skip
+		if (skipTrans && ((srcCol & 0x00FFFFFF) == 0x00FF00FF))
+			continue;
+
+		if (BlenderMode == -1) {
+			destP[x] = srcCol;
+			continue;
+		}
+
+		uint8 aSrc = srcCol >> 24, rSrc = srcCol >> 16, gSrc = srcCol >> 8, bSrc = srcCol;
+		uint8 aDest = destP[x] >> 24, rDest = destP[x] >> 16, gDest = destP[x] >> 8, bDest = destP[x];
+
+		switch (BlenderMode) {
+		case kSourceAlphaBlender:
+			blendSourceAlpha(aSrc, rSrc, gSrc, bSrc, aDest, rDest, gDest, bDest, srcAlpha);
+			break;
+		case kArgbToArgbBlender:
+			blendArgbToArgb(aSrc, rSrc, gSrc, bSrc, aDest, rDest, gDest, bDest, srcAlpha);
+			break;
+		case kArgbToRgbBlender:
+			blendArgbToRgb(aSrc, rSrc, gSrc, bSrc, aDest, rDest, gDest, bDest, srcAlpha);
+			break;
+		case kRgbToArgbBlender:
+			blendRgbToArgb(aSrc, rSrc, gSrc, bSrc, aDest, rDest, gDest, bDest, srcAlpha);
+			break;
+		case kRgbToRgbBlender:
+			blendRgbToRgb(aSrc, rSrc, gSrc, bSrc, aDest, rDest, gDest, bDest, srcAlpha);
+			break;
+		case kAlphaPreservedBlenderMode:
+			blendPreserveAlpha(aSrc, rSrc, gSrc, bSrc, aDest, rDest, gDest, bDest, srcAlpha);
+			break;
+		case kOpaqueBlenderMode:
+			blendOpaque(aSrc, rSrc, gSrc, bSrc, aDest, rDest, gDest, bDest, srcAlpha);
+			break;
+		case kAdditiveBlenderMode:
+			blendAdditiveAlpha(aSrc, rSrc, gSrc, bSrc, aDest, rDest, gDest, bDest, srcAlpha);
+			break;
+		default:
+			break;
+		}
+
+		destP[x] = ((uint32)aDest << 24) | ((uint32)rDest << 16) | ((uint32)gDest << 8) | bDest;
+	}
+}
+
+BITMAP::DrawRow32 BITMAP::getDrawRow32(const Graphics::PixelFormat &srcFormat, int srcAlpha, bool useTint) const {
+	// The row functions take 0x00FF00FF as the transparent color, and the
+	// blenders the channels of ARGB8888, even when copying
+	if (srcFormat != format || format != argb8888Format())
+		return nullptr;
+	if (srcAlpha == -1)
+		return &BITMAP::drawRow32<-1>;
+	if (useTint)
+		return nullptr;
+
+	switch (_G(_blender_mode)) {
+	case kSourceAlphaBlender:
+		return &BITMAP::drawRow32<kSourceAlphaBlender>;
+	case kArgbToArgbBlender:
+		return &BITMAP::drawRow32<kArgbToArgbBlender>;
+	case kArgbToRgbBlender:
+		return &BITMAP::drawRow32<kArgbToRgbBlender>;
+	case kRgbToArgbBlender:
+		// Without translucency this is an opaque copy
+		if (srcAlpha == 0 || srcAlpha == 0xff)
+			return &BITMAP::drawRow32<kOpaqueBlenderMode>;
+		return &BITMAP::drawRow32<kRgbToArgbBlender>;
+	case kRgbToRgbBlender:
+		return &BITMAP::drawRow32<kRgbToRgbBlender>;
+	case kAlphaPreservedBlenderMode:
+		return &BITMAP::drawRow32<kAlphaPreservedBlenderMode>;
+	case kOpaqueBlenderMode:
+		return &BITMAP::drawRow32<kOpaqueBlenderMode>;
+	case kAdditiveBlenderMode:
+		return &BITMAP::drawRow32<kAdditiveBlenderMode>;
+	default:
+		// The tint blenders convert to HSV and back
+		return nullptr;
+	}
+}
+
 const int SCALE_THRESHOLD = 0x100;
 #define VGA_COLOR_TRANS(x) ((x) * 255 / 63)
 
@@ -166,6 +382,35 @@ void BITMAP::draw(const BITMAP *srcBitmap, const Common::Rect &srcRect,
 	int xStart = (dstRect.left < destRect.left) ? dstRect.left - destRect.left : 0;
 	int yStart = (dstRect.top < destRect.top) ? dstRect.top - destRect.top : 0;
 
+	// Draw whole rows at once when the formats and blender allow it
+	const DrawRow32 drawRow = getDrawRow32(src.format, srcAlpha, useTint);
+	if (drawRow) {
+		const int xBegin = MAX(0, -xStart);
+		const int count = MIN((int)dstRect.width(), destArea.w - xStart) - xBegin;
+		if (count <= 0)
+			return;
+
+		Common::Array<uint32> flippedRow(horizFlip ? count : 0);
+		for (int destY = yStart, yCtr = 0; yCtr < dstRect.height(); ++destY, ++yCtr) {
+			if (destY < 0 || destY >= destArea.h)
+				continue;
+			const uint32 *srcP = (const uint32 *)src.getBasePtr(
+			                         horizFlip ? srcArea.right - 1 : srcArea.left,
+			                         vertFlip ? srcArea.bottom - 1 - yCtr :
+			                         srcArea.top + yCtr);
+			if (horizFlip) {
+				for (int i = 0; i < count; ++i)
+					flippedRow[i] = srcP[-(xBegin + i)];
+				srcP = &flippedRow[0];
+			} else {
+				srcP += xBegin;
+			}
+
+			(this->*drawRow)((uint32 *)destArea.getBasePtr(xStart + xBegin, destY), srcP, count, skipTrans, srcAlpha);
+		}
+		return;
+	}
+
 	for (int destY = yStart, yCtr = 0; yCtr < dstRect.height(); ++destY, ++yCtr) {
 		if (destY < 0 || destY >= destArea.h)
 			continue;
@@ -293,6 +538,38 @@ void BITMAP::stretchDraw(const BITMAP *srcBitmap, const Common::Rect &srcRect,
 	int xStart = (dstRect.left < destRect.left) ? dstRect.left - destRect.left : 0;
 	int yStart = (dstRect.top < destRect.top) ? dstRect.top - destRect.top : 0;
 
+	// Draw whole rows at once when the formats and blender allow it. The
+	// source pixels of a row are picked first, and only once for the rows
+	// repeated when scaling up.
+	const DrawRow32 drawRow = getDrawRow32(src.format, srcAlpha, false);
+	if (drawRow) {
+		const int xBegin = MAX(0, -xStart);
+		const int count = MIN((int)dstRect.width(), destArea.w - xStart) - xBegin;
+		if (count <= 0)
+			return;
+
+		Common::Array<int> srcX(count);
+		for (int i = 0; i < count; ++i)
+			srcX[i] = (xBegin + i) * scaleX / SCALE_THRESHOLD;
+
+		Common::Array<uint32> row(count);
+		int lastSrcY = -1;
+		for (int destY = yStart, yCtr = 0; yCtr < dstRect.height(); ++destY, ++yCtr) {
+			if (destY < 0 || destY >= destArea.h)
+				continue;
+			const int srcY = srcRect.top + yCtr * scaleY / SCALE_THRESHOLD;
+			if (srcY != lastSrcY) {
+				const uint32 *srcP = (const uint32 *)src.getBasePtr(srcRect.left, srcY);
+				for (int i = 0; i < count; ++i)
+					row[i] = srcP[srcX[i]];
+				lastSrcY = srcY;
+			}
+
+			(this->*drawRow)((uint32 *)destArea.getBasePtr(xStart + xBegin, destY), &row[0], count, skipTrans, srcAlpha);
+		}
+		return;
+	}
+
 	for (int destY = yStart, yCtr = 0, scaleYCtr = 0; yCtr < dstRect.height();
 	        ++destY, ++yCtr, scaleYCtr += scaleY) {
 		if (destY < 0 || destY >= destArea.h)
@@ -131,6 +131,20 @@ public:
 
 	void blendPixel(uint8 aSrc, uint8 rSrc, uint8 gSrc, uint8 bSrc, uint8 &aDest, uint8 &rDest, uint8 &gDest, uint8 &bDest, uint32 alpha) const;
 
+	// Draws a row of 32 bpp pixels of the destination format. The blender
+	// mode is a template parameter, so that it is not checked per pixel,
+	// and -1 copies the pixels without blending.
+	typedef void (BITMAP::*DrawRow32)(uint32 *destP, const uint32 *srcP, int count, bool skipTrans, int srcAlpha) const;
+
+	template<int BlenderMode>
+	void drawRow32(uint32 *destP, const uint32 *srcP, int count, bool skipTrans, int srcAlpha) const;
+
+	/**
+	 * Returns the row function to use for drawing from the given format,
+	 * or nullptr if the draw has to go through the per pixel code
+	 */
+	DrawRow32 getDrawRow32(const Graphics::PixelFormat &srcFormat, int srcAlpha, bool useTint) const;
+
 
 	inline void rgbBlend(uint8 rSrc, uint8 gSrc, uint8 bSrc, uint8 &rDest, uint8 &gDest, uint8 &bDest, uint32 alpha) const {
 		// Note: the original's handling varies slightly for R & B vs G.
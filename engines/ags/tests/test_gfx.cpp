@@ -22,12 +22,115 @@
 #include "common/scummsys.h"
 #include "ags/shared/core/platform.h"
 #include "ags/shared/gfx/gfx_def.h"
-#include "ags/shared/debugging/assert.h"
+#include "ags/lib/allegro/color.h"
+#include "ags/lib/allegro/surface.h"
+#include "ags/globals.h"
 
 namespace AGS3 {
 
 namespace GfxDef = AGS::Shared::GfxDef;
 
+// Fills a bitmap with random colors, including the transparent color and
+// fully transparent and fully opaque pixels
+static void FillRandom(Graphics::ManagedSurface &surf, uint32 seed) {
+	for (int y = 0; y < surf.h; ++y) {
+		for (int x = 0; x < surf.w; ++x) {
+			seed = seed * 1103515245 + 12345;
+			byte a = seed >> 24, r = seed >> 16, g = seed >> 8, b = seed >> 4;
+			if ((seed & 0x7) == 0) {
+				r = 255;
+				g = 0;
+				b = 255;
+			}
+			if ((seed & 0x30) == 0)
+				a = (seed & 0x40) ? 255 : 0;
+			surf.setPixel(x, y, surf.format.ARGBToColor(a, r, g, b));
+		}
+	}
+}
+
+static void ConvertPixels(const Graphics::ManagedSurface &src, Graphics::ManagedSurface &dst) {
+	for (int y = 0; y < src.h; ++y) {
+		for (int x = 0; x < src.w; ++x) {
+			byte a, r, g, b;
+			src.format.colorToARGB(src.getPixel(x, y), a, r, g, b);
+			dst.setPixel(x, y, dst.format.ARGBToColor(a, r, g, b));
+		}
+	}
+}
+
+static bool SamePixels(const Graphics::ManagedSurface &a, const Graphics::ManagedSurface &b) {
+	for (int y = 0; y < a.h; ++y) {
+		if (memcmp(a.getBasePtr(0, y), b.getBasePtr(0, y), a.w * a.format.bytesPerPixel))
+			return false;
+	}
+	return true;
+}
+
+// Draws a sprite between ARGB8888 bitmaps, which uses the row functions,
+// and from a copy of it in RGBA8888, which uses the per pixel code
+static void Test_DrawRows(BlenderMode mode, int srcAlpha, bool skipTrans, bool horizFlip, bool stretch) {
+	const Graphics::PixelFormat argb(4, 8, 8, 8, 8, 16, 8, 0, 24);
+	const Graphics::PixelFormat rgba(4, 8, 8, 8, 8, 24, 16, 8, 0);
+	set_blender_mode(mode, 0, 0, 0, 0);
+
+	Surface src(21, 5, argb), converted(21, 5, rgba);
+	Surface expected(24, 12, argb), actual(24, 12, argb);
+	FillRandom(src, 1 + mode * 7 + srcAlpha);
+	ConvertPixels(src, converted);
+	FillRandom(expected, 2 + mode);
+	FillRandom(actual, 2 + mode);
+
+	// The destination is clipped on the left and the bottom
+	const Common::Rect srcRect(1, 0, 20, 5);
+	if (stretch) {
+		expected.stretchDraw(&converted, srcRect, Common::Rect(-3, 2, 34, 14), skipTrans, srcAlpha);
+		actual.stretchDraw(&src, srcRect, Common::Rect(-3, 2, 34, 14), skipTrans, srcAlpha);
+	} else {
+		expected.draw(&converted, srcRect, -2, 8, horizFlip, false, skipTrans, srcAlpha, -1, -1, -1);
+		actual.draw(&src, srcRect, -2, 8, horizFlip, false, skipTrans, srcAlpha, -1, -1, -1);
+	}
+	assert(SamePixels(expected, actual));
+}
+
+static void Test_BitmapDraw() {
+	const BlenderMode savedMode = _G(_blender_mode);
+
+	// The row functions must give the same results as the per pixel code
+	const BlenderMode modes[] = {
+		kSourceAlphaBlender, kArgbToArgbBlender, kArgbToRgbBlender, kRgbToArgbBlender,
+		kRgbToRgbBlender, kAlphaPreservedBlenderMode, kOpaqueBlenderMode, kAdditiveBlenderMode
+	};
+	const int alphas[] = { -1, 0, 1, 100, 254, 255 };
+	for (int m = 0; m < ARRAYSIZE(modes); ++m) {
+		for (int a = 0; a < ARRAYSIZE(alphas); ++a) {
+			Test_DrawRows(modes[m], alphas[a], false, false, false);
+			Test_DrawRows(modes[m], alphas[a], true, false, false);
+			Test_DrawRows(modes[m], alphas[a], true, true, false);
+		}
+	}
+	Test_DrawRows(kRgbToRgbBlender, -1, true, false, true);
+	Test_DrawRows(kRgbToRgbBlender, 100, true, false, true);
+	Test_DrawRows(kSourceAlphaBlender, 0, true, false, true);
+	Test_DrawRows(kAdditiveBlenderMode, 200, false, false, true);
+
+	// Copying between bitmaps of another 32 bpp format must skip the
+	// transparent color of that format
+	const Graphics::PixelFormat argb(4, 8, 8, 8, 8, 16, 8, 0, 24);
+	const Graphics::PixelFormat rgba(4, 8, 8, 8, 8, 24, 16, 8, 0);
+	Surface src(9, 4, argb), converted(9, 4, rgba);
+	Surface expected(9, 4, rgba), actual(9, 4, rgba);
+	FillRandom(src, 3);
+	ConvertPixels(src, converted);
+	FillRandom(expected, 4);
+	FillRandom(actual, 4);
+	expected.draw(&src, Common::Rect(0, 0, 9, 4), 0, 0, false, false, true, -1, -1, -1, -1);
+	actual.draw(&converted, Common::Rect(0, 0, 9, 4), 0, 0, false, false, true, -1, -1, -1, -1);
+	assert(SamePixels(expected, actual));
+
+	set_blender_mode(savedMode, _G(trans_blend_red), _G(trans_blend_green), _G(trans_blend_blue), _G(trans_blend_alpha));
+}
+
 void Test_Gfx() {
 	// Test that every transparency which is a multiple of 10 is converted
 	// forth and back without loosing precision
@@ -41,6 +144,8 @@ void Test_Gfx() {
 		trans100_back[i] = GfxDef::LegacyTrans255ToTrans100(trans255[i]);
 		assert(trans100[i] == trans100_back[i]);
 	}
+
+	Test_BitmapDraw();
 }
 
 } // namespace AGS3
@@ -756,12 +756,7 @@ void Menu::readThumbnail() {
 	int w = thumbnail->w, h = thumbnail->h;
 
 	_thumbnailSurface.create(w, h, Graphics::PixelFormat::createFormatCLUT8());
-	for (int i = 0; i < w; i++)
-		for (int j = 0; j < h; j++) {
-			byte r, g, b;
-			thumbnail->format.colorToRGB(thumbnail->getPixel(i, j), r, g, b);
-			_thumbnailSurface.setPixel(i, j, paletteLookup.findBestColor(r, g, b));
-		}
+	paletteLookup.mapPixels(*thumbnail, _thumbnailSurface);
 }
 
 void Menu::showThumbnail() {
@@ -179,8 +179,15 @@ bool Window::render(bool forceRedraw, Graphics::ManagedSurface *blitTo) {
 		font->drawString(blitTo, msg, blitTo->w - 2 - width, 2, width , _wm->_colorWhite);
 	}
 
+	// Only the rendered parts need composing into the screen
+	if (_dirtyRects.empty() || (g_director->_debugDraw & kDebugDrawFrame)) {
+		_contentIsDirty = true;
+	} else {
+		for (Common::List<Common::Rect>::iterator i = _dirtyRects.begin(); i != _dirtyRects.end(); i++)
+			addDamage(*i);
+	}
+
 	_dirtyRects.clear();
-	_contentIsDirty = true;
 
 	return true;
 }
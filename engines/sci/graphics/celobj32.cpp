@@ -91,6 +91,7 @@ void CelObj::init() {
 	_nextCacheId = 1;
 	_scaler = new CelScaler();
 	_cache = new CelCache(100);
+	_larryScaleCache = new LarryScaleCache(100);
 }
 
 void CelObj::deinit() {
@@ -98,6 +99,8 @@ void CelObj::deinit() {
 	_scaler = nullptr;
 	delete _cache;
 	_cache = nullptr;
+	delete _larryScaleCache;
+	_larryScaleCache = nullptr;
 }
 
 #pragma mark -
@@ -234,14 +237,18 @@ struct SCALER_Scale {
 				scaledPosition.y,
 				scaledPosition.x + (celObj._width * scaleX).toInt(),
 				scaledPosition.y + (celObj._height * scaleY).toInt());
-			_sourceBuffer = Common::SharedPtr<Buffer>(new Buffer(), Graphics::SurfaceDeleter());
-			_sourceBuffer->create(
-				scaledImageRect.width(), scaledImageRect.height(),
-				Graphics::PixelFormat::createFormatCLUT8());
-			Copier copier(_reader, *_sourceBuffer);
-			Graphics::larryScale(
-				celObj._width, celObj._height, celObj._skipColor, copier,
-				scaledImageRect.width(), scaledImageRect.height(), copier);
+			_sourceBuffer = celObj.searchLarryScaleCache(scaledImageRect.width(), scaledImageRect.height());
+			if (!_sourceBuffer) {
+				_sourceBuffer = Common::SharedPtr<Buffer>(new Buffer(), Graphics::SurfaceDeleter());
+				_sourceBuffer->create(
+					scaledImageRect.width(), scaledImageRect.height(),
+					Graphics::PixelFormat::createFormatCLUT8());
+				Copier copier(_reader, *_sourceBuffer);
+				Graphics::larryScale(
+					celObj._width, celObj._height, celObj._skipColor, copier,
+					scaledImageRect.width(), scaledImageRect.height(), copier);
+				celObj.putInLarryScaleCache(_sourceBuffer);
+			}
 
 			// Set _valuesX and _valuesY to reference the scaled image without additional scaling
 			for (int16 x = targetRect.left; x < targetRect.right; ++x) {
@@ -727,6 +734,40 @@ void CelObj::putCopyInCache(const int cacheIndex) const {
 	entry.id = ++_nextCacheId;
 }
 
+LarryScaleCache *CelObj::_larryScaleCache = nullptr;
+
+Common::SharedPtr<Buffer> CelObj::searchLarryScaleCache(const int16 width, const int16 height) const {
+	for (uint i = 0; i < _larryScaleCache->size(); ++i) {
+		LarryScaleCacheEntry &entry = (*_larryScaleCache)[i];
+		if (entry.buffer && entry.celInfo == _info && entry.width == width && entry.height == height) {
+			entry.id = ++_nextCacheId;
+			return entry.buffer;
+		}
+	}
+
+	return Common::SharedPtr<Buffer>();
+}
+
+void CelObj::putInLarryScaleCache(const Common::SharedPtr<Buffer> &buffer) const {
+	if (_info.type != kCelTypeView && _info.type != kCelTypePic) {
+		return;
+	}
+
+	uint oldestIndex = 0;
+	for (uint i = 1; i < _larryScaleCache->size(); ++i) {
+		if ((*_larryScaleCache)[i].id < (*_larryScaleCache)[oldestIndex].id) {
+			oldestIndex = i;
+		}
+	}
+
+	LarryScaleCacheEntry &entry = (*_larryScaleCache)[oldestIndex];
+	entry.id = ++_nextCacheId;
+	entry.celInfo = _info;
+	entry.width = buffer->w;
+	entry.height = buffer->h;
+	entry.buffer = buffer;
+}
+
 #pragma mark -
 #pragma mark CelObj - Drawing
 
@@ -151,6 +151,33 @@ struct CelCacheEntry {
 
 typedef Common::Array<CelCacheEntry> CelCache;
 
+struct LarryScaleCacheEntry {
+	/**
+	 * A monotonically increasing cache ID used to identify the least recently
+	 * used item in the cache for replacement.
+	 */
+	int id;
+
+	/**
+	 * The cel that was scaled.
+	 */
+	CelInfo32 celInfo;
+
+	/**
+	 * The size the cel was scaled to.
+	 */
+	int16 width, height;
+
+	/**
+	 * The scaled, unflipped cel.
+	 */
+	Common::SharedPtr<Buffer> buffer;
+
+	LarryScaleCacheEntry() : id(0), width(0), height(0) {}
+};
+
+typedef Common::Array<LarryScaleCacheEntry> LarryScaleCache;
+
 #pragma mark -
 #pragma mark CelScaler
 
@@ -477,6 +504,26 @@ protected:
 	 * Puts a copy of this CelObj into the cache at the given cache index.
 	 */
 	void putCopyInCache(int index) const;
+
+	/**
+	 * A cache of the cels scaled by LarryScale, so that the cels of views and
+	 * pics are only scaled once to each size.
+	 */
+	static LarryScaleCache *_larryScaleCache;
+
+public:
+	/**
+	 * Returns the LarryScale scaled version of this cel at the given size, or
+	 * a null pointer if it is not in the cache.
+	 */
+	Common::SharedPtr<Buffer> searchLarryScaleCache(int16 width, int16 height) const;
+
+	/**
+	 * Puts the LarryScale scaled version of this cel into the cache, replacing
+	 * the least recently used one. Cels which are not read from resources are
+	 * not cached, since their bitmaps can change.
+	 */
+	void putInLarryScaleCache(const Common::SharedPtr<Buffer> &buffer) const;
 };
 
 #pragma mark -
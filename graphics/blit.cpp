@@ -21,6 +21,7 @@
 
 #include "graphics/blit.h"
 #include "graphics/pixelformat.h"
+#include "graphics/scaler/simd.h"
 
 namespace Graphics {
 
@@ -193,6 +194,285 @@ inline void crossBlitLogic3BppSource(byte *dst, const byte *src, const uint w, c
 	}
 }
 
+/**
+ * Specialized converters for the format pairs which are the most common
+ * in practice. Each of them converts a row of pixels, and gives the same
+ * colors as colorToARGB() followed by ARGBToColor().
+ */
+typedef void (*FastBlitRow)(byte *dst, const byte *src, const uint w,
+							const PixelFormat &dstFmt, const PixelFormat &srcFmt);
+
+struct FastBlitConverter {
+	bool (*matches)(const PixelFormat &dstFmt, const PixelFormat &srcFmt);
+	FastBlitRow convertRow;
+};
+
+template<typename SrcColor, typename DstColor>
+inline void convertPixel(byte *dst, const byte *src, const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	byte a, r, g, b;
+	srcFmt.colorToARGB(*(const SrcColor *)src, a, r, g, b);
+	*(DstColor *)dst = dstFmt.ARGBToColor(a, r, g, b);
+}
+
+inline bool isRGB565(const PixelFormat &fmt) {
+	return fmt == PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0);
+}
+
+inline bool isRGB555(const PixelFormat &fmt) {
+	return fmt == PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0);
+}
+
+// Any 32 bit format with 8 bit components, and an optional 8 bit alpha
+inline bool is8888(const PixelFormat &fmt) {
+	return fmt.bytesPerPixel == 4 && fmt.rLoss == 0 && fmt.gLoss == 0 && fmt.bLoss == 0
+		&& (fmt.aLoss == 0 || fmt.aLoss == 8)
+		&& fmt.rShift <= 24 && fmt.gShift <= 24 && fmt.bShift <= 24 && fmt.aShift <= 24;
+}
+
+// The alpha bits set by ARGBToColor() for sources without alpha
+inline uint32 opaqueAlpha(const PixelFormat &dstFmt) {
+	return (0xFF >> dstFmt.aLoss) << dstFmt.aShift;
+}
+
+bool matches565To8888(const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	return isRGB565(srcFmt) && is8888(dstFmt);
+}
+
+// Converts from right to left, so that it can be done in place
+void convert565To8888(byte *dst, const byte *src, const uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	uint x = w;
+	while (x & 7) {
+		--x;
+		convertPixel<uint16, uint32>(dst + x * 4, src + x * 2, dstFmt, srcFmt);
+	}
+
+#if defined(SCALER_SIMD_SSE2)
+	const __m128i rShift = _mm_cvtsi32_si128(dstFmt.rShift);
+	const __m128i gShift = _mm_cvtsi32_si128(dstFmt.gShift);
+	const __m128i bShift = _mm_cvtsi32_si128(dstFmt.bShift);
+	const __m128i alpha = _mm_set1_epi32(opaqueAlpha(dstFmt));
+	const __m128i zero = _mm_setzero_si128();
+	while (x) {
+		x -= 8;
+		const __m128i p = _mm_loadu_si128((const __m128i *)(src + x * 2));
+		__m128i r = _mm_srli_epi16(p, 11);
+		__m128i g = _mm_and_si128(_mm_srli_epi16(p, 5), _mm_set1_epi16(0x3F));
+		__m128i b = _mm_and_si128(p, _mm_set1_epi16(0x1F));
+		r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+		g = _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4));
+		b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+
+		const __m128i lo = _mm_or_si128(_mm_or_si128(alpha, _mm_sll_epi32(_mm_unpacklo_epi16(r, zero), rShift)),
+		                                _mm_or_si128(_mm_sll_epi32(_mm_unpacklo_epi16(g, zero), gShift), _mm_sll_epi32(_mm_unpacklo_epi16(b, zero), bShift)));
+		const __m128i hi = _mm_or_si128(_mm_or_si128(alpha, _mm_sll_epi32(_mm_unpackhi_epi16(r, zero), rShift)),
+		                                _mm_or_si128(_mm_sll_epi32(_mm_unpackhi_epi16(g, zero), gShift), _mm_sll_epi32(_mm_unpackhi_epi16(b, zero), bShift)));
+		_mm_storeu_si128((__m128i *)(dst + x * 4 + 16), hi);
+		_mm_storeu_si128((__m128i *)(dst + x * 4), lo);
+	}
+#elif defined(SCALER_SIMD_NEON)
+	const int32x4_t rShift = vdupq_n_s32(dstFmt.rShift);
+	const int32x4_t gShift = vdupq_n_s32(dstFmt.gShift);
+	const int32x4_t bShift = vdupq_n_s32(dstFmt.bShift);
+	const uint32x4_t alpha = vdupq_n_u32(opaqueAlpha(dstFmt));
+	while (x) {
+		x -= 8;
+		const uint16x8_t p = vld1q_u16((const uint16 *)(src + x * 2));
+		uint16x8_t r = vshrq_n_u16(p, 11);
+		uint16x8_t g = vandq_u16(vshrq_n_u16(p, 5), vdupq_n_u16(0x3F));
+		uint16x8_t b = vandq_u16(p, vdupq_n_u16(0x1F));
+		r = vorrq_u16(vshlq_n_u16(r, 3), vshrq_n_u16(r, 2));
+		g = vorrq_u16(vshlq_n_u16(g, 2), vshrq_n_u16(g, 4));
+		b = vorrq_u16(vshlq_n_u16(b, 3), vshrq_n_u16(b, 2));
+
+		const uint32x4_t lo = vorrq_u32(vorrq_u32(alpha, vshlq_u32(vmovl_u16(vget_low_u16(r)), rShift)),
+		                                vorrq_u32(vshlq_u32(vmovl_u16(vget_low_u16(g)), gShift), vshlq_u32(vmovl_u16(vget_low_u16(b)), bShift)));
+		const uint32x4_t hi = vorrq_u32(vorrq_u32(alpha, vshlq_u32(vmovl_u16(vget_high_u16(r)), rShift)),
+		                                vorrq_u32(vshlq_u32(vmovl_u16(vget_high_u16(g)), gShift), vshlq_u32(vmovl_u16(vget_high_u16(b)), bShift)));
+		vst1q_u32((uint32 *)(dst + x * 4 + 16), hi);
+		vst1q_u32((uint32 *)(dst + x * 4), lo);
+	}
+#else
+	while (x) {
+		--x;
+		convertPixel<uint16, uint32>(dst + x * 4, src + x * 2, dstFmt, srcFmt);
+	}
+#endif
+}
+
+bool matches8888To565(const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	return is8888(srcFmt) && isRGB565(dstFmt);
+}
+
+void convert8888To565(byte *dst, const byte *src, const uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	uint x = 0;
+#if defined(SCALER_SIMD_SSE2)
+	const __m128i rShift = _mm_cvtsi32_si128(srcFmt.rShift + 3);
+	const __m128i gShift = _mm_cvtsi32_si128(srcFmt.gShift + 2);
+	const __m128i bShift = _mm_cvtsi32_si128(srcFmt.bShift + 3);
+	const __m128i mask5 = _mm_set1_epi32(0x1F);
+	const __m128i mask6 = _mm_set1_epi32(0x3F);
+	// There is no unsigned saturation from 32 to 16 bits in SSE2, so the
+	// signed one is used on values moved to the signed range
+	const __m128i bias32 = _mm_set1_epi32(0x8000);
+	const __m128i bias16 = _mm_set1_epi16((short)0x8000);
+	for (; x + 8 <= w; x += 8) {
+		__m128i p[2];
+		for (int i = 0; i < 2; ++i) {
+			const __m128i v = _mm_loadu_si128((const __m128i *)(src + x * 4 + i * 16));
+			const __m128i r = _mm_and_si128(_mm_srl_epi32(v, rShift), mask5);
+			const __m128i g = _mm_and_si128(_mm_srl_epi32(v, gShift), mask6);
+			const __m128i b = _mm_and_si128(_mm_srl_epi32(v, bShift), mask5);
+			p[i] = _mm_sub_epi32(_mm_or_si128(_mm_or_si128(_mm_slli_epi32(r, 11), _mm_slli_epi32(g, 5)), b), bias32);
+		}
+		_mm_storeu_si128((__m128i *)(dst + x * 2), _mm_add_epi16(_mm_packs_epi32(p[0], p[1]), bias16));
+	}
+#elif defined(SCALER_SIMD_NEON)
+	const int32x4_t rShift = vdupq_n_s32(-(srcFmt.rShift + 3));
+	const int32x4_t gShift = vdupq_n_s32(-(srcFmt.gShift + 2));
+	const int32x4_t bShift = vdupq_n_s32(-(srcFmt.bShift + 3));
+	const uint32x4_t mask5 = vdupq_n_u32(0x1F);
+	const uint32x4_t mask6 = vdupq_n_u32(0x3F);
+	for (; x + 8 <= w; x += 8) {
+		uint16x4_t p[2];
+		for (int i = 0; i < 2; ++i) {
+			const uint32x4_t v = vld1q_u32((const uint32 *)(src + x * 4 + i * 16));
+			const uint32x4_t r = vandq_u32(vshlq_u32(v, rShift), mask5);
+			const uint32x4_t g = vandq_u32(vshlq_u32(v, gShift), mask6);
+			const uint32x4_t b = vandq_u32(vshlq_u32(v, bShift), mask5);
+			p[i] = vmovn_u32(vorrq_u32(vorrq_u32(vshlq_n_u32(r, 11), vshlq_n_u32(g, 5)), b));
+		}
+		vst1q_u16((uint16 *)(dst + x * 2), vcombine_u16(p[0], p[1]));
+	}
+#endif
+	for (; x < w; ++x)
+		convertPixel<uint32, uint16>(dst + x * 2, src + x * 4, dstFmt, srcFmt);
+}
+
+bool matches555To565(const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	return isRGB555(srcFmt) && isRGB565(dstFmt);
+}
+
+// The lowest bit of green is the copy of its highest bit made by expand()
+void convert555To565(byte *dst, const byte *src, const uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	uint x = 0;
+#if defined(SCALER_SIMD_SSE2)
+	const __m128i rgMask = _mm_set1_epi16(0x7FE0);
+	const __m128i gLowMask = _mm_set1_epi16(0x0020);
+	const __m128i bMask = _mm_set1_epi16(0x001F);
+	for (; x + 8 <= w; x += 8) {
+		const __m128i p = _mm_loadu_si128((const __m128i *)(src + x * 2));
+		const __m128i rg = _mm_slli_epi16(_mm_and_si128(p, rgMask), 1);
+		const __m128i gLow = _mm_and_si128(_mm_srli_epi16(p, 4), gLowMask);
+		_mm_storeu_si128((__m128i *)(dst + x * 2), _mm_or_si128(_mm_or_si128(rg, gLow), _mm_and_si128(p, bMask)));
+	}
+#elif defined(SCALER_SIMD_NEON)
+	const uint16x8_t rgMask = vdupq_n_u16(0x7FE0);
+	const uint16x8_t gLowMask = vdupq_n_u16(0x0020);
+	const uint16x8_t bMask = vdupq_n_u16(0x001F);
+	for (; x + 8 <= w; x += 8) {
+		const uint16x8_t p = vld1q_u16((const uint16 *)(src + x * 2));
+		const uint16x8_t rg = vshlq_n_u16(vandq_u16(p, rgMask), 1);
+		const uint16x8_t gLow = vandq_u16(vshrq_n_u16(p, 4), gLowMask);
+		vst1q_u16((uint16 *)(dst + x * 2), vorrq_u16(vorrq_u16(rg, gLow), vandq_u16(p, bMask)));
+	}
+#endif
+	for (; x < w; ++x)
+		convertPixel<uint16, uint16>(dst + x * 2, src + x * 2, dstFmt, srcFmt);
+}
+
+bool matches8888To8888(const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	return is8888(srcFmt) && is8888(dstFmt);
+}
+
+// Swizzles the components, e.g. between ABGR8888 and ARGB8888
+void convert8888To8888(byte *dst, const byte *src, const uint w, const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	uint x = 0;
+#if defined(SCALER_SIMD_SSE2) || defined(SCALER_SIMD_NEON)
+	// Sources without alpha give opaque pixels, and destinations without
+	// alpha drop it
+	const bool copyAlpha = srcFmt.aLoss == 0 && dstFmt.aLoss == 0;
+	const uint32 alpha = (srcFmt.aLoss == 8) ? opaqueAlpha(dstFmt) : 0;
+#endif
+#if defined(SCALER_SIMD_SSE2)
+	const __m128i srcShifts[4] = {
+		_mm_cvtsi32_si128(srcFmt.rShift), _mm_cvtsi32_si128(srcFmt.gShift),
+		_mm_cvtsi32_si128(srcFmt.bShift), _mm_cvtsi32_si128(srcFmt.aShift)
+	};
+	const __m128i dstShifts[4] = {
+		_mm_cvtsi32_si128(dstFmt.rShift), _mm_cvtsi32_si128(dstFmt.gShift),
+		_mm_cvtsi32_si128(dstFmt.bShift), _mm_cvtsi32_si128(dstFmt.aShift)
+	};
+	const int components = copyAlpha ? 4 : 3;
+	const __m128i mask = _mm_set1_epi32(0xFF);
+	const __m128i alphaBits = _mm_set1_epi32(alpha);
+	for (; x + 4 <= w; x += 4) {
+		const __m128i v = _mm_loadu_si128((const __m128i *)(src + x * 4));
+		__m128i p = alphaBits;
+		for (int i = 0; i < components; ++i)
+			p = _mm_or_si128(p, _mm_sll_epi32(_mm_and_si128(_mm_srl_epi32(v, srcShifts[i]), mask), dstShifts[i]));
+		_mm_storeu_si128((__m128i *)(dst + x * 4), p);
+	}
+#elif defined(SCALER_SIMD_NEON)
+	const int32x4_t srcShifts[4] = {
+		vdupq_n_s32(-srcFmt.rShift), vdupq_n_s32(-srcFmt.gShift),
+		vdupq_n_s32(-srcFmt.bShift), vdupq_n_s32(-srcFmt.aShift)
+	};
+	const int32x4_t dstShifts[4] = {
+		vdupq_n_s32(dstFmt.rShift), vdupq_n_s32(dstFmt.gShift),
+		vdupq_n_s32(dstFmt.bShift), vdupq_n_s32(dstFmt.aShift)
+	};
+	const int components = copyAlpha ? 4 : 3;
+	const uint32x4_t mask = vdupq_n_u32(0xFF);
+	const uint32x4_t alphaBits = vdupq_n_u32(alpha);
+	for (; x + 4 <= w; x += 4) {
+		const uint32x4_t v = vld1q_u32((const uint32 *)(src + x * 4));
+		uint32x4_t p = alphaBits;
+		for (int i = 0; i < components; ++i)
+			p = vorrq_u32(p, vshlq_u32(vandq_u32(vshlq_u32(v, srcShifts[i]), mask), dstShifts[i]));
+		vst1q_u32((uint32 *)(dst + x * 4), p);
+	}
+#endif
+	for (; x < w; ++x)
+		convertPixel<uint32, uint32>(dst + x * 4, src + x * 4, dstFmt, srcFmt);
+}
+
+const FastBlitConverter fastBlitConverters[] = {
+	{ matches565To8888, convert565To8888 },
+	{ matches8888To565, convert8888To565 },
+	{ matches555To565, convert555To565 },
+	{ matches8888To8888, convert8888To8888 }
+};
+
+FastBlitRow findFastBlitConverter(const PixelFormat &dstFmt, const PixelFormat &srcFmt) {
+	for (uint i = 0; i < ARRAYSIZE(fastBlitConverters); ++i) {
+		if (fastBlitConverters[i].matches(dstFmt, srcFmt))
+			return fastBlitConverters[i].convertRow;
+	}
+	return nullptr;
+}
+
+/**
+ * Looks up 4 pixels of a row at a time in the map, from right to left so
+ * that it can be done in place.
+ */
+template<typename DstColor>
+void crossBlitMapRow(byte *dst, const byte *src, const uint w, const uint32 *map) {
+	DstColor *d = (DstColor *)dst;
+	uint x = w;
+	while (x & 3) {
+		--x;
+		d[x] = map[src[x]];
+	}
+	while (x) {
+		x -= 4;
+		const byte c0 = src[x], c1 = src[x + 1], c2 = src[x + 2], c3 = src[x + 3];
+		d[x + 3] = map[c3];
+		d[x + 2] = map[c2];
+		d[x + 1] = map[c1];
+		d[x] = map[c0];
+	}
+}
+
 } // End of anonymous namespace
 
 // Function to blit a rect from one color format to another
@@ -212,6 +492,21 @@ bool crossBlit(byte *dst, const byte *src,
 		return true;
 	}
 
+	// Use a specialized converter for the most common format pairs. Those
+	// converting to larger pixels go from the last row to the first for
+	// the same reason as below.
+	const FastBlitRow fastConverter = findFastBlitConverter(dstFmt, srcFmt);
+	if (fastConverter) {
+		if (dstFmt.bytesPerPixel > srcFmt.bytesPerPixel) {
+			for (uint y = h; y-- > 0; )
+				fastConverter(dst + y * dstPitch, src + y * srcPitch, w, dstFmt, srcFmt);
+		} else {
+			for (uint y = 0; y < h; ++y)
+				fastConverter(dst + y * dstPitch, src + y * srcPitch, w, dstFmt, srcFmt);
+		}
+		return true;
+	}
+
 	// Faster, but larger, to provide optimized handling for each case.
 	const uint srcDelta = (srcPitch - w * srcFmt.bytesPerPixel);
 	const uint dstDelta = (dstPitch - w * dstFmt.bytesPerPixel);
@@ -332,18 +627,16 @@ bool crossBlitMap(byte *dst, const byte *src,
 		// buffer copying the surface from top left to bottom right would
 		// overwrite the source, since we have more bits per destination
 		// color than per source color.
-		dst += h * dstPitch - dstDelta - bytesPerPixel;
-		src += h * srcPitch - srcDelta - 1;
-		crossBlitLogic1BppSource<uint16, true, false>(dst, src, w, h, srcDelta, dstDelta, map, 0);
+		for (uint y = h; y-- > 0; )
+			crossBlitMapRow<uint16>(dst + y * dstPitch, src + y * srcPitch, w, map);
 	} else if (bytesPerPixel == 4) {
 		// We need to blit the surface from bottom right to top left here.
 		// This is neeeded, because when we convert to the same memory
 		// buffer copying the surface from top left to bottom right would
 		// overwrite the source, since we have more bits per destination
 		// color than per source color.
-		dst += h * dstPitch - dstDelta - bytesPerPixel;
-		src += h * srcPitch - srcDelta - 1;
-		crossBlitLogic1BppSource<uint32, true, false>(dst, src, w, h, srcDelta, dstDelta, map, 0);
+		for (uint y = h; y-- > 0; )
+			crossBlitMapRow<uint32>(dst + y * dstPitch, src + y * srcPitch, w, map);
 	} else {
 		return false;
 	}
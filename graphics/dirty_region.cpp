@@ -0,0 +1,204 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "common/util.h"
+#include "graphics/dirty_region.h"
+
+namespace Graphics {
+
+// Above this many rects, uploading them one by one costs more than
+// uploading the whole area at once
+static const uint kDefaultMaxRects = 100;
+
+DirtyRegion::DirtyRegion() : _width(0), _height(0), _tileShift(kDefaultTileShift),
+		_tilesW(0), _tilesH(0), _wordsPerRow(0), _maxRects(kDefaultMaxRects), _top(0), _bottom(-1) {
+}
+
+DirtyRegion::DirtyRegion(int width, int height, uint tileShift) : _width(0), _height(0),
+		_tileShift(tileShift), _tilesW(0), _tilesH(0), _wordsPerRow(0), _maxRects(kDefaultMaxRects),
+		_top(0), _bottom(-1) {
+	setSize(width, height);
+}
+
+void DirtyRegion::setSize(int width, int height) {
+	if (width == _width && height == _height)
+		return;
+
+	_width = MAX(width, 0);
+	_height = MAX(height, 0);
+	_tilesW = (_width + (1 << _tileShift) - 1) >> _tileShift;
+	_tilesH = (_height + (1 << _tileShift) - 1) >> _tileShift;
+	_wordsPerRow = (_tilesW + 31) / 32;
+	_bits.resize(_wordsPerRow * _tilesH);
+	_top = 0;
+	_bottom = _tilesH - 1;
+	clear();
+}
+
+void DirtyRegion::setBits(int row, int first, int last) {
+	uint32 *words = &_bits[row * _wordsPerRow];
+	const int firstWord = first >> 5;
+	const int lastWord = last >> 5;
+	const uint32 firstMask = 0xFFFFFFFF << (first & 31);
+	const uint32 lastMask = 0xFFFFFFFF >> (31 - (last & 31));
+
+	if (firstWord == lastWord) {
+		words[firstWord] |= firstMask & lastMask;
+		return;
+	}
+
+	words[firstWord] |= firstMask;
+	for (int i = firstWord + 1; i < lastWord; ++i)
+		words[i] = 0xFFFFFFFF;
+	words[lastWord] |= lastMask;
+}
+
+void DirtyRegion::addRect(const Common::Rect &r) {
+	Common::Rect bounds = r;
+	bounds.clip(Common::Rect(_width, _height));
+	if (bounds.isEmpty())
+		return;
+
+	const int firstCol = bounds.left >> _tileShift;
+	const int lastCol = (bounds.right - 1) >> _tileShift;
+	const int firstRow = bounds.top >> _tileShift;
+	const int lastRow = (bounds.bottom - 1) >> _tileShift;
+
+	for (int row = firstRow; row <= lastRow; ++row)
+		setBits(row, firstCol, lastCol);
+
+	if (isEmpty()) {
+		_top = firstRow;
+		_bottom = lastRow;
+	} else {
+		_top = MIN(_top, firstRow);
+		_bottom = MAX(_bottom, lastRow);
+	}
+}
+
+void DirtyRegion::addAll() {
+	addRect(Common::Rect(_width, _height));
+}
+
+void DirtyRegion::clear() {
+	if (isEmpty())
+		return;
+
+	for (uint i = _top * _wordsPerRow; i < (_bottom + 1) * _wordsPerRow; ++i)
+		_bits[i] = 0;
+	_top = 0;
+	_bottom = -1;
+}
+
+bool DirtyRegion::intersects(const Common::Rect &r) const {
+	Common::Rect bounds = r;
+	bounds.clip(Common::Rect(_width, _height));
+	if (bounds.isEmpty() || isEmpty())
+		return false;
+
+	const int firstCol = bounds.left >> _tileShift;
+	const int lastCol = (bounds.right - 1) >> _tileShift;
+	const int firstRow = MAX<int>(bounds.top >> _tileShift, _top);
+	const int lastRow = MIN<int>((bounds.bottom - 1) >> _tileShift, _bottom);
+
+	for (int row = firstRow; row <= lastRow; ++row) {
+		const uint32 *words = &_bits[row * _wordsPerRow];
+		for (int col = firstCol; col <= lastCol; ++col) {
+			if (words[col >> 5] & (1U << (col & 31)))
+				return true;
+		}
+	}
+
+	return false;
+}
+
+bool DirtyRegion::getRects(Common::Array<Common::Rect> &rects) const {
+	rects.resize(0);
+	if (isEmpty())
+		return true;
+
+	// Rects are built in tile units. The rects which end on the previous
+	// row, and so may be extended by the spans of the current row, are
+	// kept in order of their left edge, as the spans are found.
+	Common::Array<uint> prevRow, curRow;
+	uint dirtyTiles = 0;
+	bool fragmented = false;
+
+	for (int row = _top; row <= _bottom && !fragmented; ++row) {
+		const uint32 *words = &_bits[row * _wordsPerRow];
+		uint prev = 0;
+		curRow.resize(0);
+
+		int col = 0;
+		while (col < _tilesW) {
+			const uint32 word = words[col >> 5] >> (col & 31);
+			if (word == 0) {
+				// Skip to the next word
+				col = (col | 31) + 1;
+				continue;
+			}
+			if (!(word & 1)) {
+				++col;
+				continue;
+			}
+
+			const int left = col;
+			while (col < _tilesW && (words[col >> 5] & (1U << (col & 31))))
+				++col;
+			dirtyTiles += col - left;
+
+			while (prev < prevRow.size() && rects[prevRow[prev]].left < left)
+				++prev;
+
+			if (prev < prevRow.size() && rects[prevRow[prev]].left == left && rects[prevRow[prev]].right == col) {
+				rects[prevRow[prev]].bottom = row + 1;
+				curRow.push_back(prevRow[prev]);
+			} else {
+				if (rects.size() == _maxRects) {
+					fragmented = true;
+					break;
+				}
+				curRow.push_back(rects.size());
+				rects.push_back(Common::Rect(left, row, col, row + 1));
+			}
+		}
+
+		prevRow.swap(curRow);
+	}
+
+	if (fragmented || dirtyTiles * 4 > (uint)(_tilesW * _tilesH) * 3) {
+		rects.resize(0);
+		rects.push_back(Common::Rect(_width, _height));
+		return false;
+	}
+
+	for (uint i = 0; i < rects.size(); ++i) {
+		Common::Rect &r = rects[i];
+		r.left <<= _tileShift;
+		r.top <<= _tileShift;
+		r.right = MIN<int>(r.right << _tileShift, _width);
+		r.bottom = MIN<int>(r.bottom << _tileShift, _height);
+	}
+
+	return true;
+}
+
+} // End of namespace Graphics
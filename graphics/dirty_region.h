@@ -0,0 +1,126 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRAPHICS_DIRTY_REGION_H
+#define GRAPHICS_DIRTY_REGION_H
+
+#include "common/array.h"
+#include "common/rect.h"
+
+namespace Graphics {
+
+/**
+ * @defgroup graphics_dirty_region Dirty region
+ * @ingroup graphics
+ *
+ * @brief DirtyRegion class for tracking the areas of a surface to update.
+ *
+ * @{
+ */
+
+/**
+ * Keeps track of the modified areas of a surface with a bitmask of
+ * fixed size tiles.
+ *
+ * Marking an area only sets the bits of the tiles it covers, so it does
+ * not matter how many rects overlap. The dirty tiles are coalesced into
+ * rects when they are needed: runs of tiles on a tile row make spans, and
+ * identical spans on consecutive rows make a single rect.
+ */
+class DirtyRegion {
+public:
+	/** Default tile size, as a shift: 16x16 pixels */
+	static const uint kDefaultTileShift = 4;
+
+	DirtyRegion();
+	DirtyRegion(int width, int height, uint tileShift = kDefaultTileShift);
+
+	/**
+	 * Sets the size of the tracked area. If the size changes, the region
+	 * is cleared.
+	 */
+	void setSize(int width, int height);
+
+	int getWidth() const { return _width; }
+	int getHeight() const { return _height; }
+
+	/**
+	 * Sets the number of rects above which getRects() advises updating
+	 * the whole area.
+	 */
+	void setMaxRects(uint maxRects) { _maxRects = maxRects; }
+
+	/**
+	 * Marks an area as dirty. The area is clipped to the tracked area.
+	 */
+	void addRect(const Common::Rect &r);
+
+	/**
+	 * Marks the whole area as dirty
+	 */
+	void addAll();
+
+	/**
+	 * Marks all of the area as clean
+	 */
+	void clear();
+
+	/**
+	 * Returns true if no area is dirty
+	 */
+	bool isEmpty() const { return _top > _bottom; }
+
+	/**
+	 * Returns true if a part of the tiles covered by the given area is dirty
+	 */
+	bool intersects(const Common::Rect &r) const;
+
+	/**
+	 * Gets the dirty areas, coalesced into rects aligned on the tiles and
+	 * clipped to the tracked area.
+	 *
+	 * If the region is too fragmented, because there would be more than
+	 * the maximum number of rects or because most of the tiles are dirty,
+	 * a single rect of the whole area is returned instead.
+	 *
+	 * @return false if the whole area should be updated
+	 */
+	bool getRects(Common::Array<Common::Rect> &rects) const;
+
+private:
+	void setBits(int row, int first, int last);
+
+	int _width, _height;
+	uint _tileShift;
+	int _tilesW, _tilesH;
+	uint _wordsPerRow;
+	uint _maxRects;
+
+	/** First and last tile rows with dirty tiles */
+	int _top, _bottom;
+
+	Common::Array<uint32> _bits;
+};
+
+/** @} */
+} // End of namespace Graphics
+
+#endif
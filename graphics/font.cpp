@@ -55,7 +55,8 @@ Common::Rect getBoundingBoxImpl(const Font &font, const StringType &str, int x,
 	// that we do allow an empty width to be specified here. This allows us
 	// to obtain the complete bounding box of a string.
 	const int leftX = x, rightX = w ? (x + w + 1) : 0x7FFFFFFF;
-	int width = font.getStringWidth(str);
+	const TextLayout *layout = font.getCachedLayout(str);
+	int width = layout ? layout->width : font.getStringWidth(str);
 
 	if (align == kTextAlignCenter)
 		x = x + (w - width)/2;
@@ -66,6 +67,26 @@ Common::Rect getBoundingBoxImpl(const Font &font, const StringType &str, int x,
 	bool first = true;
 	Common::Rect bbox;
 
+	if (layout) {
+		for (uint i = 0; i < layout->chars.size(); ++i) {
+			const TextLayout::Char &c = layout->chars[i];
+			if (x + c.x + c.box.right > rightX)
+				break;
+			if (x + c.x + c.box.right >= leftX) {
+				Common::Rect charBox = c.box;
+				charBox.translate(x + c.x, y);
+				if (first) {
+					bbox = charBox;
+					first = false;
+				} else {
+					bbox.extend(charBox);
+				}
+			}
+		}
+
+		return bbox;
+	}
+
 	typename StringType::unsigned_type last = 0;
 	for (typename StringType::const_iterator i = str.begin(), end = str.end(); i != end; ++i) {
 		const typename StringType::unsigned_type cur = *i;
@@ -93,6 +114,10 @@ Common::Rect getBoundingBoxImpl(const Font &font, const StringType &str, int x,
 
 template<class StringType>
 int getStringWidthImpl(const Font &font, const StringType &str) {
+	const TextLayout *layout = font.getCachedLayout(str);
+	if (layout)
+		return layout->width;
+
 	int space = 0;
 	typename StringType::unsigned_type last = 0;
 
@@ -112,7 +137,8 @@ void drawStringImpl(const Font &font, SurfaceType *dst, const StringType &str, i
 	assert(dst != 0);
 
 	const int leftX = x, rightX = x + w + 1;
-	int width = font.getStringWidth(str);
+	const TextLayout *layout = font.getCachedLayout(str);
+	int width = layout ? layout->width : font.getStringWidth(str);
 
 	if (align == kTextAlignCenter)
 		x = x + (w - width)/2;
@@ -120,6 +146,18 @@ void drawStringImpl(const Font &font, SurfaceType *dst, const StringType &str, i
 		x = x + w - width;
 	x += deltax;
 
+	if (layout) {
+		for (uint i = 0; i < layout->chars.size(); ++i) {
+			const TextLayout::Char &c = layout->chars[i];
+			if (x + c.x + c.box.right > rightX)
+				break;
+			if (x + c.x + c.box.right >= leftX)
+				font.drawChar(dst, c.chr, x + c.x, y, color);
+		}
+
+		return;
+	}
+
 	typename StringType::unsigned_type last = 0;
 	for (typename StringType::const_iterator i = str.begin(), end = str.end(); i != end; ++i) {
 		const typename StringType::unsigned_type cur = *i;
@@ -453,6 +491,27 @@ int Font::getStringWidth(const Common::U32String &str) const {
 	return getStringWidthImpl(*this, str);
 }
 
+void Font::layoutText(const Common::U32String &str, TextLayout &layout) const {
+	layout.chars.resize(str.size());
+
+	int x = 0;
+	uint32 last = 0;
+	for (uint i = 0; i < str.size(); ++i) {
+		const uint32 cur = str[i];
+		x += getKerningOffset(last, cur);
+		last = cur;
+
+		TextLayout::Char &c = layout.chars[i];
+		c.chr = cur;
+		c.x = x;
+		c.box = getBoundingBox(cur);
+
+		x += getCharWidth(cur);
+	}
+
+	layout.width = x;
+}
+
 void Font::drawChar(ManagedSurface *dst, uint32 chr, int x, int y, uint32 color) const {
 	drawChar(dst->surfacePtr(), chr, x, y, color);
 
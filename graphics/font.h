@@ -22,14 +22,11 @@
 #ifndef GRAPHICS_FONT_H
 #define GRAPHICS_FONT_H
 
+#include "common/array.h"
 #include "common/str.h"
 #include "common/ustr.h"
 #include "common/rect.h"
 
-namespace Common {
-template<class T> class Array;
-}
-
 namespace Graphics {
 
 /**
@@ -73,6 +70,24 @@ enum WordWrapMode {
  */
 TextAlign convertTextAlignH(TextAlign alignH, bool rtl);
 
+/**
+ * Placement of the characters of a string drawn with a font.
+ *
+ * @see Font::layoutText
+ */
+struct TextLayout {
+	struct Char {
+		uint32 chr;        ///< The character.
+		int x;             ///< Position of the character, kerning included.
+		Common::Rect box;  ///< Bounding box of the character, relative to its position.
+	};
+
+	Common::Array<Char> chars;
+	int width;             ///< Logical width of the string.
+
+	TextLayout() : width(0) {}
+};
+
 /**
  * Instances of this class represent a distinct font, with a built-in renderer.
  *
@@ -249,6 +264,21 @@ public:
 	/** @overload */
 	int getStringWidth(const Common::U32String &str) const;
 
+	/**
+	 * Return the layout of the string @p str from a cache of the recently
+	 * used strings, for fonts which keep one.
+	 *
+	 * The layout is used by drawString, getBoundingBox and getStringWidth
+	 * instead of querying the width, kerning and bounding box of every
+	 * character again. It stays valid until the next call.
+	 *
+	 * @return The cached layout, or nullptr if the font does not cache
+	 *         layouts or the string should be laid out directly.
+	 */
+	virtual const TextLayout *getCachedLayout(const Common::String &str) const { return nullptr; }
+	/** @overload */
+	virtual const TextLayout *getCachedLayout(const Common::U32String &str) const { return nullptr; }
+
 	/**
 	 * Word-wrap a text (that can contain newline characters) so that
 	 * no text line is wider than @p maxWidth pixels.
@@ -269,6 +299,13 @@ public:
 	int wordWrapText(const Common::String &str, int maxWidth, Common::Array<Common::String> &lines, int initWidth = 0, uint32 mode = kWordWrapOnExplicitNewLines) const;
 	/** @overload */
 	int wordWrapText(const Common::U32String &str, int maxWidth, Common::Array<Common::U32String> &lines, int initWidth = 0, uint32 mode = kWordWrapOnExplicitNewLines) const;
+
+protected:
+	/**
+	 * Compute the layout of the string @p str, for fonts which implement
+	 * getCachedLayout.
+	 */
+	void layoutText(const Common::U32String &str, TextLayout &layout) const;
 };
 /** @} */
 } // End of namespace Graphics
@@ -161,6 +161,9 @@ public:
 	void drawChar(Surface *dst, uint32 chr, int x, int y, uint32 color) const override;
 	void drawChar(ManagedSurface *dst, uint32 chr, int x, int y, uint32 color) const override;
 
+	const TextLayout *getCachedLayout(const Common::String &str) const override;
+	const TextLayout *getCachedLayout(const Common::U32String &str) const override;
+
 private:
 	bool _initialized;
 	FT_Face _face;
@@ -184,6 +187,28 @@ private:
 	bool _allowLateCaching;
 	void assureCached(uint32 chr) const;
 
+	// Glyph images are packed in rows into a few large atlas surfaces,
+	// rather than each having its own allocation
+	static const int kAtlasSize = 256;
+	mutable Common::Array<Surface *> _atlases;
+	mutable Surface *_atlas;
+	mutable int _atlasX, _atlasY, _atlasRowHeight;
+	void allocateGlyphImage(Surface &image, int w, int h) const;
+
+	// Layouts of the recently used strings, the least recently used one
+	// being replaced when the cache is full
+	static const uint kLayoutCacheSize = 64;
+	static const uint kMaxLayoutLength = 256;
+	struct CachedLayout {
+		Common::U32String str;
+		TextLayout layout;
+		uint32 lastUse;
+	};
+	mutable Common::Array<CachedLayout> _layouts;
+	typedef Common::HashMap<Common::U32String, uint> LayoutIndex;
+	mutable LayoutIndex _layoutIndex;
+	mutable uint32 _layoutUse;
+
 	Common::SeekableReadStream *readTTFTable(FT_ULong tag) const;
 
 	int computePointSize(int size, TTFSizeMode sizeMode) const;
@@ -203,7 +228,8 @@ private:
 TTFFont::TTFFont()
 	: _initialized(false), _face(), _ttfFile(0), _size(0), _width(0), _height(0), _ascent(0),
 	  _descent(0), _glyphs(), _loadFlags(FT_LOAD_TARGET_NORMAL), _renderMode(FT_RENDER_MODE_NORMAL),
-	  _hasKerning(false), _allowLateCaching(false), _fakeBold(false), _fakeItalic(false) {
+	  _hasKerning(false), _allowLateCaching(false), _atlas(nullptr), _atlasX(0), _atlasY(0), _atlasRowHeight(0),
+	  _layoutUse(0), _fakeBold(false), _fakeItalic(false) {
 }
 
 TTFFont::~TTFFont() {
@@ -213,11 +239,13 @@ TTFFont::~TTFFont() {
 		delete[] _ttfFile;
 		_ttfFile = 0;
 
-		for (GlyphCache::iterator i = _glyphs.begin(), end = _glyphs.end(); i != end; ++i)
-			i->_value.image.free();
-
 		_initialized = false;
 	}
+
+	for (uint i = 0; i < _atlases.size(); ++i) {
+		_atlases[i]->free();
+		delete _atlases[i];
+	}
 }
 
 bool TTFFont::load(Common::SeekableReadStream &stream, int size, TTFSizeMode sizeMode,
@@ -812,8 +840,12 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 		bitmap = &_face->glyph->bitmap;
 	}
 
+	if (bitmap->pixel_mode != FT_PIXEL_MODE_MONO && bitmap->pixel_mode != FT_PIXEL_MODE_GRAY) {
+		warning("TTFFont::cacheGlyph: Unsupported pixel mode %d", bitmap->pixel_mode);
+		return false;
+	}
 
-	glyph.image.create(bitmap->width, bitmap->rows, PixelFormat::createFormatCLUT8());
+	allocateGlyphImage(glyph.image, bitmap->width, bitmap->rows);
 
 	const uint8 *src = bitmap->buffer;
 	int srcPitch = bitmap->pitch;
@@ -835,12 +867,12 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 					mask = *curSrc++;
 
 				if (mask & 0x80)
-					*dst = 255;
+					dst[x] = 255;
 
 				mask <<= 1;
-				++dst;
 			}
 
+			dst += glyph.image.pitch;
 			src += srcPitch;
 		}
 		break;
@@ -854,9 +886,7 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 		break;
 
 	default:
-		warning("TTFFont::cacheGlyph: Unsupported pixel mode %d", bitmap->pixel_mode);
-		glyph.image.free();
-		return false;
+		break;
 	}
 
 #if FAKE_BOLD == 1
@@ -868,6 +898,43 @@ bool TTFFont::cacheGlyph(Glyph &glyph, uint32 chr) const {
 	return true;
 }
 
+void TTFFont::allocateGlyphImage(Surface &image, int w, int h) const {
+	image.w = w;
+	image.h = h;
+	image.pitch = 0;
+	image.format = PixelFormat::createFormatCLUT8();
+	image.setPixels(nullptr);
+
+	if (!w || !h)
+		return;
+
+	// Glyphs larger than an atlas get one of their own
+	if (w > kAtlasSize || h > kAtlasSize) {
+		Surface *atlas = new Surface();
+		atlas->create(w, h, image.format);
+		_atlases.push_back(atlas);
+		image = atlas->getSubArea(Common::Rect(w, h));
+		return;
+	}
+
+	if (_atlasX + w > kAtlasSize) {
+		_atlasX = 0;
+		_atlasY += _atlasRowHeight;
+		_atlasRowHeight = 0;
+	}
+
+	if (!_atlas || _atlasY + h > kAtlasSize) {
+		_atlas = new Surface();
+		_atlas->create(kAtlasSize, kAtlasSize, image.format);
+		_atlases.push_back(_atlas);
+		_atlasX = _atlasY = _atlasRowHeight = 0;
+	}
+
+	image = _atlas->getSubArea(Common::Rect(_atlasX, _atlasY, _atlasX + w, _atlasY + h));
+	_atlasX += w;
+	_atlasRowHeight = MAX(_atlasRowHeight, h);
+}
+
 void TTFFont::assureCached(uint32 chr) const {
 	if (!chr || !_allowLateCaching || _glyphs.contains(chr)) {
 		return;
@@ -879,6 +946,50 @@ void TTFFont::assureCached(uint32 chr) const {
 	}
 }
 
+const TextLayout *TTFFont::getCachedLayout(const Common::String &str) const {
+	if (str.empty() || str.size() > kMaxLayoutLength)
+		return nullptr;
+
+	// Characters of 8-bit strings are used as is, as drawString does
+	Common::U32String key;
+	for (uint i = 0; i < str.size(); ++i)
+		key += (Common::u32char_type_t)(byte)str[i];
+
+	return getCachedLayout(key);
+}
+
+const TextLayout *TTFFont::getCachedLayout(const Common::U32String &str) const {
+	if (str.empty() || str.size() > kMaxLayoutLength)
+		return nullptr;
+
+	LayoutIndex::const_iterator entry = _layoutIndex.find(str);
+	if (entry != _layoutIndex.end()) {
+		CachedLayout &cached = _layouts[entry->_value];
+		cached.lastUse = ++_layoutUse;
+		return &cached.layout;
+	}
+
+	uint index = _layouts.size();
+	if (index < kLayoutCacheSize) {
+		_layouts.resize(index + 1);
+	} else {
+		index = 0;
+		for (uint i = 1; i < _layouts.size(); ++i) {
+			if (_layouts[i].lastUse < _layouts[index].lastUse)
+				index = i;
+		}
+		_layoutIndex.erase(_layouts[index].str);
+	}
+
+	CachedLayout &cached = _layouts[index];
+	cached.str = str;
+	cached.lastUse = ++_layoutUse;
+	layoutText(str, cached.layout);
+	_layoutIndex[str] = index;
+
+	return &cached.layout;
+}
+
 Font *loadTTFFont(Common::SeekableReadStream &stream, int size, TTFSizeMode sizeMode, uint dpi, TTFRenderMode renderMode, const uint32 *mapping, bool stemDarkening) {
 	TTFFont *font = new TTFFont();
 
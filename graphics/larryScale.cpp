@@ -21,6 +21,7 @@
 
 #include "larryScale.h"
 #include "common/array.h"
+#include "graphics/scaler/simd.h"
 
 namespace Graphics {
 
@@ -28,6 +29,9 @@ typedef LarryScaleColor Color;
 
 const int kMargin = 2;
 
+// The number of source rows upscaled together. See scaleUp().
+const int kBandHeight = 16;
+
 // A bitmap that has a margin of `kMargin` pixels all around it.
 // Allows fast access without time-consuming bounds checking.
 template<typename T>
@@ -147,31 +151,97 @@ public:
 	}
 };
 
-inline bool isLinePixel(const MarginedBitmap<Color> &src, int x, int y) {
+// An equality matrix is a combination of eight Boolean flags indicating whether
+// each of the surrounding pixels has the same color as the central pixel.
+//
+// +------+------+------+
+// | 0x02 | 0x04 | 0x08 |
+// +------+------+------+
+// | 0x01 | Ref. | 0x10 |
+// +------+------+------+
+// | 0x80 | 0x40 | 0x20 |
+// +------+------+------+
+typedef byte EqualityMatrix;
+
+EqualityMatrix getEqualityMatrix(const Color *pixel, int stride) {
+#define EQUALS(x, y) (pixel[y * stride + x] == *pixel)
+
+	return (EQUALS(-1, 0) ? 0x01 : 0x00)
+		| (EQUALS(-1, -1) ? 0x02 : 0x00)
+		| (EQUALS(0, -1) ? 0x04 : 0x00)
+		| (EQUALS(1, -1) ? 0x08 : 0x00)
+		| (EQUALS(1, 0) ? 0x10 : 0x00)
+		| (EQUALS(1, 1) ? 0x20 : 0x00)
+		| (EQUALS(0, 1) ? 0x40 : 0x00)
+		| (EQUALS(-1, 1) ? 0x80 : 0x00);
+
+#undef EQUALS
+}
+
+// Computes the equality matrices of one row of pixels
+void computeEqualityMatrices(const MarginedBitmap<Color> &src, int y, MarginedBitmap<EqualityMatrix> &matrices) {
+	const int width = src.getWidth();
+	const int stride = src.getStride();
+	const Color *pixels = src.getPointerTo(0, y);
+	EqualityMatrix *row = matrices.getPointerTo(0, y);
+	int x = 0;
+
+	// 16 pixels are compared with their neighbours at once. The margin holds
+	// the neighbours of the pixels at the edges.
+#if defined(SCALER_SIMD_SSE2)
+#define EQUALS(xOffset, yOffset, bit) _mm_and_si128(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(pixel + yOffset * stride + xOffset)), center), _mm_set1_epi8((char)bit))
+	for (; x + 16 <= width; x += 16) {
+		const Color *pixel = pixels + x;
+		const __m128i center = _mm_loadu_si128((const __m128i *)pixel);
+		const __m128i matrix = _mm_or_si128(
+			_mm_or_si128(_mm_or_si128(EQUALS(-1, 0, 0x01), EQUALS(-1, -1, 0x02)), _mm_or_si128(EQUALS(0, -1, 0x04), EQUALS(1, -1, 0x08))),
+			_mm_or_si128(_mm_or_si128(EQUALS(1, 0, 0x10), EQUALS(1, 1, 0x20)), _mm_or_si128(EQUALS(0, 1, 0x40), EQUALS(-1, 1, 0x80))));
+		_mm_storeu_si128((__m128i *)(row + x), matrix);
+	}
+#undef EQUALS
+#elif defined(SCALER_SIMD_NEON)
+#define EQUALS(xOffset, yOffset, bit) vandq_u8(vceqq_u8(vld1q_u8(pixel + yOffset * stride + xOffset), center), vdupq_n_u8(bit))
+	for (; x + 16 <= width; x += 16) {
+		const Color *pixel = pixels + x;
+		const uint8x16_t center = vld1q_u8(pixel);
+		const uint8x16_t matrix = vorrq_u8(
+			vorrq_u8(vorrq_u8(EQUALS(-1, 0, 0x01), EQUALS(-1, -1, 0x02)), vorrq_u8(EQUALS(0, -1, 0x04), EQUALS(1, -1, 0x08))),
+			vorrq_u8(vorrq_u8(EQUALS(1, 0, 0x10), EQUALS(1, 1, 0x20)), vorrq_u8(EQUALS(0, 1, 0x40), EQUALS(-1, 1, 0x80))));
+		vst1q_u8(row + x, matrix);
+	}
+#undef EQUALS
+#endif
+
+	for (; x < width; ++x) {
+		row[x] = getEqualityMatrix(pixels + x, stride);
+	}
+}
+
+inline bool isLinePixel(const MarginedBitmap<Color> &src, EqualityMatrix matrix, int x, int y) {
 #define EQUALS(xOffset, yOffset) (src.get(x + xOffset, y + yOffset) == pixel)
 
 	const Color pixel = src.get(x, y);
 
 	// Single pixels are fills
-	if (!EQUALS(-1, -1) && !EQUALS(0, -1) && !EQUALS(1, -1) && !EQUALS(1, 0) && !EQUALS(1, 1) && !EQUALS(0, 1) && !EQUALS(-1, 1) && !EQUALS(-1, 0)) {
+	if (matrix == 0x00) {
 		return false;
 	}
 
 	// 2x2 blocks are fills
-	if (EQUALS(0, -1) && EQUALS(1, -1) && EQUALS(1, 0)) return false;
-	if (EQUALS(1, 0) && EQUALS(1, 1) && EQUALS(0, 1)) return false;
-	if (EQUALS(0, 1) && EQUALS(-1, 1) && EQUALS(-1, 0)) return false;
-	if (EQUALS(-1, 0) && EQUALS(-1, -1) && EQUALS(0, -1)) return false;
+	if ((matrix & 0x1c) == 0x1c) return false;
+	if ((matrix & 0x70) == 0x70) return false;
+	if ((matrix & 0xc1) == 0xc1) return false;
+	if ((matrix & 0x07) == 0x07) return false;
 
 	// A pixel adjacent to a 2x2 block is a fill.
-	if (EQUALS(-1, -1) && EQUALS(0, -1) && EQUALS(-1, -2) && EQUALS(0, -2)) return false;
-	if (EQUALS(0, -1) && EQUALS(1, -1) && EQUALS(0, -2) && EQUALS(1, -2)) return false;
-	if (EQUALS(1, -1) && EQUALS(1, 0) && EQUALS(2, -1) && EQUALS(2, 0)) return false;
-	if (EQUALS(1, 0) && EQUALS(1, 1) && EQUALS(2, 0) && EQUALS(2, 1)) return false;
-	if (EQUALS(1, 1) && EQUALS(0, 1) && EQUALS(1, 2) && EQUALS(0, 2)) return false;
-	if (EQUALS(0, 1) && EQUALS(-1, 1) && EQUALS(0, 2) && EQUALS(-1, 2)) return false;
-	if (EQUALS(-1, 1) && EQUALS(-1, 0) && EQUALS(-2, 1) && EQUALS(-2, 0)) return false;
-	if (EQUALS(-1, 0) && EQUALS(-1, -1) && EQUALS(-2, 0) && EQUALS(-2, -1)) return false;
+	if ((matrix & 0x06) == 0x06 && EQUALS(-1, -2) && EQUALS(0, -2)) return false;
+	if ((matrix & 0x0c) == 0x0c && EQUALS(0, -2) && EQUALS(1, -2)) return false;
+	if ((matrix & 0x18) == 0x18 && EQUALS(2, -1) && EQUALS(2, 0)) return false;
+	if ((matrix & 0x30) == 0x30 && EQUALS(2, 0) && EQUALS(2, 1)) return false;
+	if ((matrix & 0x60) == 0x60 && EQUALS(1, 2) && EQUALS(0, 2)) return false;
+	if ((matrix & 0xc0) == 0xc0 && EQUALS(0, 2) && EQUALS(-1, 2)) return false;
+	if ((matrix & 0x81) == 0x81 && EQUALS(-2, 1) && EQUALS(-2, 0)) return false;
+	if ((matrix & 0x03) == 0x03 && EQUALS(-2, 0) && EQUALS(-2, -1)) return false;
 
 	// Everything else is part of a line
 	return true;
@@ -179,14 +249,19 @@ inline bool isLinePixel(const MarginedBitmap<Color> &src, int x, int y) {
 #undef EQUALS
 }
 
-MarginedBitmap<bool> createMarginedLinePixelsBitmap(const MarginedBitmap<Color> &src) {
-	MarginedBitmap<bool> result(src.getWidth(), src.getHeight(), false);
-	for (int y = 0; y < src.getHeight(); ++y) {
+// Computes the equality matrices and the line pixels of the rows y1 to y2 - 1
+void classifyRows(
+	const MarginedBitmap<Color> &src,
+	int y1, int y2,
+	MarginedBitmap<EqualityMatrix> &matrices,
+	MarginedBitmap<bool> &linePixels
+) {
+	for (int y = y1; y < y2; ++y) {
+		computeEqualityMatrices(src, y, matrices);
 		for (int x = 0; x < src.getWidth(); ++x) {
-			result.set(x, y, isLinePixel(src, x, y));
+			linePixels.set(x, y, isLinePixel(src, matrices.get(x, y), x, y));
 		}
 	}
-	return result;
 }
 
 void scaleDown(
@@ -216,7 +291,8 @@ void scaleDown(
 				int linePixelCount = 0;
 				for (int srcY = srcY1; srcY < srcY2; ++srcY) {
 					for (int srcX = srcX1; srcX < srcX2; ++srcX) {
-						const bool colorIsFromLine = isLinePixel(src, srcX, srcY);
+						const EqualityMatrix matrix = getEqualityMatrix(src.getPointerTo(srcX, srcY), src.getStride());
+						const bool colorIsFromLine = isLinePixel(src, matrix, srcX, srcY);
 						if (colorIsFromLine) {
 							bestLineColor = src.get(srcX, srcY);
 							++linePixelCount;
@@ -254,33 +330,6 @@ void scaleDown(
 	}
 }
 
-// An equality matrix is a combination of eight Boolean flags indicating whether
-// each of the surrounding pixels has the same color as the central pixel.
-//
-// +------+------+------+
-// | 0x02 | 0x04 | 0x08 |
-// +------+------+------+
-// | 0x01 | Ref. | 0x10 |
-// +------+------+------+
-// | 0x80 | 0x40 | 0x20 |
-// +------+------+------+
-typedef byte EqualityMatrix;
-
-EqualityMatrix getEqualityMatrix(const Color *pixel, int stride) {
-#define EQUALS(x, y) (pixel[y * stride + x] == *pixel)
-
-	return (EQUALS(-1, 0) ? 0x01 : 0x00)
-		| (EQUALS(-1, -1) ? 0x02 : 0x00)
-		| (EQUALS(0, -1) ? 0x04 : 0x00)
-		| (EQUALS(1, -1) ? 0x08 : 0x00)
-		| (EQUALS(1, 0) ? 0x10 : 0x00)
-		| (EQUALS(1, 1) ? 0x20 : 0x00)
-		| (EQUALS(0, 1) ? 0x40 : 0x00)
-		| (EQUALS(-1, 1) ? 0x80 : 0x00);
-
-#undef EQUALS
-}
-
 // scapeUp() requires generated functions
 #include "larryScale_generated.cpp"
 
@@ -297,48 +346,64 @@ void scaleUp(
 	assert(dstWidth >= srcWidth && dstWidth <= 2 * src.getWidth());
 	assert(dstHeight >= srcHeight && dstHeight <= 2 * src.getHeight());
 
-	const MarginedBitmap<bool> linePixels = createMarginedLinePixelsBitmap(src);
+	// The source is upscaled in bands of rows. The pixels of a band are
+	// classified before its rows are scaled; the rows of a band only depend on
+	// the classification of the band and of the rows just above and below
+	// it, so each band also classifies the first row of the next one. This
+	// keeps the classification in the cache while it is used. Bands could be
+	// scaled independently, but without a thread API to rely on here they
+	// are processed one after another.
+	MarginedBitmap<EqualityMatrix> matrices(srcWidth, srcHeight, 0);
+	MarginedBitmap<bool> linePixels(srcWidth, srcHeight, false);
 	Common::Array<Color> topDstRow(dstWidth);
 	Common::Array<Color> bottomDstRow(dstWidth);
-	for (int srcY = 0; srcY < src.getHeight(); ++srcY) {
-		const int dstY1 = srcY * dstHeight / src.getHeight();
-		const int dstY2 = (srcY + 1) * dstHeight / src.getHeight();
-		const int dstBlockHeight = dstY2 - dstY1;
-
-		for (int srcX = 0; srcX < src.getWidth(); ++srcX) {
-			const int dstX1 = srcX * dstWidth / src.getWidth();
-			const int dstX2 = (srcX + 1) * dstWidth / src.getWidth();
-			const int dstBlockWidth = dstX2 - dstX1;
-
-			if (dstBlockWidth == 1) {
-				if (dstBlockHeight == 1) {
-					// 1x1
-					topDstRow[dstX1] = src.get(srcX, srcY);
-				} else {
-					// 1x2
-					Color &top = topDstRow[dstX1];
-					Color &bottom = bottomDstRow[dstX1];
-					scalePixelTo1x2(src, linePixels, srcX, srcY, top, bottom);
-				}
-			} else {
-				if (dstBlockHeight == 1) {
-					// 2x1
-					Color &left = topDstRow[dstX1];
-					Color &right = topDstRow[dstX1 + 1];
-					scalePixelTo2x1(src, linePixels, srcX, srcY, left, right);
+	int classifiedRows = 0;
+	for (int bandTop = 0; bandTop < srcHeight; bandTop += kBandHeight) {
+		const int bandBottom = MIN(bandTop + kBandHeight, srcHeight);
+		const int classifyBottom = MIN(bandBottom + 1, srcHeight);
+		classifyRows(src, classifiedRows, classifyBottom, matrices, linePixels);
+		classifiedRows = classifyBottom;
+
+		for (int srcY = bandTop; srcY < bandBottom; ++srcY) {
+			const int dstY1 = srcY * dstHeight / src.getHeight();
+			const int dstY2 = (srcY + 1) * dstHeight / src.getHeight();
+			const int dstBlockHeight = dstY2 - dstY1;
+
+			for (int srcX = 0; srcX < src.getWidth(); ++srcX) {
+				const int dstX1 = srcX * dstWidth / src.getWidth();
+				const int dstX2 = (srcX + 1) * dstWidth / src.getWidth();
+				const int dstBlockWidth = dstX2 - dstX1;
+
+				if (dstBlockWidth == 1) {
+					if (dstBlockHeight == 1) {
+						// 1x1
+						topDstRow[dstX1] = src.get(srcX, srcY);
+					} else {
+						// 1x2
+						Color &top = topDstRow[dstX1];
+						Color &bottom = bottomDstRow[dstX1];
+						scalePixelTo1x2(src, matrices, linePixels, srcX, srcY, top, bottom);
+					}
 				} else {
-					// 2x2
-					Color &topLeft = topDstRow[dstX1];
-					Color &topRight = topDstRow[dstX1 + 1];
-					Color &bottomLeft = bottomDstRow[dstX1];
-					Color &bottomRight = bottomDstRow[dstX1 + 1];
-					scalePixelTo2x2(src, linePixels, srcX, srcY, topLeft, topRight, bottomLeft, bottomRight);
+					if (dstBlockHeight == 1) {
+						// 2x1
+						Color &left = topDstRow[dstX1];
+						Color &right = topDstRow[dstX1 + 1];
+						scalePixelTo2x1(src, matrices, linePixels, srcX, srcY, left, right);
+					} else {
+						// 2x2
+						Color &topLeft = topDstRow[dstX1];
+						Color &topRight = topDstRow[dstX1 + 1];
+						Color &bottomLeft = bottomDstRow[dstX1];
+						Color &bottomRight = bottomDstRow[dstX1 + 1];
+						scalePixelTo2x2(src, matrices, linePixels, srcX, srcY, topLeft, topRight, bottomLeft, bottomRight);
+					}
 				}
 			}
-		}
-		rowWriter.writeRow(dstY1, topDstRow.data());
-		if (dstBlockHeight == 2) {
-			rowWriter.writeRow(dstY1 + 1, bottomDstRow.data());
+			rowWriter.writeRow(dstY1, topDstRow.data());
+			if (dstBlockHeight == 2) {
+				rowWriter.writeRow(dstY1 + 1, bottomDstRow.data());
+			}
 		}
 	}
 }
@@ -24,13 +24,14 @@
 
 inline void scalePixelTo2x2(
 	const MarginedBitmap<Color> &src,
+	const MarginedBitmap<EqualityMatrix> &matrices,
 	const MarginedBitmap<bool> &linePixels,
 	int x, int y,
 	// Out parameters
 	Color &topLeft, Color &topRight, Color &bottomLeft, Color &bottomRight
 ) {
 	const Color pixel = src.get(x, y);
-	const EqualityMatrix matrix = getEqualityMatrix(src.getPointerTo(x, y), src.getStride());
+	const EqualityMatrix matrix = matrices.get(x, y);
 
 	// Note: There is a case label for every possible value, so we don't need a default label, but one is added to avoid any compiler warnings.
 	switch (matrix) {
@@ -391,13 +392,14 @@ inline void scalePixelTo2x2(
 
 inline void scalePixelTo2x1(
 	const MarginedBitmap<Color> &src,
+	const MarginedBitmap<EqualityMatrix> &matrices,
 	const MarginedBitmap<bool> &linePixels,
 	int x, int y,
 	// Out parameters
 	Color &left, Color &right
 ) {
 	const Color pixel = src.get(x, y);
-	const EqualityMatrix matrix = getEqualityMatrix(src.getPointerTo(x, y), src.getStride());
+	const EqualityMatrix matrix = matrices.get(x, y);
 
 	// Note: There is a case label for every possible value, so we don't need a default label, but one is added to avoid any compiler warnings.
 	switch (matrix) {
@@ -506,13 +508,14 @@ inline void scalePixelTo2x1(
 
 inline void scalePixelTo1x2(
 	const MarginedBitmap<Color> &src,
+	const MarginedBitmap<EqualityMatrix> &matrices,
 	const MarginedBitmap<bool> &linePixels,
 	int x, int y,
 	// Out parameters
 	Color &top, Color &bottom
 ) {
 	const Color pixel = src.get(x, y);
-	const EqualityMatrix matrix = getEqualityMatrix(src.getPointerTo(x, y), src.getStride());
+	const EqualityMatrix matrix = matrices.get(x, y);
 
 	// Note: There is a case label for every possible value, so we don't need a default label, but one is added to avoid any compiler warnings.
 	switch (matrix) {
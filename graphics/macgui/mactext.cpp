@@ -191,6 +191,8 @@ void MacText::init() {
 	_textMaxHeight = 0;
 	_surface = nullptr;
 	_shadowSurface = nullptr;
+	_surfaceStorage = nullptr;
+	_shadowSurfaceStorage = nullptr;
 
 	if (!_fixedDims) {
 		int right = _dims.right;
@@ -261,6 +263,8 @@ MacText::~MacText() {
 	delete _cursorRect;
 	delete _surface;
 	delete _shadowSurface;
+	delete _surfaceStorage;
+	delete _shadowSurfaceStorage;
 	delete _cursorSurface;
 	delete _cursorSurface2;
 }
@@ -869,52 +873,84 @@ void MacText::splitString(const Common::U32String &str, int curLine) {
 
 
 void MacText::reallocSurface() {
-	// round to closest 10
-	//TODO: work out why this rounding doesn't correctly fill the entire width
-	//int requiredH = (_text.size() + (_text.size() * 10 + 9) / 10) * lineH
-
-	if (!_surface) {
-		_surface = new ManagedSurface(_maxWidth, _textMaxHeight, _wm->_pixelformat);
-
-		if (_textShadow)
-			_shadowSurface = new ManagedSurface(_maxWidth, _textMaxHeight, _wm->_pixelformat);
-
+	if (_surface && _surface->w >= _maxWidth && _surface->h >= _textMaxHeight)
 		return;
-	}
 
-	if (_surface->w < _maxWidth || _surface->h < _textMaxHeight) {
-		// realloc surface and copy old content
-		ManagedSurface *n = new ManagedSurface(_maxWidth, _textMaxHeight, _wm->_pixelformat);
+	// The surfaces are given half of their height ahead, so that text
+	// added line by line does not copy the whole surface every time
+	if (!_surfaceStorage || _surfaceStorage->w < _maxWidth || _surfaceStorage->h < _textMaxHeight) {
+		ManagedSurface *n = new ManagedSurface(_maxWidth, _textMaxHeight + _textMaxHeight / 2, _wm->_pixelformat);
 		n->clear(_bgcolor);
-		n->blitFrom(*_surface, Common::Point(0, 0));
+		if (_surface)
+			n->blitFrom(*_surface, Common::Point(0, 0));
 
 		delete _surface;
-		_surface = n;
+		delete _surfaceStorage;
+		_surfaceStorage = n;
 
 		// same as shadow surface
 		if (_textShadow) {
-			ManagedSurface *newShadowSurface = new ManagedSurface(_maxWidth, _textMaxHeight, _wm->_pixelformat);
+			ManagedSurface *newShadowSurface = new ManagedSurface(_maxWidth, _textMaxHeight + _textMaxHeight / 2, _wm->_pixelformat);
 			newShadowSurface->clear(_bgcolor);
-			newShadowSurface->blitFrom(*_shadowSurface, Common::Point(0, 0));
+			if (_shadowSurface)
+				newShadowSurface->blitFrom(*_shadowSurface, Common::Point(0, 0));
 
 			delete _shadowSurface;
-			_shadowSurface = newShadowSurface;
+			delete _shadowSurfaceStorage;
+			_shadowSurfaceStorage = newShadowSurface;
 		}
+	} else {
+		delete _surface;
+		delete _shadowSurface;
 	}
+
+	_surface = new ManagedSurface(*_surfaceStorage, Common::Rect(_maxWidth, _textMaxHeight));
+	_shadowSurface = _textShadow ? new ManagedSurface(*_shadowSurfaceStorage, Common::Rect(_maxWidth, _textMaxHeight)) : nullptr;
 }
 
 void MacText::render() {
+	// The lines are rendered when they are drawn
 	if (_fullRefresh) {
 		_surface->clear(_bgcolor);
 		if (_textShadow)
 			_shadowSurface->clear(_bgcolor);
 
-		render(0, _textLines.size());
+		for (uint i = 0; i < _textLines.size(); i++)
+			_textLines[i].rendered = false;
 
 		_fullRefresh = false;
 	}
 }
 
+void MacText::renderLines(int top, int bottom) {
+	render();
+
+	if (_textLines.empty())
+		return;
+
+	// Last line starting above the top
+	int first = 0, last = _textLines.size() - 1;
+	while (first < last) {
+		int mid = (first + last + 1) / 2;
+		if (_textLines[mid].y <= top)
+			first = mid;
+		else
+			last = mid - 1;
+	}
+
+	for (int i = first; i < (int)_textLines.size() && _textLines[i].y < bottom; i++) {
+		if (_textLines[i].rendered)
+			continue;
+
+		int to = i;
+		while (to + 1 < (int)_textLines.size() && !_textLines[to + 1].rendered && _textLines[to + 1].y < bottom)
+			to++;
+
+		render(i, to);
+		i = to;
+	}
+}
+
 void MacText::render(int from, int to, int shadow) {
 	int w = MIN(_maxWidth, _textMaxWidth);
 	ManagedSurface *surface = shadow ? _shadowSurface : _surface;
@@ -991,6 +1027,12 @@ void MacText::render(int from, int to) {
 
 	render(from, to, 0);
 
+	for (int i = from; i <= to; i++)
+		_textLines[i].rendered = true;
+
+	if (!debugLevelSet(9))
+		return;
+
 	for (uint i = 0; i < _textLines.size(); i++) {
 		debugN(9, "MacText::render: %2d ", i);
 
@@ -1093,15 +1135,25 @@ void MacText::setInterLinear(int interLinear) {
 	_contentIsDirty = true;
 }
 
-void MacText::recalcDims() {
+void MacText::recalcDims(int from) {
 	if (_textLines.empty())
 		return;
 
 	int y = 0;
 	_textMaxWidth = 0;
 
-	for (uint i = 0; i < _textLines.size(); i++) {
-		_textLines[i].y = y;
+	from = CLIP<int>(from, 0, _textLines.size() - 1);
+	for (int i = 0; i < from; i++)
+		_textMaxWidth = MAX(_textMaxWidth, getLineWidth(i));
+	if (from > 0)
+		y = _textLines[from - 1].y + MAX(getLineHeight(from - 1), _interLinear);
+
+	for (uint i = from; i < _textLines.size(); i++) {
+		// the lines which moved are rendered again
+		if (_textLines[i].y != y) {
+			_textLines[i].y = y;
+			_textLines[i].rendered = false;
+		}
 
 		// We must calculate width first, because it enforces
 		// the computation. Calling Height() will return cached value!
@@ -1260,10 +1312,14 @@ void MacText::appendText(const Common::U32String &str, const Font *font, uint16
 }
 
 void MacText::appendText_(const Common::U32String &strWithFont, uint oldLen) {
+	// the last lines may have been removed since
+	const int from = MIN<int>(oldLen, _textLines.size()) - 1;
+
 	splitString(strWithFont);
-	recalcDims();
+	recalcDims(from);
 
-	render(oldLen - 1, _textLines.size());
+	for (uint i = MAX(from, 0); i < _textLines.size(); i++)
+		_textLines[i].rendered = false;
 
 	_contentIsDirty = true;
 
@@ -1287,9 +1343,10 @@ void MacText::appendTextDefault(const Common::U32String &str, bool skipAdd) {
 		_str += strWithFont;
 	}
 	splitString(strWithFont);
-	recalcDims();
+	recalcDims(oldLen - 1);
 
-	render(oldLen - 1, _textLines.size());
+	for (uint i = MAX<int>(oldLen - 1, 0); i < _textLines.size(); i++)
+		_textLines[i].rendered = false;
 }
 
 void MacText::appendTextDefault(const Common::String &str, bool skipAdd) {
@@ -1326,7 +1383,7 @@ void MacText::draw(ManagedSurface *g, int x, int y, int w, int h, int xoff, int
 	if (_textLines.empty())
 		return;
 
-	render();
+	renderLines(y, y + MIN(h, g->h - yoff));
 
 	if (x + w < _surface->w || y + h < _surface->h)
 		g->fillRect(Common::Rect(x + xoff, y + yoff, x + w + xoff, y + h + yoff), _bgcolor);
@@ -1404,13 +1461,13 @@ void MacText::drawToPoint(ManagedSurface *g, Common::Rect srcRect, Common::Point
 	if (_textLines.empty())
 		return;
 
-	render();
-
 	srcRect.clip(_surface->getBounds());
 
 	if (srcRect.isEmpty())
 		return;
 
+	renderLines(srcRect.top, srcRect.bottom);
+
 	g->blitFrom(*_surface, srcRect, dstPoint);
 }
 
@@ -1418,11 +1475,18 @@ void MacText::drawToPoint(ManagedSurface *g, Common::Point dstPoint) {
 	if (_textLines.empty())
 		return;
 
-	render();
+	renderLines(0, _textMaxHeight);
 
 	g->blitFrom(*_surface, dstPoint);
 }
 
+ManagedSurface *MacText::getSurface() {
+	if (_surface)
+		renderLines(0, _textMaxHeight);
+
+	return _surface;
+}
+
 // Count newline characters in String
 uint getNewlinesInString(const Common::U32String &str) {
 	Common::U32String::const_iterator p = str.begin();
@@ -114,6 +114,8 @@ struct MacTextLine {
 	int y;
 	int charwidth;
 	bool paragraphEnd;
+	// whether the line is drawn on the text surface at its current position
+	bool rendered;
 
 	Common::Array<MacFontRun> chunks;
 
@@ -121,6 +123,7 @@ struct MacTextLine {
 		width = height = charwidth = -1;
 		y = 0;
 		paragraphEnd = false;
+		rendered = false;
 	}
 
 	MacFontRun &firstChunk() { return chunks[0]; }
@@ -179,7 +182,7 @@ public:
 	void drawToPoint(ManagedSurface *g, Common::Rect srcRect, Common::Point dstPoint);
 	void drawToPoint(ManagedSurface *g, Common::Point dstPoint);
 
-	Graphics::ManagedSurface *getSurface() { return _surface; }
+	Graphics::ManagedSurface *getSurface();
 	int getInterLinear() { return _interLinear; }
 	void setInterLinear(int interLinear);
 	void setMaxWidth(int maxWidth);
@@ -316,7 +319,21 @@ private:
 	void splitString(const Common::U32String &str, int curLine = -1);
 	void render(int from, int to, int shadow);
 	void render(int from, int to);
-	void recalcDims();
+
+	/**
+	 * Renders the lines between the given vertical positions of the text
+	 * which are not drawn on the text surface yet. The lines are only
+	 * rendered when a part of them is drawn.
+	 */
+	void renderLines(int top, int bottom);
+
+	/**
+	 * Computes the positions of the lines and the size of the text
+	 *
+	 * @param from First line which changed, the previous ones keep
+	 *             their position and size
+	 */
+	void recalcDims(int from = 0);
 	void reallocSurface();
 
 	void drawSelection(int xoff, int yoff);
@@ -357,6 +374,9 @@ protected:
 
 	ManagedSurface *_surface;
 	ManagedSurface *_shadowSurface;
+	// the text surfaces are areas of those, which grow ahead of the text
+	ManagedSurface *_surfaceStorage;
+	ManagedSurface *_shadowSurfaceStorage;
 
 	TextAlign _textAlignment;
 
@@ -40,6 +40,8 @@ public:
 
 	virtual bool draw(ManagedSurface *g, bool forceRedraw = false) override;
 	virtual bool draw(bool forceRedraw = false) override;
+	// The text and the cursor are only drawn as a whole
+	bool getDamage(Common::Array<Common::Rect> &rects) override { return false; }
 	virtual void blit(ManagedSurface *g, Common::Rect &dest) override;
 
 	void setTextWindowFont(const MacFont *macFont);
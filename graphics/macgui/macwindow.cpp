@@ -146,13 +146,14 @@ void MacWindow::setBackgroundPattern(int pattern) {
 }
 
 bool MacWindow::draw(bool forceRedraw) {
-	if (!_borderIsDirty && !_contentIsDirty && !forceRedraw)
+	if (!_borderIsDirty && !_contentIsDirty && _damage.empty() && !forceRedraw)
 		return false;
 
 	if (_borderIsDirty || forceRedraw)
 		drawBorder();
 
 	_contentIsDirty = false;
+	_damage.clear();
 
 	return true;
 }
@@ -170,6 +171,41 @@ bool MacWindow::draw(ManagedSurface *g, bool forceRedraw) {
 	return true;
 }
 
+bool MacWindow::getDamage(Common::Array<Common::Rect> &rects) {
+	if (_borderIsDirty || _contentIsDirty) {
+		rects.push_back(_dims);
+		return true;
+	}
+
+	for (uint i = 0; i < _damage.size(); i++) {
+		Common::Rect r = _damage[i];
+		r.translate(_innerDims.left, _innerDims.top);
+		rects.push_back(r);
+	}
+
+	return true;
+}
+
+void MacWindow::blitArea(ManagedSurface *g, const Common::Rect &r) {
+	Common::Rect area(_innerDims.left, _innerDims.top, _innerDims.left + _composeSurface->w, _innerDims.top + _composeSurface->h);
+	area.clip(r);
+	if (!area.isEmpty()) {
+		Common::Rect src = area;
+		src.translate(-_innerDims.left, -_innerDims.top);
+		g->blitFrom(*_composeSurface, src, Common::Point(area.left, area.top));
+	}
+
+	area = Common::Rect(_dims.left, _dims.top, _dims.left + _borderSurface.w, _dims.top + _borderSurface.h);
+	area.clip(r);
+	if (!area.isEmpty()) {
+		Common::Rect src = area;
+		src.translate(-_dims.left, -_dims.top);
+
+		uint32 transcolor = (_wm->_pixelformat.bytesPerPixel == 1) ? _wm->_colorGreen : 0;
+		g->transBlitFrom(_borderSurface, src, Common::Point(area.left, area.top), transcolor);
+	}
+}
+
 void MacWindow::blit(ManagedSurface *g, Common::Rect &dest) {
 	// Only the inner surface is blitted here
 	uint32 transcolor = (_wm->_pixelformat.bytesPerPixel == 1) ? _wm->_colorGreen2 : 0;
@@ -556,6 +592,29 @@ void MacWindow::addDirtyRect(const Common::Rect &r) {
 		_dirtyRects.push_back(bounds);
 }
 
+void MacWindow::addDamage(const Common::Rect &r) {
+	if (!r.isValidRect())
+		return;
+
+	Common::Rect bounds = r;
+	bounds.clip(Common::Rect(_composeSurface->w, _composeSurface->h));
+
+	if (bounds.isEmpty())
+		return;
+
+	// The WM does not draw the windows covered by others, so keep the list
+	// short until they are drawn again
+	if (_damage.size() >= kMaxDamageRects) {
+		for (uint i = 1; i < _damage.size(); i++)
+			bounds.extend(_damage[i]);
+		_damage[0].extend(bounds);
+		_damage.resize(1);
+		return;
+	}
+
+	_damage.push_back(bounds);
+}
+
 void MacWindow::markAllDirty() {
 	_dirtyRects.clear();
 	_dirtyRects.push_back(Common::Rect(_composeSurface->w, _composeSurface->h));
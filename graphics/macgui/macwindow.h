@@ -47,7 +47,8 @@ enum WindowType {
 };
 
 enum {
-	kBorderWidth = 17
+	kBorderWidth = 17,
+	kMaxDamageRects = 16
 };
 
 enum WindowClick {
@@ -150,6 +151,23 @@ public:
 	 */
 	virtual bool draw(ManagedSurface *g, bool forceRedraw = false) = 0;
 
+	/**
+	 * Method called by the WM to get the parts of the window which need to
+	 * be drawn into the target surface again.
+	 * @param rects Array to which the parts are added, relative to the WM's screen.
+	 * @return false if the window can only be drawn as a whole, with draw().
+	 */
+	virtual bool getDamage(Common::Array<Common::Rect> &rects) { return false; }
+
+	/**
+	 * Method called by the WM to draw a part of the window into the target
+	 * surface, after the window has been drawn internally with draw().
+	 * It is only used when getDamage() returns true.
+	 * @param g Surface on which to draw the window.
+	 * @param r Part of the window to draw, relative to the WM's screen.
+	 */
+	virtual void blitArea(ManagedSurface *g, const Common::Rect &r) {}
+
 	/**
 	 * Method called by the WM when there is an event concerning the window.
 	 * Note that depending on the subclass of the window, it might not be called
@@ -343,7 +361,18 @@ public:
 	void markAllDirty();
 	void mergeDirtyRects();
 
-	bool isDirty() override { return _borderIsDirty || _contentIsDirty; }
+	/**
+	 * Mark a part of the inner surface as changed. Unlike setDirty(), only
+	 * the marked parts are drawn again into the WM's screen. Past
+	 * kMaxDamageRects parts, they are merged into their bounding rect.
+	 * @param r The changed part, relative to the inner surface.
+	 */
+	void addDamage(const Common::Rect &r);
+
+	bool getDamage(Common::Array<Common::Rect> &rects) override;
+	void blitArea(ManagedSurface *g, const Common::Rect &r) override;
+
+	bool isDirty() override { return _borderIsDirty || _contentIsDirty || !_damage.empty(); }
 
 	void setBorderDirty(bool dirty) { _borderIsDirty = true; }
 	void resizeBorderSurface();
@@ -377,6 +406,7 @@ protected:
 	Common::Rect _innerDims;
 
 	Common::List<Common::Rect> _dirtyRects;
+	Common::Array<Common::Rect> _damage;
 	bool _hasScrollBar;
 
 	uint32 _mode;
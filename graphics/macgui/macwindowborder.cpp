@@ -38,11 +38,14 @@ static const byte noborderData[3][3] = {
 MacWindowBorder::MacWindowBorder() {
 
 	_border = Common::Array<NinePatchBitmap *>(kWindowBorderMaxFlag);
+	_rendered = Common::Array<RenderedBorder *>(kWindowBorderMaxFlag);
 	_window = nullptr;
 	_useInternalBorder = false;
 
-	for (uint32 i = 0; i < kWindowBorderMaxFlag; i++)
+	for (uint32 i = 0; i < kWindowBorderMaxFlag; i++) {
 		_border[i] = nullptr;
+		_rendered[i] = nullptr;
+	}
 
 	_borderOffsets.left = -1;
 	_borderOffsets.right = -1;
@@ -65,9 +68,19 @@ MacWindowBorder::~MacWindowBorder() {
 	for (uint32 i = 0; i < kWindowBorderMaxFlag; i++) {
 		if (_border[i])
 			delete _border[i];
+		freeRenderedBorder(i);
 	}
 }
 
+void MacWindowBorder::freeRenderedBorder(uint32 flags) {
+	if (!_rendered[flags])
+		return;
+
+	_rendered[flags]->surface.free();
+	delete _rendered[flags];
+	_rendered[flags] = nullptr;
+}
+
 bool MacWindowBorder::hasBorder(uint32 flags) {
 	if (flags >= kWindowBorderMaxFlag) {
 		warning("Accessing non-existed border type, %d", flags);
@@ -102,6 +115,7 @@ void MacWindowBorder::addBorder(TransparentSurface *source, uint32 flags, int ti
 	}
 	if (_border[flags])
 		delete _border[flags];
+	freeRenderedBorder(flags);
 
 	_border[flags] = new NinePatchBitmap(source, true, titlePos);
 
@@ -276,7 +290,6 @@ void MacWindowBorder::blitBorderInto(ManagedSurface &destination, uint32 flags,
 		return;
 	}
 
-	TransparentSurface srf;
 	NinePatchBitmap *src = _border[flags];
 
 	if (!src) {
@@ -294,12 +307,29 @@ void MacWindowBorder::blitBorderInto(ManagedSurface &destination, uint32 flags,
 		setTitle(_title, destination.w, wm);
 	}
 
-	srf.create(destination.w, destination.h, destination.format);
-	srf.fillRect(Common::Rect(srf.w, srf.h), wm->_colorGreen2);
+	// Stretching the nine patches, and matching their colors with the
+	// palette, is only done again when the border changes
+	RenderedBorder *rendered = _rendered[flags];
+	if (!rendered || rendered->surface.w != destination.w || rendered->surface.h != destination.h ||
+			rendered->surface.format != destination.format || rendered->titleWidth != src->getTitleWidth() ||
+			rendered->paletteVersion != wm->getPaletteVersion()) {
+		if (!rendered) {
+			rendered = new RenderedBorder;
+			_rendered[flags] = rendered;
+		} else {
+			rendered->surface.free();
+		}
+
+		TransparentSurface &srf = rendered->surface;
+		srf.create(destination.w, destination.h, destination.format);
+		srf.fillRect(Common::Rect(srf.w, srf.h), wm->_colorGreen2);
+
+		src->blit(srf, 0, 0, srf.w, srf.h, NULL, 0, wm);
+		rendered->titleWidth = src->getTitleWidth();
+		rendered->paletteVersion = wm->getPaletteVersion();
+	}
 
-	src->blit(srf, 0, 0, srf.w, srf.h, NULL, 0, wm);
-	destination.transBlitFrom(srf, wm->_colorGreen2);
-	srf.free();
+	destination.transBlitFrom(rendered->surface, wm->_colorGreen2);
 
 	if (flags & kWindowBorderTitle)
 		drawTitle(&destination, wm, src->getTitleOffset());
@@ -147,10 +147,24 @@ public:
 	void setBorder(Graphics::TransparentSurface *surface, uint32 flags, int lo = -1, int ro = -1, int to = -1, int bo = -1);
 	void setBorder(Graphics::TransparentSurface *surface, uint32 flags, BorderOffsets offsets);
 private:
+	/**
+	 * The last rendering of a border, without the title and the scrollbar.
+	 * It is reused as long as the size, the title width and the palette
+	 * do not change.
+	 */
+	struct RenderedBorder {
+		TransparentSurface surface;
+		int titleWidth;
+		uint32 paletteVersion;
+	};
+
+	void freeRenderedBorder(uint32 flags);
+
 	int _scrollPos, _scrollSize;
 	Common::String _title;
 
 	Common::Array<NinePatchBitmap *> _border;
+	Common::Array<RenderedBorder *> _rendered;
 
 	MacWindow *_window;
 
@@ -211,6 +211,7 @@ MacWindowManager::MacWindowManager(uint32 mode, MacPatterns *patterns, Common::L
 	g_system->getPaletteManager()->setPalette(palette, 0, ARRAYSIZE(palette) / 3);
 
 	_paletteSize = ARRAYSIZE(palette) / 3;
+	_paletteVersion = 0;
 	if (_paletteSize) {
 		_palette = (byte *)malloc(_paletteSize * 3);
 		memcpy(_palette, palette, _paletteSize * 3);
@@ -831,6 +832,10 @@ void MacWindowManager::draw() {
 
 	Common::Rect bounds = getScreenBounds();
 
+	// The parts of the screen surface to copy to the screen
+	_screenDamage.setSize(bounds.width(), bounds.height());
+	_screenDamage.clear();
+
 	if (_fullRefresh) {
 		if (!(_mode & kWMModeNoDesktop)) {
 			Common::Rect screen = getScreenBounds();
@@ -842,7 +847,7 @@ void MacWindowManager::draw() {
 
 			if (_screen) {
 				_screen->blitFrom(*_desktop, Common::Point(0, 0));
-				g_system->copyRectToScreen(_screen->getPixels(), _screen->pitch, 0, 0, _screen->w, _screen->h);
+				_screenDamage.addAll();
 			} else {
 				_screenCopyPauseToken = new PauseToken(pauseEngine());
 				g_system->copyRectToScreen(_desktop->getPixels(), _desktop->pitch, 0, 0, _desktop->w, _desktop->h);
@@ -852,7 +857,7 @@ void MacWindowManager::draw() {
 			_redrawEngineCallback(_engineR);
 	}
 
-	Common::Array<Common::Rect> dirtyRects;
+	Common::Array<Common::Rect> dirtyRects, damage;
 	for (Common::List<BaseMacWindow *>::const_iterator it = _windowStack.begin(); it != _windowStack.end(); it++) {
 		BaseMacWindow *w = *it;
 		if (!w->isVisible())
@@ -870,6 +875,9 @@ void MacWindowManager::draw() {
 		if (clip.isEmpty())
 			continue;
 
+		if (_screen && isOccluded(it, clip))
+			continue;
+
 		bool forceRedraw = _fullRefresh;
 		if (!forceRedraw && dirtyRects.size()) {
 			for (Common::Array<Common::Rect>::iterator dirty = dirtyRects.begin(); dirty != dirtyRects.end(); dirty++) {
@@ -922,10 +930,56 @@ void MacWindowManager::draw() {
 				delete _screenCopyPauseToken;
 				_screenCopyPauseToken = nullptr;
 			}
-		} else if (w->draw(_screen, forceRedraw)) {
-			w->setDirty(false);
-			g_system->copyRectToScreen(_screen->getBasePtr(clip.left, clip.top), _screen->pitch, clip.left, clip.top, clip.width(), clip.height());
-			dirtyRects.push_back(clip);
+		} else {
+			damage.clear();
+
+			if (!w->getDamage(damage)) {
+				// The window can only be drawn as a whole
+				if (w->draw(_screen, forceRedraw)) {
+					w->setDirty(false);
+					damage.push_back(clip);
+				}
+			} else {
+				// Only compose the parts which changed, and the parts over
+				// what was drawn below
+				if (_fullRefresh) {
+					damage.clear();
+					damage.push_back(clip);
+				} else {
+					for (Common::Array<Common::Rect>::iterator dirty = dirtyRects.begin(); dirty != dirtyRects.end(); dirty++) {
+						if (clip.intersects(*dirty))
+							damage.push_back(clip.findIntersectingRect(*dirty));
+					}
+				}
+
+				if (!damage.empty())
+					w->draw(_fullRefresh);
+
+				uint count = 0;
+				for (uint i = 0; i < damage.size(); i++) {
+					Common::Rect r = damage[i];
+					r.clip(clip);
+					if (r.isEmpty() || isOccluded(it, r))
+						continue;
+
+					w->blitArea(_screen, r);
+					damage[count++] = r;
+				}
+				damage.resize(count);
+			}
+
+			for (uint i = 0; i < damage.size(); i++) {
+				_screenDamage.addRect(damage[i]);
+				dirtyRects.push_back(damage[i]);
+			}
+		}
+	}
+
+	if (_screen) {
+		_screenDamage.getRects(_screenDamageRects);
+		for (uint i = 0; i < _screenDamageRects.size(); i++) {
+			const Common::Rect &r = _screenDamageRects[i];
+			g_system->copyRectToScreen(_screen->getBasePtr(r.left, r.top), _screen->pitch, r.left, r.top, r.width(), r.height());
 		}
 	}
 
@@ -949,6 +1003,17 @@ void MacWindowManager::draw() {
 	_fullRefresh = false;
 }
 
+bool MacWindowManager::isOccluded(Common::List<BaseMacWindow *>::const_iterator it, const Common::Rect &r) const {
+	// The inner surfaces of the windows are drawn opaque, so the windows
+	// below them do not need drawing
+	for (++it; it != _windowStack.end(); it++) {
+		if ((*it)->isVisible() && (*it)->getInnerDimensions().contains(r))
+			return true;
+	}
+
+	return false;
+}
+
 static void menuTimerHandler(void *refCon) {
 	MacWindowManager *wm = (MacWindowManager *)refCon;
 
@@ -1296,6 +1361,7 @@ void MacWindowManager::passPalette(const byte *pal, uint size) {
 		memcpy(_palette, pal, size * 3);
 	}
 	_paletteSize = size;
+	_paletteVersion++;
 
 	_paletteLookup.setPalette(pal, size);
 
@@ -27,6 +27,7 @@
 #include "common/stack.h"
 #include "common/events.h"
 
+#include "graphics/dirty_region.h"
 #include "graphics/font.h"
 #include "graphics/fontman.h"
 #include "graphics/macgui/macwindow.h"
@@ -262,6 +263,13 @@ public:
 	 */
 	void draw();
 
+	/**
+	 * Accessor to the parts of the screen surface which were copied to the
+	 * screen by the last call to draw(), not counting the menu.
+	 * @return The updated rects, relative to the WM's screen.
+	 */
+	const Common::Array<Common::Rect> &getScreenDamage() const { return _screenDamageRects; }
+
 	/**
 	 * Method to process the events from the engine.
 	 * Most often this method will be called from the engine's GUI, and
@@ -332,6 +340,11 @@ public:
 
 	const byte *getPalette() { return _palette; }
 	uint getPaletteSize() { return _paletteSize; }
+	/**
+	 * Accessor to a counter of the palette changes, to tell whether the
+	 * colors matched with a previous palette are still valid.
+	 */
+	uint32 getPaletteVersion() const { return _paletteVersion; }
 
 	void renderZoomBox(bool redraw = false);
 	void addZoomBox(ZoomBox *box);
@@ -403,6 +416,7 @@ private:
 	bool haveZoomBox() { return !_zoomBoxes.empty(); }
 
 	void adjustDimensions(const Common::Rect &clip, const Common::Rect &dims, int &adjWidth, int &adjHeight);
+	bool isOccluded(Common::List<BaseMacWindow *>::const_iterator it, const Common::Rect &r) const;
 
 public:
 	TransparentSurface *_desktopBmp;
@@ -424,6 +438,8 @@ private:
 	int _activeWindow;
 
 	bool _fullRefresh;
+	DirtyRegion _screenDamage;
+	Common::Array<Common::Rect> _screenDamageRects;
 
 	bool _inEditableArea;
 
@@ -431,6 +447,7 @@ private:
 	MacPatterns _builtinPatterns;
 	byte *_palette;
 	uint _paletteSize;
+	uint32 _paletteVersion;
 
 	MacMenu *_menu;
 	uint32 _menuDelay;
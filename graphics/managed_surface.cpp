@@ -20,7 +20,9 @@
  */
 
 #include "graphics/managed_surface.h"
+#include "graphics/scaler/simd.h"
 #include "common/algorithm.h"
+#include "common/array.h"
 #include "common/textconsole.h"
 #include "common/endian.h"
 
@@ -691,6 +693,221 @@ void transBlit(const Surface &src, const Common::Rect &srcRect, ManagedSurface &
 	delete[] lookup;
 }
 
+#ifdef USE_SCALER_SIMD
+
+// Operations on 16 bytes of pixels of a given size
+template<typename T> struct KeyedVec;
+
+#if defined(SCALER_SIMD_SSE2)
+
+typedef __m128i KeyVec;
+
+static inline KeyVec keyLoad(const void *p) { return _mm_loadu_si128((const __m128i *)p); }
+static inline void keyStore(void *p, KeyVec v) { _mm_storeu_si128((__m128i *)p, v); }
+static inline KeyVec keyAnd(KeyVec a, KeyVec b) { return _mm_and_si128(a, b); }
+// Lanes of mask set to dst, others to src
+static inline KeyVec keySelect(KeyVec mask, KeyVec dst, KeyVec src) {
+	return _mm_or_si128(_mm_and_si128(mask, dst), _mm_andnot_si128(mask, src));
+}
+
+static inline KeyVec reverse16(KeyVec v) {
+	v = _mm_shufflelo_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+	v = _mm_shufflehi_epi16(v, _MM_SHUFFLE(0, 1, 2, 3));
+	return _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 3, 2));
+}
+
+template<> struct KeyedVec<uint8> {
+	static KeyVec splat(uint8 v) { return _mm_set1_epi8((char)v); }
+	static KeyVec equals(KeyVec a, KeyVec b) { return _mm_cmpeq_epi8(a, b); }
+	static KeyVec reverse(KeyVec v) {
+		v = reverse16(v);
+		return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+	}
+};
+
+template<> struct KeyedVec<uint16> {
+	static KeyVec splat(uint16 v) { return _mm_set1_epi16((short)v); }
+	static KeyVec equals(KeyVec a, KeyVec b) { return _mm_cmpeq_epi16(a, b); }
+	static KeyVec reverse(KeyVec v) { return reverse16(v); }
+};
+
+template<> struct KeyedVec<uint32> {
+	static KeyVec splat(uint32 v) { return _mm_set1_epi32((int)v); }
+	static KeyVec equals(KeyVec a, KeyVec b) { return _mm_cmpeq_epi32(a, b); }
+	static KeyVec reverse(KeyVec v) { return _mm_shuffle_epi32(v, _MM_SHUFFLE(0, 1, 2, 3)); }
+};
+
+#elif defined(SCALER_SIMD_NEON)
+
+typedef uint8x16_t KeyVec;
+
+static inline KeyVec keyLoad(const void *p) { return vld1q_u8((const uint8 *)p); }
+static inline void keyStore(void *p, KeyVec v) { vst1q_u8((uint8 *)p, v); }
+static inline KeyVec keyAnd(KeyVec a, KeyVec b) { return vandq_u8(a, b); }
+// Lanes of mask set to dst, others to src
+static inline KeyVec keySelect(KeyVec mask, KeyVec dst, KeyVec src) { return vbslq_u8(mask, dst, src); }
+
+template<> struct KeyedVec<uint8> {
+	static KeyVec splat(uint8 v) { return vdupq_n_u8(v); }
+	static KeyVec equals(KeyVec a, KeyVec b) { return vceqq_u8(a, b); }
+	static KeyVec reverse(KeyVec v) {
+		v = vrev64q_u8(v);
+		return vextq_u8(v, v, 8);
+	}
+};
+
+template<> struct KeyedVec<uint16> {
+	static KeyVec splat(uint16 v) { return vreinterpretq_u8_u16(vdupq_n_u16(v)); }
+	static KeyVec equals(KeyVec a, KeyVec b) {
+		return vreinterpretq_u8_u16(vceqq_u16(vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b)));
+	}
+	static KeyVec reverse(KeyVec v) {
+		uint16x8_t r = vrev64q_u16(vreinterpretq_u16_u8(v));
+		return vreinterpretq_u8_u16(vextq_u16(r, r, 4));
+	}
+};
+
+template<> struct KeyedVec<uint32> {
+	static KeyVec splat(uint32 v) { return vreinterpretq_u8_u32(vdupq_n_u32(v)); }
+	static KeyVec equals(KeyVec a, KeyVec b) {
+		return vreinterpretq_u8_u32(vceqq_u32(vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b)));
+	}
+	static KeyVec reverse(KeyVec v) {
+		uint32x4_t r = vrev64q_u32(vreinterpretq_u32_u8(v));
+		return vreinterpretq_u8_u32(vextq_u32(r, r, 2));
+	}
+};
+
+#endif
+
+#endif // USE_SCALER_SIMD
+
+/**
+ * Copy a row of pixels, except the ones equal to the key. The stored pixels
+ * are masked with pixelMask. When reversed, src points to the last pixel
+ * and the row is read backwards.
+ */
+template<typename T>
+static void copyKeyedRow(T *dst, const T *src, int width, T key, T pixelMask, bool reversed) {
+	int x = 0;
+
+#ifdef USE_SCALER_SIMD
+	const int lanes = 16 / sizeof(T);
+	const KeyVec keyVec = KeyedVec<T>::splat(key);
+	const KeyVec maskVec = KeyedVec<T>::splat(pixelMask);
+
+	for (; x + lanes <= width; x += lanes) {
+		KeyVec s;
+		if (reversed)
+			s = KeyedVec<T>::reverse(keyLoad(src - x - (lanes - 1)));
+		else
+			s = keyLoad(src + x);
+
+		const KeyVec isKey = KeyedVec<T>::equals(s, keyVec);
+		keyStore(dst + x, keySelect(isKey, keyLoad(dst + x), keyAnd(s, maskVec)));
+	}
+#endif
+
+	for (; x < width; ++x) {
+		const T srcVal = reversed ? src[-x] : src[x];
+		if (srcVal != key)
+			dst[x] = srcVal & pixelMask;
+	}
+}
+
+/**
+ * Copy a row of pixels picked through a table of offsets, except the ones
+ * equal to the key
+ */
+template<typename T>
+static void copyKeyedRowScaled(T *dst, const T *src, const int *offsets, int width, T key, T pixelMask) {
+	for (int x = 0; x < width; ++x) {
+		const T srcVal = src[offsets[x]];
+		if (srcVal != key)
+			dst[x] = srcVal & pixelMask;
+	}
+}
+
+/**
+ * Color keyed blit between surfaces of the same opaque format, which
+ * does not need the pixels to be decoded. Every pixel not equal to the key
+ * is copied as is, like transBlit() does for these surfaces.
+ */
+template<typename T>
+static void transBlitKeyed(const Surface &src, const Common::Rect &srcRect, ManagedSurface &dest,
+		const Common::Rect &destRect, T transColor, bool flipped) {
+	const int scaleX = SCALE_THRESHOLD * srcRect.width() / destRect.width();
+	const int scaleY = SCALE_THRESHOLD * srcRect.height() / destRect.height();
+
+	// Pixels outside of the color components are dropped by transBlit()
+	const T pixelMask = src.format.isCLUT8() ? (T)0xFF : (T)(src.format.ARGBToColor(0, 0xFF, 0xFF, 0xFF));
+
+	const int left = MAX<int>(destRect.left, 0);
+	const int right = MIN<int>(destRect.right, dest.w);
+	if (left >= right)
+		return;
+	const int width = right - left;
+	const int xStart = left - destRect.left;
+
+	// The offsets of the source pixels from the left of the source rect,
+	// as transBlit() computes them
+	Common::Array<int> offsets;
+	const bool scaled = scaleX != SCALE_THRESHOLD;
+	if (scaled) {
+		offsets.resize(width);
+		for (int x = 0; x < width; ++x) {
+			const int srcX = (xStart + x) * scaleX / SCALE_THRESHOLD;
+			offsets[x] = flipped ? src.w - srcX - 1 : srcX;
+		}
+	}
+
+	for (int destY = MAX<int>(destRect.top, 0); destY < MIN<int>(destRect.bottom, dest.h); ++destY) {
+		const int scaleYCtr = (destY - destRect.top) * scaleY;
+		const T *srcLine = (const T *)src.getBasePtr(srcRect.left, scaleYCtr / SCALE_THRESHOLD + srcRect.top);
+		T *destLine = (T *)dest.getBasePtr(left, destY);
+
+		if (scaled)
+			copyKeyedRowScaled<T>(destLine, srcLine, &offsets[0], width, transColor, pixelMask);
+		else if (flipped)
+			copyKeyedRow<T>(destLine, srcLine + src.w - xStart - 1, width, transColor, pixelMask, true);
+		else
+			copyKeyedRow<T>(destLine, srcLine + xStart, width, transColor, pixelMask, false);
+	}
+}
+
+/**
+ * Dispatch the blits which can be done by transBlitKeyed()
+ * @return false if the generic transBlit() is needed
+ */
+static bool transBlitKeyedFormat(const Surface &src, const Common::Rect &srcRect, ManagedSurface &dest,
+		const Common::Rect &destRect, uint32 transColor, bool flipped, uint32 overrideColor, uint32 srcAlpha,
+		const byte *srcPalette, const byte *dstPalette, const Surface *mask, bool maskOnly) {
+	// Sources with an alpha channel, or with extra transparency, need blending
+	if (src.format != dest.format || src.format.aBits() != 0 || mask || maskOnly)
+		return false;
+
+	switch (src.format.bytesPerPixel) {
+	case 1:
+		// Palettes are matched, and the color overridden, per pixel
+		if (overrideColor || srcAlpha == 0 || (srcPalette && dstPalette))
+			return false;
+		transBlitKeyed<uint8>(src, srcRect, dest, destRect, transColor, flipped);
+		return true;
+	case 2:
+		if (srcAlpha != 0xff)
+			return false;
+		transBlitKeyed<uint16>(src, srcRect, dest, destRect, transColor, flipped);
+		return true;
+	case 4:
+		if (srcAlpha != 0xff)
+			return false;
+		transBlitKeyed<uint32>(src, srcRect, dest, destRect, transColor, flipped);
+		return true;
+	default:
+		return false;
+	}
+}
+
 #define HANDLE_BLIT(SRC_BYTES, DEST_BYTES, SRC_TYPE, DEST_TYPE) \
 	if (src.format.bytesPerPixel == SRC_BYTES && format.bytesPerPixel == DEST_BYTES) \
 		transBlit<SRC_TYPE, DEST_TYPE>(src, srcRect, *this, destRect, transColor, flipped, overrideColor, srcAlpha, srcPalette, dstPalette, mask, maskOnly); \
@@ -707,16 +924,19 @@ void ManagedSurface::transBlitFromInner(const Surface &src, const Common::Rect &
 			error("Surface::transBlitFrom: mask dimensions do not match src");
 	}
 
-	HANDLE_BLIT(1, 1, uint8,  uint8)
-	HANDLE_BLIT(1, 2, uint8,  uint16)
-	HANDLE_BLIT(1, 4, uint8,  uint32)
-	HANDLE_BLIT(2, 1, uint16, uint8)
-	HANDLE_BLIT(2, 2, uint16, uint16)
-	HANDLE_BLIT(2, 4, uint16, uint32)
-	HANDLE_BLIT(4, 1, uint32, uint8)
-	HANDLE_BLIT(4, 2, uint32, uint16)
-	HANDLE_BLIT(4, 4, uint32, uint32)
-	error("Surface::transBlitFrom: bytesPerPixel must be 1, 2, or 4");
+	if (!transBlitKeyedFormat(src, srcRect, *this, destRect, transColor, flipped, overrideColor, srcAlpha,
+			srcPalette, dstPalette, mask, maskOnly)) {
+		HANDLE_BLIT(1, 1, uint8,  uint8)
+		HANDLE_BLIT(1, 2, uint8,  uint16)
+		HANDLE_BLIT(1, 4, uint8,  uint32)
+		HANDLE_BLIT(2, 1, uint16, uint8)
+		HANDLE_BLIT(2, 2, uint16, uint16)
+		HANDLE_BLIT(2, 4, uint16, uint32)
+		HANDLE_BLIT(4, 1, uint32, uint8)
+		HANDLE_BLIT(4, 2, uint32, uint16)
+		HANDLE_BLIT(4, 4, uint32, uint32)
+		error("Surface::transBlitFrom: bytesPerPixel must be 1, 2, or 4");
+	}
 
 	// Mark the affected area
 	addDirtyRect(destRect);
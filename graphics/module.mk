@@ -5,6 +5,7 @@ MODULE_OBJS := \
 	blit.o \
 	blit-scale.o \
 	cursorman.o \
+	dirty_region.o \
 	font.o \
 	fontman.o \
 	fonts/amigafont.o \
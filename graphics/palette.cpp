@@ -18,7 +18,9 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "common/endian.h"
 #include "graphics/palette.h"
+#include "graphics/surface.h"
 
 namespace Graphics {
 
@@ -39,59 +41,188 @@ bool PaletteLookup::setPalette(const byte *palette, uint len)  {
 
 	_paletteSize = len;
 	memcpy(_palette, palette, len * 3);
-	_colorHash.clear();
+	_cells[0].clear();
+	_cells[1].clear();
 
 	return true;
 }
 
+void PaletteLookup::CellTable::clear() {
+	cellStart.clear();
+	cellCount.clear();
+	candidates.clear();
+}
+
+uint PaletteLookup::distance(uint index, byte cr, byte cg, byte cb, bool useNaiveAlg) const {
+	const byte *palettePtr = &_palette[index * 3];
+
+	if (useNaiveAlg) {
+		int redSquareDiff = (cr - palettePtr[0]) * (cr - palettePtr[0]);
+		int greenSquareDiff = (cg - palettePtr[1]) * (cg - palettePtr[1]);
+		int blueSquareDiff = (cb - palettePtr[2]) * (cb - palettePtr[2]);
+
+		return 3 * redSquareDiff + 5 * greenSquareDiff + 2 * blueSquareDiff;
+	}
+
+	// The square of the distance, which sorts the colors in the same order
+	int rmean = (palettePtr[0] + cr) / 2;
+	int r = palettePtr[0] - cr;
+	int g = palettePtr[1] - cg;
+	int b = palettePtr[2] - cb;
+
+	return (((512 + rmean) * r * r) >> 8) + 4 * g * g + (((767 - rmean) * b * b) >> 8);
+}
+
+/**
+ * Smallest and largest squares of the difference between a value and the
+ * values of a cell
+ */
+static inline void cellSquareDiffs(int value, int cell, int cellShift, int &minSq, int &maxSq) {
+	const int lo = cell << cellShift;
+	const int hi = lo + (1 << cellShift) - 1;
+	const int dLo = value - lo;
+	const int dHi = value - hi;
+
+	minSq = (value >= lo && value <= hi) ? 0 : MIN(dLo * dLo, dHi * dHi);
+	maxSq = MAX(dLo * dLo, dHi * dHi);
+}
+
+void PaletteLookup::buildCell(CellTable &table, int cell, bool useNaiveAlg) {
+	const int cellR = cell / (kCellsPerComponent * kCellsPerComponent);
+	const int cellG = (cell / kCellsPerComponent) % kCellsPerComponent;
+	const int cellB = cell % kCellsPerComponent;
+
+	// Bounds of the distances between each entry and the colors of the
+	// cell. An entry may only be the closest to one of the colors if its
+	// smallest distance is not above the largest distance of another entry.
+	uint minDist[256];
+	uint minOfMax = 0xFFFFFFFF;
+
+	for (uint i = 0; i < _paletteSize; ++i) {
+		const byte *palettePtr = &_palette[i * 3];
+		int minR, maxR, minG, maxG, minB, maxB;
+		cellSquareDiffs(palettePtr[0], cellR, kCellShift, minR, maxR);
+		cellSquareDiffs(palettePtr[1], cellG, kCellShift, minG, maxG);
+		cellSquareDiffs(palettePtr[2], cellB, kCellShift, minB, maxB);
+
+		uint maxDist;
+		if (useNaiveAlg) {
+			minDist[i] = 3 * minR + 5 * minG + 2 * minB;
+			maxDist = 3 * maxR + 5 * maxG + 2 * maxB;
+		} else {
+			const int rmeanMin = (palettePtr[0] + (cellR << kCellShift)) / 2;
+			const int rmeanMax = (palettePtr[0] + (cellR << kCellShift) + (1 << kCellShift) - 1) / 2;
+			minDist[i] = (((512 + rmeanMin) * minR) >> 8) + 4 * minG + (((767 - rmeanMax) * minB) >> 8);
+			maxDist = (((512 + rmeanMax) * maxR) >> 8) + 4 * maxG + (((767 - rmeanMin) * maxB) >> 8);
+		}
+
+		minOfMax = MIN(minOfMax, maxDist);
+	}
+
+	table.cellStart[cell] = table.candidates.size();
+	for (uint i = 0; i < _paletteSize; ++i) {
+		if (minDist[i] <= minOfMax)
+			table.candidates.push_back(i);
+	}
+	table.cellCount[cell] = table.candidates.size() - table.cellStart[cell];
+}
+
 byte PaletteLookup::findBestColor(byte cr, byte cg, byte cb, bool useNaiveAlg) {
 	if (_paletteSize == 0) {
 		warning("PaletteLookup::findBestColor(): Palette was not set");
 		return 0;
 	}
 
-	uint bestColor = 0;
-	double min = 0xFFFFFFFF;
-
-	uint32 color = cr << 16 | cg << 8 | cb;
-
-	if (_colorHash.contains(color))
-		return _colorHash[color];
+	CellTable &table = _cells[useNaiveAlg ? 1 : 0];
+	if (table.cellStart.empty()) {
+		table.cellStart.resize(kCellsPerComponent * kCellsPerComponent * kCellsPerComponent, kCellNotBuilt);
+		table.cellCount.resize(kCellsPerComponent * kCellsPerComponent * kCellsPerComponent);
+	}
 
-	if (useNaiveAlg) {
-		byte *palettePtr = _palette;
+	const int cell = ((cr >> kCellShift) * kCellsPerComponent + (cg >> kCellShift)) * kCellsPerComponent + (cb >> kCellShift);
+	if (table.cellStart[cell] == kCellNotBuilt)
+		buildCell(table, cell, useNaiveAlg);
+
+	const byte *candidates = &table.candidates[table.cellStart[cell]];
+	const uint count = table.cellCount[cell];
+	if (count == 1)
+		return candidates[0];
+
+	// As with a search of the whole palette, the first of the closest
+	// entries is returned
+	byte bestColor = candidates[0];
+	uint min = distance(bestColor, cr, cg, cb, useNaiveAlg);
+	for (uint i = 1; i < count; ++i) {
+		const uint dist = distance(candidates[i], cr, cg, cb, useNaiveAlg);
+		if (dist < min) {
+			bestColor = candidates[i];
+			min = dist;
+		}
+	}
 
-		for (uint i = 0; i < _paletteSize; i++) {
-			int redSquareDiff = (cr - palettePtr[0]) * (cr - palettePtr[0]);
-			int greenSquareDiff = (cg - palettePtr[1]) * (cg - palettePtr[1]);
-			int blueSquareDiff = (cb - palettePtr[2]) * (cb - palettePtr[2]);
+	return bestColor;
+}
 
-			int weightedColorError = 3 * redSquareDiff + 5 * greenSquareDiff + 2 * blueSquareDiff;
-			if (weightedColorError < min) {
-				bestColor = i;
-				min = weightedColorError;
+template<int BytesPerPixel>
+void PaletteLookup::mapRows(byte *dst, int dstPitch, const byte *src, int srcPitch, int w, int h, const PixelFormat &srcFormat, bool useNaiveAlg) {
+	// Neighbouring pixels often have the same color
+	uint32 lastColor = 0;
+	byte lastIndex = 0;
+	bool hasLast = false;
+
+	for (int y = 0; y < h; ++y) {
+		const byte *srcRow = src + y * srcPitch;
+		byte *dstRow = dst + y * dstPitch;
+
+		for (int x = 0; x < w; ++x) {
+			uint32 color;
+			if (BytesPerPixel == 2)
+				color = *(const uint16 *)srcRow;
+			else if (BytesPerPixel == 3)
+				color = READ_UINT24(srcRow);
+			else
+				color = *(const uint32 *)srcRow;
+			srcRow += BytesPerPixel;
+
+			if (!hasLast || color != lastColor) {
+				byte r, g, b;
+				srcFormat.colorToRGB(color, r, g, b);
+				lastIndex = findBestColor(r, g, b, useNaiveAlg);
+				lastColor = color;
+				hasLast = true;
 			}
 
-			palettePtr += 3;
-		}
-	} else {
-		for (uint i = 0; i < _paletteSize; ++i) {
-			int rmean = (*(_palette + 3 * i + 0) + cr) / 2;
-			int r = *(_palette + 3 * i + 0) - cr;
-			int g = *(_palette + 3 * i + 1) - cg;
-			int b = *(_palette + 3 * i + 2) - cb;
-
-			double dist = sqrt((((512 + rmean) * r * r) >> 8) + 4 * g * g + (((767 - rmean) * b * b) >> 8));
-			if (min > dist) {
-				bestColor = i;
-				min = dist;
-			}
+			*dstRow++ = lastIndex;
 		}
 	}
+}
 
-	_colorHash[color] = bestColor;
+void PaletteLookup::mapPixels(byte *dst, int dstPitch, const byte *src, int srcPitch, int w, int h, const PixelFormat &srcFormat, bool useNaiveAlg) {
+	if (_paletteSize == 0) {
+		warning("PaletteLookup::mapPixels(): Palette was not set");
+		return;
+	}
 
-	return bestColor;
+	switch (srcFormat.bytesPerPixel) {
+	case 2:
+		mapRows<2>(dst, dstPitch, src, srcPitch, w, h, srcFormat, useNaiveAlg);
+		break;
+	case 3:
+		mapRows<3>(dst, dstPitch, src, srcPitch, w, h, srcFormat, useNaiveAlg);
+		break;
+	case 4:
+		mapRows<4>(dst, dstPitch, src, srcPitch, w, h, srcFormat, useNaiveAlg);
+		break;
+	default:
+		error("PaletteLookup::mapPixels(): Unsupported source format with %d bytes per pixel", srcFormat.bytesPerPixel);
+	}
+}
+
+void PaletteLookup::mapPixels(const Surface &src, Surface &dst, bool useNaiveAlg) {
+	assert(dst.format.bytesPerPixel == 1);
+	assert(dst.w >= src.w && dst.h >= src.h);
+
+	mapPixels((byte *)dst.getPixels(), dst.pitch, (const byte *)src.getPixels(), src.pitch, src.w, src.h, src.format, useNaiveAlg);
 }
 
 } // end of namespace Graphics
@@ -23,6 +23,7 @@
 #define GRAPHICS_PALETTE_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
 #include "common/hashmap.h"
 #include "common/noncopyable.h"
 
@@ -111,6 +112,18 @@ public:
 
 namespace Graphics {
 
+struct PixelFormat;
+struct Surface;
+
+/**
+ * Finds the closest palette entries to RGB colors.
+ *
+ * The RGB cube is divided into cells, and for each cell the lookup keeps the
+ * palette entries which may be the closest to one of its colors. These
+ * candidates are found the first time a color of the cell is looked up,
+ * so only a few entries are compared for each color, and the result is
+ * the same as a search of the whole palette.
+ */
 class PaletteLookup {
 public:
 	PaletteLookup();
@@ -143,10 +156,58 @@ public:
 	 */
 	byte findBestColor(byte r, byte g, byte b, bool useNaiveAlg = false);
 
+	/**
+	 * @brief Convert true color pixels to the closest palette entries
+	 *
+	 * @param dst          the destination, with one byte per pixel
+	 * @param dstPitch     the pitch of the destination
+	 * @param src          the source pixels
+	 * @param srcPitch     the pitch of the source
+	 * @param w            the width of the area to convert
+	 * @param h            the height of the area to convert
+	 * @param srcFormat    the format of the source pixels, from 2 to 4 bytes per pixel
+	 * @param useNaiveAlg  see findBestColor()
+	 */
+	void mapPixels(byte *dst, int dstPitch, const byte *src, int srcPitch, int w, int h, const PixelFormat &srcFormat, bool useNaiveAlg = false);
+
+	/**
+	 * @brief Convert a true color surface to the closest palette entries
+	 *
+	 * @param src          the source surface
+	 * @param dst          the destination surface, in CLUT8 and at least as large as the source
+	 * @param useNaiveAlg  see findBestColor()
+	 */
+	void mapPixels(const Surface &src, Surface &dst, bool useNaiveAlg = false);
+
 private:
+	/** Cells per component, each covering 8 values */
+	static const int kCellShift = 3;
+	static const int kCellsPerComponent = 256 >> kCellShift;
+
+	/**
+	 * Candidates of the cells for one of the distance algorithms. The
+	 * candidates of a cell are the cellCount[cell] entries of candidates
+	 * starting at cellStart[cell].
+	 */
+	struct CellTable {
+		Common::Array<uint32> cellStart;
+		Common::Array<uint16> cellCount;
+		Common::Array<byte> candidates;
+
+		void clear();
+	};
+
+	static const uint32 kCellNotBuilt = 0xFFFFFFFF;
+
+	void buildCell(CellTable &table, int cell, bool useNaiveAlg);
+	uint distance(uint index, byte r, byte g, byte b, bool useNaiveAlg) const;
+
+	template<int BytesPerPixel>
+	void mapRows(byte *dst, int dstPitch, const byte *src, int srcPitch, int w, int h, const PixelFormat &srcFormat, bool useNaiveAlg);
+
 	byte _palette[256 * 3];
 	uint _paletteSize;
-	Common::HashMap<int, byte> _colorHash;
+	CellTable _cells[2];
 };
 
 } //  // end of namespace Graphics
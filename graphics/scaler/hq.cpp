@@ -21,6 +21,7 @@
 #include "graphics/scaler/hq.h"
 #include "graphics/scaler.h"
 #include "graphics/scaler/intern.h"
+#include "graphics/scaler/simd.h"
 
 // RGB-to-YUV lookup table
 
@@ -193,16 +194,121 @@ static inline uint32 ConvertYUV(uint32 x, const uint32 *RGBtoYUV) {
 	return RGBtoYUV[r | g | b];
 }
 
+#ifdef USE_SCALER_SIMD
+/**
+ * Number of pixels whose patterns are computed at once by the vectorized
+ * code, which keeps its buffers on the stack.
+ */
+enum { kHQPatternChunk = 64 };
+
+/**
+ * Compute the HQ patterns of 4 pixels at a time, from the YUV values of the
+ * previous, current and next rows. Each row starts with the pixel left of the
+ * first one. The pattern bits are the same as those computed with diffYUV().
+ * @return The number of patterns computed.
+ */
+static int computeHQPatternsSimd(const uint32 *yuvPrev, const uint32 *yuvCur, const uint32 *yuvNext, int count, uint8 *patterns) {
+	// Largest differences of V, U and Y still considered equal, see diffYUV()
+	const uint32 threshold = 0x00300706;
+	const uint32 *neighbours[8] = {
+		yuvPrev, yuvPrev + 1, yuvPrev + 2,
+		yuvCur, yuvCur + 2,
+		yuvNext, yuvNext + 1, yuvNext + 2
+	};
+	int i = 0;
+
+#if defined(SCALER_SIMD_SSE2)
+	const __m128i thr = _mm_set1_epi32(threshold);
+	const __m128i zero = _mm_setzero_si128();
+
+	for (; i + 4 <= count; i += 4) {
+		const __m128i center = _mm_loadu_si128((const __m128i *)(yuvCur + i + 1));
+		__m128i pattern = zero;
+
+		for (int n = 0; n < 8; ++n) {
+			const __m128i other = _mm_loadu_si128((const __m128i *)(neighbours[n] + i));
+			const __m128i diff = _mm_or_si128(_mm_subs_epu8(center, other), _mm_subs_epu8(other, center));
+			const __m128i same = _mm_cmpeq_epi32(_mm_subs_epu8(diff, thr), zero);
+			pattern = _mm_or_si128(pattern, _mm_andnot_si128(same, _mm_set1_epi32(1 << n)));
+		}
+
+		pattern = _mm_packs_epi32(pattern, pattern);
+		pattern = _mm_packus_epi16(pattern, pattern);
+		const uint32 packed = _mm_cvtsi128_si32(pattern);
+		memcpy(patterns + i, &packed, 4);
+	}
+#elif defined(SCALER_SIMD_NEON)
+	const uint8x16_t thr = vreinterpretq_u8_u32(vdupq_n_u32(threshold));
+
+	for (; i + 4 <= count; i += 4) {
+		const uint8x16_t center = vreinterpretq_u8_u32(vld1q_u32(yuvCur + i + 1));
+		uint32x4_t pattern = vdupq_n_u32(0);
+
+		for (int n = 0; n < 8; ++n) {
+			const uint8x16_t other = vreinterpretq_u8_u32(vld1q_u32(neighbours[n] + i));
+			const uint32x4_t over = vreinterpretq_u32_u8(vcgtq_u8(vabdq_u8(center, other), thr));
+			pattern = vorrq_u32(pattern, vandq_u32(vtstq_u32(over, over), vdupq_n_u32(1 << n)));
+		}
+
+		const uint16x4_t narrow = vmovn_u32(pattern);
+		uint8 packed[8];
+		vst1_u8(packed, vmovn_u16(vcombine_u16(narrow, narrow)));
+		memcpy(patterns + i, packed, 4);
+	}
+#endif
+
+	return i;
+}
+
+/**
+ * Compute the HQ patterns of a run of pixels of a row.
+ * @param p        Pointer to the first pixel.
+ * @param count    The number of pixels, at most kHQPatternChunk.
+ * @param patterns Receives the patterns, one per pixel.
+ */
+template<typename ColorMask>
+static void computeHQPatterns(const typename ColorMask::PixelType *p, uint32 nextlineSrc, int count, uint8 *patterns, const uint32 *RGBtoYUV) {
+	typedef typename ColorMask::PixelType Pixel;
+
+	uint32 yuv[3][kHQPatternChunk + 2];
+
+	for (int row = 0; row < 3; ++row) {
+		const Pixel *src = p - 1 + (row - 1) * (int)nextlineSrc;
+		for (int i = 0; i < count + 2; ++i)
+			yuv[row][i] = sizeof(Pixel) == 2 ? RGBtoYUV[src[i]] : ConvertYUV<ColorMask>(src[i], RGBtoYUV);
+	}
+
+	int i = computeHQPatternsSimd(yuv[0], yuv[1], yuv[2], count, patterns);
+
+	for (; i < count; ++i) {
+		const int yuv5 = yuv[1][i + 1];
+		int pattern = 0;
+		if (diffYUV(yuv5, yuv[0][i])) pattern |= 0x0001;
+		if (diffYUV(yuv5, yuv[0][i + 1])) pattern |= 0x0002;
+		if (diffYUV(yuv5, yuv[0][i + 2])) pattern |= 0x0004;
+		if (diffYUV(yuv5, yuv[1][i])) pattern |= 0x0008;
+		if (diffYUV(yuv5, yuv[1][i + 2])) pattern |= 0x0010;
+		if (diffYUV(yuv5, yuv[2][i])) pattern |= 0x0020;
+		if (diffYUV(yuv5, yuv[2][i + 1])) pattern |= 0x0040;
+		if (diffYUV(yuv5, yuv[2][i + 2])) pattern |= 0x0080;
+		patterns[i] = pattern;
+	}
+}
+#endif
+
 /*
  * The HQ2x high quality 2x graphics filter.
  * Original author Maxim Stepin (https://web.archive.org/web/20090204033742/http://www.hiend3d.com/hq2x.html).
  * Adapted for ScummVM to 16 bit output and optimized by Max Horn.
  */
 template<typename ColorMask>
-static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height, const uint32 *RGBtoYUV) {
+static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height, const uint32 *RGBtoYUV, bool simd) {
 	typedef typename ColorMask::PixelType Pixel;
 
 	int w1, w2, w3, w4, w5, w6, w7, w8, w9;
+#ifdef USE_SCALER_SIMD
+	uint8 patterns[kHQPatternChunk];
+#endif
 
 	const uint32 nextlineSrc = srcPitch / sizeof(Pixel);
 	const Pixel *p = (const Pixel *)srcPtr;
@@ -239,15 +345,25 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			w9 = *(p + nextlineSrc);
 
 			int pattern = 0;
-			const int yuv5 = YUV(5);
-			if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
-			if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
-			if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
-			if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
-			if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
-			if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
-			if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
-			if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+#ifdef USE_SCALER_SIMD
+			if (simd) {
+				const int x = width - tmpWidth - 1;
+				if (x % kHQPatternChunk == 0)
+					computeHQPatterns<ColorMask>(p - 1, nextlineSrc, MIN<int>(kHQPatternChunk, width - x), patterns, RGBtoYUV);
+				pattern = patterns[x % kHQPatternChunk];
+			} else
+#endif
+			{
+				const int yuv5 = YUV(5);
+				if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
+				if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
+				if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
+				if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
+				if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
+				if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
+				if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
+				if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			}
 
 			switch (pattern) {
 			case 0:
@@ -2116,10 +2232,13 @@ static void HQ2x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
  * Adapted for ScummVM to 16 bit output and optimized by Max Horn.
  */
 template<typename ColorMask>
-static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height, const uint32 *RGBtoYUV) {
+static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height, const uint32 *RGBtoYUV, bool simd) {
 	typedef typename ColorMask::PixelType Pixel;
 
 	int  w1, w2, w3, w4, w5, w6, w7, w8, w9;
+#ifdef USE_SCALER_SIMD
+	uint8 patterns[kHQPatternChunk];
+#endif
 
 	const uint32 nextlineSrc = srcPitch / sizeof(Pixel);
 	const Pixel *p = (const Pixel *)srcPtr;
@@ -2157,15 +2276,25 @@ static void HQ3x_implementation(const uint8 *srcPtr, uint32 srcPitch, uint8 *dst
 			w9 = *(p + nextlineSrc);
 
 			int pattern = 0;
-			const int yuv5 = YUV(5);
-			if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
-			if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
-			if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
-			if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
-			if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
-			if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
-			if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
-			if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+#ifdef USE_SCALER_SIMD
+			if (simd) {
+				const int x = width - tmpWidth - 1;
+				if (x % kHQPatternChunk == 0)
+					computeHQPatterns<ColorMask>(p - 1, nextlineSrc, MIN<int>(kHQPatternChunk, width - x), patterns, RGBtoYUV);
+				pattern = patterns[x % kHQPatternChunk];
+			} else
+#endif
+			{
+				const int yuv5 = YUV(5);
+				if (w5 != w1 && diffYUV(yuv5, YUV(1))) pattern |= 0x0001;
+				if (w5 != w2 && diffYUV(yuv5, YUV(2))) pattern |= 0x0002;
+				if (w5 != w3 && diffYUV(yuv5, YUV(3))) pattern |= 0x0004;
+				if (w5 != w4 && diffYUV(yuv5, YUV(4))) pattern |= 0x0008;
+				if (w5 != w6 && diffYUV(yuv5, YUV(6))) pattern |= 0x0010;
+				if (w5 != w7 && diffYUV(yuv5, YUV(7))) pattern |= 0x0020;
+				if (w5 != w8 && diffYUV(yuv5, YUV(8))) pattern |= 0x0040;
+				if (w5 != w9 && diffYUV(yuv5, YUV(9))) pattern |= 0x0080;
+			}
 
 			switch (pattern) {
 			case 0:
@@ -4987,19 +5116,19 @@ void HQScaler::HQ3x16(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint3
 void HQScaler::HQ2x16(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
 	if (_format.gLoss == 2)
 		HQ2x_implementation<Graphics::ColorMasks<565> >(srcPtr, srcPitch, dstPtr,
-				dstPitch, width, height, _RGBtoYUV);
+				dstPitch, width, height, _RGBtoYUV, _useSimd);
 	else
 		HQ2x_implementation<Graphics::ColorMasks<555> >(srcPtr, srcPitch, dstPtr,
-				dstPitch, width, height, _RGBtoYUV);
+				dstPitch, width, height, _RGBtoYUV, _useSimd);
 }
 
 void HQScaler::HQ3x16(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch, int width, int height) {
 	if (_format.gLoss == 2)
 		HQ3x_implementation<Graphics::ColorMasks<565> >(srcPtr, srcPitch, dstPtr,
-				dstPitch, width, height, _RGBtoYUV);
+				dstPitch, width, height, _RGBtoYUV, _useSimd);
 	else
 		HQ3x_implementation<Graphics::ColorMasks<555> >(srcPtr, srcPitch, dstPtr,
-				dstPitch, width, height, _RGBtoYUV);
+				dstPitch, width, height, _RGBtoYUV, _useSimd);
 }
 #endif
 
@@ -5007,15 +5136,15 @@ void HQScaler::HQ2x32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint3
 	if (_format.aLoss == 0) {
 		if (_format.aShift == 0) {
 			HQ2x_implementation<Graphics::ColorMasks<-8888> >(srcPtr, srcPitch, dstPtr,
-					dstPitch, width, height, _RGBtoYUV);
+					dstPitch, width, height, _RGBtoYUV, _useSimd);
 		} else {
 			HQ2x_implementation<Graphics::ColorMasks<8888> >(srcPtr, srcPitch, dstPtr,
-					dstPitch, width, height, _RGBtoYUV);
+					dstPitch, width, height, _RGBtoYUV, _useSimd);
 		}
 	} else {
 		assert((_format.rMax() | _format.gMax() | _format.bMax()) <= 0xffffff);
 		HQ2x_implementation<Graphics::ColorMasks<888> >(srcPtr, srcPitch, dstPtr,
-				dstPitch, width, height, _RGBtoYUV);
+				dstPitch, width, height, _RGBtoYUV, _useSimd);
 	}
 }
 
@@ -5023,15 +5152,15 @@ void HQScaler::HQ3x32(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint3
 	if (_format.aLoss == 0) {
 		if (_format.aShift == 0) {
 			HQ3x_implementation<Graphics::ColorMasks<-8888> >(srcPtr, srcPitch, dstPtr,
-					dstPitch, width, height, _RGBtoYUV);
+					dstPitch, width, height, _RGBtoYUV, _useSimd);
 		} else {
 			HQ3x_implementation<Graphics::ColorMasks<8888> >(srcPtr, srcPitch, dstPtr,
-					dstPitch, width, height, _RGBtoYUV);
+					dstPitch, width, height, _RGBtoYUV, _useSimd);
 		}
 	} else {
 		assert((_format.rMax() | _format.gMax() | _format.bMax()) <= 0xffffff);
 		HQ3x_implementation<Graphics::ColorMasks<888> >(srcPtr, srcPitch, dstPtr,
-				dstPitch, width, height, _RGBtoYUV);
+				dstPitch, width, height, _RGBtoYUV, _useSimd);
 	}
 }
 
@@ -5079,6 +5208,8 @@ public:
 
 	bool canDrawCursor() const override { return false; }
 	uint extraPixels() const override { return 1; }
+	bool isReentrant() const override { return true; }
+	bool hasSimd() const override { return true; }
 	const char *getName() const override;
 	const char *getPrettyName() const override;
 };
@@ -19,6 +19,7 @@
  */
 
 #include "graphics/scaler/normal.h"
+#include "graphics/scaler/simd.h"
 
 #ifdef USE_SCALERS
 
@@ -203,6 +204,156 @@ void Normal5x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPit
 		dstPtr += dstPitch5;
 	}
 }
+
+#ifdef USE_SCALER_SIMD
+#if defined(SCALER_SIMD_SSE2)
+
+static inline void normal2xVector(const uint16 *src, uint16 *dst0, uint16 *dst1) {
+	const __m128i v = _mm_loadu_si128((const __m128i *)src);
+	const __m128i lo = _mm_unpacklo_epi16(v, v);
+	const __m128i hi = _mm_unpackhi_epi16(v, v);
+
+	_mm_storeu_si128((__m128i *)dst0, lo);
+	_mm_storeu_si128((__m128i *)(dst0 + 8), hi);
+	_mm_storeu_si128((__m128i *)dst1, lo);
+	_mm_storeu_si128((__m128i *)(dst1 + 8), hi);
+}
+
+static inline void normal2xVector(const uint32 *src, uint32 *dst0, uint32 *dst1) {
+	const __m128i v = _mm_loadu_si128((const __m128i *)src);
+	const __m128i lo = _mm_unpacklo_epi32(v, v);
+	const __m128i hi = _mm_unpackhi_epi32(v, v);
+
+	_mm_storeu_si128((__m128i *)dst0, lo);
+	_mm_storeu_si128((__m128i *)(dst0 + 4), hi);
+	_mm_storeu_si128((__m128i *)dst1, lo);
+	_mm_storeu_si128((__m128i *)(dst1 + 4), hi);
+}
+
+static inline void normal3xVector(const uint16 *src, uint16 *dst0, uint16 *dst1, uint16 *dst2) {
+	const __m128i v = _mm_loadu_si128((const __m128i *)src);
+	// p0 p0 p0 p1 p1 p1 p2 p2 | p2 p3 p3 p3 p4 p4 p4 p5 | p5 p5 p6 p6 p6 p7 p7 p7
+	const __m128i out0 = _mm_unpacklo_epi64(_mm_shufflelo_epi16(v, _MM_SHUFFLE(1, 0, 0, 0)),
+	                                        _mm_shufflelo_epi16(v, _MM_SHUFFLE(2, 2, 1, 1)));
+	const __m128i high = _mm_shufflehi_epi16(v, _MM_SHUFFLE(1, 0, 0, 0));
+	const __m128i out1 = _mm_unpacklo_epi64(_mm_shufflelo_epi16(v, _MM_SHUFFLE(3, 3, 3, 2)),
+	                                        _mm_unpackhi_epi64(high, high));
+	const __m128i out2 = _mm_unpackhi_epi64(_mm_shufflehi_epi16(v, _MM_SHUFFLE(2, 2, 1, 1)),
+	                                        _mm_shufflehi_epi16(v, _MM_SHUFFLE(3, 3, 3, 2)));
+	uint16 *dst[3] = { dst0, dst1, dst2 };
+
+	for (int i = 0; i < 3; ++i) {
+		_mm_storeu_si128((__m128i *)dst[i], out0);
+		_mm_storeu_si128((__m128i *)(dst[i] + 8), out1);
+		_mm_storeu_si128((__m128i *)(dst[i] + 16), out2);
+	}
+}
+
+static inline void normal3xVector(const uint32 *src, uint32 *dst0, uint32 *dst1, uint32 *dst2) {
+	const __m128i v = _mm_loadu_si128((const __m128i *)src);
+	// p0 p0 p0 p1 | p1 p1 p2 p2 | p2 p3 p3 p3
+	const __m128i out0 = _mm_shuffle_epi32(v, _MM_SHUFFLE(1, 0, 0, 0));
+	const __m128i out1 = _mm_shuffle_epi32(v, _MM_SHUFFLE(2, 2, 1, 1));
+	const __m128i out2 = _mm_shuffle_epi32(v, _MM_SHUFFLE(3, 3, 3, 2));
+	uint32 *dst[3] = { dst0, dst1, dst2 };
+
+	for (int i = 0; i < 3; ++i) {
+		_mm_storeu_si128((__m128i *)dst[i], out0);
+		_mm_storeu_si128((__m128i *)(dst[i] + 4), out1);
+		_mm_storeu_si128((__m128i *)(dst[i] + 8), out2);
+	}
+}
+
+#elif defined(SCALER_SIMD_NEON)
+
+static inline void normal2xVector(const uint16 *src, uint16 *dst0, uint16 *dst1) {
+	uint16x8x2_t v;
+	v.val[0] = v.val[1] = vld1q_u16(src);
+	vst2q_u16(dst0, v);
+	vst2q_u16(dst1, v);
+}
+
+static inline void normal2xVector(const uint32 *src, uint32 *dst0, uint32 *dst1) {
+	uint32x4x2_t v;
+	v.val[0] = v.val[1] = vld1q_u32(src);
+	vst2q_u32(dst0, v);
+	vst2q_u32(dst1, v);
+}
+
+static inline void normal3xVector(const uint16 *src, uint16 *dst0, uint16 *dst1, uint16 *dst2) {
+	uint16x8x3_t v;
+	v.val[0] = v.val[1] = v.val[2] = vld1q_u16(src);
+	vst3q_u16(dst0, v);
+	vst3q_u16(dst1, v);
+	vst3q_u16(dst2, v);
+}
+
+static inline void normal3xVector(const uint32 *src, uint32 *dst0, uint32 *dst1, uint32 *dst2) {
+	uint32x4x3_t v;
+	v.val[0] = v.val[1] = v.val[2] = vld1q_u32(src);
+	vst3q_u32(dst0, v);
+	vst3q_u32(dst1, v);
+	vst3q_u32(dst2, v);
+}
+
+#endif
+
+/**
+ * Vectorized nearest-neighbor 2x scaler, for 16 and 32 bit pixels.
+ */
+template<typename Pixel>
+void Normal2xSimd(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+							int width, int height) {
+	const int pixelsPerVector = 16 / sizeof(Pixel);
+
+	while (height--) {
+		const Pixel *src = (const Pixel *)srcPtr;
+		Pixel *dst0 = (Pixel *)dstPtr;
+		Pixel *dst1 = (Pixel *)(dstPtr + dstPitch);
+		int i = 0;
+
+		for (; i + pixelsPerVector <= width; i += pixelsPerVector)
+			normal2xVector(src + i, dst0 + i * 2, dst1 + i * 2);
+
+		for (; i < width; ++i) {
+			dst0[i * 2] = dst0[i * 2 + 1] = src[i];
+			dst1[i * 2] = dst1[i * 2 + 1] = src[i];
+		}
+
+		srcPtr += srcPitch;
+		dstPtr += dstPitch << 1;
+	}
+}
+
+/**
+ * Vectorized nearest-neighbor 3x scaler, for 16 and 32 bit pixels.
+ */
+template<typename Pixel>
+void Normal3xSimd(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPitch,
+							int width, int height) {
+	const int pixelsPerVector = 16 / sizeof(Pixel);
+
+	while (height--) {
+		const Pixel *src = (const Pixel *)srcPtr;
+		Pixel *dst0 = (Pixel *)dstPtr;
+		Pixel *dst1 = (Pixel *)(dstPtr + dstPitch);
+		Pixel *dst2 = (Pixel *)(dstPtr + dstPitch * 2);
+		int i = 0;
+
+		for (; i + pixelsPerVector <= width; i += pixelsPerVector)
+			normal3xVector(src + i, dst0 + i * 3, dst1 + i * 3, dst2 + i * 3);
+
+		for (; i < width; ++i) {
+			dst0[i * 3] = dst0[i * 3 + 1] = dst0[i * 3 + 2] = src[i];
+			dst1[i * 3] = dst1[i * 3 + 1] = dst1[i * 3 + 2] = src[i];
+			dst2[i * 3] = dst2[i * 3 + 1] = dst2[i * 3 + 2] = src[i];
+		}
+
+		srcPtr += srcPitch;
+		dstPtr += dstPitch * 3;
+	}
+}
+#endif // USE_SCALER_SIMD
 #endif
 
 void NormalScaler::scaleIntern(const uint8 *srcPtr, uint32 srcPitch,
@@ -224,6 +375,15 @@ void NormalScaler::scaleIntern(const uint8 *srcPtr, uint32 srcPitch,
 			break;
 		}
 	} else if (_format.bytesPerPixel == 2) {
+#ifdef USE_SCALER_SIMD
+		if (_useSimd && (_factor == 2 || _factor == 3)) {
+			if (_factor == 2)
+				Normal2xSimd<uint16>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+			else
+				Normal3xSimd<uint16>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+			return;
+		}
+#endif
 		switch (_factor) {
 		case 2:
 #ifdef USE_ARM_SCALER_ASM
@@ -244,6 +404,15 @@ void NormalScaler::scaleIntern(const uint8 *srcPtr, uint32 srcPitch,
 		}
 	} else {
 		assert(_format.bytesPerPixel == 4);
+#ifdef USE_SCALER_SIMD
+		if (_useSimd && (_factor == 2 || _factor == 3)) {
+			if (_factor == 2)
+				Normal2xSimd<uint32>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+			else
+				Normal3xSimd<uint32>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
+			return;
+		}
+#endif
 		switch (_factor) {
 		case 2:
 			Normal2x<uint32>(srcPtr, srcPitch, dstPtr, dstPitch, width, height);
@@ -287,6 +456,8 @@ public:
 
 	bool canDrawCursor() const override { return true; }
 	uint extraPixels() const override { return 0; }
+	bool isReentrant() const override { return true; }
+	bool hasSimd() const override { return true; }
 	const char *getName() const override;
 	const char *getPrettyName() const override;
 };
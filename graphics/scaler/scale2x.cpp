@@ -36,6 +36,7 @@
 #include "common/scummsys.h"
 
 #include "graphics/scaler/scale2x.h"
+#include "graphics/scaler/simd.h"
 
 /***************************************************************************/
 /* Scale2x C implementation */
@@ -147,6 +148,167 @@ void scale2x_32_def(scale2x_uint32* dst0, scale2x_uint32* dst1, const scale2x_ui
 	scale2x_32_def_single(dst1, src2, src1, src0, count);
 }
 
+/***************************************************************************/
+/* Scale2x SSE2/NEON implementation */
+
+#ifdef USE_SCALER_SIMD
+
+/*
+ * Apply the Scale2x effect at a single row, on 8 pixels of 16 bits or 4
+ * pixels of 32 bits at a time. The remaining pixels are computed by the C
+ * implementation.
+ *
+ * Like the C implementation, the pixels over the left and right borders are
+ * read from the row.
+ */
+#if defined(SCALER_SIMD_SSE2)
+
+static inline void scale2x_16_simd_single(scale2x_uint16* __restrict__ dst, const scale2x_uint16* __restrict__ src0, const scale2x_uint16* __restrict__ src1, const scale2x_uint16* __restrict__ src2, unsigned count) {
+	while (count >= 8) {
+		const __m128i b = _mm_loadu_si128((const __m128i *)src0);
+		const __m128i d = _mm_loadu_si128((const __m128i *)(src1 - 1));
+		const __m128i e = _mm_loadu_si128((const __m128i *)src1);
+		const __m128i f = _mm_loadu_si128((const __m128i *)(src1 + 1));
+		const __m128i h = _mm_loadu_si128((const __m128i *)src2);
+
+		/* the pixels with B != H and D != F */
+		const __m128i same = _mm_or_si128(_mm_cmpeq_epi16(b, h), _mm_cmpeq_epi16(d, f));
+		const __m128i left = _mm_andnot_si128(same, _mm_cmpeq_epi16(d, b));
+		const __m128i right = _mm_andnot_si128(same, _mm_cmpeq_epi16(f, b));
+		const __m128i dst0 = _mm_or_si128(_mm_and_si128(left, b), _mm_andnot_si128(left, e));
+		const __m128i dst1 = _mm_or_si128(_mm_and_si128(right, b), _mm_andnot_si128(right, e));
+
+		_mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(dst0, dst1));
+		_mm_storeu_si128((__m128i *)(dst + 8), _mm_unpackhi_epi16(dst0, dst1));
+
+		src0 += 8;
+		src1 += 8;
+		src2 += 8;
+		dst += 16;
+		count -= 8;
+	}
+
+	scale2x_16_def_single(dst, src0, src1, src2, count);
+}
+
+static inline void scale2x_32_simd_single(scale2x_uint32* __restrict__ dst, const scale2x_uint32* __restrict__ src0, const scale2x_uint32* __restrict__ src1, const scale2x_uint32* __restrict__ src2, unsigned count) {
+	while (count >= 4) {
+		const __m128i b = _mm_loadu_si128((const __m128i *)src0);
+		const __m128i d = _mm_loadu_si128((const __m128i *)(src1 - 1));
+		const __m128i e = _mm_loadu_si128((const __m128i *)src1);
+		const __m128i f = _mm_loadu_si128((const __m128i *)(src1 + 1));
+		const __m128i h = _mm_loadu_si128((const __m128i *)src2);
+
+		/* the pixels with B != H and D != F */
+		const __m128i same = _mm_or_si128(_mm_cmpeq_epi32(b, h), _mm_cmpeq_epi32(d, f));
+		const __m128i left = _mm_andnot_si128(same, _mm_cmpeq_epi32(d, b));
+		const __m128i right = _mm_andnot_si128(same, _mm_cmpeq_epi32(f, b));
+		const __m128i dst0 = _mm_or_si128(_mm_and_si128(left, b), _mm_andnot_si128(left, e));
+		const __m128i dst1 = _mm_or_si128(_mm_and_si128(right, b), _mm_andnot_si128(right, e));
+
+		_mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi32(dst0, dst1));
+		_mm_storeu_si128((__m128i *)(dst + 4), _mm_unpackhi_epi32(dst0, dst1));
+
+		src0 += 4;
+		src1 += 4;
+		src2 += 4;
+		dst += 8;
+		count -= 4;
+	}
+
+	scale2x_32_def_single(dst, src0, src1, src2, count);
+}
+
+#elif defined(SCALER_SIMD_NEON)
+
+static inline void scale2x_16_simd_single(scale2x_uint16* __restrict__ dst, const scale2x_uint16* __restrict__ src0, const scale2x_uint16* __restrict__ src1, const scale2x_uint16* __restrict__ src2, unsigned count) {
+	while (count >= 8) {
+		const uint16x8_t b = vld1q_u16(src0);
+		const uint16x8_t d = vld1q_u16(src1 - 1);
+		const uint16x8_t e = vld1q_u16(src1);
+		const uint16x8_t f = vld1q_u16(src1 + 1);
+		const uint16x8_t h = vld1q_u16(src2);
+
+		/* the pixels with B != H and D != F */
+		const uint16x8_t same = vorrq_u16(vceqq_u16(b, h), vceqq_u16(d, f));
+		uint16x8x2_t out;
+		out.val[0] = vbslq_u16(vbicq_u16(vceqq_u16(d, b), same), b, e);
+		out.val[1] = vbslq_u16(vbicq_u16(vceqq_u16(f, b), same), b, e);
+		vst2q_u16(dst, out);
+
+		src0 += 8;
+		src1 += 8;
+		src2 += 8;
+		dst += 16;
+		count -= 8;
+	}
+
+	scale2x_16_def_single(dst, src0, src1, src2, count);
+}
+
+static inline void scale2x_32_simd_single(scale2x_uint32* __restrict__ dst, const scale2x_uint32* __restrict__ src0, const scale2x_uint32* __restrict__ src1, const scale2x_uint32* __restrict__ src2, unsigned count) {
+	while (count >= 4) {
+		const uint32x4_t b = vld1q_u32(src0);
+		const uint32x4_t d = vld1q_u32(src1 - 1);
+		const uint32x4_t e = vld1q_u32(src1);
+		const uint32x4_t f = vld1q_u32(src1 + 1);
+		const uint32x4_t h = vld1q_u32(src2);
+
+		/* the pixels with B != H and D != F */
+		const uint32x4_t same = vorrq_u32(vceqq_u32(b, h), vceqq_u32(d, f));
+		uint32x4x2_t out;
+		out.val[0] = vbslq_u32(vbicq_u32(vceqq_u32(d, b), same), b, e);
+		out.val[1] = vbslq_u32(vbicq_u32(vceqq_u32(f, b), same), b, e);
+		vst2q_u32(dst, out);
+
+		src0 += 4;
+		src1 += 4;
+		src2 += 4;
+		dst += 8;
+		count -= 4;
+	}
+
+	scale2x_32_def_single(dst, src0, src1, src2, count);
+}
+
+#endif
+
+/**
+ * Scale by a factor of 2 a row of pixels of 16 bits.
+ * This function operates like scale2x_16_def() but uses SSE2 or NEON
+ * instructions.
+ * @param src0 Pointer at the first pixel of the previous row.
+ * @param src1 Pointer at the first pixel of the current row.
+ * @param src2 Pointer at the first pixel of the next row.
+ * @param count Length in pixels of the src0, src1 and src2 rows.
+ * It must be at least 2.
+ * @param dst0 First destination row, double length in pixels.
+ * @param dst1 Second destination row, double length in pixels.
+ */
+void scale2x_16_simd(scale2x_uint16* dst0, scale2x_uint16* dst1, const scale2x_uint16* src0, const scale2x_uint16* src1, const scale2x_uint16* src2, unsigned count) {
+	scale2x_16_simd_single(dst0, src0, src1, src2, count);
+	scale2x_16_simd_single(dst1, src2, src1, src0, count);
+}
+
+/**
+ * Scale by a factor of 2 a row of pixels of 32 bits.
+ * This function operates like scale2x_32_def() but uses SSE2 or NEON
+ * instructions.
+ * @param src0 Pointer at the first pixel of the previous row.
+ * @param src1 Pointer at the first pixel of the current row.
+ * @param src2 Pointer at the first pixel of the next row.
+ * @param count Length in pixels of the src0, src1 and src2 rows.
+ * It must be at least 2.
+ * @param dst0 First destination row, double length in pixels.
+ * @param dst1 Second destination row, double length in pixels.
+ */
+void scale2x_32_simd(scale2x_uint32* dst0, scale2x_uint32* dst1, const scale2x_uint32* src0, const scale2x_uint32* src1, const scale2x_uint32* src2, unsigned count) {
+	scale2x_32_simd_single(dst0, src0, src1, src2, count);
+	scale2x_32_simd_single(dst1, src2, src1, src0, count);
+}
+
+#endif
+
 /***************************************************************************/
 /* Scale2x MMX implementation */
 
@@ -36,6 +36,7 @@
 #include "common/scummsys.h"
 
 #include "graphics/scaler/scale3x.h"
+#include "graphics/scaler/simd.h"
 
 /***************************************************************************/
 /* Scale3x C implementation */
@@ -221,3 +222,237 @@ void scale3x_32_def(scale3x_uint32* dst0, scale3x_uint32* dst1, scale3x_uint32*
 	scale3x_32_def_center(dst1, src0, src1, src2, count);
 	scale3x_32_def_border(dst2, src2, src1, src0, count);
 }
+
+/***************************************************************************/
+/* Scale3x SSE2/NEON implementation */
+
+#ifdef USE_SCALER_SIMD
+
+/*
+ * Vector operations used by the Scale3x implementation, for each pixel size.
+ */
+#if defined(SCALER_SIMD_SSE2)
+
+struct scale3x_simd_16 {
+	typedef scale3x_uint16 pixel;
+	typedef __m128i vector;
+	enum { kPixels = 8 };
+
+	static inline vector load(const pixel* src) { return _mm_loadu_si128((const __m128i *)src); }
+	static inline vector eq(vector a, vector b) { return _mm_cmpeq_epi16(a, b); }
+	static inline vector and_(vector a, vector b) { return _mm_and_si128(a, b); }
+	static inline vector or_(vector a, vector b) { return _mm_or_si128(a, b); }
+	/* a & ~b */
+	static inline vector bic(vector a, vector b) { return _mm_andnot_si128(b, a); }
+	/* mask ? a : b */
+	static inline vector select(vector mask, vector a, vector b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+
+	static inline void store3(pixel* dst, vector x0, vector x1, vector x2) {
+		pixel tmp[3][kPixels];
+		_mm_storeu_si128((__m128i *)tmp[0], x0);
+		_mm_storeu_si128((__m128i *)tmp[1], x1);
+		_mm_storeu_si128((__m128i *)tmp[2], x2);
+		for (int i = 0; i < kPixels; ++i) {
+			dst[i * 3 + 0] = tmp[0][i];
+			dst[i * 3 + 1] = tmp[1][i];
+			dst[i * 3 + 2] = tmp[2][i];
+		}
+	}
+};
+
+struct scale3x_simd_32 {
+	typedef scale3x_uint32 pixel;
+	typedef __m128i vector;
+	enum { kPixels = 4 };
+
+	static inline vector load(const pixel* src) { return _mm_loadu_si128((const __m128i *)src); }
+	static inline vector eq(vector a, vector b) { return _mm_cmpeq_epi32(a, b); }
+	static inline vector and_(vector a, vector b) { return _mm_and_si128(a, b); }
+	static inline vector or_(vector a, vector b) { return _mm_or_si128(a, b); }
+	static inline vector bic(vector a, vector b) { return _mm_andnot_si128(b, a); }
+	static inline vector select(vector mask, vector a, vector b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+
+	static inline void store3(pixel* dst, vector x0, vector x1, vector x2) {
+		/* a0 b0 c0 a1 | b1 c1 a2 b2 | c2 a3 b3 c3 */
+		const __m128i ab_lo = _mm_unpacklo_epi32(x0, x1); /* a0 b0 a1 b1 */
+		const __m128i ab_hi = _mm_unpackhi_epi32(x0, x1); /* a2 b2 a3 b3 */
+		const __m128i ca_lo = _mm_unpacklo_epi32(x2, x0); /* c0 a0 c1 a1 */
+		const __m128i bc_lo = _mm_unpacklo_epi32(x1, x2); /* b0 c0 b1 c1 */
+		const __m128i bc_hi = _mm_unpackhi_epi32(x1, x2); /* b2 c2 b3 c3 */
+		const __m128i ca_hi = _mm_unpackhi_epi32(x2, x0); /* c2 a2 c3 a3 */
+
+		_mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi64(ab_lo, _mm_shuffle_epi32(ca_lo, _MM_SHUFFLE(3, 2, 3, 0))));
+		_mm_storeu_si128((__m128i *)(dst + 4), _mm_unpacklo_epi64(_mm_shuffle_epi32(bc_lo, _MM_SHUFFLE(1, 0, 3, 2)), ab_hi));
+		_mm_storeu_si128((__m128i *)(dst + 8), _mm_unpackhi_epi64(_mm_shuffle_epi32(ca_hi, _MM_SHUFFLE(3, 0, 1, 0)), bc_hi));
+	}
+};
+
+#elif defined(SCALER_SIMD_NEON)
+
+struct scale3x_simd_16 {
+	typedef scale3x_uint16 pixel;
+	typedef uint16x8_t vector;
+	enum { kPixels = 8 };
+
+	static inline vector load(const pixel* src) { return vld1q_u16(src); }
+	static inline vector eq(vector a, vector b) { return vceqq_u16(a, b); }
+	static inline vector and_(vector a, vector b) { return vandq_u16(a, b); }
+	static inline vector or_(vector a, vector b) { return vorrq_u16(a, b); }
+	static inline vector bic(vector a, vector b) { return vbicq_u16(a, b); }
+	static inline vector select(vector mask, vector a, vector b) { return vbslq_u16(mask, a, b); }
+
+	static inline void store3(pixel* dst, vector x0, vector x1, vector x2) {
+		uint16x8x3_t out;
+		out.val[0] = x0;
+		out.val[1] = x1;
+		out.val[2] = x2;
+		vst3q_u16(dst, out);
+	}
+};
+
+struct scale3x_simd_32 {
+	typedef scale3x_uint32 pixel;
+	typedef uint32x4_t vector;
+	enum { kPixels = 4 };
+
+	static inline vector load(const pixel* src) { return vld1q_u32(src); }
+	static inline vector eq(vector a, vector b) { return vceqq_u32(a, b); }
+	static inline vector and_(vector a, vector b) { return vandq_u32(a, b); }
+	static inline vector or_(vector a, vector b) { return vorrq_u32(a, b); }
+	static inline vector bic(vector a, vector b) { return vbicq_u32(a, b); }
+	static inline vector select(vector mask, vector a, vector b) { return vbslq_u32(mask, a, b); }
+
+	static inline void store3(pixel* dst, vector x0, vector x1, vector x2) {
+		uint32x4x3_t out;
+		out.val[0] = x0;
+		out.val[1] = x1;
+		out.val[2] = x2;
+		vst3q_u32(dst, out);
+	}
+};
+
+#endif
+
+/*
+ * Vectorized versions of scale3x_*_def_border() and scale3x_*_def_center(),
+ * computing T::kPixels source pixels at a time. They return the number of
+ * pixels left for the C implementation.
+ */
+template<class T>
+static inline unsigned scale3x_simd_border(typename T::pixel* __restrict__ dst, const typename T::pixel* __restrict__ src0, const typename T::pixel* __restrict__ src1, const typename T::pixel* __restrict__ src2, unsigned count) {
+	typedef typename T::vector vector;
+
+	while (count >= (unsigned)T::kPixels) {
+		const vector a = T::load(src0 - 1);
+		const vector b = T::load(src0);
+		const vector c = T::load(src0 + 1);
+		const vector d = T::load(src1 - 1);
+		const vector e = T::load(src1);
+		const vector f = T::load(src1 + 1);
+		const vector h = T::load(src2);
+
+		/* the pixels with B != H and D != F */
+		const vector same = T::or_(T::eq(b, h), T::eq(d, f));
+		const vector db = T::bic(T::eq(d, b), same);
+		const vector fb = T::bic(T::eq(f, b), same);
+		const vector middle = T::or_(T::bic(db, T::eq(e, c)), T::bic(fb, T::eq(e, a)));
+
+		T::store3(dst, T::select(db, d, e), T::select(middle, b, e), T::select(fb, f, e));
+
+		src0 += T::kPixels;
+		src1 += T::kPixels;
+		src2 += T::kPixels;
+		dst += 3 * T::kPixels;
+		count -= T::kPixels;
+	}
+
+	return count;
+}
+
+template<class T>
+static inline unsigned scale3x_simd_center(typename T::pixel* __restrict__ dst, const typename T::pixel* __restrict__ src0, const typename T::pixel* __restrict__ src1, const typename T::pixel* __restrict__ src2, unsigned count) {
+	typedef typename T::vector vector;
+
+	while (count >= (unsigned)T::kPixels) {
+		const vector a = T::load(src0 - 1);
+		const vector b = T::load(src0);
+		const vector c = T::load(src0 + 1);
+		const vector d = T::load(src1 - 1);
+		const vector e = T::load(src1);
+		const vector f = T::load(src1 + 1);
+		const vector g = T::load(src2 - 1);
+		const vector h = T::load(src2);
+		const vector i = T::load(src2 + 1);
+
+		/* the pixels with B != H and D != F */
+		const vector same = T::or_(T::eq(b, h), T::eq(d, f));
+		const vector left = T::or_(T::bic(T::eq(d, b), T::eq(e, g)), T::bic(T::eq(d, h), T::eq(e, a)));
+		const vector right = T::or_(T::bic(T::eq(f, b), T::eq(e, i)), T::bic(T::eq(f, h), T::eq(e, c)));
+
+		T::store3(dst, T::select(T::bic(left, same), d, e), e, T::select(T::bic(right, same), f, e));
+
+		src0 += T::kPixels;
+		src1 += T::kPixels;
+		src2 += T::kPixels;
+		dst += 3 * T::kPixels;
+		count -= T::kPixels;
+	}
+
+	return count;
+}
+
+/**
+ * Scale by a factor of 3 a row of pixels of 16 bits.
+ * This function operates like scale3x_16_def() but uses SSE2 or NEON
+ * instructions.
+ * @param src0 Pointer at the first pixel of the previous row.
+ * @param src1 Pointer at the first pixel of the current row.
+ * @param src2 Pointer at the first pixel of the next row.
+ * @param count Length in pixels of the src0, src1 and src2 rows.
+ * It must be at least 2.
+ * @param dst0 First destination row, triple length in pixels.
+ * @param dst1 Second destination row, triple length in pixels.
+ * @param dst2 Third destination row, triple length in pixels.
+ */
+void scale3x_16_simd(scale3x_uint16* dst0, scale3x_uint16* dst1, scale3x_uint16* dst2, const scale3x_uint16* src0, const scale3x_uint16* src1, const scale3x_uint16* src2, unsigned count) {
+	const unsigned rest = scale3x_simd_border<scale3x_simd_16>(dst0, src0, src1, src2, count);
+	const unsigned done = count - rest;
+
+	scale3x_simd_center<scale3x_simd_16>(dst1, src0, src1, src2, count);
+	scale3x_simd_border<scale3x_simd_16>(dst2, src2, src1, src0, count);
+
+	if (rest) {
+		scale3x_16_def_border(dst0 + 3 * done, src0 + done, src1 + done, src2 + done, rest);
+		scale3x_16_def_center(dst1 + 3 * done, src0 + done, src1 + done, src2 + done, rest);
+		scale3x_16_def_border(dst2 + 3 * done, src2 + done, src1 + done, src0 + done, rest);
+	}
+}
+
+/**
+ * Scale by a factor of 3 a row of pixels of 32 bits.
+ * This function operates like scale3x_32_def() but uses SSE2 or NEON
+ * instructions.
+ * @param src0 Pointer at the first pixel of the previous row.
+ * @param src1 Pointer at the first pixel of the current row.
+ * @param src2 Pointer at the first pixel of the next row.
+ * @param count Length in pixels of the src0, src1 and src2 rows.
+ * It must be at least 2.
+ * @param dst0 First destination row, triple length in pixels.
+ * @param dst1 Second destination row, triple length in pixels.
+ * @param dst2 Third destination row, triple length in pixels.
+ */
+void scale3x_32_simd(scale3x_uint32* dst0, scale3x_uint32* dst1, scale3x_uint32* dst2, const scale3x_uint32* src0, const scale3x_uint32* src1, const scale3x_uint32* src2, unsigned count) {
+	const unsigned rest = scale3x_simd_border<scale3x_simd_32>(dst0, src0, src1, src2, count);
+	const unsigned done = count - rest;
+
+	scale3x_simd_center<scale3x_simd_32>(dst1, src0, src1, src2, count);
+	scale3x_simd_border<scale3x_simd_32>(dst2, src2, src1, src0, count);
+
+	if (rest) {
+		scale3x_32_def_border(dst0 + 3 * done, src0 + done, src1 + done, src2 + done, rest);
+		scale3x_32_def_center(dst1 + 3 * done, src0 + done, src1 + done, src2 + done, rest);
+		scale3x_32_def_border(dst2 + 3 * done, src2 + done, src1 + done, src0 + done, rest);
+	}
+}
+
+#endif
@@ -39,6 +39,7 @@
 #include "graphics/scaler/scale2x.h"
 #include "graphics/scaler/scale3x.h"
 #include "graphics/scaler/scalebit.h"
+#include "graphics/scaler/simd.h"
 
 #define DST(bits, num)	(scale2x_uint ## bits *)dst ## num
 #define SRC(bits, num)	(const scale2x_uint ## bits *)src ## num
@@ -46,7 +47,17 @@
 /**
  * Apply the Scale2x effect on a group of rows. Used internally.
  */
-static inline void stage_scale2x(void* dst0, void* dst1, const void* src0, const void* src1, const void* src2, unsigned pixel, unsigned pixel_per_row) {
+static inline void stage_scale2x(void* dst0, void* dst1, const void* src0, const void* src1, const void* src2, unsigned pixel, unsigned pixel_per_row, bool simd) {
+#ifdef USE_SCALER_SIMD
+	if (simd && pixel != 1) {
+		if (pixel == 2)
+			scale2x_16_simd(DST(16,0), DST(16,1), SRC(16,0), SRC(16,1), SRC(16,2), pixel_per_row);
+		else
+			scale2x_32_simd(DST(32,0), DST(32,1), SRC(32,0), SRC(32,1), SRC(32,2), pixel_per_row);
+		return;
+	}
+#endif
+
 	switch (pixel) {
 #if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
 	case 1: scale2x_8_mmx( DST( 8,0), DST( 8,1), SRC( 8,0), SRC( 8,1), SRC( 8,2), pixel_per_row); break;
@@ -68,7 +79,17 @@ static inline void stage_scale2x(void* dst0, void* dst1, const void* src0, const
 /**
  * Apply the Scale3x effect on a group of rows. Used internally.
  */
-static inline void stage_scale3x(void* dst0, void* dst1, void* dst2, const void* src0, const void* src1, const void* src2, unsigned pixel, unsigned pixel_per_row) {
+static inline void stage_scale3x(void* dst0, void* dst1, void* dst2, const void* src0, const void* src1, const void* src2, unsigned pixel, unsigned pixel_per_row, bool simd) {
+#ifdef USE_SCALER_SIMD
+	if (simd && pixel != 1) {
+		if (pixel == 2)
+			scale3x_16_simd(DST(16,0), DST(16,1), DST(16,2), SRC(16,0), SRC(16,1), SRC(16,2), pixel_per_row);
+		else
+			scale3x_32_simd(DST(32,0), DST(32,1), DST(32,2), SRC(32,0), SRC(32,1), SRC(32,2), pixel_per_row);
+		return;
+	}
+#endif
+
 	switch (pixel) {
 	case 1: scale3x_8_def( DST( 8,0), DST( 8,1), DST( 8,2), SRC( 8,0), SRC( 8,1), SRC( 8,2), pixel_per_row); break;
 	case 2: scale3x_16_def(DST(16,0), DST(16,1), DST(16,2), SRC(16,0), SRC(16,1), SRC(16,2), pixel_per_row); break;
@@ -80,9 +101,30 @@ static inline void stage_scale3x(void* dst0, void* dst1, void* dst2, const void*
 /**
  * Apply the Scale4x effect on a group of rows. Used internally.
  */
-static inline void stage_scale4x(void* dst0, void* dst1, void* dst2, void* dst3, const void* src0, const void* src1, const void* src2, const void* src3, unsigned pixel, unsigned pixel_per_row) {
-	stage_scale2x(dst0, dst1, src0, src1, src2, pixel, 2 * pixel_per_row);
-	stage_scale2x(dst2, dst3, src1, src2, src3, pixel, 2 * pixel_per_row);
+static inline void stage_scale4x(void* dst0, void* dst1, void* dst2, void* dst3, const void* src0, const void* src1, const void* src2, const void* src3, unsigned pixel, unsigned pixel_per_row, bool simd) {
+	stage_scale2x(dst0, dst1, src0, src1, src2, pixel, 2 * pixel_per_row, simd);
+	stage_scale2x(dst2, dst3, src1, src2, src3, pixel, 2 * pixel_per_row, simd);
+}
+
+/**
+ * Size in bytes of the border kept on each side of the Scale4x intermediate
+ * rows. The optimized row scalers read the pixels next to both ends of a row.
+ */
+#define SCALE4X_MID_MARGIN 8
+
+/**
+ * Fill the borders of a Scale4x intermediate row by repeating its first
+ * and last pixels, so that scaling it never reads the contents of the
+ * neighbouring rows of the buffer. Used internally.
+ */
+static inline void stage_mid_border(unsigned char* row, unsigned pixel, unsigned pixel_per_row) {
+	unsigned char* last = row + (pixel_per_row - 1) * pixel;
+	unsigned i;
+
+	for (i = 0; i < SCALE4X_MID_MARGIN; i += pixel) {
+		memcpy(row - SCALE4X_MID_MARGIN + i, row, pixel);
+		memcpy(last + pixel + i, last, pixel);
+	}
 }
 
 #define SCDST(i) (dst+(i)*dst_slice)
@@ -102,8 +144,9 @@ static inline void stage_scale4x(void* dst0, void* dst1, void* dst2, void* dst3,
  * @param pixel Bytes per pixel of the source and destination bitmap.
  * @param width Horizontal size in pixels of the source bitmap.
  * @param height Vertical size in pixels of the source bitmap.
+ * @param simd Use the SSE2 or NEON implementation for 16 and 32 bits pixels.
  */
-static void scale2x(void* void_dst, unsigned dst_slice, const void* void_src, unsigned src_slice, unsigned pixel, unsigned width, unsigned height) {
+static void scale2x(void* void_dst, unsigned dst_slice, const void* void_src, unsigned src_slice, unsigned pixel, unsigned width, unsigned height, bool simd) {
 	unsigned char* dst = (unsigned char*)void_dst;
 	const unsigned char* src = (const unsigned char*)void_src;
 	unsigned count;
@@ -113,7 +156,7 @@ static void scale2x(void* void_dst, unsigned dst_slice, const void* void_src, un
 	count = height;
 
 	while (count) {
-		stage_scale2x(SCDST(0), SCDST(1), SCSRC(0), SCSRC(1), SCSRC(2), pixel, width);
+		stage_scale2x(SCDST(0), SCDST(1), SCSRC(0), SCSRC(1), SCSRC(2), pixel, width, simd);
 
 		dst = SCDST(2);
 		src = SCSRC(1);
@@ -139,8 +182,9 @@ static void scale2x(void* void_dst, unsigned dst_slice, const void* void_src, un
  * @param pixel Bytes per pixel of the source and destination bitmap.
  * @param width Horizontal size in pixels of the source bitmap.
  * @param height Vertical size in pixels of the source bitmap.
+ * @param simd Use the SSE2 or NEON implementation for 16 and 32 bits pixels.
  */
-static void scale3x(void* void_dst, unsigned dst_slice, const void* void_src, unsigned src_slice, unsigned pixel, unsigned width, unsigned height) {
+static void scale3x(void* void_dst, unsigned dst_slice, const void* void_src, unsigned src_slice, unsigned pixel, unsigned width, unsigned height, bool simd) {
 	unsigned char* dst = (unsigned char*)void_dst;
 	const unsigned char* src = (const unsigned char*)void_src;
 	unsigned count;
@@ -150,7 +194,7 @@ static void scale3x(void* void_dst, unsigned dst_slice, const void* void_src, un
 	count = height;
 
 	while (count) {
-		stage_scale3x(SCDST(0), SCDST(1), SCDST(2), SCSRC(0), SCSRC(1), SCSRC(2), pixel, width);
+		stage_scale3x(SCDST(0), SCDST(1), SCDST(2), SCSRC(0), SCSRC(1), SCSRC(2), pixel, width, simd);
 
 		dst = SCDST(3);
 		src = SCSRC(1);
@@ -166,9 +210,9 @@ static void scale3x(void* void_dst, unsigned dst_slice, const void* void_src, un
  * The destination bitmap must be manually allocated before calling the function,
  * note that the resulting size is exactly 4x4 times the size of the source bitmap.
  * \note This function requires also a small buffer bitmap used internally to store
- * intermediate results. This bitmap must have at least a horizontal size in bytes of 2*width*pixel,
- * and a vertical size of 6 rows. The memory of this buffer must not be allocated
- * in video memory because it's also read and not only written. Generally
+ * intermediate results. This bitmap must have at least a horizontal size in bytes of
+ * 2*width*pixel + 2*SCALE4X_MID_MARGIN, and a vertical size of 6 rows. The memory of this
+ * buffer must not be allocated in video memory because it's also read and not only written. Generally
  * a heap (malloc) or a stack (alloca) buffer is the best choices.
  * @param void_dst Pointer at the first pixel of the destination bitmap.
  * @param dst_slice Size in bytes of a destination bitmap row.
@@ -179,32 +223,38 @@ static void scale3x(void* void_dst, unsigned dst_slice, const void* void_src, un
  * @param pixel Bytes per pixel of the source and destination bitmap.
  * @param width Horizontal size in pixels of the source bitmap.
  * @param height Vertical size in pixels of the source bitmap.
+ * @param simd Use the SSE2 or NEON implementation for 16 and 32 bits pixels.
  */
-static void scale4x_buf(void* void_dst, unsigned dst_slice, void* void_mid, unsigned mid_slice, const void* void_src, unsigned src_slice, unsigned pixel, unsigned width, unsigned height) {
+static void scale4x_buf(void* void_dst, unsigned dst_slice, void* void_mid, unsigned mid_slice, const void* void_src, unsigned src_slice, unsigned pixel, unsigned width, unsigned height, bool simd) {
 	unsigned char* dst = (unsigned char*)void_dst;
 	const unsigned char* src = (const unsigned char*)void_src;
 	unsigned count;
+	unsigned i;
 	unsigned char* mid[6];
 
 	assert(height >= 4);
 
 	count = height;
 
-	/* set the 6 buffer pointers */
-	mid[0] = (unsigned char*)void_mid;
+	/* set the 6 buffer pointers, skipping the left border of each row */
+	mid[0] = (unsigned char*)void_mid + SCALE4X_MID_MARGIN;
 	mid[1] = mid[0] + mid_slice;
 	mid[2] = mid[1] + mid_slice;
 	mid[3] = mid[2] + mid_slice;
 	mid[4] = mid[3] + mid_slice;
 	mid[5] = mid[4] + mid_slice;
 
-	stage_scale2x(SCMID(0), SCMID(1), SCSRC(0), SCSRC(1), SCSRC(2), pixel, width);
-	stage_scale2x(SCMID(2), SCMID(3), SCSRC(1), SCSRC(2), SCSRC(3), pixel, width);
+	stage_scale2x(SCMID(0), SCMID(1), SCSRC(0), SCSRC(1), SCSRC(2), pixel, width, simd);
+	stage_scale2x(SCMID(2), SCMID(3), SCSRC(1), SCSRC(2), SCSRC(3), pixel, width, simd);
+	for (i = 0; i < 4; ++i)
+		stage_mid_border(SCMID(i), pixel, 2 * width);
 	while (count) {
 		unsigned char* tmp;
 
-		stage_scale2x(SCMID(4), SCMID(5), SCSRC(2), SCSRC(3), SCSRC(4), pixel, width);
-		stage_scale4x(SCDST(0), SCDST(1), SCDST(2), SCDST(3), SCMID(1), SCMID(2), SCMID(3), SCMID(4), pixel, width);
+		stage_scale2x(SCMID(4), SCMID(5), SCSRC(2), SCSRC(3), SCSRC(4), pixel, width, simd);
+		stage_mid_border(SCMID(4), pixel, 2 * width);
+		stage_mid_border(SCMID(5), pixel, 2 * width);
+		stage_scale4x(SCDST(0), SCDST(1), SCDST(2), SCDST(3), SCMID(1), SCMID(2), SCMID(3), SCMID(4), pixel, width, simd);
 
 		dst = SCDST(4);
 		src = SCSRC(1);
@@ -241,8 +291,9 @@ static void scale4x_buf(void* void_dst, unsigned dst_slice, void* void_mid, unsi
  * @param pixel Bytes per pixel of the source and destination bitmap.
  * @param width Horizontal size in pixels of the source bitmap.
  * @param height Vertical size in pixels of the source bitmap.
+ * @param simd Use the SSE2 or NEON implementation for 16 and 32 bits pixels.
  */
-static void scale4x(void* void_dst, unsigned dst_slice, const void* void_src, unsigned src_slice, unsigned pixel, unsigned width, unsigned height) {
+static void scale4x(void* void_dst, unsigned dst_slice, const void* void_src, unsigned src_slice, unsigned pixel, unsigned width, unsigned height, bool simd) {
 	unsigned mid_slice;
 	void* mid;
 
@@ -250,6 +301,8 @@ static void scale4x(void* void_dst, unsigned dst_slice, const void* void_src, un
 
 	mid_slice = (mid_slice + 0x7) & ~0x7; /* align to 8 bytes */
 
+	mid_slice += 2 * SCALE4X_MID_MARGIN; /* room for the row borders */
+
 #if defined(HAVE_ALLOCA)
 	mid = alloca(6 * mid_slice); /* allocate space for 6 row buffers */
 
@@ -261,7 +314,7 @@ static void scale4x(void* void_dst, unsigned dst_slice, const void* void_src, un
 		return;
 #endif
 
-	scale4x_buf(void_dst, dst_slice, mid, mid_slice, void_src, src_slice, pixel, width, height);
+	scale4x_buf(void_dst, dst_slice, mid, mid_slice, void_src, src_slice, pixel, width, height, simd);
 
 #if !defined(HAVE_ALLOCA)
 	free(mid);
@@ -335,18 +388,19 @@ int scale_precondition(unsigned scale, unsigned pixel, unsigned width, unsigned
  * @param pixel Bytes per pixel of the source and destination bitmap.
  * @param width Horizontal size in pixels of the source bitmap.
  * @param height Vertical size in pixels of the source bitmap.
+ * @param simd Use the SSE2 or NEON implementation for 16 and 32 bits pixels.
  */
-void scale(unsigned scale, void* void_dst, unsigned dst_slice, const void* void_src, unsigned src_slice, unsigned pixel, unsigned width, unsigned height)
+void scale(unsigned scale, void* void_dst, unsigned dst_slice, const void* void_src, unsigned src_slice, unsigned pixel, unsigned width, unsigned height, bool simd)
 {
 	switch (scale) {
 	case 2:
-		scale2x(void_dst, dst_slice, void_src, src_slice, pixel, width, height);
+		scale2x(void_dst, dst_slice, void_src, src_slice, pixel, width, height, simd);
 		break;
 	case 3:
-		scale3x(void_dst, dst_slice, void_src, src_slice, pixel, width, height);
+		scale3x(void_dst, dst_slice, void_src, src_slice, pixel, width, height, simd);
 		break;
 	case 4:
-		scale4x(void_dst, dst_slice, void_src, src_slice, pixel, width, height);
+		scale4x(void_dst, dst_slice, void_src, src_slice, pixel, width, height, simd);
 		break;
 	default:
 		break;
@@ -356,9 +410,9 @@ void scale(unsigned scale, void* void_dst, unsigned dst_slice, const void* void_
 void AdvMameScaler::scaleIntern(const uint8 *srcPtr, uint32 srcPitch,
 							uint8 *dstPtr, uint32 dstPitch, int width, int height, int x, int y) {
 	if (_factor != 4)
-		::scale(_factor, dstPtr, dstPitch, srcPtr - srcPitch, srcPitch, _format.bytesPerPixel, width, height);
+		::scale(_factor, dstPtr, dstPitch, srcPtr - srcPitch, srcPitch, _format.bytesPerPixel, width, height, _useSimd);
 	else
-		::scale(_factor, dstPtr, dstPitch, srcPtr - srcPitch * 2, srcPitch, _format.bytesPerPixel, width, height);
+		::scale(_factor, dstPtr, dstPitch, srcPtr - srcPitch * 2, srcPitch, _format.bytesPerPixel, width, height, _useSimd);
 }
 
 uint AdvMameScaler::increaseFactor() {
@@ -382,6 +436,8 @@ public:
 
 	bool canDrawCursor() const override { return true; }
 	uint extraPixels() const override { return 4; }
+	bool isReentrant() const override { return true; }
+	bool hasSimd() const override { return true; }
 	const char *getName() const override;
 	const char *getPrettyName() const override;
 };
@@ -0,0 +1,42 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GRAPHICS_SCALER_SIMD_H
+#define GRAPHICS_SCALER_SIMD_H
+
+#include "common/scummsys.h"
+
+// SSE2 is part of the x86-64 baseline and NEON of the AArch64 one, so the
+// vectorized scaler kernels are built without any extra compiler flag and
+// are always usable on the CPUs the binary runs on.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SCALER_SIMD_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define SCALER_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+#if defined(SCALER_SIMD_SSE2) || defined(SCALER_SIMD_NEON)
+#define USE_SCALER_SIMD
+#endif
+
+#endif
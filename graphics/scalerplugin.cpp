@@ -19,6 +19,7 @@
  */
 
 #include "graphics/scalerplugin.h"
+#include "graphics/scaler/simd.h"
 
 namespace {
 /**
@@ -42,6 +43,14 @@ void Normal1x(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr, uint32 dstPit
 }
 } // End of anonymous namespace
 
+bool Scaler::hasSimdSupport() {
+#ifdef USE_SCALER_SIMD
+	return true;
+#else
+	return false;
+#endif
+}
+
 void Scaler::scale(const uint8 *srcPtr, uint32 srcPitch, uint8 *dstPtr,
 	                           uint32 dstPitch, int width, int height, int x, int y) {
 	if (_factor == 1) {
@@ -27,7 +27,7 @@
 
 class Scaler {
 public:
-	Scaler(const Graphics::PixelFormat &format) : _format(format) {}
+	Scaler(const Graphics::PixelFormat &format) : _format(format), _useSimd(hasSimdSupport()) {}
 	virtual ~Scaler() {}
 
 	/**
@@ -72,6 +72,24 @@ public:
 		return oldFactor;
 	}
 
+	/**
+	 * Enable or disable the vectorized code paths of the scaler, if it has
+	 * any for its pixel format. They are enabled by default whenever they
+	 * are supported, and produce the same output as the plain C++ code.
+	 *
+	 * @see ScalerPluginObject::hasSimd
+	 */
+	void setSimd(bool enable) { _useSimd = enable && hasSimdSupport(); }
+
+	/** Return whether the vectorized code paths are used. */
+	bool getSimd() const { return _useSimd; }
+
+	/**
+	 * Return whether vectorized scaler code (SSE2 or NEON) was built for
+	 * the CPU ScummVM runs on.
+	 */
+	static bool hasSimdSupport();
+
 	/**
 	 * Set the source to be used when scaling and copying to the old buffer.
 	 *
@@ -103,6 +121,7 @@ protected:
 
 	uint _factor;
 	Graphics::PixelFormat _format;
+	bool _useSimd;
 };
 
 /**
@@ -199,6 +218,23 @@ public:
 	 */
 	virtual bool useOldSource() const { return false; }
 
+	/**
+	 * Indicates whether an instance of this scaler can scale several rects
+	 * at the same time from different threads. Scalers which modify their
+	 * state while scaling, such as those using the old source, must not
+	 * return true. If it returns true, the backend can optionally split
+	 * large rects into bands which are scaled in parallel.
+	 */
+	virtual bool isReentrant() const { return false; }
+
+	/**
+	 * Indicates whether this scaler has vectorized code paths for 16 and
+	 * 32 bit pixel formats. They are used by the instances of the scaler
+	 * when Scaler::hasSimdSupport() returns true, unless disabled with
+	 * Scaler::setSimd().
+	 */
+	virtual bool hasSimd() const { return false; }
+
 protected:
 	Common::Array<uint> _factors;
 };
@@ -43,6 +43,7 @@ void Screen::update() {
 	mergeDirtyRects();
 
 	// Loop through copying dirty areas to the physical screen
+	_dirtyRegion.setSize(getOffsetFromOwner().x + this->w, getOffsetFromOwner().y + this->h);
 	Common::List<Common::Rect>::iterator i;
 	for (i = _dirtyRects.begin(); i != _dirtyRects.end(); ++i) {
 		const Common::Rect &r = *i;
@@ -53,6 +54,7 @@ void Screen::update() {
 
 	// Signal the physical screen to update
 	updateScreen();
+	_dirtyRegion.clear();
 	_dirtyRects.clear();
 }
 
@@ -66,35 +68,50 @@ void Screen::addDirtyRect(const Common::Rect &r) {
 	bounds.clip(getBounds());
 	bounds.translate(getOffsetFromOwner().x, getOffsetFromOwner().y);
 
-	if (bounds.width() > 0 && bounds.height() > 0)
-		_dirtyRects.push_back(bounds);
+	if (bounds.width() > 0 && bounds.height() > 0) {
+		_dirtyRegion.setSize(getOffsetFromOwner().x + this->w, getOffsetFromOwner().y + this->h);
+		_dirtyRegion.addRect(bounds);
+	}
+}
+
+bool Screen::isDirty(const Common::Rect &r) const {
+	if (_dirtyRegion.intersects(r))
+		return true;
+
+	for (Common::List<Common::Rect>::const_iterator i = _dirtyRects.begin(); i != _dirtyRects.end(); ++i) {
+		if (i->intersects(r))
+			return true;
+	}
+
+	return false;
 }
 
 void Screen::makeAllDirty() {
+	_dirtyRegion.clear();
 	_dirtyRects.clear();
 	addDirtyRect(Common::Rect(0, 0, this->w, this->h));
 }
 
 void Screen::mergeDirtyRects() {
-	Common::List<Common::Rect>::iterator rOuter, rInner;
-
-	// Process the dirty rect list to find any rects to merge
-	for (rOuter = _dirtyRects.begin(); rOuter != _dirtyRects.end(); ++rOuter) {
-		rInner = rOuter;
-		while (++rInner != _dirtyRects.end()) {
+	// Rects already in the list, from a previous merge or added directly
+	// by a subclass, are merged again with the new ones
+	_dirtyRegion.setSize(getOffsetFromOwner().x + this->w, getOffsetFromOwner().y + this->h);
+	Common::List<Common::Rect>::iterator i;
+	for (i = _dirtyRects.begin(); i != _dirtyRects.end(); ++i)
+		_dirtyRegion.addRect(*i);
+	_dirtyRects.clear();
 
-			if ((*rOuter).intersects(*rInner)) {
-				// These two rectangles overlap, so merge them
-				unionRectangle(*rOuter, *rOuter, *rInner);
+	if (_dirtyRegion.isEmpty())
+		return;
 
-				// remove the inner rect from the list
-				_dirtyRects.erase(rInner);
+	// Coalesce the dirty tiles. When they are too fragmented, this gives
+	// the whole screen
+	Common::Array<Common::Rect> rects;
+	_dirtyRegion.getRects(rects);
+	_dirtyRegion.clear();
 
-				// move back to beginning of list
-				rInner = rOuter;
-			}
-		}
-	}
+	for (uint j = 0; j < rects.size(); ++j)
+		_dirtyRects.push_back(rects[j]);
 }
 
 bool Screen::unionRectangle(Common::Rect &destRect, const Common::Rect &src1, const Common::Rect &src2) {
@@ -22,6 +22,7 @@
 #ifndef GRAPHICS_SCREEN_H
 #define GRAPHICS_SCREEN_H
 
+#include "graphics/dirty_region.h"
 #include "graphics/managed_surface.h"
 #include "graphics/pixelformat.h"
 #include "common/list.h"
@@ -50,12 +51,17 @@ namespace Graphics {
 class Screen : public ManagedSurface {
 protected:
 	/**
-	 * List of affected areas of the screen
+	 * Affected areas of the screen which have not been merged yet
+	 */
+	DirtyRegion _dirtyRegion;
+
+	/**
+	 * List of affected areas of the screen, filled when they are merged
 	 */
 	Common::List<Common::Rect> _dirtyRects;
 protected:
 	/**
-	 * Merges together overlapping dirty areas of the screen
+	 * Merges together the dirty areas of the screen into the dirty rects list
 	 */
 	void mergeDirtyRects();
 
@@ -71,7 +77,12 @@ public:
 	/**
 	 * Returns true if there are any pending screen updates (dirty areas)
 	 */
-	bool isDirty() const { return !_dirtyRects.empty(); }
+	bool isDirty() const { return !_dirtyRegion.isEmpty() || !_dirtyRects.empty(); }
+
+	/**
+	 * Returns true if a part of the given area may have pending screen updates
+	 */
+	bool isDirty(const Common::Rect &r) const;
 
 	/**
 	 * Marks the whole screen as dirty. This forces the next call to update
@@ -82,7 +93,10 @@ public:
 	/**
 	 * Clear the current dirty rects list
 	 */
-	virtual void clearDirtyRects() { _dirtyRects.clear(); }
+	virtual void clearDirtyRects() {
+		_dirtyRegion.clear();
+		_dirtyRects.clear();
+	}
 
 	/**
 	 * Adds a rectangle to the list of modified areas of the screen during the
@@ -21,6 +21,11 @@
 #include "graphics/svg.h"
 
 #include "common/endian.h"
+#include "common/hashmap.h"
+#include "common/list.h"
+#include "common/md5.h"
+#include "common/memstream.h"
+#include "common/singleton.h"
 #include "common/stream.h"
 #include "common/textconsole.h"
 #include "graphics/pixelformat.h"
@@ -37,6 +42,79 @@
 
 namespace Graphics {
 
+/**
+ * Renderings of SVG data, keyed by the size and the MD5 of the data. The
+ * surfaces are always in the same format, so it is not part of the key.
+ * When the cache grows too large, the oldest renderings are freed first.
+ */
+class SVGBitmapCache : public Common::Singleton<SVGBitmapCache> {
+public:
+	SVGBitmapCache() : _size(0) {}
+	~SVGBitmapCache() { clear(); }
+
+	bool lookup(const Common::String &key, ManagedSurface &dst) const;
+	void add(const Common::String &key, const ManagedSurface &src);
+	void clear();
+
+private:
+	// Total size of the renderings, with their keys and surface headers
+	static const uint kMaxSize = 8 * 1024 * 1024;
+
+	static uint entrySize(const Common::String &key, const Surface &surface);
+
+	typedef Common::HashMap<Common::String, Surface *> SurfaceMap;
+	SurfaceMap _surfaces;
+	Common::List<Common::String> _order;
+	uint _size;
+};
+
+bool SVGBitmapCache::lookup(const Common::String &key, ManagedSurface &dst) const {
+	SurfaceMap::const_iterator i = _surfaces.find(key);
+	if (i == _surfaces.end())
+		return false;
+
+	const Surface *src = i->_value;
+	dst.copyRectToSurface(*src, 0, 0, Common::Rect(src->w, src->h));
+	return true;
+}
+
+uint SVGBitmapCache::entrySize(const Common::String &key, const Surface &surface) {
+	// The key is held by both the map and the list
+	return surface.h * surface.w * surface.format.bytesPerPixel + sizeof(Surface) +
+	       2 * (sizeof(Common::String) + key.size() + 1);
+}
+
+void SVGBitmapCache::add(const Common::String &key, const ManagedSurface &src) {
+	const uint size = entrySize(key, src.rawSurface());
+	if (size > kMaxSize || _surfaces.contains(key))
+		return;
+
+	while (_size + size > kMaxSize) {
+		Surface *oldest = _surfaces[_order.front()];
+		_size -= entrySize(_order.front(), *oldest);
+		oldest->free();
+		delete oldest;
+		_surfaces.erase(_order.front());
+		_order.pop_front();
+	}
+
+	Surface *surface = new Surface();
+	surface->copyFrom(src.rawSurface());
+	_surfaces[key] = surface;
+	_order.push_back(key);
+	_size += size;
+}
+
+void SVGBitmapCache::clear() {
+	for (SurfaceMap::iterator i = _surfaces.begin(); i != _surfaces.end(); ++i) {
+		i->_value->free();
+		delete i->_value;
+	}
+	_surfaces.clear();
+	_order.clear();
+	_size = 0;
+}
+
 SVGBitmap::SVGBitmap(Common::SeekableReadStream *in, int dw, int dh)
 	: ManagedSurface(dw, dh, PIXELFORMAT) {
 	if (dw == 0 || dh == 0)
@@ -48,6 +126,14 @@ SVGBitmap::SVGBitmap(Common::SeekableReadStream *in, int dw, int dh)
 	in->read(data, size);
 	data[size] = '\0';
 
+	// The key is made before parsing, which modifies the data
+	Common::MemoryReadStream dataStream((const byte *)data, size);
+	Common::String key = Common::String::format("%dx%d:", dw, dh) + Common::computeStreamMD5AsString(dataStream);
+	if (SVGBitmapCache::instance().lookup(key, *this)) {
+		delete[] data;
+		return;
+	}
+
 	NSVGimage *svg = nsvgParse(data, "px", 96);
 	if (svg == NULL)
 		error("Cannot parse SVG image");
@@ -66,6 +152,16 @@ SVGBitmap::SVGBitmap(Common::SeekableReadStream *in, int dw, int dh)
 
 	nsvgDeleteRasterizer(rasterizer);
 	nsvgDelete(svg);
+
+	SVGBitmapCache::instance().add(key, *this);
+}
+
+void SVGBitmap::clearCache() {
+	SVGBitmapCache::destroy();
 }
 
 } // end of namespace Graphics
+
+namespace Common {
+DECLARE_SINGLETON(Graphics::SVGBitmapCache);
+} // End of namespace Common
@@ -31,10 +31,19 @@ namespace Graphics {
 
 /**
  * A derived graphics surface, which renders bitmap data from a SVG stream.
+ *
+ * The renderings are kept in a cache shared by the whole process, so
+ * rendering the same SVG data at the same size again only copies the
+ * pixels.
  */
 class SVGBitmap : public ManagedSurface {
 public:
 	SVGBitmap(Common::SeekableReadStream *in, int dw, int dh);
+
+	/**
+	 * Free the renderings kept in the cache.
+	 */
+	static void clearCache();
 };
 
 } // end of namespace Graphics
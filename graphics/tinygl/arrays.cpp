@@ -38,10 +38,11 @@
 
 namespace TinyGL {
 
-void GLContext::glopArrayElement(GLParam *param) {
+// Sets the current color, normal and texture coordinates from the arrays,
+// and returns whether the element has a vertex
+bool GLContext::gl_load_array_element(int idx, Vector4 &coord) {
 	int offset;
 	int states = client_states;
-	int idx = param[1].i;
 
 	if (states & COLOR_ARRAY) {
 		GLParam p[5];
@@ -194,88 +195,125 @@ void GLContext::glopArrayElement(GLParam *param) {
 		}
 	}
 	if (states & VERTEX_ARRAY) {
-		GLParam p[5];
 		int size = vertex_array_size;
 		offset = idx * vertex_array_stride;
 		switch (vertex_array_type) {
 		case TGL_FLOAT: {
 				TGLfloat *array = (TGLfloat *)((TGLbyte *)vertex_array + offset);
-				p[1].f = array[0];
-				p[2].f = array[1];
-				p[3].f = size > 2 ? array[2] : 0.0f;
-				p[4].f = size > 3 ? array[3] : 1.0f;
+				coord.X = array[0];
+				coord.Y = array[1];
+				coord.Z = size > 2 ? array[2] : 0.0f;
+				coord.W = size > 3 ? array[3] : 1.0f;
 				break;
 			}
 		case TGL_DOUBLE: {
 				TGLdouble *array = (TGLdouble *)((TGLbyte *)vertex_array + offset);
-				p[1].f = array[0];
-				p[2].f = array[1];
-				p[3].f = size > 2 ? array[2] : 0.0f;
-				p[4].f = size > 3 ? array[3] : 1.0f;
+				coord.X = array[0];
+				coord.Y = array[1];
+				coord.Z = size > 2 ? array[2] : 0.0f;
+				coord.W = size > 3 ? array[3] : 1.0f;
 				break;
 			}
 		case TGL_INT: {
 				TGLint *array = (TGLint *)((TGLbyte *)vertex_array + offset);
-				p[1].f = array[0];
-				p[2].f = array[1];
-				p[3].f = size > 2 ? array[2] : 0.0f;
-				p[4].f = size > 3 ? array[3] : 1.0f;
+				coord.X = array[0];
+				coord.Y = array[1];
+				coord.Z = size > 2 ? array[2] : 0.0f;
+				coord.W = size > 3 ? array[3] : 1.0f;
 				break;
 			}
 		case TGL_SHORT: {
 				TGLshort *array = (TGLshort *)((TGLbyte *)vertex_array + offset);
-				p[1].f = array[0];
-				p[2].f = array[1];
-				p[3].f = size > 2 ? array[2] : 0.0f;
-				p[4].f = size > 3 ? array[3] : 1.0f;
+				coord.X = array[0];
+				coord.Y = array[1];
+				coord.Z = size > 2 ? array[2] : 0.0f;
+				coord.W = size > 3 ? array[3] : 1.0f;
 				break;
 			}
 		default:
 			assert(0);
 		}
+		return true;
+	}
+	return false;
+}
+
+void GLContext::glopArrayElement(GLParam *param) {
+	Vector4 coord;
+
+	if (gl_load_array_element(param[1].i, coord)) {
+		GLParam p[5];
+		p[1].f = coord.X;
+		p[2].f = coord.Y;
+		p[3].f = coord.Z;
+		p[4].f = coord.W;
 		glopVertex(p);
 	}
 }
 
-void GLContext::glopDrawArrays(GLParam *p) {
+// Draws elements of the arrays, whose vertices are transformed all at once
+void GLContext::gl_draw_array_elements(int first, int count, const void *indices, int type) {
 	GLParam array_element[2];
+
+	// With lighting, the colors of the array may change the material of
+	// each vertex, which is then shaded as soon as it is given
+	const bool batch = (client_states & VERTEX_ARRAY) &&
+		!(lighting_enabled && color_material_enabled && (client_states & COLOR_ARRAY));
+
+	if (batch)
+		gl_reserve_vertices(count);
+	GLVertex *v = &vertex[vertex_n];
+
+	for (int i = 0; i < count; i++) {
+		int idx = first + i;
+		if (indices) {
+			switch (type) {
+			case TGL_UNSIGNED_BYTE:
+				idx = ((const TGLubyte *)indices)[i];
+				break;
+			case TGL_UNSIGNED_SHORT:
+				idx = ((const TGLushort *)indices)[i];
+				break;
+			case TGL_UNSIGNED_INT:
+				idx = ((const TGLuint *)indices)[i];
+				break;
+			default:
+				assert(0);
+				break;
+			}
+		}
+
+		if (batch) {
+			gl_load_array_element(idx, v[i].coord);
+			gl_init_vertex(&v[i]);
+		} else {
+			array_element[1].i = idx;
+			glopArrayElement(array_element);
+		}
+	}
+
+	if (batch) {
+		gl_transform_vertices(v, count);
+		vertex_n += count;
+		vertex_cnt += count;
+	}
+}
+
+void GLContext::glopDrawArrays(GLParam *p) {
 	GLParam begin[2];
 
 	begin[1].i = p[1].i;
 	glopBegin(begin);
-	for (int i = 0; i < p[3].i; i++) {
-		array_element[1].i = p[2].i + i;
-		glopArrayElement(array_element);
-	}
+	gl_draw_array_elements(p[2].i, p[3].i, nullptr, 0);
 	glopEnd(nullptr);
 }
 
 void GLContext::glopDrawElements(GLParam *p) {
-	GLParam array_element[2];
-	void *indices;
 	GLParam begin[2];
 
-	indices = (char *)p[4].p;
 	begin[1].i = p[1].i;
-
 	glopBegin(begin);
-	for (int i = 0; i < p[2].i; i++) {
-		switch (p[3].i) {
-		case TGL_UNSIGNED_BYTE:
-			array_element[1].i = ((TGLbyte *)indices)[i];
-			break;
-		case TGL_UNSIGNED_SHORT:
-			array_element[1].i = ((TGLshort *)indices)[i];
-			break;
-		case TGL_UNSIGNED_INT:
-			array_element[1].i = ((TGLint *)indices)[i];
-			break;
-		default:
-			assert(0);
-			break;
-		}
-		glopArrayElement(array_element);
-	}
+	gl_draw_array_elements(0, p[2].i, p[4].p, p[3].i);
 	glopEnd(nullptr);
 }
 
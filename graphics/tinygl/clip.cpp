@@ -399,7 +399,7 @@ void GLContext::gl_draw_triangle_fill(GLContext *c, GLVertex *p0, GLVertex *p1,
 		if (c->_profilingEnabled) {
 			count_triangles_textured++;
 		}
-		c->fb->setTexture(c->current_texture->images[0].pixmap, c->texture_wrap_s, c->texture_wrap_t);
+		c->fb->setTexture(c->selectTextureLevel(c->current_texture, &p0->zp, &p1->zp, &p2->zp), c->texture_wrap_s, c->texture_wrap_t);
 		if (c->current_shade_model == TGL_SMOOTH) {
 			c->fb->fillTriangleTextureMappingPerspectiveSmooth(&p0->zp, &p1->zp, &p2->zp);
 		} else {
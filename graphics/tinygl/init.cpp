@@ -138,7 +138,8 @@ void GLContext::endSharedState() {
 	GLSharedState *s = &shared_state;
 
 	for (int i = 0; i < MAX_DISPLAY_LISTS; i++) {
-		// TODO
+		if (s->lists[i])
+			delete_list(i);
 	}
 	gl_free(s->lists);
 
@@ -150,6 +151,7 @@ void GLContext::init(int screenW, int screenH, Graphics::PixelFormat pixelFormat
 	GLViewport *v;
 
 	_enableDirtyRectangles = dirtyRectsEnable;
+	_enableTiledRendering = false;
 	stencil_buffer_supported = enableStencilBuffer;
 
 	fb = new TinyGL::FrameBuffer(screenW, screenH, pixelFormat, enableStencilBuffer);
@@ -181,6 +183,7 @@ void GLContext::init(int screenW, int screenH, Graphics::PixelFormat pixelFormat
 	exec_flag = 1;
 	compile_flag = 0;
 	print_flag = 0;
+	current_list = nullptr;
 
 	in_begin = 0;
 
@@ -216,6 +219,7 @@ void GLContext::init(int screenW, int screenH, Graphics::PixelFormat pixelFormat
 	local_light_model = 0;
 	lighting_enabled = 0;
 	light_model_two_side = 0;
+	normalize_enabled = false;
 
 	// default materials */
 	for (int i = 0; i < 2; i++) {
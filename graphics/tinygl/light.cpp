@@ -309,10 +309,11 @@ void GLContext::gl_shade_vertex(GLVertex *v) {
 		B += att * lB;
 	}
 
-	v->color.X = clampf(current_color.X * R, 0, 1);
-	v->color.Y = clampf(current_color.Y * G, 0, 1);
-	v->color.Z = clampf(current_color.Z * B, 0, 1);
-	v->color.W = current_color.W * A;
+	// the color of the vertex is the current color when it was given
+	v->color.X = clampf(v->color.X * R, 0, 1);
+	v->color.Y = clampf(v->color.Y * G, 0, 1);
+	v->color.Z = clampf(v->color.Z * B, 0, 1);
+	v->color.W = v->color.W * A;
 }
 
 } // end of namespace TinyGL
@@ -68,6 +68,13 @@ void GLContext::delete_list(int list) {
 		pb = pb1;
 	}
 
+	GLVertexBatch *batch = l->first_batch;
+	while (batch) {
+		GLVertexBatch *next = batch->next;
+		delete batch;
+		batch = next;
+	}
+
 	gl_free(l);
 	shared_state.lists[list] = nullptr;
 }
@@ -117,6 +124,17 @@ void GLContext::gl_compile_op(GLParam *p) {
 	int index = current_op_buffer_index;
 	GLParamBuffer *ob = current_op_buffer;
 
+	// blocks of vertices are preceded by a VertexBatch opcode, filled
+	// in by gl_EndList() when the block can be compiled
+	if (op == OP_Begin) {
+		GLParam q[2];
+		q[0].op = OP_VertexBatch;
+		q[1].p = nullptr;
+		gl_compile_op(q);
+		index = current_op_buffer_index;
+		ob = current_op_buffer;
+	}
+
 	// we should be able to add a NextBuffer opcode
 	if ((index + op_size) > (OP_BUFFER_MAX_SIZE - 2)) {
 
@@ -164,6 +182,171 @@ void GLContext::glopNextBuffer(GLParam *) {
 	assert(0);
 }
 
+// this opcode is never called directly
+void GLContext::glopVertexBatch(GLParam *) {
+	assert(0);
+}
+
+void GLContext::gl_compile_vertex_batches(GLList *l) {
+	GLParam *p = l->first_op_buffer->ops;
+	GLVertexBatch *batch = nullptr;
+	GLParam *batch_op = nullptr;
+
+	while (1) {
+		int op = p[0].op;
+		if (op == OP_EndList)
+			break;
+		if (op == OP_NextBuffer) {
+			p = (GLParam *)p[1].p;
+			continue;
+		}
+
+		if (op == OP_VertexBatch) {
+			delete batch;
+			batch = new GLVertexBatch();
+			batch_op = p;
+		} else if (batch) {
+			// The attributes set inside of the block are recorded with
+			// each vertex. Those which are not set take the current state
+			// when the list is called, so they must not change after the
+			// first vertex.
+			const bool first_vertex = batch->vertices.empty();
+			bool compiled = true;
+
+			switch (op) {
+			case OP_Begin:
+				batch->begin_type = p[1].i;
+				break;
+			case OP_Color:
+				compiled = batch->has_color || first_vertex;
+				batch->has_color = true;
+				batch->color = Vector4(p[1].f, p[2].f, p[3].f, p[4].f);
+				break;
+			case OP_Normal:
+				compiled = batch->has_normal || first_vertex;
+				batch->has_normal = true;
+				batch->normal = Vector4(p[1].f, p[2].f, p[3].f, 0.0f);
+				break;
+			case OP_TexCoord:
+				compiled = batch->has_tex_coord || first_vertex;
+				batch->has_tex_coord = true;
+				batch->tex_coord = Vector4(p[1].f, p[2].f, p[3].f, p[4].f);
+				break;
+			case OP_EdgeFlag:
+				compiled = batch->has_edge_flag || first_vertex;
+				batch->has_edge_flag = true;
+				batch->edge_flag = p[1].i;
+				break;
+			case OP_Vertex: {
+				GLVertex v;
+				v.coord = Vector4(p[1].f, p[2].f, p[3].f, p[4].f);
+				v.normal = Vector3(batch->normal.X, batch->normal.Y, batch->normal.Z);
+				v.tex_coord = batch->tex_coord;
+				v.color = batch->color;
+				v.edge_flag = batch->edge_flag;
+				batch->vertices.push_back(v);
+				break;
+			}
+			case OP_End:
+				if (!batch->vertices.empty()) {
+					batch->next_op = p + op_table_size[op];
+					batch->next = l->first_batch;
+					l->first_batch = batch;
+					batch_op[1].p = batch;
+					batch = nullptr;
+				}
+				compiled = batch == nullptr;
+				break;
+			default:
+				compiled = false;
+				break;
+			}
+
+			if (!compiled) {
+				delete batch;
+				batch = nullptr;
+			}
+		}
+
+		p += op_table_size[op];
+	}
+
+	delete batch;
+}
+
+bool GLContext::gl_call_vertex_batch(GLVertexBatch *batch) {
+	// the colors would also change the material
+	if (batch->has_color && color_material_enabled)
+		return false;
+
+	GLParam begin[2];
+	begin[1].i = batch->begin_type;
+	glopBegin(begin);
+
+	const int count = batch->vertices.size();
+	gl_reserve_vertices(count);
+	GLVertex *v = &vertex[vertex_n];
+
+	// Without lighting nor fog, the transformed vertices only depend on
+	// the matrices, the viewport and the attributes which are not set by
+	// the list
+	const bool reusable = !lighting_enabled && !fog_enabled;
+	GLVertexBatchKey key = GLVertexBatchKey();
+	if (reusable) {
+		key.model_projection = matrix_model_projection;
+		if (texture_2d_enabled && apply_texture_matrix)
+			key.texture = *matrix_stack_ptr[2];
+		key.viewport_scale = viewport.scale;
+		key.viewport_trans = viewport.trans;
+		if (!batch->has_color)
+			key.color = current_color;
+		if (!batch->has_tex_coord && texture_2d_enabled)
+			key.tex_coord = current_tex_coord;
+		if (!batch->has_edge_flag)
+			key.edge_flag = current_edge_flag;
+		key.texture_2d_enabled = texture_2d_enabled;
+	}
+
+	if (reusable && !batch->transformed.empty() && !memcmp(&key, &batch->transformed_key, sizeof(key))) {
+		memcpy(v, &batch->transformed[0], count * sizeof(GLVertex));
+	} else {
+		for (int i = 0; i < count; i++) {
+			v[i] = batch->vertices[i];
+			if (!batch->has_color)
+				v[i].color = current_color;
+			if (!batch->has_normal)
+				v[i].normal = Vector3(current_normal.X, current_normal.Y, current_normal.Z);
+			if (!batch->has_tex_coord)
+				v[i].tex_coord = current_tex_coord;
+			if (!batch->has_edge_flag)
+				v[i].edge_flag = current_edge_flag;
+		}
+		gl_transform_vertices(v, count);
+
+		if (reusable) {
+			batch->transformed.resize(count);
+			memcpy(&batch->transformed[0], v, count * sizeof(GLVertex));
+			batch->transformed_key = key;
+		} else {
+			batch->transformed.clear();
+		}
+	}
+	vertex_n += count;
+	vertex_cnt += count;
+
+	if (batch->has_color)
+		current_color = batch->color;
+	if (batch->has_normal)
+		current_normal = batch->normal;
+	if (batch->has_tex_coord)
+		current_tex_coord = batch->tex_coord;
+	if (batch->has_edge_flag)
+		current_edge_flag = batch->edge_flag;
+
+	glopEnd(nullptr);
+	return true;
+}
+
 void GLContext::glopCallList(GLParam *p) {
 	uint list = p[1].ui;
 	GLList *l = find_list(list);
@@ -178,6 +361,12 @@ void GLContext::glopCallList(GLParam *p) {
 			break;
 		if (op == OP_NextBuffer) {
 			p = (GLParam *)p[1].p;
+		} else if (op == OP_VertexBatch) {
+			GLVertexBatch *batch = (GLVertexBatch *)p[1].p;
+			if (batch && gl_call_vertex_batch(batch))
+				p = batch->next_op;
+			else
+				p += op_table_size[op];
 		} else {
 			op_table_func[op](this, p);
 			p += op_table_size[op];
@@ -196,6 +385,7 @@ void GLContext::gl_NewList(TGLuint list, TGLenum mode) {
 
 	current_op_buffer = l->first_op_buffer;
 	current_op_buffer_index = 0;
+	current_list = l;
 
 	compile_flag = 1;
 	exec_flag = (mode == TGL_COMPILE_AND_EXECUTE);
@@ -209,6 +399,7 @@ void GLContext::gl_EndList() {
 	// end of list
 	p[0].op = OP_EndList;
 	gl_compile_op(p);
+	gl_compile_vertex_batches(current_list);
 
 	compile_flag = 0;
 	exec_flag = 1;
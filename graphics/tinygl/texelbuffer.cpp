@@ -29,12 +29,12 @@
 namespace TinyGL {
 
 #define ZB_POINT_ST_UNIT (1 << ZB_POINT_ST_FRAC_BITS)
-#define ZB_POINT_ST_FRAC_MASK (ZB_POINT_ST_UNIT - 1)
 
-TexelBuffer::TexelBuffer(uint width, uint height, uint textureSize) {
+TexelBuffer::TexelBuffer(uint width, uint height, uint textureSize, bool bilinear) {
 	assert(width);
 	assert(height);
 	assert(textureSize);
+	STATIC_ASSERT(kFracBits == ZB_POINT_ST_FRAC_BITS, texel_fraction_bits_mismatch);
 
 	_width = width;
 	_height = height;
@@ -42,161 +42,24 @@ TexelBuffer::TexelBuffer(uint width, uint height, uint textureSize) {
 	_fracTextureMask = _fracTextureUnit - 1;
 	_widthRatio = (float) width / textureSize;
 	_heightRatio = (float) height / textureSize;
-}
-
-static inline uint wrap(uint wrap_mode, int coord, uint _fracTextureUnit, uint _fracTextureMask) {
-	switch (wrap_mode) {
-	case TGL_MIRRORED_REPEAT:
-		if (coord & _fracTextureUnit)
-			return _fracTextureMask - (coord & _fracTextureMask);
-		return coord & _fracTextureMask;
-	case TGL_CLAMP_TO_EDGE:
-		if (coord < 0)
-			return 0;
-		if ((uint) coord > _fracTextureMask)
-			return _fracTextureMask;
-		return coord;
-	default:
-		// Fall through
-	case TGL_REPEAT:
-		return coord & _fracTextureMask;
-	}
-}
-
-void TexelBuffer::getARGBAt(
-	uint wrap_s, uint wrap_t,
-	int s, int t,
-	uint8 &a, uint8 &r, uint8 &g, uint8 &b
-) const {
-	uint x, y;
-	x = wrap(wrap_s, s, _fracTextureUnit, _fracTextureMask) * _widthRatio;
-	y = wrap(wrap_t, t, _fracTextureUnit, _fracTextureMask) * _heightRatio;
-	getARGBAt(
-		(x >> ZB_POINT_ST_FRAC_BITS) + (y >> ZB_POINT_ST_FRAC_BITS) * _width,
-		x & ZB_POINT_ST_FRAC_MASK, y & ZB_POINT_ST_FRAC_MASK,
-		a, r, g, b
-	);
-}
+	_bilinear = bilinear;
+	_tilesPerRow = (width + kTileMask) >> kTileShift;
 
-// Nearest: store texture in original size.
-class BaseNearestTexelBuffer : public TexelBuffer {
-public:
-	BaseNearestTexelBuffer(const byte *buf, const Graphics::PixelFormat &format, uint width, uint height, uint textureSize);
-	~BaseNearestTexelBuffer();
-
-protected:
-	byte *_buf;
-	Graphics::PixelFormat _format;
-};
-
-BaseNearestTexelBuffer::BaseNearestTexelBuffer(const byte *buf, const Graphics::PixelFormat &format, uint width, uint height, uint textureSize) : TexelBuffer(width, height, textureSize), _format(format) {
-	uint count = _width * _height * _format.bytesPerPixel;
-	_buf = (byte *)gl_malloc(count);
-	memcpy(_buf, buf, count);
+	const uint tileRows = (height + kTileMask) >> kTileShift;
+	const uint texelSize = bilinear ? 4 : 1;
+	_texels = (uint32 *)gl_zalloc((_tilesPerRow * tileRows << (2 * kTileShift)) * texelSize * sizeof(uint32));
 }
 
-BaseNearestTexelBuffer::~BaseNearestTexelBuffer() {
-	gl_free(_buf);
-}
-
-template<uint Format, uint Type>
-class NearestTexelBuffer final : public BaseNearestTexelBuffer {
-public:
-	NearestTexelBuffer(const byte *buf, const Graphics::PixelFormat &format, uint width, uint height, uint textureSize)
-	  : BaseNearestTexelBuffer(buf, format, width, height, textureSize) {}
-
-protected:
-	void getARGBAt(
-		uint pixel,
-		uint, uint,
-		uint8 &a, uint8 &r, uint8 &g, uint8 &b
-	) const override {
-		Pixel col = *(((const Pixel *)_buf) + pixel);
-		_format.colorToARGBT<ColorMask>(col, a, r, g, b);
-	}
-
-	typedef ColorMasks<Format, Type> ColorMask;
-	typedef typename ColorMask::PixelType Pixel;
-};
-
-template<>
-class NearestTexelBuffer<TGL_RGB, TGL_UNSIGNED_BYTE> final : public BaseNearestTexelBuffer {
-public:
-	NearestTexelBuffer(const byte *buf, const Graphics::PixelFormat &format, uint width, uint height, uint textureSize)
-	  : BaseNearestTexelBuffer(buf, format, width, height, textureSize) {}
-
-protected:
-	void getARGBAt(
-		uint pixel,
-		uint, uint,
-		uint8 &a, uint8 &r, uint8 &g, uint8 &b
-	) const override {
-		byte *col = _buf + (pixel * 3);
-		a = 0xff;
-		r = col[0];
-		g = col[1];
-		b = col[2];
-	}
-};
-
-TexelBuffer *createNearestTexelBuffer(const byte *buf, const Graphics::PixelFormat &pf, uint format, uint type, uint width, uint height, uint textureSize) {
-	if (format == TGL_RGBA && type == TGL_UNSIGNED_BYTE) {
-		return new NearestTexelBuffer<TGL_RGBA, TGL_UNSIGNED_BYTE>(
-			buf, pf,
-			width, height,
-			textureSize
-		);
-	} else if (format == TGL_RGB && type == TGL_UNSIGNED_BYTE) {
-		return new NearestTexelBuffer<TGL_RGB,  TGL_UNSIGNED_BYTE>(
-			buf, pf,
-			width, height,
-			textureSize
-		);
-	} else if (format == TGL_RGB && type == TGL_UNSIGNED_SHORT_5_6_5) {
-		return new NearestTexelBuffer<TGL_RGB,  TGL_UNSIGNED_SHORT_5_6_5>(
-			buf, pf,
-			width, height,
-			textureSize
-		);
-	} else if (format == TGL_RGBA && type == TGL_UNSIGNED_SHORT_5_5_5_1) {
-		return new NearestTexelBuffer<TGL_RGBA, TGL_UNSIGNED_SHORT_5_5_5_1>(
-			buf, pf,
-			width, height,
-			textureSize
-		);
-	} else if (format == TGL_RGBA && type == TGL_UNSIGNED_SHORT_4_4_4_4) {
-		return new NearestTexelBuffer<TGL_RGBA, TGL_UNSIGNED_SHORT_4_4_4_4>(
-			buf, pf,
-			width, height,
-			textureSize
-		);
-	} else {
-		error("TinyGL texture: format 0x%04x and type 0x%04x combination not supported", format, type);
-	}
+TexelBuffer::~TexelBuffer() {
+	gl_free(_texels);
 }
 
-// Bilinear: each texture coordinates corresponds to the 4 original image
-// pixels linear interpolation has to work on, so that they are near each
-// other in CPU data cache, and a single actual memory fetch happens. This
-// allows applying linear filtering at render time at a very low performance
-// cost. As we expect to work on small-ish textures (512*512 ?) the 4x memory
-// usage increase should be negligible.
-class BilinearTexelBuffer : public TexelBuffer {
-public:
-	BilinearTexelBuffer(byte *buf, const Graphics::PixelFormat &format, uint width, uint height, uint textureSize);
-	~BilinearTexelBuffer();
-
-protected:
-	void getARGBAt(
-		uint pixel,
-		uint ds, uint dt,
-		uint8 &a, uint8 &r, uint8 &g, uint8 &b
-	) const override;
-
-private:
-	uint32 *_texels;
-};
-
+// Bilinear: each texel holds the 4 original image pixels linear
+// interpolation has to work on, so that they are near each other in CPU
+// data cache, and a single actual memory fetch happens. This allows applying
+// linear filtering at render time at a very low performance cost. As we
+// expect to work on small-ish textures (512*512 ?) the 4x memory usage
+// increase should be negligible.
 #define A_OFFSET (0 * 4)
 #define R_OFFSET (1 * 4)
 #define G_OFFSET (2 * 4)
@@ -205,79 +68,94 @@ private:
 #define P01_OFFSET 1
 #define P10_OFFSET 2
 #define P11_OFFSET 3
-#define PIXEL_PER_TEXEL_SHIFT 2
 
-BilinearTexelBuffer::BilinearTexelBuffer(byte *buf, const Graphics::PixelFormat &format, uint width, uint height, uint textureSize) : TexelBuffer(width, height, textureSize) {
-	const Graphics::PixelBuffer src(format, buf);
+static inline void setBilinearPixel(uint8 *texel8, int offset, uint32 col) {
+	texel8[offset + A_OFFSET] = col >> 24;
+	texel8[offset + R_OFFSET] = col >> 16;
+	texel8[offset + G_OFFSET] = col >> 8;
+	texel8[offset + B_OFFSET] = col;
+}
 
-	uint pixel00_offset = 0, pixel11_offset, pixel01_offset, pixel10_offset;
-	uint8 *texel8;
-	uint32 *texel32;
+TexelBuffer *TexelBuffer::create(const uint32 *argb, uint width, uint height, uint textureSize, bool bilinear) {
+	TexelBuffer *buffer = new TexelBuffer(width, height, textureSize, bilinear);
+
+	for (uint y = 0; y < height; y++) {
+		const uint32 *row = argb + y * width;
+		// the pixels after the last row and column are the ones of the last
+		// row and column
+		const uint32 *nextRow = (y + 1 == height) ? row : row + width;
+		for (uint x = 0; x < width; x++) {
+			const uint texel = buffer->getTexelIndex(x, y);
+			if (!bilinear) {
+				buffer->_texels[texel] = row[x];
+				continue;
+			}
+
+			const uint nextX = (x + 1 == width) ? x : x + 1;
+			uint8 *texel8 = (uint8 *)(buffer->_texels + texel);
+			setBilinearPixel(texel8, P00_OFFSET, row[x]);
+			setBilinearPixel(texel8, P01_OFFSET, row[nextX]);
+			setBilinearPixel(texel8, P10_OFFSET, nextRow[x]);
+			setBilinearPixel(texel8, P11_OFFSET, nextRow[nextX]);
+		}
+	}
 
-	texel32 = _texels = (uint32 *)gl_malloc((_width * _height << PIXEL_PER_TEXEL_SHIFT) * sizeof(uint32));
+	return buffer;
+}
+
+TexelBuffer *TexelBuffer::createMipmap() const {
+	if (_width == 1 && _height == 1)
+		return nullptr;
+
+	// The texels of this level, in ARGB, which are the top left pixels of the
+	// bilinear texels
+	Common::Array<uint32> src(_width * _height);
 	for (uint y = 0; y < _height; y++) {
 		for (uint x = 0; x < _width; x++) {
-			texel8 = (uint8 *)texel32;
-			pixel11_offset = pixel00_offset + _width + 1;
-			src.getARGBAt(
-				pixel00_offset,
-				*(texel8 + P00_OFFSET + A_OFFSET),
-				*(texel8 + P00_OFFSET + R_OFFSET),
-				*(texel8 + P00_OFFSET + G_OFFSET),
-				*(texel8 + P00_OFFSET + B_OFFSET)
-			);
-			if ((x + 1) == _width) {
-				pixel11_offset -= 1;
-				pixel01_offset = pixel00_offset;
-			} else
-				pixel01_offset = pixel00_offset + 1;
-			src.getARGBAt(
-				pixel01_offset,
-				*(texel8 + P01_OFFSET + A_OFFSET),
-				*(texel8 + P01_OFFSET + R_OFFSET),
-				*(texel8 + P01_OFFSET + G_OFFSET),
-				*(texel8 + P01_OFFSET + B_OFFSET)
-			);
-			if ((y + 1) == _height) {
-				pixel11_offset -= _width;
-				pixel10_offset = pixel00_offset;
-			} else
-				pixel10_offset = pixel00_offset + _width;
-			src.getARGBAt(
-				pixel10_offset,
-				*(texel8 + P10_OFFSET + A_OFFSET),
-				*(texel8 + P10_OFFSET + R_OFFSET),
-				*(texel8 + P10_OFFSET + G_OFFSET),
-				*(texel8 + P10_OFFSET + B_OFFSET)
-			);
-			src.getARGBAt(
-				pixel11_offset,
-				*(texel8 + P11_OFFSET + A_OFFSET),
-				*(texel8 + P11_OFFSET + R_OFFSET),
-				*(texel8 + P11_OFFSET + G_OFFSET),
-				*(texel8 + P11_OFFSET + B_OFFSET)
-			);
-			texel32 += 1 << PIXEL_PER_TEXEL_SHIFT;
-			pixel00_offset++;
+			const uint texel = getTexelIndex(x, y);
+			if (!_bilinear) {
+				src[y * _width + x] = _texels[texel];
+			} else {
+				const uint8 *texel8 = (const uint8 *)(_texels + texel);
+				src[y * _width + x] = (texel8[P00_OFFSET + A_OFFSET] << 24) | (texel8[P00_OFFSET + R_OFFSET] << 16) |
+				                      (texel8[P00_OFFSET + G_OFFSET] << 8) | texel8[P00_OFFSET + B_OFFSET];
+			}
 		}
 	}
-}
 
-BilinearTexelBuffer::~BilinearTexelBuffer() {
-	gl_free(_texels);
+	const uint width = MAX<uint>(_width / 2, 1);
+	const uint height = MAX<uint>(_height / 2, 1);
+	Common::Array<uint32> dst(width * height);
+	for (uint y = 0; y < height; y++) {
+		const uint32 *row0 = &src[MIN(2 * y, _height - 1) * _width];
+		const uint32 *row1 = &src[MIN(2 * y + 1, _height - 1) * _width];
+		for (uint x = 0; x < width; x++) {
+			const uint x0 = MIN(2 * x, _width - 1);
+			const uint x1 = MIN(2 * x + 1, _width - 1);
+			uint32 col = 0;
+			for (int shift = 0; shift < 32; shift += 8) {
+				const uint sum = ((row0[x0] >> shift) & 0xff) + ((row0[x1] >> shift) & 0xff) +
+				                 ((row1[x0] >> shift) & 0xff) + ((row1[x1] >> shift) & 0xff);
+				col |= ((sum + 2) >> 2) << shift;
+			}
+			dst[y * width + x] = col;
+		}
+	}
+
+	return create(&dst[0], width, height, _fracTextureUnit >> ZB_POINT_ST_FRAC_BITS, _bilinear);
 }
 
 static inline int interpolate(int v00, int v01, int v10, int xf, int yf) {
 	return v00 + (((v01 - v00) * xf + (v10 - v00) * yf) >> ZB_POINT_ST_FRAC_BITS);
 }
 
-void BilinearTexelBuffer::getARGBAt(
-	uint pixel,
+void TexelBuffer::getBilinearARGBAt(
+	uint texel,
 	uint ds, uint dt,
 	uint8 &a, uint8 &r, uint8 &g, uint8 &b
 ) const {
 	uint p00_offset, p01_offset, p10_offset;
-	uint8 *texel = (uint8 *)(_texels + (pixel << PIXEL_PER_TEXEL_SHIFT));
+	const uint8 *texel8 = (const uint8 *)(_texels + texel);
 	if ((ds + dt) > ZB_POINT_ST_UNIT) {
 		p00_offset = P11_OFFSET;
 		p10_offset = P01_OFFSET;
@@ -290,41 +168,85 @@ void BilinearTexelBuffer::getARGBAt(
 		p01_offset = P01_OFFSET;
 	}
 	a = interpolate(
-		*(texel + p00_offset + A_OFFSET),
-		*(texel + p01_offset + A_OFFSET),
-		*(texel + p10_offset + A_OFFSET),
+		*(texel8 + p00_offset + A_OFFSET),
+		*(texel8 + p01_offset + A_OFFSET),
+		*(texel8 + p10_offset + A_OFFSET),
 		ds,
 		dt
 	);
 	r = interpolate(
-		*(texel + p00_offset + R_OFFSET),
-		*(texel + p01_offset + R_OFFSET),
-		*(texel + p10_offset + R_OFFSET),
+		*(texel8 + p00_offset + R_OFFSET),
+		*(texel8 + p01_offset + R_OFFSET),
+		*(texel8 + p10_offset + R_OFFSET),
 		ds,
 		dt
 	);
 	g = interpolate(
-		*(texel + p00_offset + G_OFFSET),
-		*(texel + p01_offset + G_OFFSET),
-		*(texel + p10_offset + G_OFFSET),
+		*(texel8 + p00_offset + G_OFFSET),
+		*(texel8 + p01_offset + G_OFFSET),
+		*(texel8 + p10_offset + G_OFFSET),
 		ds,
 		dt
 	);
 	b = interpolate(
-		*(texel + p00_offset + B_OFFSET),
-		*(texel + p01_offset + B_OFFSET),
-		*(texel + p10_offset + B_OFFSET),
+		*(texel8 + p00_offset + B_OFFSET),
+		*(texel8 + p01_offset + B_OFFSET),
+		*(texel8 + p10_offset + B_OFFSET),
 		ds,
 		dt
 	);
 }
 
+// Nearest: the texels are converted the same way as they were read before
+// they were stored in ARGB.
+template<uint Format, uint Type>
+static void convertTexels(const byte *buf, const Graphics::PixelFormat &format, uint count, uint32 *argb) {
+	typedef ColorMasks<Format, Type> ColorMask;
+	typedef typename ColorMask::PixelType Pixel;
+
+	const Pixel *src = (const Pixel *)buf;
+	for (uint i = 0; i < count; i++) {
+		uint8 a, r, g, b;
+		format.colorToARGBT<ColorMask>(src[i], a, r, g, b);
+		argb[i] = (a << 24) | (r << 16) | (g << 8) | b;
+	}
+}
+
+template<>
+void convertTexels<TGL_RGB, TGL_UNSIGNED_BYTE>(const byte *buf, const Graphics::PixelFormat &format, uint count, uint32 *argb) {
+	for (uint i = 0; i < count; i++) {
+		const byte *col = buf + i * 3;
+		argb[i] = (0xff << 24) | (col[0] << 16) | (col[1] << 8) | col[2];
+	}
+}
+
+TexelBuffer *createNearestTexelBuffer(const byte *buf, const Graphics::PixelFormat &pf, uint format, uint type, uint width, uint height, uint textureSize) {
+	Common::Array<uint32> argb(width * height);
+	if (format == TGL_RGBA && type == TGL_UNSIGNED_BYTE) {
+		convertTexels<TGL_RGBA, TGL_UNSIGNED_BYTE>(buf, pf, argb.size(), &argb[0]);
+	} else if (format == TGL_RGB && type == TGL_UNSIGNED_BYTE) {
+		convertTexels<TGL_RGB,  TGL_UNSIGNED_BYTE>(buf, pf, argb.size(), &argb[0]);
+	} else if (format == TGL_RGB && type == TGL_UNSIGNED_SHORT_5_6_5) {
+		convertTexels<TGL_RGB,  TGL_UNSIGNED_SHORT_5_6_5>(buf, pf, argb.size(), &argb[0]);
+	} else if (format == TGL_RGBA && type == TGL_UNSIGNED_SHORT_5_5_5_1) {
+		convertTexels<TGL_RGBA, TGL_UNSIGNED_SHORT_5_5_5_1>(buf, pf, argb.size(), &argb[0]);
+	} else if (format == TGL_RGBA && type == TGL_UNSIGNED_SHORT_4_4_4_4) {
+		convertTexels<TGL_RGBA, TGL_UNSIGNED_SHORT_4_4_4_4>(buf, pf, argb.size(), &argb[0]);
+	} else {
+		error("TinyGL texture: format 0x%04x and type 0x%04x combination not supported", format, type);
+	}
+	return TexelBuffer::create(&argb[0], width, height, textureSize, false);
+}
+
 TexelBuffer *createBilinearTexelBuffer(byte *buf, const Graphics::PixelFormat &pf, uint format, uint type, uint width, uint height, uint textureSize) {
-	return new BilinearTexelBuffer(
-		buf, pf,
-		width, height,
-		textureSize
-	);
+	const Graphics::PixelBuffer src(pf, buf);
+	Common::Array<uint32> argb(width * height);
+	for (uint i = 0; i < argb.size(); i++) {
+		uint8 a, r, g, b;
+		src.getARGBAt(i, a, r, g, b);
+		argb[i] = (a << 24) | (r << 16) | (g << 8) | b;
+	}
+	return TexelBuffer::create(&argb[0], width, height, textureSize, true);
 }
 
 } // end of namespace TinyGL
@@ -23,28 +23,95 @@
 #define GRAPHICS_TEXELBUFFER_H
 
 #include "graphics/pixelformat.h"
+#include "graphics/tinygl/gl.h"
 
 namespace TinyGL {
 
+/**
+ * The texels of a texture, converted to 32-bit ARGB when the texture is
+ * loaded, so that reading them is a direct access.
+ *
+ * The texels are stored in tiles of 4x4 texels, so that the texels used for
+ * neighbour pixels are close to each other in memory whatever the
+ * orientation of the texture on screen. With bilinear filtering, each texel
+ * also holds its right, bottom and bottom right neighbours.
+ */
 class TexelBuffer {
 public:
-	TexelBuffer(uint width, uint height, uint textureSize);
-	virtual ~TexelBuffer() {};
+	~TexelBuffer();
+
+	/** Same as ZB_POINT_ST_FRAC_BITS */
+	static const uint kFracBits = 14;
 
-	void getARGBAt(
+	uint getWidth() const { return _width; }
+	uint getHeight() const { return _height; }
+
+	inline void getARGBAt(
 		uint wrap_s, uint wrap_t,
 		int s, int t,
 		uint8 &a, uint8 &r, uint8 &g, uint8 &b
-	) const;
+	) const {
+		const uint x = wrap(wrap_s, s) * _widthRatio;
+		const uint y = wrap(wrap_t, t) * _heightRatio;
+		const uint texel = getTexelIndex(x >> kFracBits, y >> kFracBits);
+		if (!_bilinear) {
+			const uint32 col = _texels[texel];
+			a = col >> 24;
+			r = col >> 16;
+			g = col >> 8;
+			b = col;
+		} else {
+			getBilinearARGBAt(texel, x & ((1 << kFracBits) - 1), y & ((1 << kFracBits) - 1), a, r, g, b);
+		}
+	}
+
+	/**
+	 * Creates the next mipmap level of the texture: half of its size, each
+	 * texel being the average of four texels of this level. Returns nullptr
+	 * if the texture is only one texel large.
+	 */
+	TexelBuffer *createMipmap() const;
+
+	static TexelBuffer *create(const uint32 *argb, uint width, uint height, uint textureSize, bool bilinear);
+
+private:
+	TexelBuffer(uint width, uint height, uint textureSize, bool bilinear);
+
+	inline uint wrap(uint wrapMode, int coord) const {
+		switch (wrapMode) {
+		case TGL_MIRRORED_REPEAT:
+			if (coord & _fracTextureUnit)
+				return _fracTextureMask - (coord & _fracTextureMask);
+			return coord & _fracTextureMask;
+		case TGL_CLAMP_TO_EDGE:
+			if (coord < 0)
+				return 0;
+			if ((uint) coord > _fracTextureMask)
+				return _fracTextureMask;
+			return coord;
+		default:
+			// Fall through
+		case TGL_REPEAT:
+			return coord & _fracTextureMask;
+		}
+	}
+
+	inline uint getTexelIndex(uint x, uint y) const {
+		const uint index = ((((y >> kTileShift) * _tilesPerRow + (x >> kTileShift)) << kTileShift) + (y & kTileMask)) << kTileShift;
+		return (index + (x & kTileMask)) << (_bilinear ? 2 : 0);
+	}
+
+	void getBilinearARGBAt(uint texel, uint ds, uint dt, uint8 &a, uint8 &r, uint8 &g, uint8 &b) const;
+
+	/** Tiles of 4x4 texels */
+	static const uint kTileShift = 2;
+	static const uint kTileMask = (1 << kTileShift) - 1;
 
-protected:
-	virtual void getARGBAt(
-		uint pixel,
-		uint ds, uint dt,
-		uint8 &a, uint8 &r, uint8 &g, uint8 &b
-	) const = 0;
 	uint _width, _height, _fracTextureUnit, _fracTextureMask;
 	float _widthRatio, _heightRatio;
+	uint _tilesPerRow;
+	bool _bilinear;
+	uint32 *_texels;
 };
 
 TexelBuffer *createNearestTexelBuffer(const byte *buf, const Graphics::PixelFormat &pf, uint format, uint type, uint width, uint height, uint textureSize);
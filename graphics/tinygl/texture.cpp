@@ -177,6 +177,68 @@ void GLContext::glopTexImage2D(GLParam *p) {
 			break;
 		}
 	}
+
+	if (level == 0)
+		updateMipmaps(current_texture, true);
+}
+
+static bool isMipmapFilter(int filter) {
+	switch (filter) {
+	case TGL_LINEAR_MIPMAP_NEAREST:
+	case TGL_LINEAR_MIPMAP_LINEAR:
+	case TGL_NEAREST_MIPMAP_NEAREST:
+	case TGL_NEAREST_MIPMAP_LINEAR:
+		return true;
+	default:
+		return false;
+	}
+}
+
+void GLContext::updateMipmaps(GLTexture *t, bool rebuild) {
+	// The other levels are generated from the first one, when the game
+	// asked for this texture to be minified with mipmaps
+	bool mipmaps = isMipmapFilter(t->min_filter) && t->images[0].pixmap != nullptr;
+	if (mipmaps == (t->images[1].pixmap != nullptr) && !rebuild)
+		return;
+
+	t->versionNumber++;
+	for (int i = 1; i < MAX_TEXTURE_LEVELS; i++) {
+		GLImage *mipmap = &t->images[i];
+		delete mipmap->pixmap;
+		mipmap->pixmap = nullptr;
+		if (mipmaps) {
+			mipmap->pixmap = t->images[i - 1].pixmap->createMipmap();
+			mipmap->xsize = _textureSize;
+			mipmap->ysize = _textureSize;
+			mipmaps = mipmap->pixmap != nullptr;
+		}
+	}
+}
+
+const TexelBuffer *GLContext::selectTextureLevel(const GLTexture *t, const ZBufferPoint *p0, const ZBufferPoint *p1, const ZBufferPoint *p2) {
+	const TexelBuffer *texture = t->images[0].pixmap;
+	if (!isMipmapFilter(t->min_filter) || !t->images[1].pixmap)
+		return texture;
+
+	// The level is the one whose texels are closest to the size of the
+	// pixels, from the ratio of the areas of the triangle in texels and on
+	// screen: level n is used from a ratio of 2 * 4^(n - 1)
+	const float sScale = (float)texture->getWidth() / (_textureSize << ZB_POINT_ST_FRAC_BITS);
+	const float tScale = (float)texture->getHeight() / (_textureSize << ZB_POINT_ST_FRAC_BITS);
+	const float ds1 = (p1->s - p0->s) * sScale, dt1 = (p1->t - p0->t) * tScale;
+	const float ds2 = (p2->s - p0->s) * sScale, dt2 = (p2->t - p0->t) * tScale;
+	const float texelArea = ABS(ds1 * dt2 - ds2 * dt1);
+	const float pixelArea = ABS((float)(p1->x - p0->x) * (p2->y - p0->y) - (float)(p2->x - p0->x) * (p1->y - p0->y));
+	if (pixelArea == 0)
+		return texture;
+
+	const float ratio = texelArea / pixelArea;
+	float threshold = 2.0f;
+	for (int i = 1; i < MAX_TEXTURE_LEVELS && t->images[i].pixmap && ratio >= threshold; i++) {
+		texture = t->images[i].pixmap;
+		threshold *= 4.0f;
+	}
+	return texture;
 }
 
 // TODO: not all tests are done
@@ -234,6 +296,8 @@ error:
 		case TGL_NEAREST:
 		case TGL_LINEAR:
 			texture_min_filter = param;
+			current_texture->min_filter = param;
+			updateMipmaps(current_texture, false);
 			break;
 		default:
 			goto error;
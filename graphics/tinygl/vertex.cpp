@@ -27,9 +27,85 @@
 
 #include "graphics/tinygl/zgl.h"
 #include "graphics/tinygl/zdirtyrect.h"
+#include "graphics/scaler/simd.h"
 
 namespace TinyGL {
 
+// Matrix used to transform a batch of vertices. With SSE2 or NEON, the
+// columns of the matrix stay in vector registers, and the products are
+// summed in the same order as Matrix4 does. The result is then the same as
+// the one of Matrix4, unless the compiler fuses the multiplications and
+// additions of Matrix4 into FMA instructions, as GCC does by default when
+// targeting AArch64. The vector products and sums are never fused.
+class VertexMatrix {
+public:
+	VertexMatrix(const Matrix4 &m) {
+#if defined(USE_SCALER_SIMD)
+		for (int i = 0; i < 4; i++) {
+			const float column[4] = { m._m[0][i], m._m[1][i], m._m[2][i], m._m[3][i] };
+			_columns[i] = load(column);
+		}
+#else
+		_m = m;
+#endif
+	}
+
+	// W is assumed to be 1
+	void transform3x4(const Vector4 &in, Vector4 &out) const {
+#if defined(USE_SCALER_SIMD)
+		store(out._v, add(mulAdd(mulAdd(mul(_columns[0], in.X), _columns[1], in.Y), _columns[2], in.Z), _columns[3]));
+#else
+		const Vector4 vector = in;
+		_m.transform3x4(vector, out);
+#endif
+	}
+
+	void transform(const Vector4 &in, Vector4 &out) const {
+#if defined(USE_SCALER_SIMD)
+		store(out._v, mulAdd(mulAdd(mulAdd(mul(_columns[0], in.X), _columns[1], in.Y), _columns[2], in.Z), _columns[3], in.W));
+#else
+		const Vector4 vector = in;
+		_m.transform(vector, out);
+#endif
+	}
+
+	void transform3x3(const Vector3 &in, Vector3 &out) const {
+#if defined(USE_SCALER_SIMD)
+		float result[4];
+		store(result, mulAdd(mulAdd(mul(_columns[0], in.X), _columns[1], in.Y), _columns[2], in.Z));
+		out = Vector3(result[0], result[1], result[2]);
+#else
+		const Vector3 vector = in;
+		_m.transform3x3(vector, out);
+#endif
+	}
+
+private:
+#if defined(SCALER_SIMD_SSE2)
+	typedef __m128 Column;
+
+	static Column load(const float *f) { return _mm_loadu_ps(f); }
+	static void store(float *f, Column v) { _mm_storeu_ps(f, v); }
+	static Column add(Column a, Column b) { return _mm_add_ps(a, b); }
+	static Column mul(Column a, float f) { return _mm_mul_ps(a, _mm_set1_ps(f)); }
+#elif defined(SCALER_SIMD_NEON)
+	typedef float32x4_t Column;
+
+	static Column load(const float *f) { return vld1q_f32(f); }
+	static void store(float *f, Column v) { vst1q_f32(f, v); }
+	static Column add(Column a, Column b) { return vaddq_f32(a, b); }
+	static Column mul(Column a, float f) { return vmulq_n_f32(a, f); }
+#endif
+
+#if defined(USE_SCALER_SIMD)
+	static Column mulAdd(Column sum, Column a, float f) { return add(sum, mul(a, f)); }
+
+	Column _columns[4];
+#else
+	Matrix4 _m;
+#endif
+};
+
 void GLContext::glopNormal(GLParam *p) {
 	current_normal.X = p[1].f;
 	current_normal.Y = p[2].f;
@@ -152,106 +228,108 @@ void GLContext::glopBegin(GLParam *p) {
 	}
 }
 
-// coords, tranformation, clip code and projection
-// TODO : handle all cases
-void GLContext::gl_vertex_transform(GLVertex *v) {
-	Matrix4 *m;
+void GLContext::gl_init_vertex(GLVertex *v) {
+	v->normal.X = current_normal.X;
+	v->normal.Y = current_normal.Y;
+	v->normal.Z = current_normal.Z;
+	v->tex_coord = current_tex_coord;
+	v->color = current_color;
+	v->edge_flag = current_edge_flag;
+}
+
+void GLContext::gl_reserve_vertices(int count) {
+	// quick fix to avoid crashes on large polygons
+	if (vertex_n + count > vertex_max) {
+		GLVertex *newarray;
+		while (vertex_n + count > vertex_max)
+			vertex_max <<= 1;    // just double size
+		newarray = (GLVertex *)gl_realloc(vertex, sizeof(GLVertex) * vertex_max);
+		if (!newarray) {
+			error("unable to allocate GLVertex array.");
+		}
+		vertex = newarray;
+	}
+}
 
+// coords, tranformation, clip code, color and projection of vertices whose
+// object coordinates, normal, texture coordinates and color are set
+// TODO : handle all cases
+void GLContext::gl_transform_vertices(GLVertex *v, int count) {
 	if (lighting_enabled || fog_enabled) {
 		// eye coordinates needed for lighting and fog
-		m = matrix_stack_ptr[0];
-		m->transform3x4(v->coord, v->ec);
+		const VertexMatrix modelView(*matrix_stack_ptr[0]);
+		for (int i = 0; i < count; i++)
+			modelView.transform3x4(v[i].coord, v[i].ec);
 	}
 
 	if (fog_enabled) {
-		gl_calc_fog_factor(v);
+		for (int i = 0; i < count; i++)
+			gl_calc_fog_factor(&v[i]);
 	}
 
 	if (lighting_enabled) {
 		// projection coordinates
-		m = matrix_stack_ptr[1];
-		m->transform(v->ec, v->pc);
+		const VertexMatrix projection(*matrix_stack_ptr[1]);
+		const VertexMatrix normal(matrix_model_view_inv);
+		for (int i = 0; i < count; i++) {
+			projection.transform(v[i].ec, v[i].pc);
+			normal.transform3x3(v[i].normal, v[i].normal);
 
-		m = &matrix_model_view_inv;
-		m->transform3x3(current_normal, v->normal);
+			if (normalize_enabled) {
+				v[i].normal.normalize();
+			}
 
-		if (normalize_enabled) {
-			v->normal.normalize();
+			gl_shade_vertex(&v[i]);
 		}
 	} else {
 		// no eye coordinates needed, no normal
 		// NOTE: W = 1 is assumed
-		m = &matrix_model_projection;
-		m->transform3x4(v->coord, v->pc);
-
-		if (matrix_model_projection_no_w_transform) {
-			v->pc.W = (m->_m[3][3]);
+		const VertexMatrix modelProjection(matrix_model_projection);
+		for (int i = 0; i < count; i++) {
+			modelProjection.transform3x4(v[i].coord, v[i].pc);
+
+			if (matrix_model_projection_no_w_transform) {
+				v[i].pc.W = matrix_model_projection._m[3][3];
+			}
+			v[i].normal.X = v[i].normal.Y = v[i].normal.Z = 0;
+			v[i].ec.X = v[i].ec.Y = v[i].ec.Z = v[i].ec.W = 0;
 		}
-		v->normal.X = v->normal.Y = v->normal.Z = 0;
-		v->ec.X = v->ec.Y = v->ec.Z = v->ec.W = 0;
 	}
 
-	v->clip_code = gl_clipcode(v->pc.X, v->pc.Y, v->pc.Z, v->pc.W);
+	if (texture_2d_enabled && apply_texture_matrix) {
+		const VertexMatrix texture(*matrix_stack_ptr[2]);
+		for (int i = 0; i < count; i++)
+			texture.transform(v[i].tex_coord, v[i].tex_coord);
+	}
+
+	for (int i = 0; i < count; i++) {
+		v[i].clip_code = gl_clipcode(v[i].pc.X, v[i].pc.Y, v[i].pc.Z, v[i].pc.W);
+
+		// precompute the mapping to the viewport
+		if (v[i].clip_code == 0)
+			gl_transform_to_viewport(&v[i]);
+	}
 }
 
 void GLContext::glopVertex(GLParam *p) {
 	GLVertex *v;
-	int n, cnt;
 
 	assert(in_begin != 0);
 
-	n = vertex_n;
-	cnt = vertex_cnt;
-	cnt++;
-	vertex_cnt = cnt;
+	gl_reserve_vertices(1);
 
-	// quick fix to avoid crashes on large polygons
-	if (n >= vertex_max) {
-		GLVertex *newarray;
-		vertex_max <<= 1;    // just double size
-		newarray = (GLVertex *)gl_realloc(vertex, sizeof(GLVertex) * vertex_max);
-		if (!newarray) {
-			error("unable to allocate GLVertex array.");
-		}
-		vertex = newarray;
-	}
 	// new vertex entry
-	v = &vertex[n];
-	n++;
+	v = &vertex[vertex_n];
+	vertex_n++;
+	vertex_cnt++;
 
 	v->coord.X = p[1].f;
 	v->coord.Y = p[2].f;
 	v->coord.Z = p[3].f;
 	v->coord.W = p[4].f;
+	gl_init_vertex(v);
 
-	gl_vertex_transform(v);
-
-	// color
-
-	if (lighting_enabled) {
-		gl_shade_vertex(v);
-	} else {
-		v->color = current_color;
-	}
-
-	// tex coords
-
-	if (texture_2d_enabled) {
-		if (apply_texture_matrix) {
-			matrix_stack_ptr[2]->transform(current_tex_coord, v->tex_coord);
-		} else {
-			v->tex_coord = current_tex_coord;
-		}
-	}
-	// precompute the mapping to the viewport
-	if (v->clip_code == 0)
-		gl_transform_to_viewport(v);
-
-	// edge flag
-
-	v->edge_flag = current_edge_flag;
-
-	vertex_n = n;
+	gl_transform_vertices(v, 1);
 }
 
 void GLContext::glopEnd(GLParam *) {
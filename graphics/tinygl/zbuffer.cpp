@@ -99,6 +99,7 @@ FrameBuffer::FrameBuffer(int width, int height, const Graphics::PixelFormat &for
 	_currentTexture = nullptr;
 
 	_enableScissor = false;
+	_vectorSpansEnabled = true;
 }
 
 FrameBuffer::~FrameBuffer() {
@@ -332,6 +332,29 @@ private:
 	template <bool kDepthWrite, bool kEnableScissor, bool kStencilEnabled, bool kDepthTestEnabled>
 	void putPixelDepth(uint *pz, byte *ps, int _a, int x, int y, uint &z, int &dzdx);
 
+	/**
+	 * Vectorized versions of putPixelNoTexture() and putPixelTexture(), drawing
+	 * count pixels, a multiple of four, in a row. They are only used for the
+	 * states canUseVectorSpans() accepts, without fog, alpha test or stencil,
+	 * and give the same pixels as the per pixel functions.
+	 */
+	template <bool kDepthWrite, bool kSmoothMode, bool kEnableBlending, bool kDepthTestEnabled>
+	void putSpanNoTexture(int fbOffset, uint *pz, int count, uint &z, uint &r, uint &g, uint &b, uint &a,
+	                      int dzdx, int drdx, int dgdx, int dbdx, uint dadx);
+
+	template <bool kDepthWrite, bool kSmoothMode, bool kEnableBlending, bool kDepthTestEnabled>
+	void putSpanTexture(int fbOffset, const TexelBuffer *texture, uint *pz, int count,
+	                    uint &z, int &t, int &s, uint &r, uint &g, uint &b, uint &a,
+	                    int dzdx, int dsdx, int dtdx, int drdx, int dgdx, int dbdx, uint dadx);
+
+	bool canUseVectorSpans() const;
+
+	/**
+	 * Returns how many of the pixels of a row starting at x may be drawn by
+	 * the vector spans: a multiple of four, or 0.
+	 */
+	int getVectorSpanLength(int x, int y, int count, uint z, int dzdx, bool scissor, bool depthWrite) const;
+
 
 	template <bool kEnableAlphaTest>
 	FORCEINLINE void writePixel(int pixel, int value) {
@@ -620,6 +643,15 @@ public:
 		_fogColorB = colorB;
 	}
 
+	/**
+	 * Allows or not drawing the triangles with the vector instructions, when
+	 * they are available. The per pixel code gives the same result, and is
+	 * the reference for the vector code.
+	 */
+	void enableVectorSpans(bool enable) {
+		_vectorSpansEnabled = enable;
+	}
+
 private:
 
 	/**
@@ -740,6 +772,7 @@ private:
 	int _offsetStates;
 	float _offsetFactor;
 	float _offsetUnits;
+	bool _vectorSpansEnabled;
 	bool _fogEnabled;
 	float _fogColorR;
 	float _fogColorG;
@@ -29,7 +29,7 @@
 namespace TinyGL {
 
 void GLContext::issueDrawCall(DrawCall *drawCall) {
-	if (_enableDirtyRectangles && drawCall->getDirtyRegion().isEmpty())
+	if ((_enableDirtyRectangles || _enableTiledRendering) && drawCall->getDirtyRegion().isEmpty())
 		return;
 	_drawCallsQueue.push_back(drawCall);
 }
@@ -252,15 +252,62 @@ void GLContext::presentBufferSimple(Common::List<Common::Rect> &dirtyAreas) {
 	_drawCallAllocator[_currentAllocatorIndex].reset();
 }
 
+void GLContext::presentBufferTiled(Common::List<Common::Rect> &dirtyAreas) {
+	typedef Common::List<DrawCall *>::const_iterator DrawCallIterator;
+
+	const int width = fb->getPixelBufferWidth();
+	const int height = fb->getPixelBufferHeight();
+	const int bandCount = (height + TILE_BAND_HEIGHT - 1) / TILE_BAND_HEIGHT;
+
+	dirtyAreas.push_back(Common::Rect(width, height));
+
+	// Sort the draw calls into the bands they touch, keeping their order.
+	Common::Array<Common::Array<DrawCall *> > bands(bandCount);
+	for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+		const Common::Rect &region = (*it)->getDirtyRegion();
+		const int firstBand = MAX(region.top, (int16)0) / TILE_BAND_HEIGHT;
+		const int lastBand = MIN(region.bottom - 1, height - 1) / TILE_BAND_HEIGHT;
+		for (int band = firstBand; band <= lastBand; band++) {
+			bands[band].push_back(*it);
+		}
+	}
+
+	// Each band is drawn from start to end while its part of the buffers
+	// is still in the cache.
+	for (int band = 0; band < bandCount; band++) {
+		const Common::Rect bandRect(0, band * TILE_BAND_HEIGHT, width, MIN((band + 1) * TILE_BAND_HEIGHT, height));
+		for (uint i = 0; i < bands[band].size(); i++) {
+			bands[band][i]->execute(bandRect, true);
+		}
+	}
+
+	for (DrawCallIterator it = _drawCallsQueue.begin(); it != _drawCallsQueue.end(); ++it) {
+		delete *it;
+	}
+
+	_drawCallsQueue.clear();
+
+	disposeResources();
+
+	_drawCallAllocator[_currentAllocatorIndex].reset();
+}
+
 void presentBuffer(Common::List<Common::Rect> &dirtyAreas) {
 	GLContext *c = gl_get_context();
 	if (c->_enableDirtyRectangles) {
 		c->presentBufferDirtyRects(dirtyAreas);
+	} else if (c->_enableTiledRendering) {
+		c->presentBufferTiled(dirtyAreas);
 	} else {
 		c->presentBufferSimple(dirtyAreas);
 	}
 }
 
+void enableTiledRendering(bool enable) {
+	GLContext *c = gl_get_context();
+	c->_enableTiledRendering = enable;
+}
+
 void presentBuffer() {
 	Common::List<Common::Rect> dirtyAreas;
 	presentBuffer(dirtyAreas);
@@ -295,7 +342,7 @@ RasterizationDrawCall::RasterizationDrawCall() : DrawCall(DrawCall_Rasterization
 	_drawTriangleBack = c->draw_triangle_back;
 	memcpy(_vertex, c->vertex, sizeof(GLVertex) * _vertexCount);
 	_state = captureState();
-	if (c->_enableDirtyRectangles) {
+	if (c->_enableDirtyRectangles || c->_enableTiledRendering) {
 		computeDirtyRegion();
 	}
 }
@@ -573,7 +620,8 @@ BlittingDrawCall::BlittingDrawCall(BlitImage *image, const BlitTransform &transf
 	tglIncBlitImageRef(image);
 	_blitState = captureState();
 	_imageVersion = tglGetBlitImageVersion(image);
-	if (gl_get_context()->_enableDirtyRectangles) {
+	TinyGL::GLContext *c = gl_get_context();
+	if (c->_enableDirtyRectangles || c->_enableTiledRendering) {
 		computeDirtyRegion();
 	}
 }
@@ -690,7 +738,7 @@ ClearBufferDrawCall::ClearBufferDrawCall(bool clearZBuffer, int zValue,
 	  _rValue(rValue), _gValue(gValue), _bValue(bValue), _clearStencilBuffer(clearStencilBuffer),
 	  _stencilValue(stencilValue), DrawCall(DrawCall_Clear) {
 	TinyGL::GLContext *c = gl_get_context();
-	if (c->_enableDirtyRectangles) {
+	if (c->_enableDirtyRectangles || c->_enableTiledRendering) {
 		_dirtyRegion = c->renderRect;
 	}
 }
@@ -76,6 +76,10 @@ enum {
 #define MAX_DISPLAY_LISTS 1024
 #define OP_BUFFER_MAX_SIZE 512
 
+// height of the bands of the frame buffer drawn one after the other
+// by the tiled rendering
+#define TILE_BAND_HEIGHT 64
+
 #define TGL_OFFSET_FILL    0x1
 #define TGL_OFFSET_LINE    0x2
 #define TGL_OFFSET_POINT   0x4
@@ -157,8 +161,11 @@ struct GLParamBuffer {
 	struct GLParamBuffer *next;
 };
 
+struct GLVertexBatch;
+
 struct GLList {
 	GLParamBuffer *first_op_buffer;
+	GLVertexBatch *first_batch;
 	// TODO: extensions for a hash table or a better allocating scheme
 };
 
@@ -194,6 +201,37 @@ struct GLVertex {
 	}
 };
 
+// State the transformation of the vertices depends on, when neither
+// lighting nor fog are enabled
+struct GLVertexBatchKey {
+	Matrix4 model_projection;
+	Matrix4 texture;
+	Vector3 viewport_scale;
+	Vector3 viewport_trans;
+	Vector4 color;
+	Vector4 tex_coord;
+	int edge_flag;
+	int texture_2d_enabled;
+};
+
+// The vertices of a glBegin()/glEnd() block of a display list, with the
+// attributes set inside of the block. The last transformed vertices are
+// kept, and drawn again while the state they depend on does not change.
+struct GLVertexBatch {
+	int begin_type;
+	Common::Array<GLVertex> vertices;
+	bool has_color, has_normal, has_tex_coord, has_edge_flag;
+	// current state at the end of the block
+	Vector4 color, normal, tex_coord;
+	int edge_flag;
+
+	Common::Array<GLVertex> transformed;
+	GLVertexBatchKey transformed_key;
+
+	GLParam *next_op; // first op after the block
+	GLVertexBatch *next;
+};
+
 struct GLImage {
 	TexelBuffer *pixmap;
 	int xsize, ysize;
@@ -207,6 +245,7 @@ struct GLTexture {
 	GLImage images[MAX_TEXTURE_LEVELS];
 	uint handle;
 	int versionNumber;
+	int min_filter; // Set with glTexParameter while the texture is bound, 0 if never set
 	struct GLTexture *next, *prev;
 	bool disposed;
 };
@@ -328,6 +367,7 @@ struct GLContext {
 	// current list
 	GLParamBuffer *current_op_buffer;
 	int current_op_buffer_index;
+	GLList *current_list;
 	int exec_flag, compile_flag, print_flag;
 
 	// matrix
@@ -451,6 +491,7 @@ struct GLContext {
 	Common::Rect _scissorRect;
 
 	bool _enableDirtyRectangles;
+	bool _enableTiledRendering;
 
 	// blit test
 	Common::List<BlitImage *> _blitImages;
@@ -463,7 +504,11 @@ struct GLContext {
 	bool _debugRectsEnabled;
 	bool _profilingEnabled;
 
-	void gl_vertex_transform(GLVertex *v);
+	void gl_init_vertex(GLVertex *v);
+	void gl_reserve_vertices(int count);
+	void gl_transform_vertices(GLVertex *v, int count);
+	bool gl_load_array_element(int idx, Vector4 &coord);
+	void gl_draw_array_elements(int first, int count, const void *indices, int type);
 	void gl_calc_fog_factor(GLVertex *v);
 
 	void gl_get_pname(TGLenum pname, union uglValue *data, eDataType &dataType);
@@ -509,6 +554,8 @@ public:
 	GLTexture *alloc_texture(uint h);
 	GLTexture *find_texture(uint h);
 	void free_texture(GLTexture *t);
+	void updateMipmaps(GLTexture *t, bool rebuild);
+	const TexelBuffer *selectTextureLevel(const GLTexture *t, const ZBufferPoint *p0, const ZBufferPoint *p1, const ZBufferPoint *p2);
 	void gl_GenTextures(TGLsizei n, TGLuint *textures);
 	void gl_DeleteTextures(TGLsizei n, const TGLuint *textures);
 	void gl_PixelStore(TGLenum pname, TGLint param);
@@ -519,6 +566,7 @@ public:
 
 	void presentBufferDirtyRects(Common::List<Common::Rect> &dirtyAreas);
 	void presentBufferSimple(Common::List<Common::Rect> &dirtyAreas);
+	void presentBufferTiled(Common::List<Common::Rect> &dirtyAreas);
 
 	void debugDrawRectangle(Common::Rect rect, int r, int g, int b);
 
@@ -534,6 +582,8 @@ public:
 	void gl_NewList(TGLuint list, TGLenum mode);
 	void gl_EndList();
 	TGLboolean gl_IsList(TGLuint list);
+	void gl_compile_vertex_batches(GLList *l);
+	bool gl_call_vertex_batch(GLVertexBatch *batch);
 	TGLuint gl_GenLists(TGLsizei range);
 
 	void initSharedState();
@@ -29,6 +29,13 @@
 #include "graphics/tinygl/texelbuffer.h"
 #include "graphics/tinygl/zbuffer.h"
 #include "graphics/tinygl/zgl.h"
+#include "graphics/scaler/simd.h"
+
+// The spans of the triangles are drawn four pixels at a time with SSE2 or
+// NEON, for the most common states
+#if defined(USE_SCALER_SIMD)
+#define TINYGL_VECTOR_SPANS
+#endif
 
 namespace TinyGL {
 
@@ -157,6 +164,322 @@ void FrameBuffer::putPixelDepth(uint *pz, byte *ps, int _a, int x, int y, uint &
 	z += dzdx;
 }
 
+#ifdef TINYGL_VECTOR_SPANS
+
+// The vector spans work on four pixels at a time, in 32-bit lanes
+
+#if defined(SCALER_SIMD_SSE2)
+typedef __m128i SpanVec;
+
+static inline SpanVec spanSplat(uint32 v) { return _mm_set1_epi32((int32)v); }
+static inline SpanVec spanRamp(uint32 v, int step) { return _mm_setr_epi32((int32)v, (int32)(v + step), (int32)(v + 2 * step), (int32)(v + 3 * step)); }
+static inline SpanVec spanLoad(const uint32 *src) { return _mm_loadu_si128((const __m128i *)src); }
+static inline void spanStore(uint32 *dst, SpanVec v) { _mm_storeu_si128((__m128i *)dst, v); }
+static inline SpanVec spanAdd(SpanVec a, SpanVec b) { return _mm_add_epi32(a, b); }
+static inline SpanVec spanSub(SpanVec a, SpanVec b) { return _mm_sub_epi32(a, b); }
+static inline SpanVec spanAnd(SpanVec a, SpanVec b) { return _mm_and_si128(a, b); }
+static inline SpanVec spanOr(SpanVec a, SpanVec b) { return _mm_or_si128(a, b); }
+static inline SpanVec spanNot(SpanVec a) { return _mm_xor_si128(a, _mm_set1_epi32(-1)); }
+static inline SpanVec spanSelect(SpanVec mask, SpanVec a, SpanVec b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+static inline SpanVec spanShiftLeft(SpanVec a, int n) { return _mm_sll_epi32(a, _mm_cvtsi32_si128(n)); }
+static inline SpanVec spanShiftRight(SpanVec a, int n) { return _mm_srl_epi32(a, _mm_cvtsi32_si128(n)); }
+static inline SpanVec spanEqual(SpanVec a, SpanVec b) { return _mm_cmpeq_epi32(a, b); }
+static inline int spanMask(SpanVec mask) { return _mm_movemask_ps(_mm_castsi128_ps(mask)); }
+
+/** Lanes where a > b, for unsigned values */
+static inline SpanVec spanGreater(SpanVec a, SpanVec b) {
+	const __m128i bias = _mm_set1_epi32((int32)0x80000000);
+	return _mm_cmpgt_epi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias));
+}
+
+/** Products of 16-bit values, of which only the low 16 bits are kept */
+static inline SpanVec spanMul16(SpanVec a, SpanVec b) { return _mm_mullo_epi16(a, b); }
+
+/** The values are at most 510 */
+static inline SpanVec spanMin255(SpanVec a) {
+	const __m128i max = _mm_set1_epi32(255);
+	return spanSelect(_mm_cmpgt_epi32(a, max), max, a);
+}
+
+/** Depth values, as stored after a round trip through a float */
+static inline SpanVec spanRoundDepth(SpanVec z) { return _mm_cvttps_epi32(_mm_cvtepi32_ps(z)); }
+
+#elif defined(SCALER_SIMD_NEON)
+typedef uint32x4_t SpanVec;
+
+static inline SpanVec spanSplat(uint32 v) { return vdupq_n_u32(v); }
+static inline SpanVec spanRamp(uint32 v, int step) {
+	const uint32 values[4] = { v, v + step, v + 2 * step, v + 3 * step };
+	return vld1q_u32(values);
+}
+static inline SpanVec spanLoad(const uint32 *src) { return vld1q_u32(src); }
+static inline void spanStore(uint32 *dst, SpanVec v) { vst1q_u32(dst, v); }
+static inline SpanVec spanAdd(SpanVec a, SpanVec b) { return vaddq_u32(a, b); }
+static inline SpanVec spanSub(SpanVec a, SpanVec b) { return vsubq_u32(a, b); }
+static inline SpanVec spanAnd(SpanVec a, SpanVec b) { return vandq_u32(a, b); }
+static inline SpanVec spanOr(SpanVec a, SpanVec b) { return vorrq_u32(a, b); }
+static inline SpanVec spanNot(SpanVec a) { return vmvnq_u32(a); }
+static inline SpanVec spanSelect(SpanVec mask, SpanVec a, SpanVec b) { return vbslq_u32(mask, a, b); }
+static inline SpanVec spanShiftLeft(SpanVec a, int n) { return vshlq_u32(a, vdupq_n_s32(n)); }
+static inline SpanVec spanShiftRight(SpanVec a, int n) { return vshlq_u32(a, vdupq_n_s32(-n)); }
+static inline SpanVec spanEqual(SpanVec a, SpanVec b) { return vceqq_u32(a, b); }
+
+static inline int spanMask(SpanVec mask) {
+	const uint32 lanes[4] = { 1, 2, 4, 8 };
+	const uint32x4_t bits = vandq_u32(mask, vld1q_u32(lanes));
+	uint32x2_t sum = vpadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+	sum = vpadd_u32(sum, sum);
+	return vget_lane_u32(sum, 0);
+}
+
+/** Lanes where a > b, for unsigned values */
+static inline SpanVec spanGreater(SpanVec a, SpanVec b) { return vcgtq_u32(a, b); }
+
+/** Products of 16-bit values, of which only the low 16 bits are kept */
+static inline SpanVec spanMul16(SpanVec a, SpanVec b) { return vandq_u32(vmulq_u32(a, b), vdupq_n_u32(0xFFFF)); }
+
+/** The values are at most 510 */
+static inline SpanVec spanMin255(SpanVec a) { return vminq_u32(a, vdupq_n_u32(255)); }
+
+/** Depth values, as stored after a round trip through a float */
+static inline SpanVec spanRoundDepth(SpanVec z) {
+	return vreinterpretq_u32_s32(vcvtq_s32_f32(vcvtq_f32_s32(vreinterpretq_s32_u32(z))));
+}
+#endif
+
+static inline bool isVectorBlendingFactor(int factor) {
+	return factor == TGL_ZERO || factor == TGL_ONE || factor == TGL_SRC_ALPHA || factor == TGL_ONE_MINUS_SRC_ALPHA;
+}
+
+/** The color components of the pixels which pass the depth test */
+struct SpanFragments {
+	SpanVec z, mask;
+	SpanVec a, r, g, b;
+};
+
+/**
+ * The state of the frame buffer the vector spans need, read once per span
+ */
+struct SpanTarget {
+	SpanTarget(byte *pixelBuffer, uint *depthBuffer, const Graphics::PixelFormat &format, int func, int sFactor, int dFactor) :
+		pixels((uint32 *)pixelBuffer), zbuf(depthBuffer), depthFunc(func), sourceFactor(sFactor), destinationFactor(dFactor),
+		aLoss(format.aLoss), aShift(format.aShift), rShift(format.rShift), gShift(format.gShift), bShift(format.bShift) {
+	}
+
+	uint32 *pixels;
+	uint *zbuf;
+	int depthFunc;
+	int sourceFactor, destinationFactor;
+	int aLoss, aShift, rShift, gShift, bShift;
+
+	/** Same as FrameBuffer::compareDepth() */
+	SpanVec depthTest(SpanVec zSrc, SpanVec zDst) const {
+		switch (depthFunc) {
+		case TGL_LESS:
+			return spanGreater(zSrc, zDst);
+		case TGL_EQUAL:
+			return spanEqual(zDst, zSrc);
+		case TGL_LEQUAL:
+			return spanNot(spanGreater(zDst, zSrc));
+		case TGL_GREATER:
+			return spanGreater(zDst, zSrc);
+		case TGL_NOTEQUAL:
+			return spanNot(spanEqual(zDst, zSrc));
+		case TGL_GEQUAL:
+			return spanNot(spanGreater(zSrc, zDst));
+		case TGL_ALWAYS:
+			return spanSplat(0xFFFFFFFF);
+		default:
+			return spanSplat(0);
+		}
+	}
+
+	/** Same as the blending factors of FrameBuffer::writePixel() */
+	static SpanVec blendingFactor(int factor, SpanVec c, SpanVec a) {
+		switch (factor) {
+		case TGL_ZERO:
+			return spanSplat(0);
+		case TGL_SRC_ALPHA:
+			return spanShiftRight(spanMul16(c, a), 8);
+		case TGL_ONE_MINUS_SRC_ALPHA:
+			return spanShiftRight(spanMul16(c, spanSub(spanSplat(255), a)), 8);
+		default:
+			return c;
+		}
+	}
+
+	SpanVec pack(SpanVec a, SpanVec r, SpanVec g, SpanVec b) const {
+		return spanOr(spanOr(spanShiftLeft(spanShiftRight(a, aLoss), aShift), spanShiftLeft(r, rShift)),
+		              spanOr(spanShiftLeft(g, gShift), spanShiftLeft(b, bShift)));
+	}
+
+	/** Same as FrameBuffer::writePixel(), without fog or alpha test */
+	template <bool kDepthWrite, bool kEnableBlending>
+	void write(int offset, const SpanFragments &f) const {
+		if (kDepthWrite) {
+			const SpanVec z = spanLoad(zbuf + offset);
+			spanStore(zbuf + offset, spanSelect(f.mask, spanRoundDepth(f.z), z));
+		}
+
+		const SpanVec dst = spanLoad(pixels + offset);
+		SpanVec color;
+		if (!kEnableBlending) {
+			color = pack(f.a, f.r, f.g, f.b);
+		} else {
+			const SpanVec byteMask = spanSplat(0xFF);
+			const SpanVec rDst = spanAnd(spanShiftRight(dst, rShift), byteMask);
+			const SpanVec gDst = spanAnd(spanShiftRight(dst, gShift), byteMask);
+			const SpanVec bDst = spanAnd(spanShiftRight(dst, bShift), byteMask);
+			const SpanVec r = spanAdd(blendingFactor(sourceFactor, f.r, f.a), blendingFactor(destinationFactor, rDst, f.a));
+			const SpanVec g = spanAdd(blendingFactor(sourceFactor, f.g, f.a), blendingFactor(destinationFactor, gDst, f.a));
+			const SpanVec b = spanAdd(blendingFactor(sourceFactor, f.b, f.a), blendingFactor(destinationFactor, bDst, f.a));
+			color = pack(byteMask, spanMin255(r), spanMin255(g), spanMin255(b));
+		}
+		spanStore(pixels + offset, spanSelect(f.mask, color, dst));
+	}
+};
+
+bool FrameBuffer::canUseVectorSpans() const {
+	if (!_vectorSpansEnabled || _pbufBpp != 4)
+		return false;
+	if (_pbufFormat.rLoss != 0 || _pbufFormat.gLoss != 0 || _pbufFormat.bLoss != 0 ||
+	    (_pbufFormat.aLoss != 0 && _pbufFormat.aLoss != 8))
+		return false;
+	if (_blendingEnabled && (!isVectorBlendingFactor(_sourceBlendingFactor) || !isVectorBlendingFactor(_destinationBlendingFactor)))
+		return false;
+	return true;
+}
+
+int FrameBuffer::getVectorSpanLength(int x, int y, int count, uint z, int dzdx, bool scissor, bool depthWrite) const {
+	count &= ~3;
+	if (count <= 0)
+		return 0;
+	// the per pixel code does not step the interpolated values for the
+	// pixels outside of the scissor rectangle
+	if (scissor && (x < _clipRectangle.left || x + count > _clipRectangle.right ||
+	                y < _clipRectangle.top || y >= _clipRectangle.bottom))
+		return 0;
+	// the conversion of the depth values to float is only done for the
+	// values which fit in a signed integer
+	if (depthWrite) {
+		const int64 zLast = (int64)z + (int64)dzdx * (count - 1);
+		if (z > 0x7FFFFFFF || zLast < 0 || zLast > 0x7FFFFFFF)
+			return 0;
+	}
+	return count;
+}
+
+template <bool kDepthWrite, bool kSmoothMode, bool kEnableBlending, bool kDepthTestEnabled>
+void FrameBuffer::putSpanNoTexture(int fbOffset, uint *pz, int count, uint &z, uint &r, uint &g, uint &b, uint &a,
+                                   int dzdx, int drdx, int dgdx, int dbdx, uint dadx) {
+	const SpanTarget target(_pbuf.getRawBuffer(), _zbuf, _pbufFormat, _depthFunc, _sourceBlendingFactor, _destinationBlendingFactor);
+	const SpanVec byteMask = spanSplat(0xFF);
+	const SpanVec dz = spanSplat(4 * (uint)dzdx);
+	const SpanVec dr = spanSplat(kSmoothMode ? 4 * (uint)drdx : 0);
+	const SpanVec dg = spanSplat(kSmoothMode ? 4 * (uint)dgdx : 0);
+	const SpanVec db = spanSplat(kSmoothMode ? 4 * (uint)dbdx : 0);
+	const SpanVec da = spanSplat(kSmoothMode ? 4 * dadx : 0);
+	SpanVec zv = spanRamp(z, dzdx);
+	SpanVec rv = spanRamp(r, kSmoothMode ? drdx : 0);
+	SpanVec gv = spanRamp(g, kSmoothMode ? dgdx : 0);
+	SpanVec bv = spanRamp(b, kSmoothMode ? dbdx : 0);
+	SpanVec av = spanRamp(a, kSmoothMode ? dadx : 0);
+
+	SpanFragments f;
+	for (int i = 0; i < count; i += 4) {
+		f.z = zv;
+		f.mask = kDepthTestEnabled ? target.depthTest(zv, spanLoad(pz + i)) : spanSplat(0xFFFFFFFF);
+		if (spanMask(f.mask)) {
+			f.a = spanAnd(spanShiftRight(av, ZB_POINT_ALPHA_BITS - 8), byteMask);
+			f.r = spanAnd(spanShiftRight(rv, ZB_POINT_RED_BITS - 8), byteMask);
+			f.g = spanAnd(spanShiftRight(gv, ZB_POINT_GREEN_BITS - 8), byteMask);
+			f.b = spanAnd(spanShiftRight(bv, ZB_POINT_BLUE_BITS - 8), byteMask);
+			target.write<kDepthWrite, kEnableBlending>(fbOffset + i, f);
+		}
+		zv = spanAdd(zv, dz);
+		if (kSmoothMode) {
+			rv = spanAdd(rv, dr);
+			gv = spanAdd(gv, dg);
+			bv = spanAdd(bv, db);
+			av = spanAdd(av, da);
+		}
+	}
+
+	z += count * dzdx;
+	if (kSmoothMode) {
+		r += count * drdx;
+		g += count * dgdx;
+		b += count * dbdx;
+		a += count * dadx;
+	}
+}
+
+template <bool kDepthWrite, bool kSmoothMode, bool kEnableBlending, bool kDepthTestEnabled>
+void FrameBuffer::putSpanTexture(int fbOffset, const TexelBuffer *texture, uint *pz, int count,
+                                 uint &z, int &t, int &s, uint &r, uint &g, uint &b, uint &a,
+                                 int dzdx, int dsdx, int dtdx, int drdx, int dgdx, int dbdx, uint dadx) {
+	const SpanTarget target(_pbuf.getRawBuffer(), _zbuf, _pbufFormat, _depthFunc, _sourceBlendingFactor, _destinationBlendingFactor);
+	const SpanVec byteMask = spanSplat(0xFF);
+	const SpanVec wordMask = spanSplat(0xFFFF);
+	const SpanVec dz = spanSplat(4 * (uint)dzdx);
+	const SpanVec dr = spanSplat(kSmoothMode ? 4 * (uint)drdx : 0);
+	const SpanVec dg = spanSplat(kSmoothMode ? 4 * (uint)dgdx : 0);
+	const SpanVec db = spanSplat(kSmoothMode ? 4 * (uint)dbdx : 0);
+	const SpanVec da = spanSplat(kSmoothMode ? 4 * dadx : 0);
+	SpanVec zv = spanRamp(z, dzdx);
+	SpanVec rv = spanRamp(r, kSmoothMode ? drdx : 0);
+	SpanVec gv = spanRamp(g, kSmoothMode ? dgdx : 0);
+	SpanVec bv = spanRamp(b, kSmoothMode ? dbdx : 0);
+	SpanVec av = spanRamp(a, kSmoothMode ? dadx : 0);
+
+	SpanFragments f;
+	for (int i = 0; i < count; i += 4) {
+		f.z = zv;
+		f.mask = kDepthTestEnabled ? target.depthTest(zv, spanLoad(pz + i)) : spanSplat(0xFFFFFFFF);
+		const int lanes = spanMask(f.mask);
+		if (lanes) {
+			// the texels are only read for the pixels which pass the depth test
+			uint32 texA[4], texR[4], texG[4], texB[4];
+			for (int j = 0; j < 4; j++) {
+				uint8 c_a = 0, c_r = 0, c_g = 0, c_b = 0;
+				if (lanes & (1 << j))
+					texture->getARGBAt(_wrapS, _wrapT, s + (i + j) * dsdx, t + (i + j) * dtdx, c_a, c_r, c_g, c_b);
+				texA[j] = c_a;
+				texR[j] = c_r;
+				texG[j] = c_g;
+				texB[j] = c_b;
+			}
+
+			// the texels are modulated by the color, which is truncated to
+			// a byte as in putPixelTexture()
+			f.a = spanAnd(spanShiftRight(spanMul16(spanLoad(texA), spanAnd(spanShiftRight(av, ZB_POINT_ALPHA_BITS - 8), wordMask)), ZB_POINT_ALPHA_BITS - 8), byteMask);
+			f.r = spanAnd(spanShiftRight(spanMul16(spanLoad(texR), spanAnd(spanShiftRight(rv, ZB_POINT_RED_BITS - 8), wordMask)), ZB_POINT_RED_BITS - 8), byteMask);
+			f.g = spanAnd(spanShiftRight(spanMul16(spanLoad(texG), spanAnd(spanShiftRight(gv, ZB_POINT_GREEN_BITS - 8), wordMask)), ZB_POINT_GREEN_BITS - 8), byteMask);
+			f.b = spanAnd(spanShiftRight(spanMul16(spanLoad(texB), spanAnd(spanShiftRight(bv, ZB_POINT_BLUE_BITS - 8), wordMask)), ZB_POINT_BLUE_BITS - 8), byteMask);
+			target.write<kDepthWrite, kEnableBlending>(fbOffset + i, f);
+		}
+		zv = spanAdd(zv, dz);
+		if (kSmoothMode) {
+			rv = spanAdd(rv, dr);
+			gv = spanAdd(gv, dg);
+			bv = spanAdd(bv, db);
+			av = spanAdd(av, da);
+		}
+	}
+
+	z += count * dzdx;
+	s += count * dsdx;
+	t += count * dtdx;
+	if (kSmoothMode) {
+		r += count * drdx;
+		g += count * dgdx;
+		b += count * dbdx;
+		a += count * dadx;
+	}
+}
+
+#endif // TINYGL_VECTOR_SPANS
+
 template <bool kInterpRGB, bool kInterpZ, bool kInterpST, bool kInterpSTZ, bool kSmoothMode,
           bool kDepthWrite, bool kFogMode, bool kAlphaTestEnabled, bool kEnableScissor,
           bool kBlendingEnabled, bool kStencilEnabled, bool kDepthTestEnabled>
@@ -190,6 +513,10 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 
 	byte fog_r = 0, fog_g = 0, fog_b = 0;
 
+#ifdef TINYGL_VECTOR_SPANS
+	const bool vectorSpans = kInterpRGB && kInterpZ && !kFogMode && !kAlphaTestEnabled && !kStencilEnabled && canUseVectorSpans();
+#endif
+
 	// we sort the vertex with increasing y
 	if (p1->y < p0->y) {
 		tp = p0;
@@ -423,8 +750,14 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 
 		// we draw all the scan line of the part
 		while (nb_lines > 0) {
+			// the lines below the scissor rectangle are not drawn either
+			if (kEnableScissor && y >= _clipRectangle.bottom)
+				return;
+
 			int x = x1;
-			if (!kInterpRGB) {
+			if (kEnableScissor && y < _clipRectangle.top) {
+				// the line is above the scissor rectangle: only step the edges
+			} else if (!kInterpRGB) {
 				int n;
 				uint *pz;
 				byte *ps = nullptr;
@@ -483,6 +816,19 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 				if (kStencilEnabled) {
 					ps = ps1 + x1;
 				}
+#ifdef TINYGL_VECTOR_SPANS
+				if (vectorSpans) {
+					const int count = getVectorSpanLength(x, y, n + 1, z, dzdx, kEnableScissor, kDepthWrite);
+					if (count > 0) {
+						putSpanNoTexture<kDepthWrite, kSmoothMode, kBlendingEnabled, kDepthTestEnabled>
+						                (pp, pz, count, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx);
+						pp += count;
+						pz += count;
+						n -= count;
+						x += count;
+					}
+				}
+#endif
 				while (n >= 3) {
 					putPixelNoTexture<kDepthWrite, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
 					                 (pp, pz, ps, 0, x, y, z, r, g, b, a, dzdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
@@ -557,6 +903,12 @@ void FrameBuffer::fillTriangle(ZBufferPoint *p0, ZBufferPoint *p1, ZBufferPoint
 						fz += fndzdx;
 						zinv = (float)(1.0 / fz);
 					}
+#ifdef TINYGL_VECTOR_SPANS
+					if (vectorSpans && getVectorSpanLength(x, y, NB_INTERP, z, dzdx, kEnableScissor, kDepthWrite) == NB_INTERP) {
+						putSpanTexture<kDepthWrite, kSmoothMode, kBlendingEnabled, kDepthTestEnabled>
+						              (pp, texture, pz, NB_INTERP, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx);
+					} else
+#endif
 					for (int _a = 0; _a < NB_INTERP; _a++) {
 						putPixelTexture<kDepthWrite, kInterpRGB, kSmoothMode, kFogMode, kAlphaTestEnabled, kEnableScissor, kBlendingEnabled, kStencilEnabled, kDepthTestEnabled>
 						               (pp, texture, _wrapS, _wrapT, pz, ps, _a, x, y, z, t, s, r, g, b, a, dzdx, dsdx, dtdx, drdx, dgdx, dbdx, dadx, fog, fog_r, fog_g, fog_b, dfdx);
@@ -22,6 +22,7 @@
 
 
 #include "common/algorithm.h"
+#include "common/array.h"
 #include "common/endian.h"
 #include "common/util.h"
 #include "common/rect.h"
@@ -31,6 +32,7 @@
 #include "graphics/primitives.h"
 #include "graphics/transparent_surface.h"
 #include "graphics/transform_tools.h"
+#include "graphics/scaler/simd.h"
 
 namespace Graphics {
 
@@ -58,6 +60,161 @@ static const int kGIndex = 1;
 static const int kRIndex = 0;
 #endif
 
+#if defined(USE_SCALER_SIMD) && defined(SCUMM_LITTLE_ENDIAN)
+#define TRANSPARENT_SURFACE_SIMD
+
+/**
+ * The vectorized blenders work on two pixels per vector, with every color
+ * component widened to 16 bits so that the products of two components fit.
+ * Each of them gives the exact same result as the per pixel C++ code.
+ */
+#if defined(SCALER_SIMD_SSE2)
+typedef __m128i BlendVec;
+
+static inline BlendVec blendSplat(uint16 v) { return _mm_set1_epi16(v); }
+static inline BlendVec blendLanes(uint16 a, uint16 b, uint16 g, uint16 r) { return _mm_set_epi16(r, g, b, a, r, g, b, a); }
+static inline BlendVec blendMul(BlendVec a, BlendVec b) { return _mm_mullo_epi16(a, b); }
+static inline BlendVec blendMulHi(BlendVec a, BlendVec b) { return _mm_mulhi_epu16(a, b); }
+static inline BlendVec blendShr8(BlendVec a) { return _mm_srli_epi16(a, 8); }
+static inline BlendVec blendAdd(BlendVec a, BlendVec b) { return _mm_add_epi16(a, b); }
+static inline BlendVec blendSubSat(BlendVec a, BlendVec b) { return _mm_subs_epu16(a, b); }
+static inline BlendVec blendOr(BlendVec a, BlendVec b) { return _mm_or_si128(a, b); }
+static inline BlendVec blendIsZero(BlendVec a) { return _mm_cmpeq_epi16(a, _mm_setzero_si128()); }
+static inline BlendVec blendSelect(BlendVec mask, BlendVec a, BlendVec b) {
+	return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// Copies the alpha of each pixel into its other components
+static inline BlendVec blendAlpha(BlendVec a) {
+	return _mm_shufflehi_epi16(_mm_shufflelo_epi16(a, _MM_SHUFFLE(0, 0, 0, 0)), _MM_SHUFFLE(0, 0, 0, 0));
+}
+
+// Loads 4 pixels, in reverse order when the input is horizontally flipped
+static inline void blendLoad(const byte *in, int32 inStep, BlendVec &lo, BlendVec &hi) {
+	__m128i v;
+	if (inStep < 0)
+		v = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)(in - 12)), _MM_SHUFFLE(0, 1, 2, 3));
+	else
+		v = _mm_loadu_si128((const __m128i *)in);
+	lo = _mm_unpacklo_epi8(v, _mm_setzero_si128());
+	hi = _mm_unpackhi_epi8(v, _mm_setzero_si128());
+}
+
+static inline void blendStore(byte *out, BlendVec lo, BlendVec hi) {
+	_mm_storeu_si128((__m128i *)out, _mm_packus_epi16(lo, hi));
+}
+#elif defined(SCALER_SIMD_NEON)
+typedef uint16x8_t BlendVec;
+
+static inline BlendVec blendSplat(uint16 v) { return vdupq_n_u16(v); }
+static inline BlendVec blendLanes(uint16 a, uint16 b, uint16 g, uint16 r) {
+	const uint16 lanes[8] = { a, b, g, r, a, b, g, r };
+	return vld1q_u16(lanes);
+}
+static inline BlendVec blendMul(BlendVec a, BlendVec b) { return vmulq_u16(a, b); }
+static inline BlendVec blendMulHi(BlendVec a, BlendVec b) {
+	return vcombine_u16(vshrn_n_u32(vmull_u16(vget_low_u16(a), vget_low_u16(b)), 16),
+	                    vshrn_n_u32(vmull_u16(vget_high_u16(a), vget_high_u16(b)), 16));
+}
+static inline BlendVec blendShr8(BlendVec a) { return vshrq_n_u16(a, 8); }
+static inline BlendVec blendAdd(BlendVec a, BlendVec b) { return vaddq_u16(a, b); }
+static inline BlendVec blendSubSat(BlendVec a, BlendVec b) { return vqsubq_u16(a, b); }
+static inline BlendVec blendOr(BlendVec a, BlendVec b) { return vorrq_u16(a, b); }
+static inline BlendVec blendIsZero(BlendVec a) { return vceqq_u16(a, vdupq_n_u16(0)); }
+static inline BlendVec blendSelect(BlendVec mask, BlendVec a, BlendVec b) { return vbslq_u16(mask, a, b); }
+
+// Copies the alpha of each pixel into its other components
+static inline BlendVec blendAlpha(BlendVec a) {
+	uint64x2_t v = vandq_u64(vreinterpretq_u64_u16(a), vdupq_n_u64(0xFFFF));
+	v = vorrq_u64(v, vshlq_n_u64(v, 16));
+	return vreinterpretq_u16_u64(vorrq_u64(v, vshlq_n_u64(v, 32)));
+}
+
+// Loads 4 pixels, in reverse order when the input is horizontally flipped
+static inline void blendLoad(const byte *in, int32 inStep, BlendVec &lo, BlendVec &hi) {
+	uint8x16_t v;
+	if (inStep < 0) {
+		uint32x4_t p = vrev64q_u32(vreinterpretq_u32_u8(vld1q_u8(in - 12)));
+		v = vreinterpretq_u8_u32(vcombine_u32(vget_high_u32(p), vget_low_u32(p)));
+	} else {
+		v = vld1q_u8(in);
+	}
+	lo = vmovl_u8(vget_low_u8(v));
+	hi = vmovl_u8(vget_high_u8(v));
+}
+
+static inline void blendStore(byte *out, BlendVec lo, BlendVec hi) {
+	vst1q_u8(out, vcombine_u8(vqmovn_u16(lo), vqmovn_u16(hi)));
+}
+#endif
+
+/**
+ * Color modulation of a blit, broadcast to the vector lanes
+ */
+struct BlendColor {
+	BlendVec alphaMod;   ///< alpha modulation in every lane
+	BlendVec colorMod;   ///< color modulation of each component
+	BlendVec unmodded;   ///< lanes whose color modulation is 255
+	BlendVec alphaMask;  ///< 255 in the alpha lanes
+	BlendVec alphaLanes; ///< selects the alpha lanes
+
+	BlendColor(byte ca, byte cr, byte cg, byte cb) {
+		alphaMod = blendSplat(ca);
+		colorMod = blendLanes(255, cb, cg, cr);
+		unmodded = blendLanes(0xFFFF, cb == 255 ? 0xFFFF : 0, cg == 255 ? 0xFFFF : 0, cr == 255 ? 0xFFFF : 0);
+		alphaMask = blendLanes(255, 0, 0, 0);
+		alphaLanes = blendLanes(0xFFFF, 0, 0, 0);
+	}
+};
+
+static inline BlendVec blendAlphaSimd(BlendVec in, BlendVec out, const BlendColor &c) {
+	const BlendVec ina = blendShr8(blendMul(blendAlpha(in), c.alphaMod));
+	const BlendVec src = blendMulHi(blendMul(in, ina), c.colorMod);
+	const BlendVec dst = blendShr8(blendMul(out, blendSubSat(blendSplat(255), ina)));
+	return blendSelect(blendIsZero(ina), out, blendOr(blendAdd(dst, src), c.alphaMask));
+}
+
+static inline BlendVec blendAdditiveSimd(BlendVec in, BlendVec out, const BlendColor &c) {
+	const BlendVec ina = blendShr8(blendMul(blendAlpha(in), c.alphaMod));
+	const BlendVec src = blendMul(in, ina);
+	const BlendVec add = blendSelect(c.unmodded, blendShr8(src), blendMulHi(src, c.colorMod));
+	// Sums above 255 are saturated when the pixels are stored
+	return blendSelect(blendOr(blendIsZero(ina), c.alphaLanes), out, blendAdd(out, add));
+}
+
+static inline BlendVec blendSubtractiveSimd(BlendVec in, BlendVec out, const BlendColor &c) {
+	const BlendVec ina = blendAlpha(in);
+	const BlendVec src = blendMul(in, out);
+	const BlendVec sub = blendSelect(c.unmodded, blendMulHi(src, ina), blendShr8(blendMulHi(src, blendMul(c.colorMod, ina))));
+	return blendOr(blendSubSat(out, sub), c.alphaMask);
+}
+
+static inline BlendVec blendMultiplySimd(BlendVec in, BlendVec out, const BlendColor &c) {
+	const BlendVec ina = blendShr8(blendMul(blendAlpha(in), c.alphaMod));
+	const BlendVec src = blendMul(in, ina);
+	const BlendVec mul = blendSelect(c.unmodded, blendShr8(src), blendMulHi(src, c.colorMod));
+	return blendSelect(blendOr(blendIsZero(ina), c.alphaLanes), out, blendShr8(blendMul(out, mul)));
+}
+
+/**
+ * Blends as many groups of 4 pixels of a row as possible, and advances the
+ * pointers past them. Returns the number of blended pixels.
+ */
+template<BlendVec (*blend)(BlendVec, BlendVec, const BlendColor &)>
+static inline uint32 doBlitSimdRow(byte *&in, byte *&out, uint32 width, int32 inStep, const BlendColor &c) {
+	uint32 j = 0;
+	for (; j + 4 <= width; j += 4) {
+		BlendVec inLo, inHi, outLo, outHi;
+		blendLoad(in, inStep, inLo, inHi);
+		blendLoad(out, 4, outLo, outHi);
+		blendStore(out, blend(inLo, outLo, c), blend(inHi, outHi, c));
+		in += inStep * 4;
+		out += 16;
+	}
+	return j;
+}
+#endif
+
 TransparentSurface::TransparentSurface() : Surface(), _alphaMode(ALPHA_FULL) {}
 
 TransparentSurface::TransparentSurface(const Surface &surf, bool copyData) : Surface(), _alphaMode(ALPHA_FULL) {
@@ -145,10 +302,18 @@ static void doBlitAlphaBlendImpl(byte *ino, byte *outo, uint32 width, uint32 hei
 	byte cg = rgbmod   ? ((color >> kGModShift) & 0xFF) : 255;
 	byte cb = rgbmod   ? ((color >> kBModShift) & 0xFF) : 255;
 
+#ifdef TRANSPARENT_SURFACE_SIMD
+	const BlendColor simdColor(ca, cr, cg, cb);
+#endif
+
 	for (uint32 i = 0; i < height; i++) {
 		out = outo;
 		in = ino;
-		for (uint32 j = 0; j < width; j++) {
+		uint32 j = 0;
+#ifdef TRANSPARENT_SURFACE_SIMD
+		j = doBlitSimdRow<blendAlphaSimd>(in, out, width, inStep, simdColor);
+#endif
+		for (; j < width; j++) {
 
 			uint32 ina = in[kAIndex] * ca >> 8;
 
@@ -205,10 +370,18 @@ static void doBlitAdditiveBlendImpl(byte *ino, byte *outo, uint32 width, uint32
 	byte cg = rgbmod   ? ((color >> kGModShift) & 0xFF) : 255;
 	byte cb = rgbmod   ? ((color >> kBModShift) & 0xFF) : 255;
 
+#ifdef TRANSPARENT_SURFACE_SIMD
+	const BlendColor simdColor(ca, cr, cg, cb);
+#endif
+
 	for (uint32 i = 0; i < height; i++) {
 		out = outo;
 		in = ino;
-		for (uint32 j = 0; j < width; j++) {
+		uint32 j = 0;
+#ifdef TRANSPARENT_SURFACE_SIMD
+		j = doBlitSimdRow<blendAdditiveSimd>(in, out, width, inStep, simdColor);
+#endif
+		for (; j < width; j++) {
 
 			uint32 ina = in[kAIndex] * ca >> 8;
 
@@ -274,10 +447,18 @@ static void doBlitSubtractiveBlendImpl(byte *ino, byte *outo, uint32 width, uint
 	byte cg = rgbmod   ? ((color >> kGModShift) & 0xFF) : 255;
 	byte cb = rgbmod   ? ((color >> kBModShift) & 0xFF) : 255;
 
+#ifdef TRANSPARENT_SURFACE_SIMD
+	const BlendColor simdColor(255, cr, cg, cb);
+#endif
+
 	for (uint32 i = 0; i < height; i++) {
 		out = outo;
 		in = ino;
-		for (uint32 j = 0; j < width; j++) {
+		uint32 j = 0;
+#ifdef TRANSPARENT_SURFACE_SIMD
+		j = doBlitSimdRow<blendSubtractiveSimd>(in, out, width, inStep, simdColor);
+#endif
+		for (; j < width; j++) {
 
 			out[kAIndex] = 255;
 			if (cb != 255) {
@@ -331,10 +512,18 @@ static void doBlitMultiplyBlendImpl(byte *ino, byte *outo, uint32 width, uint32
 	byte cg = rgbmod   ? ((color >> kGModShift) & 0xFF) : 255;
 	byte cb = rgbmod   ? ((color >> kBModShift) & 0xFF) : 255;
 
+#ifdef TRANSPARENT_SURFACE_SIMD
+	const BlendColor simdColor(ca, cr, cg, cb);
+#endif
+
 	for (uint32 i = 0; i < height; i++) {
 		out = outo;
 		in = ino;
-		for (uint32 j = 0; j < width; j++) {
+		uint32 j = 0;
+#ifdef TRANSPARENT_SURFACE_SIMD
+		j = doBlitSimdRow<blendMultiplySimd>(in, out, width, inStep, simdColor);
+#endif
+		for (; j < width; j++) {
 
 			uint32 ina = in[kAIndex] * ca >> 8;
 
@@ -387,152 +576,30 @@ static void doBlitMultiplyBlend(byte *ino, byte *outo, uint32 width, uint32 heig
 	}
 }
 
-Common::Rect TransparentSurface::blit(Graphics::Surface &target, int posX, int posY, int flipping, Common::Rect *pPartRect, uint color, int width, int height, TSpriteBlendMode blendMode) {
-
-	Common::Rect retSize;
-	retSize.top = 0;
-	retSize.left = 0;
-	retSize.setWidth(0);
-	retSize.setHeight(0);
-	// Check if we need to draw anything at all
-	int ca = (color >> kAModShift) & 0xff;
-
-	if (ca == 0) {
-		return retSize;
-	}
-
-	// Create an encapsulating surface for the data
-	TransparentSurface srcImage(*this, false);
-	// TODO: Is the data really in the screen format?
-	if (format.bytesPerPixel != 4) {
-		warning("TransparentSurface can only blit 32bpp images, but got %d", format.bytesPerPixel * 8);
-		return retSize;
-	}
-
-	if (pPartRect) {
-
-		int xOffset = pPartRect->left;
-		int yOffset = pPartRect->top;
-
-		if (flipping & FLIP_V) {
-			yOffset = srcImage.h - pPartRect->bottom;
-		}
-
-		if (flipping & FLIP_H) {
-			xOffset = srcImage.w - pPartRect->right;
-		}
-
-		srcImage.pixels = getBasePtr(xOffset, yOffset);
-		srcImage.w = pPartRect->width();
-		srcImage.h = pPartRect->height();
-
-		debug(6, "Blit(%d, %d, %d, [%d, %d, %d, %d], %08x, %d, %d)", posX, posY, flipping,
-			  pPartRect->left,  pPartRect->top, pPartRect->width(), pPartRect->height(), color, width, height);
-	} else {
-
-		debug(6, "Blit(%d, %d, %d, [%d, %d, %d, %d], %08x, %d, %d)", posX, posY, flipping, 0, 0,
-			  srcImage.w, srcImage.h, color, width, height);
-	}
-
-	if (width == -1) {
-		width = srcImage.w;
-	}
-	if (height == -1) {
-		height = srcImage.h;
-	}
-
-#ifdef SCALING_TESTING
-	// Hardcode scaling to 66% to test scaling
-	width = width * 2 / 3;
-	height = height * 2 / 3;
-#endif
-
-	Graphics::Surface *img = nullptr;
-	Graphics::Surface *imgScaled = nullptr;
-	byte *savedPixels = nullptr;
-	if ((width != srcImage.w) || (height != srcImage.h)) {
-		// Scale the image
-		img = imgScaled = srcImage.scale(width, height);
-		savedPixels = (byte *)img->getPixels();
+/**
+ * Dispatches a blit to the optimized function for the blend and alpha modes
+ */
+static void doBlit(byte *ino, byte *outo, uint32 width, uint32 height, uint32 pitch, int32 inStep, int32 inoStep, uint32 color, TSpriteBlendMode blendMode, AlphaType alphaMode) {
+	if (color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && alphaMode == ALPHA_OPAQUE) {
+		doBlitOpaqueFast(ino, outo, width, height, pitch, inStep, inoStep);
+	} else if (color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && alphaMode == ALPHA_BINARY) {
+		doBlitBinaryFast(ino, outo, width, height, pitch, inStep, inoStep);
 	} else {
-		img = &srcImage;
-	}
-
-	// Handle off-screen clipping
-	if (posY < 0) {
-		img->h = MAX(0, (int)img->h - -posY);
-		if (!(flipping & FLIP_V))
-			img->setPixels((byte *)img->getBasePtr(0, -posY));
-		posY = 0;
-	}
-
-	if (posX < 0) {
-		img->w = MAX(0, (int)img->w - -posX);
-		if (!(flipping & FLIP_H))
-			img->setPixels((byte *)img->getBasePtr(-posX, 0));
-		posX = 0;
-	}
-
-	if (img->w > target.w - posX) {
-		if (flipping & FLIP_H)
-			img->setPixels((byte *)img->getBasePtr(img->w - target.w + posX, 0));
-		img->w = CLIP((int)img->w, 0, (int)MAX((int)target.w - posX, 0));
-	}
-
-	if (img->h > target.h - posY) {
-		if (flipping & FLIP_V)
-			img->setPixels((byte *)img->getBasePtr(0, img->h - target.h + posY));
-		img->h = CLIP((int)img->h, 0, (int)MAX((int)target.h - posY, 0));
-	}
-
-	// Flip surface
-	if ((img->w > 0) && (img->h > 0)) {
-		int xp = 0, yp = 0;
-
-		int inStep = 4;
-		int inoStep = img->pitch;
-		if (flipping & FLIP_H) {
-			inStep = -inStep;
-			xp = img->w - 1;
-		}
-
-		if (flipping & FLIP_V) {
-			inoStep = -inoStep;
-			yp = img->h - 1;
-		}
-
-		byte *ino = (byte *)img->getBasePtr(xp, yp);
-		byte *outo = (byte *)target.getBasePtr(posX, posY);
-
-		if (color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && _alphaMode == ALPHA_OPAQUE) {
-			doBlitOpaqueFast(ino, outo, img->w, img->h, target.pitch, inStep, inoStep);
-		} else if (color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && _alphaMode == ALPHA_BINARY) {
-			doBlitBinaryFast(ino, outo, img->w, img->h, target.pitch, inStep, inoStep);
+		if (blendMode == BLEND_ADDITIVE) {
+			doBlitAdditiveBlend(ino, outo, width, height, pitch, inStep, inoStep, color);
+		} else if (blendMode == BLEND_SUBTRACTIVE) {
+			doBlitSubtractiveBlend(ino, outo, width, height, pitch, inStep, inoStep, color);
+		} else if (blendMode == BLEND_MULTIPLY) {
+			doBlitMultiplyBlend(ino, outo, width, height, pitch, inStep, inoStep, color);
 		} else {
-			if (blendMode == BLEND_ADDITIVE) {
-				doBlitAdditiveBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
-			} else if (blendMode == BLEND_SUBTRACTIVE) {
-				doBlitSubtractiveBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
-			} else if (blendMode == BLEND_MULTIPLY) {
-				doBlitMultiplyBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
-			} else {
-				assert(blendMode == BLEND_NORMAL);
-				doBlitAlphaBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
-			}
+			assert(blendMode == BLEND_NORMAL);
+			doBlitAlphaBlend(ino, outo, width, height, pitch, inStep, inoStep, color);
 		}
-
-	}
-
-	retSize.setWidth(img->w);
-	retSize.setHeight(img->h);
-
-	if (imgScaled) {
-		imgScaled->setPixels(savedPixels);
-		imgScaled->free();
-		delete imgScaled;
 	}
+}
 
-	return retSize;
+Common::Rect TransparentSurface::blit(Graphics::Surface &target, int posX, int posY, int flipping, Common::Rect *pPartRect, uint color, int width, int height, TSpriteBlendMode blendMode) {
+	return blitClip(target, Common::Rect(target.w, target.h), posX, posY, flipping, pPartRect, color, width, height, blendMode);
 }
 
 Common::Rect TransparentSurface::blitClip(Graphics::Surface &target, Common::Rect clippingArea, int posX, int posY, int flipping, Common::Rect *pPartRect, uint color, int width, int height, TSpriteBlendMode blendMode) {
@@ -594,90 +661,90 @@ Common::Rect TransparentSurface::blitClip(Graphics::Surface &target, Common::Rec
 	height = height * 2 / 3;
 #endif
 
-	Graphics::Surface *img = nullptr;
-	Graphics::Surface *imgScaled = nullptr;
-	byte *savedPixels = nullptr;
-	if ((width != srcImage.w) || (height != srcImage.h)) {
-		// Scale the image
-		img = imgScaled = srcImage.scale(width, height);
-		savedPixels = (byte *)img->getPixels();
-	} else {
-		img = &srcImage;
-	}
+	// Scaled images are not created, the source pixels are instead picked
+	// while blitting, so the clipping is done on the area of the image in
+	// the target: imgX and imgY are the offset of the visible area in it.
+	bool scaled = (width != srcImage.w) || (height != srcImage.h);
+	int imgX = 0, imgY = 0;
+	int imgW = width, imgH = height;
 
 	// Handle off-screen clipping
 	if (posY < clippingArea.top) {
-		img->h = MAX(0, (int)img->h - (clippingArea.top - posY));
+		imgH = MAX(0, imgH - (clippingArea.top - posY));
 		if (!(flipping & FLIP_V))
-			img->setPixels((byte *)img->getBasePtr(0, clippingArea.top - posY));
+			imgY += clippingArea.top - posY;
 		posY = clippingArea.top;
 	}
 
 	if (posX < clippingArea.left) {
-		img->w = MAX(0, (int)img->w - (clippingArea.left - posX));
+		imgW = MAX(0, imgW - (clippingArea.left - posX));
 		if (!(flipping & FLIP_H))
-			img->setPixels((byte *)img->getBasePtr(clippingArea.left - posX, 0));
+			imgX += clippingArea.left - posX;
 		posX = clippingArea.left;
 	}
 
-	if (img->w > clippingArea.right - posX) {
+	if (imgW > clippingArea.right - posX) {
 		if (flipping & FLIP_H)
-			img->setPixels((byte *)img->getBasePtr(img->w - clippingArea.right + posX, 0));
-		img->w = CLIP((int)img->w, 0, (int)MAX((int)clippingArea.right - posX, 0));
+			imgX += imgW - clippingArea.right + posX;
+		imgW = CLIP(imgW, 0, (int)MAX((int)clippingArea.right - posX, 0));
 	}
 
-	if (img->h > clippingArea.bottom - posY) {
+	if (imgH > clippingArea.bottom - posY) {
 		if (flipping & FLIP_V)
-			img->setPixels((byte *)img->getBasePtr(0, img->h - clippingArea.bottom + posY));
-		img->h = CLIP((int)img->h, 0, (int)MAX((int)clippingArea.bottom - posY, 0));
+			imgY += imgH - clippingArea.bottom + posY;
+		imgH = CLIP(imgH, 0, (int)MAX((int)clippingArea.bottom - posY, 0));
 	}
 
 	// Flip surface
-	if ((img->w > 0) && (img->h > 0)) {
-		int xp = 0, yp = 0;
+	if ((imgW > 0) && (imgH > 0)) {
+		byte *outo = (byte *)target.getBasePtr(posX, posY);
 
-		int inStep = 4;
-		int inoStep = img->pitch;
-		if (flipping & FLIP_H) {
-			inStep = -inStep;
-			xp = img->w - 1;
-		}
+		if (!scaled) {
+			int xp = imgX, yp = imgY;
 
-		if (flipping & FLIP_V) {
-			inoStep = -inoStep;
-			yp = img->h - 1;
-		}
+			int inStep = 4;
+			int inoStep = srcImage.pitch;
+			if (flipping & FLIP_H) {
+				inStep = -inStep;
+				xp += imgW - 1;
+			}
 
-		byte *ino = (byte *)img->getBasePtr(xp, yp);
-		byte *outo = (byte *)target.getBasePtr(posX, posY);
+			if (flipping & FLIP_V) {
+				inoStep = -inoStep;
+				yp += imgH - 1;
+			}
 
-		if (color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && _alphaMode == ALPHA_OPAQUE) {
-			doBlitOpaqueFast(ino, outo, img->w, img->h, target.pitch, inStep, inoStep);
-		} else if (color == 0xFFFFFFFF && blendMode == BLEND_NORMAL && _alphaMode == ALPHA_BINARY) {
-			doBlitBinaryFast(ino, outo, img->w, img->h, target.pitch, inStep, inoStep);
+			byte *ino = (byte *)srcImage.getBasePtr(xp, yp);
+			doBlit(ino, outo, imgW, imgH, target.pitch, inStep, inoStep, color, blendMode, _alphaMode);
 		} else {
-			if (blendMode == BLEND_ADDITIVE) {
-				doBlitAdditiveBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
-			} else if (blendMode == BLEND_SUBTRACTIVE) {
-				doBlitSubtractiveBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
-			} else if (blendMode == BLEND_MULTIPLY) {
-				doBlitMultiplyBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
-			} else {
-				assert(blendMode == BLEND_NORMAL);
-				doBlitAlphaBlend(ino, outo, img->w, img->h, target.pitch, inStep, inoStep, color);
+			// Pick the pixels of each row like scaleBlit() does, flipped
+			// already, and blend that row. Rows repeated when scaling up
+			// are only picked once.
+			Common::Array<int> srcX(imgW);
+			for (int j = 0; j < imgW; j++) {
+				int x = (flipping & FLIP_H) ? imgX + imgW - 1 - j : imgX + j;
+				srcX[j] = x * srcImage.w / width;
 			}
-		}
 
+			Common::Array<uint32> row(imgW);
+			int lastSrcY = -1;
+			for (int i = 0; i < imgH; i++) {
+				int y = (flipping & FLIP_V) ? imgY + imgH - 1 - i : imgY + i;
+				int srcY = y * srcImage.h / height;
+				if (srcY != lastSrcY) {
+					const uint32 *src = (const uint32 *)srcImage.getBasePtr(0, srcY);
+					for (int j = 0; j < imgW; j++)
+						row[j] = src[srcX[j]];
+					lastSrcY = srcY;
+				}
+				doBlit((byte *)row.begin(), outo, imgW, 1, target.pitch, 4, 0, color, blendMode, _alphaMode);
+				outo += target.pitch;
+			}
+		}
 	}
 
-	retSize.setWidth(img->w);
-	retSize.setHeight(img->h);
-
-	if (imgScaled) {
-		imgScaled->setPixels(savedPixels);
-		imgScaled->free();
-		delete imgScaled;
-	}
+	retSize.setWidth(imgW);
+	retSize.setHeight(imgH);
 
 	return retSize;
 }
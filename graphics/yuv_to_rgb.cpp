@@ -84,6 +84,7 @@
 
 #include "graphics/surface.h"
 #include "graphics/yuv_to_rgb.h"
+#include "graphics/scaler/simd.h"
 
 namespace Common {
 DECLARE_SINGLETON(Graphics::YUVToRGBManager);
@@ -202,6 +203,247 @@ const YUVToRGBLookup *YUVToRGBManager::getLookup(Graphics::PixelFormat format, Y
 	return _lookup;
 }
 
+#if defined(USE_SCALER_SIMD) && defined(SCUMM_LITTLE_ENDIAN)
+#define YUV_TO_RGB_SIMD
+
+/**
+ * The vectorized converters compute the color components of eight pixels
+ * at a time in 16-bit lanes, instead of looking them up. They give the same
+ * pixels as the lookup tables:
+ * - the chroma offsets are the truncated products of the chroma values and
+ *   the factors of the tables, in 2.14 fixed point, which is exact for all
+ *   of the 256 chroma values;
+ * - with kScaleITU, the (x - 16) * 255 / 219 scaling uses a multiplication
+ *   by the reciprocal of 219, also exact over [16, 235].
+ */
+
+// The factors of the chroma tables, in 2.14 fixed point
+static const uint16 kCrRFactor = 22960; // 0.419 / 0.299
+static const uint16 kCrGFactor = 11692; // 0.299 / 0.419
+static const uint16 kCbGFactor = 5643;  // 0.114 / 0.331
+static const uint16 kCbBFactor = 29055; // 0.587 / 0.331
+
+// floor(x / 219) == (x * kITUFactor) >> (16 + 7) for x up to 219 * 255
+static const uint16 kITUFactor = 38305;
+
+#if defined(SCALER_SIMD_SSE2)
+typedef __m128i YUVVec;
+
+static inline YUVVec yuvSplat(int16 v) { return _mm_set1_epi16(v); }
+static inline YUVVec yuvLoad(const byte *src) { return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)src), _mm_setzero_si128()); }
+static inline YUVVec yuvAdd(YUVVec a, YUVVec b) { return _mm_add_epi16(a, b); }
+static inline YUVVec yuvSub(YUVVec a, YUVVec b) { return _mm_sub_epi16(a, b); }
+static inline YUVVec yuvClamp(YUVVec a, int16 min, int16 max) { return _mm_min_epi16(_mm_max_epi16(a, _mm_set1_epi16(min)), _mm_set1_epi16(max)); }
+static inline YUVVec yuvDupLo(YUVVec a) { return _mm_unpacklo_epi16(a, a); }
+static inline YUVVec yuvDupHi(YUVVec a) { return _mm_unpackhi_epi16(a, a); }
+
+/** Truncated product of (c - 128) and a 2.14 fixed point factor */
+static inline YUVVec yuvChroma(YUVVec c, uint16 factor) {
+	const __m128i d = _mm_sub_epi16(c, _mm_set1_epi16(128));
+	const __m128i sign = _mm_srai_epi16(d, 15);
+	const __m128i abs = _mm_sub_epi16(_mm_xor_si128(d, sign), sign);
+	const __m128i p = _mm_srli_epi16(_mm_mulhi_epu16(_mm_slli_epi16(abs, 8), _mm_set1_epi16((int16)factor)), 6);
+	return _mm_sub_epi16(_mm_xor_si128(p, sign), sign);
+}
+
+static inline YUVVec yuvScaleITU(YUVVec a) {
+	const __m128i t = _mm_sub_epi16(yuvClamp(a, 16, 235), _mm_set1_epi16(16));
+	const __m128i n = _mm_mullo_epi16(t, _mm_set1_epi16(255));
+	return _mm_srli_epi16(_mm_mulhi_epu16(n, _mm_set1_epi16((int16)kITUFactor)), 7);
+}
+
+struct YUVChannel {
+	__m128i loss, shift;
+
+	void set(int l, int s) {
+		loss = _mm_cvtsi32_si128(l);
+		shift = _mm_cvtsi32_si128(s);
+	}
+
+	__m128i pack16(YUVVec c) const { return _mm_sll_epi16(_mm_srl_epi16(c, loss), shift); }
+	__m128i pack32(__m128i c) const { return _mm_sll_epi32(_mm_srl_epi32(c, loss), shift); }
+};
+
+static inline void yuvStore16(byte *dst, YUVVec r, YUVVec g, YUVVec b, YUVVec a, const YUVChannel *ch) {
+	const __m128i p = _mm_or_si128(_mm_or_si128(ch[0].pack16(r), ch[1].pack16(g)),
+	                               _mm_or_si128(ch[2].pack16(b), ch[3].pack16(a)));
+	_mm_storeu_si128((__m128i *)dst, p);
+}
+
+static inline void yuvStore32(byte *dst, YUVVec r, YUVVec g, YUVVec b, YUVVec a, const YUVChannel *ch) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i lo = _mm_or_si128(
+		_mm_or_si128(ch[0].pack32(_mm_unpacklo_epi16(r, zero)), ch[1].pack32(_mm_unpacklo_epi16(g, zero))),
+		_mm_or_si128(ch[2].pack32(_mm_unpacklo_epi16(b, zero)), ch[3].pack32(_mm_unpacklo_epi16(a, zero))));
+	const __m128i hi = _mm_or_si128(
+		_mm_or_si128(ch[0].pack32(_mm_unpackhi_epi16(r, zero)), ch[1].pack32(_mm_unpackhi_epi16(g, zero))),
+		_mm_or_si128(ch[2].pack32(_mm_unpackhi_epi16(b, zero)), ch[3].pack32(_mm_unpackhi_epi16(a, zero))));
+	_mm_storeu_si128((__m128i *)dst, lo);
+	_mm_storeu_si128((__m128i *)(dst + 16), hi);
+}
+
+#elif defined(SCALER_SIMD_NEON)
+typedef int16x8_t YUVVec;
+
+static inline YUVVec yuvSplat(int16 v) { return vdupq_n_s16(v); }
+static inline YUVVec yuvLoad(const byte *src) { return vreinterpretq_s16_u16(vmovl_u8(vld1_u8(src))); }
+static inline YUVVec yuvAdd(YUVVec a, YUVVec b) { return vaddq_s16(a, b); }
+static inline YUVVec yuvSub(YUVVec a, YUVVec b) { return vsubq_s16(a, b); }
+static inline YUVVec yuvClamp(YUVVec a, int16 min, int16 max) { return vminq_s16(vmaxq_s16(a, vdupq_n_s16(min)), vdupq_n_s16(max)); }
+static inline YUVVec yuvDupLo(YUVVec a) { return vzipq_s16(a, a).val[0]; }
+static inline YUVVec yuvDupHi(YUVVec a) { return vzipq_s16(a, a).val[1]; }
+
+/** Truncated product of (c - 128) and a 2.14 fixed point factor */
+static inline YUVVec yuvChroma(YUVVec c, uint16 factor) {
+	const int16x8_t d = vsubq_s16(c, vdupq_n_s16(128));
+	const uint16x8_t abs = vreinterpretq_u16_s16(vabsq_s16(d));
+	const uint32x4_t lo = vmull_n_u16(vget_low_u16(abs), factor);
+	const uint32x4_t hi = vmull_n_u16(vget_high_u16(abs), factor);
+	const int16x8_t p = vreinterpretq_s16_u16(vcombine_u16(vshrn_n_u32(lo, 14), vshrn_n_u32(hi, 14)));
+	return vbslq_s16(vcltq_s16(d, vdupq_n_s16(0)), vnegq_s16(p), p);
+}
+
+static inline YUVVec yuvScaleITU(YUVVec a) {
+	const uint16x8_t t = vreinterpretq_u16_s16(vsubq_s16(yuvClamp(a, 16, 235), vdupq_n_s16(16)));
+	const uint16x8_t n = vmulq_n_u16(t, 255);
+	const uint32x4_t lo = vmull_n_u16(vget_low_u16(n), kITUFactor);
+	const uint32x4_t hi = vmull_n_u16(vget_high_u16(n), kITUFactor);
+	return vreinterpretq_s16_u16(vshrq_n_u16(vcombine_u16(vshrn_n_u32(lo, 16), vshrn_n_u32(hi, 16)), 7));
+}
+
+struct YUVChannel {
+	int16x8_t loss16, shift16;
+	int32x4_t loss32, shift32;
+
+	void set(int l, int s) {
+		loss16 = vdupq_n_s16(-l);
+		shift16 = vdupq_n_s16(s);
+		loss32 = vdupq_n_s32(-l);
+		shift32 = vdupq_n_s32(s);
+	}
+
+	uint16x8_t pack16(YUVVec c) const { return vshlq_u16(vshlq_u16(vreinterpretq_u16_s16(c), loss16), shift16); }
+	uint32x4_t pack32(uint32x4_t c) const { return vshlq_u32(vshlq_u32(c, loss32), shift32); }
+};
+
+static inline void yuvStore16(byte *dst, YUVVec r, YUVVec g, YUVVec b, YUVVec a, const YUVChannel *ch) {
+	const uint16x8_t p = vorrq_u16(vorrq_u16(ch[0].pack16(r), ch[1].pack16(g)),
+	                               vorrq_u16(ch[2].pack16(b), ch[3].pack16(a)));
+	vst1q_u8(dst, vreinterpretq_u8_u16(p));
+}
+
+static inline void yuvStore32(byte *dst, YUVVec r, YUVVec g, YUVVec b, YUVVec a, const YUVChannel *ch) {
+	const uint16x8_t ur = vreinterpretq_u16_s16(r), ug = vreinterpretq_u16_s16(g);
+	const uint16x8_t ub = vreinterpretq_u16_s16(b), ua = vreinterpretq_u16_s16(a);
+	const uint32x4_t lo = vorrq_u32(
+		vorrq_u32(ch[0].pack32(vmovl_u16(vget_low_u16(ur))), ch[1].pack32(vmovl_u16(vget_low_u16(ug)))),
+		vorrq_u32(ch[2].pack32(vmovl_u16(vget_low_u16(ub))), ch[3].pack32(vmovl_u16(vget_low_u16(ua)))));
+	const uint32x4_t hi = vorrq_u32(
+		vorrq_u32(ch[0].pack32(vmovl_u16(vget_high_u16(ur))), ch[1].pack32(vmovl_u16(vget_high_u16(ug)))),
+		vorrq_u32(ch[2].pack32(vmovl_u16(vget_high_u16(ub))), ch[3].pack32(vmovl_u16(vget_high_u16(ua)))));
+	vst1q_u8(dst, vreinterpretq_u8_u32(lo));
+	vst1q_u8(dst + 16, vreinterpretq_u8_u32(hi));
+}
+#endif
+
+/**
+ * The pixel format and luminance scale of the destination surface
+ */
+struct YUVSimdFormat {
+	YUVChannel channels[4]; // R, G, B, A
+	bool ituScale;
+
+	YUVSimdFormat(const Graphics::PixelFormat &format, YUVToRGBManager::LuminanceScale scale) {
+		channels[0].set(format.rLoss, format.rShift);
+		channels[1].set(format.gLoss, format.gShift);
+		channels[2].set(format.bLoss, format.bShift);
+		channels[3].set(format.aLoss, format.aShift);
+		ituScale = (scale == YUVToRGBManager::kScaleITU);
+	}
+};
+
+/** Chroma offsets of eight pixels, see the color tables */
+struct YUVChromaVec {
+	YUVVec r, g, b;
+
+	YUVChromaVec(YUVVec u, YUVVec v) {
+		r = yuvChroma(v, kCrRFactor);
+		g = yuvSub(yuvSplat(0), yuvAdd(yuvChroma(v, kCrGFactor), yuvChroma(u, kCbGFactor)));
+		b = yuvChroma(u, kCbBFactor);
+	}
+
+	YUVChromaVec(YUVVec r_, YUVVec g_, YUVVec b_) : r(r_), g(g_), b(b_) {}
+};
+
+template<typename PixelInt>
+static inline void convertYUVSimd(byte *dst, YUVVec y, YUVVec a, const YUVChromaVec &c, const YUVSimdFormat &f) {
+	YUVVec r = yuvAdd(y, c.r);
+	YUVVec g = yuvAdd(y, c.g);
+	YUVVec b = yuvAdd(y, c.b);
+
+	if (f.ituScale) {
+		r = yuvScaleITU(r);
+		g = yuvScaleITU(g);
+		b = yuvScaleITU(b);
+	} else {
+		r = yuvClamp(r, 0, 255);
+		g = yuvClamp(g, 0, 255);
+		b = yuvClamp(b, 0, 255);
+	}
+
+	if (sizeof(PixelInt) == 2)
+		yuvStore16(dst, r, g, b, a, f.channels);
+	else
+		yuvStore32(dst, r, g, b, a, f.channels);
+}
+
+/**
+ * Convert the pixels of a row with full resolution chroma, eight at a time.
+ * Returns the number of pixels converted.
+ */
+template<typename PixelInt>
+static int convertYUV444RowSimd(byte *dstPtr, const byte *ySrc, const byte *uSrc, const byte *vSrc, int width, const YUVSimdFormat &f) {
+	const YUVVec alpha = yuvSplat(255);
+	int x = 0;
+
+	for (; x + 8 <= width; x += 8) {
+		const YUVChromaVec c(yuvLoad(uSrc + x), yuvLoad(vSrc + x));
+		convertYUVSimd<PixelInt>(dstPtr + x * sizeof(PixelInt), yuvLoad(ySrc + x), alpha, c, f);
+	}
+
+	return x;
+}
+
+/**
+ * Convert the pixels of two rows sharing half resolution chroma, sixteen at
+ * a time. aSrc may be null for opaque pixels. Returns the number of pixels
+ * converted on each row.
+ */
+template<typename PixelInt>
+static int convertYUV420RowsSimd(byte *dstPtr, int dstPitch, const byte *ySrc, const byte *aSrc, int yPitch, const byte *uSrc, const byte *vSrc, int width, const YUVSimdFormat &f) {
+	const YUVVec opaque = yuvSplat(255);
+	int x = 0;
+
+	for (; x + 16 <= width; x += 16) {
+		const YUVChromaVec c(yuvLoad(uSrc + x / 2), yuvLoad(vSrc + x / 2));
+		const YUVChromaVec lo(yuvDupLo(c.r), yuvDupLo(c.g), yuvDupLo(c.b));
+		const YUVChromaVec hi(yuvDupHi(c.r), yuvDupHi(c.g), yuvDupHi(c.b));
+
+		for (int row = 0; row < 2; ++row) {
+			const byte *y = ySrc + row * yPitch + x;
+			byte *dst = dstPtr + row * dstPitch + x * sizeof(PixelInt);
+			const YUVVec aLo = aSrc ? yuvLoad(aSrc + row * yPitch + x) : opaque;
+			const YUVVec aHi = aSrc ? yuvLoad(aSrc + row * yPitch + x + 8) : opaque;
+
+			convertYUVSimd<PixelInt>(dst, yuvLoad(y), aLo, lo, f);
+			convertYUVSimd<PixelInt>(dst + 8 * sizeof(PixelInt), yuvLoad(y + 8), aHi, hi, f);
+		}
+	}
+
+	return x;
+}
+#endif
+
 #define PUT_PIXEL(s, d) \
 	L = &rgbToPix[(s)]; \
 	*((PixelInt *)(d)) = (L[cr_r] | L[crb_g] | L[cb_b])
@@ -215,8 +457,20 @@ void convertYUV444ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	const int16 *Cb_b_tab = Cb_g_tab + 256;
 	const uint32 *rgbToPix = lookup->getRGBToPix();
 
+#ifdef YUV_TO_RGB_SIMD
+	const YUVSimdFormat simdFormat(lookup->getFormat(), lookup->getScale());
+#endif
+
 	for (int h = 0; h < yHeight; h++) {
-		for (int w = 0; w < yWidth; w++) {
+		int w = 0;
+#ifdef YUV_TO_RGB_SIMD
+		w = convertYUV444RowSimd<PixelInt>(dstPtr, ySrc, uSrc, vSrc, yWidth, simdFormat);
+		dstPtr += w * sizeof(PixelInt);
+		ySrc += w;
+		uSrc += w;
+		vSrc += w;
+#endif
+		for (; w < yWidth; w++) {
 			const uint32 *L;
 
 			int16 cr_r  = Cr_r_tab[*vSrc];
@@ -264,8 +518,20 @@ void convertYUV420ToRGB(byte *dstPtr, int dstPitch, const YUVToRGBLookup *lookup
 	const int16 *Cb_b_tab = Cb_g_tab + 256;
 	const uint32 *rgbToPix = lookup->getRGBToPix();
 
+#ifdef YUV_TO_RGB_SIMD
+	const YUVSimdFormat simdFormat(lookup->getFormat(), lookup->getScale());
+#endif
+
 	for (int h = 0; h < halfHeight; h++) {
-		for (int w = 0; w < halfWidth; w++) {
+		int w = 0;
+#ifdef YUV_TO_RGB_SIMD
+		w = convertYUV420RowsSimd<PixelInt>(dstPtr, dstPitch, ySrc, nullptr, yPitch, uSrc, vSrc, yWidth, simdFormat) / 2;
+		dstPtr += w * 2 * sizeof(PixelInt);
+		ySrc += w * 2;
+		uSrc += w;
+		vSrc += w;
+#endif
+		for (; w < halfWidth; w++) {
 			const uint32 *L;
 
 			int16 cr_r  = Cr_r_tab[*vSrc];
@@ -325,8 +591,21 @@ void convertYUVA420ToRGBA(byte *dstPtr, int dstPitch, const YUVToRGBLookup *look
 	const uint32 *rgbToPix = lookup->getRGBToPix();
 	const uint32 *aToPix = lookup->getAlphaToPix();
 
+#ifdef YUV_TO_RGB_SIMD
+	const YUVSimdFormat simdFormat(lookup->getFormat(), lookup->getScale());
+#endif
+
 	for (int h = 0; h < halfHeight; h++) {
-		for (int w = 0; w < halfWidth; w++) {
+		int w = 0;
+#ifdef YUV_TO_RGB_SIMD
+		w = convertYUV420RowsSimd<PixelInt>(dstPtr, dstPitch, ySrc, aSrc, yPitch, uSrc, vSrc, yWidth, simdFormat) / 2;
+		dstPtr += w * 2 * sizeof(PixelInt);
+		ySrc += w * 2;
+		aSrc += w * 2;
+		uSrc += w;
+		vSrc += w;
+#endif
+		for (; w < halfWidth; w++) {
 			const uint32 *L;
 
 			int16 cr_r  = Cr_r_tab[*vSrc];
@@ -53,6 +53,7 @@ EventRecorder::EventRecorder() {
 	_timerManager = nullptr;
 	_recordMode = kPassthrough;
 	_fakeMixerManager = nullptr;
+	_renderMixerManager = nullptr;
 	_initialized = false;
 	_needRedraw = false;
 	_processingMillis = false;
@@ -94,6 +95,8 @@ void EventRecorder::deinit() {
 	_recordMode = kPassthrough;
 	delete _fakeMixerManager;
 	_fakeMixerManager = nullptr;
+	delete _renderMixerManager;
+	_renderMixerManager = nullptr;
 	_controlPanel->close();
 	delete _controlPanel;
 	debugC(1, kDebugLevelEventRec, "playback:action=stopplayback");
@@ -384,6 +387,13 @@ void EventRecorder::init(const Common::String &recordFileName, RecordMode mode)
 	_fakeMixerManager = new NullMixerManager();
 	_fakeMixerManager->init();
 	_fakeMixerManager->suspendAudio();
+	if (mode == kRecorderPlayback && ConfMan.hasKey("render_audio")) {
+		// Render the audio of the recording to a file, following the
+		// recorded timeline instead of the wall clock.
+		_renderMixerManager = new OfflineMixerManager(ConfMan.get("render_audio"));
+		_renderMixerManager->init();
+		_renderMixerManager->suspendAudio();
+	}
 	_fakeTimer = 0;
 	_lastMillis = g_system->getMillis();
 	_lastScreenshotTime = 0;
@@ -493,13 +503,18 @@ void EventRecorder::switchMixer() {
 		_realMixerManager->resumeAudio();
 	} else {
 		_realMixerManager->suspendAudio();
-		_fakeMixerManager->resumeAudio();
+		if (_renderMixerManager)
+			_renderMixerManager->resumeAudio();
+		else
+			_fakeMixerManager->resumeAudio();
 	}
 }
 
 MixerManager *EventRecorder::getMixerManager() {
 	if (_recordMode == kPassthrough) {
 		return _realMixerManager;
+	} else if (_renderMixerManager) {
+		return _renderMixerManager;
 	} else {
 		return _fakeMixerManager;
 	}
@@ -569,7 +584,10 @@ void EventRecorder::updateSubsystems() {
 	}
 	RecordMode oldRecordMode = _recordMode;
 	_recordMode = kPassthrough;
-	_fakeMixerManager->update();
+	if (_renderMixerManager)
+		_renderMixerManager->update(_fakeTimer);
+	else
+		_fakeMixerManager->update();
 	_recordMode = oldRecordMode;
 }
 
@@ -43,6 +43,7 @@
 #include "common/recorderfile.h"
 #include "backends/saves/recorder/recorder-saves.h"
 #include "backends/mixer/null/null-mixer.h"
+#include "backends/mixer/offline/offline-mixer.h"
 #include "backends/saves/default/default-saves.h"
 
 
@@ -206,6 +207,7 @@ private:
 	DefaultTimerManager *_timerManager;
 	RecorderSaveFileManager _fakeSaveManager;
 	NullMixerManager *_fakeMixerManager;
+	OfflineMixerManager *_renderMixerManager;
 	GUI::OnScreenDialog *_controlPanel;
 	Common::RecorderEvent _nextEvent;
 
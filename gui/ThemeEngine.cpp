@@ -23,6 +23,8 @@
 #include "common/config-manager.h"
 #include "common/file.h"
 #include "common/fs.h"
+#include "common/md5.h"
+#include "common/savefile.h"
 #include "common/compression/unzip.h"
 #include "common/tokenizer.h"
 #include "common/translation.h"
@@ -64,6 +66,10 @@ const char *const ThemeEngine::kImageEditSmallButton = "editbtn_small.bmp";
 const char *const ThemeEngine::kImageSwitchModeSmallButton = "switchbtn_small.bmp";
 const char *const ThemeEngine::kImageFastReplaySmallButton = "fastreplay_small.bmp";
 
+static const char *const kBitmapCacheFilename = "scummvm-theme-bitmaps.dat";
+#define BITMAP_CACHE_TAG MKTAG('T', 'B', 'M', 'P')
+#define BITMAP_CACHE_VERSION 1
+
 struct TextDrawData {
 	const Graphics::Font *_fontPtr;
 };
@@ -186,6 +192,25 @@ static const DrawDataInfo kDrawDataDefaults[] = {
 	{kDDSeparator,                  "separator",    kDrawLayerBackground,   kDDNone},
 };
 
+/** Memory used by the cached drawings of DrawData elements */
+static const uint32 kDrawCacheMaxSize = 4 * 1024 * 1024;
+
+static bool equalsArea(const Graphics::Surface &cached, const Graphics::Surface &surface, const Common::Rect &r) {
+	const int rowSize = r.width() * surface.format.bytesPerPixel;
+	for (int y = 0; y < r.height(); ++y) {
+		if (memcmp(cached.getBasePtr(0, y), surface.getBasePtr(r.left, r.top + y), rowSize))
+			return false;
+	}
+
+	return true;
+}
+
+static void copyArea(Graphics::Surface &cached, const Graphics::Surface &surface, const Common::Rect &r) {
+	if (!cached.getPixels())
+		cached.create(r.width(), r.height(), surface.format);
+	cached.copyRectToSurface(surface, 0, 0, r);
+}
+
 /**********************************************************
  * ThemeEngine class
  *********************************************************/
@@ -193,7 +218,7 @@ ThemeEngine::ThemeEngine(Common::String id, GraphicsMode mode) :
 	_system(nullptr), _vectorRenderer(nullptr),
 	_layerToDraw(kDrawLayerBackground), _bytesPerPixel(0),  _graphicsMode(kGfxDisabled),
 	_font(nullptr), _initOk(false), _themeOk(false), _enabled(false), _themeFiles(),
-	_cursor(nullptr), _scaleFactor(1.0f) {
+	_cursor(nullptr), _scaleFactor(1.0f), _drawCacheSize(0), _drawCacheUse(0), _bitmapCacheDirty(false) {
 
 	_baseWidth = 640;	// Default sane values
 	_baseHeight = 480;
@@ -248,6 +273,7 @@ ThemeEngine::~ThemeEngine() {
 	_vectorRenderer = nullptr;
 	_screen.free();
 	_backBuffer.free();
+	clearDrawCache();
 
 	unloadTheme();
 	unloadExtraFont();
@@ -465,6 +491,9 @@ void ThemeEngine::setGraphicsMode(GraphicsMode mode) {
 	_vectorRenderer = Graphics::createRenderer(mode);
 	_vectorRenderer->setSurface(&_screen);
 
+	// The cached drawings may have another pixel format
+	clearDrawCache();
+
 	// Since we reinitialized our screen surfaces we know nothing has been
 	// drawn so far. Sometimes we still end up with dirty screen bits in the
 	// list. Clearing it avoids invalid overlay writes when the backend
@@ -647,12 +676,22 @@ bool ThemeEngine::addTextColor(TextColor colorId, int r, int g, int b) {
 }
 
 bool ThemeEngine::addBitmap(const Common::String &filename, const Common::String &scalablefile, int width, int height) {
+	_themeBitmaps.push_back(filename);
+
 	// Nothing has to be done if the bitmap already has been loaded.
 	Graphics::ManagedSurface *surf = _bitmaps[filename];
 	if (surf) {
 		return true;
 	}
 
+	// Nor if it was decoded in a previous run.
+	ImagesMap::iterator cached = _cachedBitmaps.find(filename);
+	if (cached != _cachedBitmaps.end()) {
+		_bitmaps[filename] = cached->_value;
+		_cachedBitmaps.erase(cached);
+		return true;
+	}
+
 	if (!scalablefile.empty()) {
 		Common::ArchiveMemberList members;
 		_themeFiles.listMatchingMembers(members, scalablefile);
@@ -661,6 +700,7 @@ bool ThemeEngine::addBitmap(const Common::String &filename, const Common::String
 			if (stream) {
 				_bitmaps[filename] = new Graphics::SVGBitmap(stream, width * _scaleFactor, height * _scaleFactor);
 				delete stream;
+				_bitmapCacheDirty = true;
 				return true;
 			}
 		}
@@ -724,6 +764,8 @@ bool ThemeEngine::addBitmap(const Common::String &filename, const Common::String
 	}
 	// Store the surface into our hashmap (attention, may store NULL entries!)
 	_bitmaps[filename] = surf;
+	if (surf)
+		_bitmapCacheDirty = true;
 
 	return surf != nullptr;
 }
@@ -757,7 +799,16 @@ void ThemeEngine::loadTheme(const Common::String &themeId) {
 		_themeOk = loadDefaultXML();
 	} else {
 		// Load the archive containing image and XML data
+		loadBitmapCache();
 		_themeOk = loadThemeXML(themeId);
+		if (_themeOk)
+			saveBitmapCache();
+
+		for (ImagesMap::iterator i = _cachedBitmaps.begin(); i != _cachedBitmaps.end(); ++i) {
+			i->_value->free();
+			delete i->_value;
+		}
+		_cachedBitmaps.clear();
 	}
 
 	if (!_themeOk) {
@@ -778,6 +829,8 @@ void ThemeEngine::unloadTheme() {
 	if (!_themeOk)
 		return;
 
+	clearDrawCache();
+
 	for (int i = 0; i < kDrawDataMAX; ++i) {
 		delete _widgets[i];
 		_widgets[i] = nullptr;
@@ -805,6 +858,159 @@ void ThemeEngine::unloadExtraFont() {
 	_texts[kTextDataExtraLang] = nullptr;
 }
 
+Common::String ThemeEngine::getBitmapCacheKey() const {
+	// Only themes in zip files are cached, identified by the MD5 of the
+	// file. The themes are small enough to hash on every load. The bitmaps
+	// of theme directories may change at any time.
+	if (!_themeArchive || !_themeFile.matchString("*.zip", true) || !_system->getSavefileManager())
+		return Common::String();
+
+	Common::SeekableReadStream *stream = nullptr;
+	Common::FSNode node(_themeFile);
+	if (node.exists() && !node.isDirectory())
+		stream = node.createReadStream();
+	else
+		stream = SearchMan.createReadStreamForMember(_themeFile);
+	if (!stream)
+		return Common::String();
+
+	const Common::String md5 = Common::computeStreamMD5AsString(*stream);
+	const bool error = stream->err();
+	delete stream;
+	if (error)
+		return Common::String();
+
+	return Common::String::format("%s|%s|%g|%s", _themeFile.c_str(), md5.c_str(),
+	                              _scaleFactor, _overlayFormat.toString().c_str());
+}
+
+void ThemeEngine::loadBitmapCache() {
+	_themeBitmaps.clear();
+	_bitmapCacheDirty = false;
+
+	const Common::String key = getBitmapCacheKey();
+	if (key.empty())
+		return;
+
+	Common::InSaveFile *stream = _system->getSavefileManager()->openRawFile(kBitmapCacheFilename);
+	if (!stream)
+		return;
+
+	if (stream->readUint32BE() != BITMAP_CACHE_TAG || stream->readUint32BE() != BITMAP_CACHE_VERSION) {
+		delete stream;
+		return;
+	}
+
+	uint32 size = stream->readUint32BE();
+	if (stream->readString(0, size) != key) {
+		debug(6, "Theme bitmap cache is stale");
+		delete stream;
+		return;
+	}
+
+	const uint32 count = stream->readUint32BE();
+	for (uint32 i = 0; i < count && !stream->err() && !stream->eos(); ++i) {
+		size = stream->readUint32BE();
+		const Common::String filename = stream->readString(0, size);
+
+		Graphics::PixelFormat format;
+		format.bytesPerPixel = stream->readByte();
+		format.rLoss = stream->readByte();
+		format.gLoss = stream->readByte();
+		format.bLoss = stream->readByte();
+		format.aLoss = stream->readByte();
+		format.rShift = stream->readByte();
+		format.gShift = stream->readByte();
+		format.bShift = stream->readByte();
+		format.aShift = stream->readByte();
+		const uint16 w = stream->readUint16BE();
+		const uint16 h = stream->readUint16BE();
+
+		if (stream->err() || stream->eos() || format.bytesPerPixel == 0 || format.bytesPerPixel > 4)
+			break;
+
+		Graphics::ManagedSurface *surf = new Graphics::ManagedSurface(w, h, format);
+		for (int y = 0; y < h; ++y)
+			stream->read(surf->getBasePtr(0, y), w * format.bytesPerPixel);
+
+		if (_cachedBitmaps.contains(filename)) {
+			_cachedBitmaps[filename]->free();
+			delete _cachedBitmaps[filename];
+		}
+		_cachedBitmaps[filename] = surf;
+	}
+
+	if (stream->err() || stream->eos()) {
+		warning("Failed to read the theme bitmap cache");
+
+		for (ImagesMap::iterator i = _cachedBitmaps.begin(); i != _cachedBitmaps.end(); ++i) {
+			i->_value->free();
+			delete i->_value;
+		}
+		_cachedBitmaps.clear();
+	}
+
+	delete stream;
+}
+
+void ThemeEngine::saveBitmapCache() {
+	if (!_bitmapCacheDirty)
+		return;
+
+	const Common::String key = getBitmapCacheKey();
+	if (key.empty())
+		return;
+
+	Common::HashMap<Common::String, bool> saved;
+	Common::Array<Common::String> filenames;
+	for (uint i = 0; i < _themeBitmaps.size(); ++i) {
+		if (saved.contains(_themeBitmaps[i]) || !_bitmaps.contains(_themeBitmaps[i]) || !_bitmaps[_themeBitmaps[i]])
+			continue;
+
+		saved[_themeBitmaps[i]] = true;
+		filenames.push_back(_themeBitmaps[i]);
+	}
+
+	Common::OutSaveFile *stream = _system->getSavefileManager()->openForSaving(kBitmapCacheFilename, false);
+	if (!stream) {
+		warning("Failed to open the theme bitmap cache for writing");
+		return;
+	}
+
+	stream->writeUint32BE(BITMAP_CACHE_TAG);
+	stream->writeUint32BE(BITMAP_CACHE_VERSION);
+	stream->writeUint32BE(key.size());
+	stream->writeString(key);
+	stream->writeUint32BE(filenames.size());
+
+	for (uint i = 0; i < filenames.size(); ++i) {
+		const Graphics::ManagedSurface *surf = _bitmaps[filenames[i]];
+
+		stream->writeUint32BE(filenames[i].size());
+		stream->writeString(filenames[i]);
+		stream->writeByte(surf->format.bytesPerPixel);
+		stream->writeByte(surf->format.rLoss);
+		stream->writeByte(surf->format.gLoss);
+		stream->writeByte(surf->format.bLoss);
+		stream->writeByte(surf->format.aLoss);
+		stream->writeByte(surf->format.rShift);
+		stream->writeByte(surf->format.gShift);
+		stream->writeByte(surf->format.bShift);
+		stream->writeByte(surf->format.aShift);
+		stream->writeUint16BE(surf->w);
+		stream->writeUint16BE(surf->h);
+
+		for (int y = 0; y < surf->h; ++y)
+			stream->write(surf->getBasePtr(0, y), surf->w * surf->format.bytesPerPixel);
+	}
+
+	stream->finalize();
+	if (stream->err())
+		warning("Failed to write the theme bitmap cache");
+
+	delete stream;
+}
+
 bool ThemeEngine::loadDefaultXML() {
 
 	// The default XML theme is included on runtime from a pregenerated
@@ -937,15 +1143,86 @@ void ThemeEngine::drawDD(DrawData type, const Common::Rect &r, uint32 dynamic, b
 		restoreBackground(extendedRect);
 
 	if (drawData->_layer == _layerToDraw) {
-		Common::List<Graphics::DrawStep>::const_iterator step;
-		for (step = drawData->_steps.begin(); step != drawData->_steps.end(); ++step) {
-			_vectorRenderer->drawStep(area, _clip, *step, dynamic);
+		Graphics::Surface *surface = _vectorRenderer->getActiveSurface()->surfacePtr();
+		CachedDrawing *cached = nullptr;
+		if (area == r && (_clip.isEmpty() || _clip.contains(extendedRect)))
+			cached = getCachedDrawing(type, extendedRect, dynamic);
+
+		if (cached && cached->result.getPixels() && equalsArea(cached->background, *surface, extendedRect)) {
+			surface->copyRectToSurface(cached->result, extendedRect.left, extendedRect.top, Common::Rect(extendedRect.width(), extendedRect.height()));
+		} else {
+			if (cached)
+				copyArea(cached->background, *surface, extendedRect);
+
+			Common::List<Graphics::DrawStep>::const_iterator step;
+			for (step = drawData->_steps.begin(); step != drawData->_steps.end(); ++step) {
+				_vectorRenderer->drawStep(area, _clip, *step, dynamic);
+			}
+
+			if (cached)
+				copyArea(cached->result, *surface, extendedRect);
 		}
 
 		addDirtyRect(extendedRect);
 	}
 }
 
+ThemeEngine::CachedDrawing *ThemeEngine::getCachedDrawing(DrawData type, const Common::Rect &r, uint32 dynamic) {
+	if (!Common::Rect(_screen.w, _screen.h).contains(r))
+		return nullptr;
+
+	const uint32 size = 2 * r.width() * r.height() * _screen.format.bytesPerPixel;
+	if (size > kDrawCacheMaxSize / 4)
+		return nullptr;
+
+	// Gradients are dithered by the parity of the screen coordinates
+	const byte parity = (r.left & 1) | ((r.top & 1) << 1);
+
+	for (uint i = 0; i < _drawCache.size(); ++i) {
+		CachedDrawing &cached = _drawCache[i];
+		if (cached.type == type && cached.w == r.width() && cached.h == r.height() && cached.dynamic == dynamic && cached.parity == parity) {
+			cached.lastUse = ++_drawCacheUse;
+			return &cached;
+		}
+	}
+
+	while (!_drawCache.empty() && _drawCacheSize + size > kDrawCacheMaxSize) {
+		uint oldest = 0;
+		for (uint i = 1; i < _drawCache.size(); ++i) {
+			if (_drawCache[i].lastUse < _drawCache[oldest].lastUse)
+				oldest = i;
+		}
+
+		CachedDrawing &cached = _drawCache[oldest];
+		_drawCacheSize -= 2 * cached.w * cached.h * _screen.format.bytesPerPixel;
+		cached.background.free();
+		cached.result.free();
+		_drawCache.remove_at(oldest);
+	}
+
+	CachedDrawing cached;
+	cached.type = type;
+	cached.w = r.width();
+	cached.h = r.height();
+	cached.dynamic = dynamic;
+	cached.parity = parity;
+	cached.lastUse = ++_drawCacheUse;
+	_drawCache.push_back(cached);
+	_drawCacheSize += size;
+
+	return &_drawCache.back();
+}
+
+void ThemeEngine::clearDrawCache() {
+	for (uint i = 0; i < _drawCache.size(); ++i) {
+		_drawCache[i].background.free();
+		_drawCache[i].result.free();
+	}
+
+	_drawCache.clear();
+	_drawCacheSize = 0;
+}
+
 void ThemeEngine::drawDDText(TextData type, TextColor color, const Common::Rect &r, const Common::U32String &text,
 	bool restoreBg, bool ellipsis, Graphics::TextAlign alignH, TextAlignVertical alignV,
 	int deltax, const Common::Rect &drawableTextArea) {
@@ -23,12 +23,14 @@
 #define GUI_THEME_ENGINE_H
 
 #include "common/scummsys.h"
+#include "common/array.h"
 #include "common/fs.h"
 #include "common/hash-str.h"
 #include "common/hashmap.h"
 #include "common/language.h"
 #include "common/list.h"
 #include "common/str.h"
+#include "common/str-array.h"
 #include "common/rect.h"
 
 #include "graphics/managed_surface.h"
@@ -683,6 +685,25 @@ protected:
 	 */
 	void unloadTheme();
 
+	/**
+	 * Returns the key identifying the bitmaps of the current theme at the
+	 * current scale and overlay format in the bitmap cache, or an empty
+	 * string if the theme bitmaps can not be cached.
+	 */
+	Common::String getBitmapCacheKey() const;
+
+	/**
+	 * Reads the theme bitmaps decoded in a previous run from the bitmap
+	 * cache, for addBitmap() to use instead of decoding them again.
+	 */
+	void loadBitmapCache();
+
+	/**
+	 * Writes the bitmaps of the current theme to the bitmap cache, if some
+	 * of them had to be decoded.
+	 */
+	void saveBitmapCache();
+
 	/**
 	 * Unload the language specific font loaded via loadExtraFont()
 	*/
@@ -713,6 +734,29 @@ protected:
 	                TextAlignVertical alignV = kTextAlignVTop, int deltax = 0,
 	                const Common::Rect &drawableTextArea = Common::Rect(0, 0, 0, 0));
 
+	/**
+	 * A DrawData element as drawn to the active surface, kept so that it
+	 * can be copied instead of rasterized again when the same element is
+	 * drawn with the same size over the same background.
+	 */
+	struct CachedDrawing {
+		DrawData type;
+		int16 w, h;
+		uint32 dynamic;
+		byte parity; ///< Parities of the left and top coordinates
+		uint32 lastUse;
+		Graphics::Surface background; ///< Pixels of the area before drawing
+		Graphics::Surface result;     ///< Pixels of the area after drawing
+	};
+
+	/**
+	 * Returns the cache entry for drawing a DrawData element in the area r,
+	 * replacing the least recently used entries if needed, or nullptr if the
+	 * drawing can not be cached.
+	 */
+	CachedDrawing *getCachedDrawing(DrawData type, const Common::Rect &r, uint32 dynamic);
+	void clearDrawCache();
+
 	/**
 	 * DEBUG: Draws a white square and writes some text next to it.
 	 */
@@ -783,6 +827,11 @@ protected:
 	 */
 	WidgetDrawData *_widgets[kDrawDataMAX];
 
+	/** Recently drawn DrawData elements, and the memory they use */
+	Common::Array<CachedDrawing> _drawCache;
+	uint32 _drawCacheSize;
+	uint32 _drawCacheUse;
+
 	/** Array of all the text fonts that can be drawn. */
 	TextDrawData *_texts[kTextDataMAX];
 
@@ -795,6 +844,14 @@ protected:
 	Common::Array<LangExtraFont> _langExtraFonts;
 
 	ImagesMap _bitmaps;
+
+	/** Bitmaps read from the bitmap cache, not yet used by the theme */
+	ImagesMap _cachedBitmaps;
+	/** Bitmaps used by the theme being loaded */
+	Common::StringArray _themeBitmaps;
+	/** Whether some bitmaps of the theme being loaded were decoded */
+	bool _bitmapCacheDirty;
+
 	Graphics::PixelFormat _overlayFormat;
 	Graphics::PixelFormat _cursorFormat;
 
@@ -0,0 +1,142 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mididrv.h"
+#include "audio/midiparser.h"
+#include "common/array.h"
+#include "common/config-manager.h"
+
+class MidiParserRecordingDriver : public MidiDriver_BASE {
+public:
+	Common::Array<uint32> _events;
+
+	void send(uint32 b) override { _events.push_back(b); }
+	void metaEvent(byte type, byte *data, uint16 length) override { _events.push_back(0xFF00 | type); }
+};
+
+class MidiParserTestSuite : public CxxTest::TestSuite {
+	Common::Array<byte> _smf;
+
+	static void append(Common::Array<byte> &dst, const byte *data, uint size) {
+		for (uint i = 0; i < size; i++)
+			dst.push_back(data[i]);
+	}
+
+	void buildSmf() {
+		static const byte header[] = {
+			'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1, 0, 96,
+		};
+		Common::Array<byte> track;
+		// Tempo change to 400000 microseconds per quarter note
+		const byte tempo[] = { 0x00, 0xFF, 0x51, 0x03, 0x06, 0x1A, 0x80 };
+		append(track, tempo, sizeof(tempo));
+		for (int i = 0; i < 64; i++) {
+			// Note on, with running status for the note off. Use a two byte
+			// delta every few notes to exercise the variable length reader.
+			const byte note = 40 + (i % 24);
+			if (i % 5 == 0) {
+				const byte on[] = { 0x81, 0x10, 0x90, note, 0x60 };
+				append(track, on, sizeof(on));
+			} else {
+				const byte on[] = { 0x10, 0x90, note, 0x60 };
+				append(track, on, sizeof(on));
+			}
+			const byte off[] = { 0x20, note, 0x00 };
+			append(track, off, sizeof(off));
+			if (i == 32) {
+				const byte tempo2[] = { 0x00, 0xFF, 0x51, 0x03, 0x07, 0xA1, 0x20 };
+				append(track, tempo2, sizeof(tempo2));
+			}
+		}
+		const byte eot[] = { 0x00, 0xFF, 0x2F, 0x00 };
+		append(track, eot, sizeof(eot));
+
+		_smf.clear();
+		append(_smf, header, sizeof(header));
+		const byte trackHeader[] = {
+			'M', 'T', 'r', 'k',
+			(byte)(track.size() >> 24), (byte)(track.size() >> 16), (byte)(track.size() >> 8), (byte)track.size()
+		};
+		append(_smf, trackHeader, sizeof(trackHeader));
+		_smf.push_back(track);
+	}
+
+	MidiParser *createParser(MidiParserRecordingDriver &driver, bool compile) {
+		MidiParser *parser = MidiParser::createParser_SMF();
+		parser->property(MidiParser::mpCompileTracks, compile);
+		parser->property(MidiParser::mpAutoLoop, 1);
+		parser->setMidiDriver(&driver);
+		parser->setTimerRate(4000);
+		parser->loadMusic(_smf.data(), _smf.size());
+		return parser;
+	}
+
+public:
+	void setUp() {
+		ConfMan.registerDefault("dump_midi", false);
+		buildSmf();
+	}
+
+	void test_compiled_playback_matches() {
+		MidiParserRecordingDriver plainDriver, compiledDriver;
+		MidiParser *plain = createParser(plainDriver, false);
+		MidiParser *compiled = createParser(compiledDriver, true);
+
+		// Play long enough to loop the track a couple of times.
+		for (int i = 0; i < 5000; i++) {
+			plain->onTimer();
+			compiled->onTimer();
+			TS_ASSERT_EQUALS(plain->getTick(), compiled->getTick());
+		}
+		TS_ASSERT(!plainDriver._events.empty());
+		TS_ASSERT(plainDriver._events == compiledDriver._events);
+
+		delete plain;
+		delete compiled;
+	}
+
+	void test_compiled_jump_matches() {
+		MidiParserRecordingDriver plainDriver, compiledDriver;
+		MidiParser *plain = createParser(plainDriver, false);
+		MidiParser *compiled = createParser(compiledDriver, true);
+
+		static const uint32 ticks[] = { 1000, 17, 0, 4500, 20000, 2222, 100000 };
+		for (int i = 0; i < ARRAYSIZE(ticks); i++) {
+			TS_ASSERT_EQUALS(plain->jumpToTick(ticks[i]), compiled->jumpToTick(ticks[i]));
+			TS_ASSERT_EQUALS(plain->getTick(), compiled->getTick());
+			for (int j = 0; j < 200; j++) {
+				plain->onTimer();
+				compiled->onTimer();
+			}
+			TS_ASSERT_EQUALS(plain->getTick(), compiled->getTick());
+		}
+		TS_ASSERT(plainDriver._events == compiledDriver._events);
+
+		delete plain;
+		delete compiled;
+	}
+
+	void test_truncated_track_is_not_compiled() {
+		// Leave the end of track event out of the declared track length.
+		// The bytes stay in the buffer, so the plain parser reads them.
+		const uint32 length = _smf.size() - 22 - 4;
+		_smf[18] = length >> 24;
+		_smf[19] = length >> 16;
+		_smf[20] = length >> 8;
+		_smf[21] = length;
+
+		MidiParserRecordingDriver plainDriver, compiledDriver;
+		MidiParser *plain = createParser(plainDriver, false);
+		MidiParser *compiled = createParser(compiledDriver, true);
+
+		for (int i = 0; i < 3000; i++) {
+			plain->onTimer();
+			compiled->onTimer();
+		}
+		TS_ASSERT_EQUALS(plain->getTick(), compiled->getTick());
+		TS_ASSERT(!plainDriver._events.empty());
+		TS_ASSERT(plainDriver._events == compiledDriver._events);
+
+		delete plain;
+		delete compiled;
+	}
+};
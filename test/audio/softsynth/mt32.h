@@ -0,0 +1,58 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/softsynth/mt32/Partial.h"
+
+#include "../../random.h"
+
+class MT32PartialMixerTestSuite : public CxxTest::TestSuite {
+	/**
+	 * The mixing of Partial::produceAndMixSample(), one sample at a time
+	 */
+	static MT32Emu::IntSample mixSample(MT32Emu::IntSample buf, MT32Emu::IntSample sample, int32 panValue) {
+		const int32 out = ((int32(sample) * panValue) >> 13) + int32(buf);
+		return out < -0x8000 ? -0x8000 : (out > 0x7FFF ? 0x7FFF : out);
+	}
+
+	static float mixSample(float buf, float sample, int32 panValue) {
+		return buf + (sample * panValue) / 14.0f;
+	}
+
+public:
+	void test_int_mixer() {
+		// Odd lengths cover the samples after the last full vector
+		static const int32 panValues[] = { 0, 1, 4681, 8192, -8192, -3 };
+		TestRandomSource rnd(1);
+		for (int p = 0; p < ARRAYSIZE(panValues); ++p) {
+			for (uint32 length = 0; length < 40; length += 13) {
+				MT32Emu::IntSample block[40], buf[40], expected[40];
+				for (uint32 i = 0; i < length; ++i) {
+					// Full scale samples, so that the sums saturate
+					block[i] = (i % 7 == 0) ? (i % 2 ? -0x8000 : 0x7FFF) : int16(rnd.next() >> 8);
+					buf[i] = int16(rnd.next() >> 8);
+					expected[i] = mixSample(buf[i], block[i], panValues[p]);
+				}
+				MT32Emu::Partial::mixPannedBlock(buf, block, length, panValues[p]);
+				for (uint32 i = 0; i < length; ++i)
+					TS_ASSERT_EQUALS(buf[i], expected[i]);
+			}
+		}
+	}
+
+	void test_float_mixer() {
+		static const int32 panValues[] = { 0, 1, 7, 14, -14 };
+		TestRandomSource rnd(2);
+		for (int p = 0; p < ARRAYSIZE(panValues); ++p) {
+			for (uint32 length = 0; length < 40; length += 13) {
+				float block[40], buf[40], expected[40];
+				for (uint32 i = 0; i < length; ++i) {
+					block[i] = (int32((rnd.next() >> 8) & 0xFFFF) - 0x8000) / 32768.0f;
+					buf[i] = (int32((rnd.next() >> 8) & 0xFFFF) - 0x8000) / 32768.0f;
+					expected[i] = mixSample(buf[i], block[i], panValues[p]);
+				}
+				MT32Emu::Partial::mixPannedBlock(buf, block, length, panValues[p]);
+				for (uint32 i = 0; i < length; ++i)
+					TS_ASSERT_EQUALS(buf[i], expected[i]);
+			}
+		}
+	}
+};
@@ -0,0 +1,70 @@
+#include <cxxtest/TestSuite.h>
+
+#include "audio/mididrv.h"
+#include "audio/midiparser.h"
+#include "base/midirender.h"
+#include "common/array.h"
+#include "common/config-manager.h"
+#include "common/system.h"
+#include "common/timer.h"
+
+#include "../null_osystem.h"
+
+class MidiRenderTestSuite : public CxxTest::TestSuite {
+	class SilentDriver : public MidiDriver_BASE {
+	public:
+		void send(uint32 b) override {}
+	};
+
+	/** A single note of the given length, at 96 ticks per quarter note */
+	static void buildSmf(Common::Array<byte> &smf, uint16 ticks) {
+		const byte data[] = {
+			'M', 'T', 'h', 'd', 0, 0, 0, 6, 0, 0, 0, 1, 0, 96,
+			'M', 'T', 'r', 'k', 0, 0, 0, 13,
+			0x00, 0x90, 60, 0x60,
+			(byte)(0x80 | (ticks >> 7)), (byte)(ticks & 0x7F), 0x80, 60, 0x00,
+			0x00, 0xFF, 0x2F, 0x00
+		};
+		smf.resize(sizeof(data));
+		memcpy(smf.data(), data, sizeof(data));
+	}
+
+	/** Returns how long the song was played, in milliseconds */
+	static uint32 render(uint16 ticks) {
+		Common::Array<byte> smf;
+		buildSmf(smf, ticks);
+
+		SilentDriver driver;
+		MidiParser *parser = MidiParser::createParser_SMF();
+		parser->setMidiDriver(&driver);
+		parser->setTimerRate(10000);
+		TS_ASSERT(parser->loadMusic(smf.data(), smf.size()));
+		g_system->getTimerManager()->installTimerProc(&MidiParser::timerCallback, 10000, parser, "midirender");
+
+		const uint32 start = g_system->getMillis();
+		TS_ASSERT(Base::playMidiToEnd(*g_system, parser, 2000));
+		const uint32 length = g_system->getMillis() - start;
+
+		g_system->getTimerManager()->removeTimerProc(&MidiParser::timerCallback);
+		delete parser;
+		return length;
+	}
+
+public:
+	void test_tail() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+		ConfMan.registerDefault("dump_midi", false);
+
+		// The default tempo is 120 quarter notes per minute. The song ends
+		// on the tick after its last event.
+		uint32 length = render(96);
+		TS_ASSERT_LESS_THAN_EQUALS(500u + 2000u, length);
+		TS_ASSERT_LESS_THAN_EQUALS(length, 500u + 2000u + 30u);
+
+		length = render(3072);
+		TS_ASSERT_LESS_THAN_EQUALS(16000u + 2000u, length);
+		TS_ASSERT_LESS_THAN_EQUALS(length, 16000u + 2000u + 30u);
+#endif
+	}
+};
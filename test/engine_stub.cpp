@@ -0,0 +1,45 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// The GUI checks for a running engine, and the Mac GUI pauses it while its
+// menus are open. There is no engine in the tests, so this stands in for
+// the parts they use.
+#include "engines/engine.h"
+
+Engine *g_engine = nullptr;
+
+PauseToken::PauseToken() : _engine(nullptr) {}
+
+#if __cplusplus >= 201103L
+PauseToken::PauseToken(PauseToken &&t2) : _engine(t2._engine) {
+	t2._engine = nullptr;
+}
+#endif
+
+PauseToken::~PauseToken() {}
+
+void PauseToken::clear() {
+	_engine = nullptr;
+}
+
+PauseToken Engine::pauseEngine() {
+	return PauseToken();
+}
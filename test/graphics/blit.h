@@ -0,0 +1,112 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/util.h"
+#include "graphics/blit.h"
+#include "graphics/pixelformat.h"
+
+#include "../random.h"
+
+class BlitTestSuite : public CxxTest::TestSuite {
+	// Not a multiple of the vector sizes
+	static const uint kWidth = 29;
+	static const uint kHeight = 5;
+
+	static uint32 readPixel(const byte *p, uint bytesPerPixel) {
+		if (bytesPerPixel == 1)
+			return *p;
+		if (bytesPerPixel == 2)
+			return *(const uint16 *)p;
+		return *(const uint32 *)p;
+	}
+
+	/**
+	 * Check a conversion against the per pixel conversion through
+	 * colorToARGB() and ARGBToColor(), both to another buffer and in place.
+	 */
+	static void checkCrossBlit(const Graphics::PixelFormat &dstFmt, const Graphics::PixelFormat &srcFmt) {
+		const uint srcPitch = (kWidth + 3) * srcFmt.bytesPerPixel;
+		const uint dstPitch = (kWidth + 1) * dstFmt.bytesPerPixel;
+		Common::Array<byte> src(srcPitch * kHeight), dst(dstPitch * kHeight, 0);
+		TestRandomSource(srcFmt.bytesPerPixel * 7 + dstFmt.rShift).fill(src.data(), src.size());
+
+		TS_ASSERT(Graphics::crossBlit(&dst[0], &src[0], dstPitch, srcPitch, kWidth, kHeight, dstFmt, srcFmt));
+
+		for (uint y = 0; y < kHeight; ++y) {
+			for (uint x = 0; x < kWidth; ++x) {
+				byte a, r, g, b;
+				srcFmt.colorToARGB(readPixel(&src[y * srcPitch + x * srcFmt.bytesPerPixel], srcFmt.bytesPerPixel), a, r, g, b);
+				TS_ASSERT_EQUALS(readPixel(&dst[y * dstPitch + x * dstFmt.bytesPerPixel], dstFmt.bytesPerPixel), dstFmt.ARGBToColor(a, r, g, b));
+			}
+		}
+
+		// Convert the source in place, with the pitch of the largest pixels
+		const uint pitch = kWidth * MAX(srcFmt.bytesPerPixel, dstFmt.bytesPerPixel);
+		Common::Array<byte> inPlace(pitch * kHeight, 0);
+		for (uint y = 0; y < kHeight; ++y)
+			memcpy(&inPlace[y * pitch], &src[y * srcPitch], kWidth * srcFmt.bytesPerPixel);
+		TS_ASSERT(Graphics::crossBlit(&inPlace[0], &inPlace[0], pitch, pitch, kWidth, kHeight, dstFmt, srcFmt));
+		for (uint y = 0; y < kHeight; ++y)
+			TS_ASSERT_SAME_DATA(&inPlace[y * pitch], &dst[y * dstPitch], kWidth * dstFmt.bytesPerPixel);
+	}
+
+	static void checkCrossBlitMap(uint bytesPerPixel) {
+		uint32 map[256];
+		for (uint i = 0; i < 256; ++i)
+			map[i] = (bytesPerPixel == 2) ? (i * 0x0101 ^ 0x1234) : (i * 0x01010101 ^ 0x12345678);
+
+		const uint srcPitch = kWidth + 3;
+		const uint dstPitch = kWidth * bytesPerPixel;
+		Common::Array<byte> src(srcPitch * kHeight), dst(dstPitch * kHeight, 0);
+		TestRandomSource(bytesPerPixel).fill(src.data(), src.size());
+
+		TS_ASSERT(Graphics::crossBlitMap(&dst[0], &src[0], dstPitch, srcPitch, kWidth, kHeight, bytesPerPixel, map));
+		for (uint y = 0; y < kHeight; ++y) {
+			for (uint x = 0; x < kWidth; ++x)
+				TS_ASSERT_EQUALS(readPixel(&dst[y * dstPitch + x * bytesPerPixel], bytesPerPixel), map[src[y * srcPitch + x]]);
+		}
+
+		Common::Array<byte> inPlace(dstPitch * kHeight, 0);
+		for (uint y = 0; y < kHeight; ++y)
+			memcpy(&inPlace[y * dstPitch], &src[y * srcPitch], kWidth);
+		TS_ASSERT(Graphics::crossBlitMap(&inPlace[0], &inPlace[0], dstPitch, dstPitch, kWidth, kHeight, bytesPerPixel, map));
+		TS_ASSERT(inPlace == dst);
+	}
+
+	static Graphics::PixelFormat rgb565() { return Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0); }
+	static Graphics::PixelFormat rgb555() { return Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0); }
+	static Graphics::PixelFormat xrgb8888() { return Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0); }
+	static Graphics::PixelFormat argb8888() { return Graphics::PixelFormat(4, 8, 8, 8, 8, 16, 8, 0, 24); }
+	static Graphics::PixelFormat abgr8888() { return Graphics::PixelFormat(4, 8, 8, 8, 8, 0, 8, 16, 24); }
+	static Graphics::PixelFormat rgba8888() { return Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0); }
+
+public:
+	void test_16bpp_to_32bpp() {
+		checkCrossBlit(xrgb8888(), rgb565());
+		checkCrossBlit(argb8888(), rgb565());
+		checkCrossBlit(rgba8888(), rgb565());
+	}
+
+	void test_32bpp_to_16bpp() {
+		checkCrossBlit(rgb565(), xrgb8888());
+		checkCrossBlit(rgb565(), rgba8888());
+	}
+
+	void test_16bpp_to_16bpp() {
+		checkCrossBlit(rgb565(), rgb555());
+		// Not a specialized pair
+		checkCrossBlit(rgb555(), rgb565());
+	}
+
+	void test_32bpp_swizzles() {
+		checkCrossBlit(argb8888(), abgr8888());
+		checkCrossBlit(abgr8888(), argb8888());
+		checkCrossBlit(rgba8888(), xrgb8888());
+		checkCrossBlit(xrgb8888(), rgba8888());
+	}
+
+	void test_clut8() {
+		checkCrossBlitMap(2);
+		checkCrossBlitMap(4);
+	}
+};
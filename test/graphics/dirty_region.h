@@ -0,0 +1,133 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "graphics/dirty_region.h"
+
+class DirtyRegionTestSuite : public CxxTest::TestSuite {
+	// Area covered by a list of rects, which must not overlap
+	static int area(const Common::Array<Common::Rect> &rects) {
+		int total = 0;
+		for (uint i = 0; i < rects.size(); ++i) {
+			total += rects[i].width() * rects[i].height();
+			for (uint j = i + 1; j < rects.size(); ++j)
+				TS_ASSERT(!rects[i].intersects(rects[j]));
+		}
+		return total;
+	}
+
+	static bool covers(const Common::Array<Common::Rect> &rects, const Common::Rect &r) {
+		for (int y = r.top; y < r.bottom; ++y) {
+			for (int x = r.left; x < r.right; ++x) {
+				bool found = false;
+				for (uint i = 0; i < rects.size() && !found; ++i)
+					found = rects[i].contains(x, y);
+				if (!found)
+					return false;
+			}
+		}
+		return true;
+	}
+
+public:
+	void test_empty() {
+		Graphics::DirtyRegion region(320, 200);
+		Common::Array<Common::Rect> rects;
+
+		TS_ASSERT(region.isEmpty());
+		TS_ASSERT(region.getRects(rects));
+		TS_ASSERT(rects.empty());
+
+		// Outside of the area
+		region.addRect(Common::Rect(320, 0, 340, 10));
+		region.addRect(Common::Rect(-10, -10, 0, 0));
+		TS_ASSERT(region.isEmpty());
+	}
+
+	void test_tiles() {
+		Graphics::DirtyRegion region(320, 200);
+		Common::Array<Common::Rect> rects;
+
+		region.addRect(Common::Rect(20, 5, 21, 6));
+		TS_ASSERT(!region.isEmpty());
+		TS_ASSERT(region.intersects(Common::Rect(16, 0, 18, 2)));
+		TS_ASSERT(!region.intersects(Common::Rect(0, 0, 16, 200)));
+
+		TS_ASSERT(region.getRects(rects));
+		TS_ASSERT_EQUALS(rects.size(), 1U);
+		TS_ASSERT_EQUALS(rects[0], Common::Rect(16, 0, 32, 16));
+
+		// Overlapping rects give the same tiles
+		region.addRect(Common::Rect(17, 3, 30, 15));
+		TS_ASSERT(region.getRects(rects));
+		TS_ASSERT_EQUALS(rects.size(), 1U);
+
+		region.clear();
+		TS_ASSERT(region.isEmpty());
+		TS_ASSERT(!region.intersects(Common::Rect(320, 200)));
+	}
+
+	void test_coalescing() {
+		Graphics::DirtyRegion region(300, 190);
+		Common::Array<Common::Rect> rects;
+
+		// Two columns of tiles, joined on a row, with the last ones clipped
+		// to the size of the area
+		region.addRect(Common::Rect(0, 0, 10, 100));
+		region.addRect(Common::Rect(40, 20, 70, 100));
+		region.addRect(Common::Rect(0, 120, 100, 130));
+		region.addRect(Common::Rect(290, 185, 300, 190));
+
+		TS_ASSERT(region.getRects(rects));
+		TS_ASSERT_EQUALS(rects.size(), 4U);
+		TS_ASSERT_EQUALS(rects[0], Common::Rect(0, 0, 16, 112));
+		TS_ASSERT_EQUALS(rects[1], Common::Rect(32, 16, 80, 112));
+		TS_ASSERT_EQUALS(rects[2], Common::Rect(0, 112, 112, 144));
+		TS_ASSERT_EQUALS(rects[3], Common::Rect(288, 176, 300, 190));
+	}
+
+	void test_wide() {
+		// More than one word of tiles per row
+		Graphics::DirtyRegion region(1280, 64);
+		Common::Array<Common::Rect> rects;
+		const Common::Rect r1(500, 10, 1100, 20), r2(1270, 50, 1280, 64);
+
+		region.addRect(r1);
+		region.addRect(r2);
+		TS_ASSERT(region.getRects(rects));
+		TS_ASSERT_EQUALS(rects.size(), 2U);
+		TS_ASSERT(covers(rects, r1));
+		TS_ASSERT(covers(rects, r2));
+		TS_ASSERT_EQUALS(area(rects), 608 * 32 + 16 * 16);
+	}
+
+	void test_fragmented() {
+		Graphics::DirtyRegion region(320, 200);
+		Common::Array<Common::Rect> rects;
+
+		// A checkerboard of single tiles
+		region.setMaxRects(10);
+		for (int y = 0; y < 200; y += 32) {
+			for (int x = 0; x < 320; x += 32)
+				region.addRect(Common::Rect(x, y, x + 1, y + 1));
+		}
+		TS_ASSERT(!region.getRects(rects));
+		TS_ASSERT_EQUALS(rects.size(), 1U);
+		TS_ASSERT_EQUALS(rects[0], Common::Rect(320, 200));
+
+		region.setMaxRects(100);
+		TS_ASSERT(region.getRects(rects));
+		TS_ASSERT_EQUALS(rects.size(), 70U);
+		// The last row of tiles is clipped to the height of the area
+		TS_ASSERT_EQUALS(area(rects), 60 * 16 * 16 + 10 * 16 * 8);
+
+		// Almost everything
+		region.clear();
+		region.addRect(Common::Rect(0, 0, 320, 180));
+		TS_ASSERT(!region.getRects(rects));
+		TS_ASSERT_EQUALS(rects[0], Common::Rect(320, 200));
+
+		region.clear();
+		region.addAll();
+		TS_ASSERT(!region.getRects(rects));
+	}
+};
@@ -0,0 +1,114 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "graphics/larryScale.h"
+
+#include "../random.h"
+
+class LarryScaleTestSuite : public CxxTest::TestSuite {
+	class Image : public Graphics::RowReader, public Graphics::RowWriter {
+	public:
+		int _width, _height;
+		Common::Array<byte> _pixels;
+
+		Image(int width, int height) : _width(width), _height(height), _pixels(width * height) {}
+
+		const Graphics::LarryScaleColor *readRow(int y) override {
+			return &_pixels[y * _width];
+		}
+
+		void writeRow(int y, const Graphics::LarryScaleColor *row) override {
+			TS_ASSERT(y >= 0 && y < _height);
+			memcpy(&_pixels[y * _width], row, _width);
+		}
+
+		uint32 checksum() const {
+			uint32 hash = 2166136261u;
+			for (uint i = 0; i < _pixels.size(); ++i)
+				hash = (hash ^ _pixels[i]) * 16777619u;
+			return hash;
+		}
+	};
+
+	/**
+	 * A cartoon like image on a transparent background: filled shapes with
+	 * outlines, one pixel wide lines and some noise
+	 */
+	static void draw(Image &image, uint32 seed) {
+		const int w = image._width, h = image._height;
+		TestRandomSource rnd(seed);
+		for (int i = 0; i < 6; ++i) {
+			const uint32 r1 = rnd.next();
+			const int x1 = (r1 >> 8) % w, y1 = (r1 >> 16) % h;
+			const uint32 r2 = rnd.next();
+			const int x2 = MIN(w, x1 + 3 + (int)(r2 >> 8) % 12), y2 = MIN(h, y1 + 3 + (int)(r2 >> 16) % 9);
+			for (int y = y1; y < y2; ++y) {
+				for (int x = x1; x < x2; ++x) {
+					const bool outline = (x == x1 || y == y1 || x == x2 - 1 || y == y2 - 1);
+					image._pixels[y * w + x] = outline ? 1 : 2 + i;
+				}
+			}
+		}
+		for (int i = 0; i < 4; ++i) {
+			const uint32 r = rnd.next();
+			int x = (r >> 8) % w, y = (r >> 16) % h;
+			for (; x < w && y < h; ++x) {
+				image._pixels[y * w + x] = 9;
+				if ((x + i) % (i + 1) == 0)
+					++y;
+			}
+		}
+		for (int i = 0; i < w * h / 20; ++i) {
+			const uint32 r = rnd.next();
+			image._pixels[(r >> 8) % (w * h)] = 10 + (r >> 24) % 3;
+		}
+	}
+
+	static uint32 scale(int srcWidth, int srcHeight, int dstWidth, int dstHeight, uint32 seed) {
+		Image src(srcWidth, srcHeight), dst(dstWidth, dstHeight);
+		draw(src, seed);
+		Graphics::larryScale(srcWidth, srcHeight, 0, src, dstWidth, dstHeight, dst);
+
+		// No new colors are introduced
+		bool used[256] = {};
+		for (uint i = 0; i < src._pixels.size(); ++i)
+			used[src._pixels[i]] = true;
+		for (uint i = 0; i < dst._pixels.size(); ++i) {
+			if (!used[dst._pixels[i]]) {
+				TS_ASSERT(used[dst._pixels[i]]);
+				break;
+			}
+		}
+
+		return dst.checksum();
+	}
+
+public:
+	void test_copy() {
+		Image src(19, 7), dst(19, 7);
+		draw(src, 1);
+		Graphics::larryScale(19, 7, 0, src, 19, 7, dst);
+		TS_ASSERT_EQUALS(src.checksum(), dst.checksum());
+	}
+
+	void test_upscale() {
+		// The outputs of the scalar implementation, these must not change
+		TS_ASSERT_EQUALS(scale(37, 23, 74, 46, 1), 1722726920u);
+		TS_ASSERT_EQUALS(scale(37, 23, 55, 30, 2), 444189411u);
+		TS_ASSERT_EQUALS(scale(37, 23, 37, 46, 3), 2978180870u);
+		TS_ASSERT_EQUALS(scale(37, 23, 74, 23, 4), 933215585u);
+		TS_ASSERT_EQUALS(scale(131, 45, 262, 90, 5), 3604947865u);
+		TS_ASSERT_EQUALS(scale(16, 16, 32, 32, 6), 170650480u);
+		TS_ASSERT_EQUALS(scale(17, 40, 33, 79, 7), 2235051312u);
+	}
+
+	void test_two_pass() {
+		TS_ASSERT_EQUALS(scale(37, 23, 100, 60, 8), 4218852363u);
+		TS_ASSERT_EQUALS(scale(37, 23, 60, 20, 9), 643835431u);
+	}
+
+	void test_downscale() {
+		TS_ASSERT_EQUALS(scale(37, 23, 20, 12, 10), 1881563082u);
+		TS_ASSERT_EQUALS(scale(64, 48, 13, 9, 11), 1283159739u);
+	}
+};
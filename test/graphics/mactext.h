@@ -0,0 +1,127 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/fontman.h"
+#include "graphics/macgui/mactext.h"
+#include "graphics/macgui/macwindowmanager.h"
+#include "graphics/managed_surface.h"
+
+#include "../null_osystem.h"
+
+class MacTextTestSuite : public CxxTest::TestSuite {
+	static const int kMaxWidth = 120;
+	static const uint32 kMode = Graphics::kWMModeNoDesktop | Graphics::kWMModeForceBuiltinFonts | Graphics::kWMMode32bpp | Graphics::kWMNoScummVMWallpaper;
+
+	class TestMacText : public Graphics::MacText {
+	public:
+		TestMacText(const Common::U32String &s, Graphics::MacWindowManager *wm) :
+			MacText(s, wm, FontMan.getFontByUsage(Graphics::FontManager::kBigGUIFont),
+			        wm->_pixelformat.RGBToColor(0, 0, 0), wm->_pixelformat.RGBToColor(255, 255, 255),
+			        kMaxWidth, Graphics::kTextAlignLeft) {}
+
+		int countRenderedLines() const {
+			int count = 0;
+			for (uint i = 0; i < _textLines.size(); i++) {
+				if (_textLines[i].rendered)
+					count++;
+			}
+			return count;
+		}
+	};
+
+	static Common::U32String lines(int from, int to) {
+		Common::U32String str;
+		for (int i = from; i < to; i++)
+			str += Common::U32String(Common::String::format("Line %d\n", i));
+		return str;
+	}
+
+	/**
+	 * Compares the given rows of the surfaces, from the top of a and from
+	 * the given row of b
+	 */
+	static bool sameRows(const Graphics::ManagedSurface &a, const Graphics::ManagedSurface &b, int top, int height) {
+		if (a.w != b.w || a.h < height || b.h < top + height)
+			return false;
+		for (int y = 0; y < height; y++) {
+			for (int x = 0; x < a.w; x++) {
+				if (a.getPixel(x, y) != b.getPixel(x, top + y))
+					return false;
+			}
+		}
+		return true;
+	}
+
+	static bool sameText(TestMacText &text, TestMacText &reference) {
+		if (text.getTextHeight() != reference.getTextHeight())
+			return false;
+		const Graphics::ManagedSurface *surface = text.getSurface();
+		const Graphics::ManagedSurface *expected = reference.getSurface();
+		return sameRows(*surface, *expected, 0, reference.getTextHeight());
+	}
+
+public:
+	void test_append() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+		Graphics::MacWindowManager wm(kMode);
+
+		// The lines appended one by one, drawn after each of them, are
+		// the same as when the whole text is laid out at once
+		TestMacText text(lines(0, 1), &wm);
+		text.getSurface();
+		for (int i = 1; i < 40; i++) {
+			text.appendTextDefault(lines(i, i + 1));
+			text.getSurface();
+		}
+
+		TestMacText reference(lines(0, 40), &wm);
+		TS_ASSERT(sameText(text, reference));
+#endif
+	}
+
+	void test_scrolled_viewport() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+		Graphics::MacWindowManager wm(kMode);
+
+		TestMacText text(lines(0, 60), &wm);
+		TestMacText reference(lines(0, 60), &wm);
+		const Graphics::ManagedSurface *expected = reference.getSurface();
+
+		// Only the lines in the viewport are rendered
+		const int top = text.getTextHeight() / 2 + 3, height = 40;
+		Graphics::ManagedSurface viewport(expected->w, height, wm._pixelformat);
+		viewport.clear(wm._pixelformat.RGBToColor(255, 255, 255));
+		text.draw(&viewport, 0, top, viewport.w, height, 0, 0);
+		TS_ASSERT(sameRows(viewport, *expected, top, height));
+		TS_ASSERT_LESS_THAN(0, text.countRenderedLines());
+		TS_ASSERT_LESS_THAN_EQUALS(text.countRenderedLines(), height / text.getLineHeight(0) + 2);
+
+		// And the rest of the text is rendered when the whole of it is used
+		TS_ASSERT(sameText(text, reference));
+		TS_ASSERT_EQUALS(text.countRenderedLines(), text.getLineCount());
+#endif
+	}
+
+	void test_append_to_last_line() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+		Graphics::MacWindowManager wm(kMode);
+
+		// An empty line is shorter than the others, except when it is the
+		// only line, so the appended text changes the height of the last
+		// line, which moves the new line up
+		TestMacText text(Common::U32String(), &wm), reference(Common::U32String(), &wm);
+		text.getSurface();
+		const int emptyHeight = text.getLineHeight(0);
+		text.appendTextDefault(Common::U32String("Line 1"));
+		reference.appendTextDefault(Common::U32String("Line 1"));
+		TS_ASSERT_LESS_THAN(text.getLineHeight(0), emptyHeight);
+
+		// The text drawn before the append is the same as the text laid
+		// out and rendered again as a whole
+		reference.setInterLinear(0);
+		TS_ASSERT(sameText(text, reference));
+#endif
+	}
+};
@@ -0,0 +1,101 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/macgui/macwindow.h"
+#include "graphics/macgui/macwindowmanager.h"
+#include "graphics/managed_surface.h"
+
+#include "../null_osystem.h"
+
+class MacWindowManagerTestSuite : public CxxTest::TestSuite {
+	static const int kWidth = 160;
+	static const int kHeight = 120;
+	static const uint32 kMode = Graphics::kWMModeNoDesktop | Graphics::kWMModeForceBuiltinFonts | Graphics::kWMMode32bpp | Graphics::kWMNoScummVMWallpaper;
+
+	static Graphics::MacWindow *addWindow(Graphics::MacWindowManager &wm, const Common::Rect &dims) {
+		Graphics::MacWindow *w = wm.addWindow(false, false, false);
+		w->disableBorder();
+		w->setDimensions(dims);
+		return w;
+	}
+
+	static Common::Rect damageBounds(Graphics::MacWindow *w, uint &count) {
+		Common::Array<Common::Rect> rects;
+		w->getDamage(rects);
+		count = rects.size();
+		Common::Rect bounds;
+		for (uint i = 0; i < rects.size(); i++) {
+			if (i == 0)
+				bounds = rects[i];
+			else
+				bounds.extend(rects[i]);
+		}
+		return bounds;
+	}
+
+public:
+	void test_damage() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+		Graphics::MacWindowManager wm(kMode);
+		Graphics::ManagedSurface screen(kWidth, kHeight, wm._pixelformat);
+		wm.setScreen(&screen);
+
+		Graphics::MacWindow *w = addWindow(wm, Common::Rect(10, 10, 150, 110));
+		wm.draw();
+		TS_ASSERT(!w->isDirty());
+
+		// Only the tiles around the damaged part are copied to the screen
+		const Common::Rect &inner = w->getInnerDimensions();
+		const Common::Rect part(inner.left + 5, inner.top + 5, inner.left + 15, inner.top + 10);
+		w->addDamage(Common::Rect(5, 5, 15, 10));
+		wm.draw();
+		TS_ASSERT(!w->isDirty());
+		TS_ASSERT_EQUALS(wm.getScreenDamage().size(), 1u);
+		TS_ASSERT(wm.getScreenDamage()[0].contains(part));
+		TS_ASSERT_LESS_THAN_EQUALS(wm.getScreenDamage()[0].width(), 32);
+		TS_ASSERT_LESS_THAN_EQUALS(wm.getScreenDamage()[0].height(), 32);
+
+		// Damage outside of the window is dropped
+		w->addDamage(Common::Rect(-20, -20, -10, -10));
+		TS_ASSERT(!w->isDirty());
+#endif
+	}
+
+	void test_occluded_damage() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+		Graphics::MacWindowManager wm(kMode);
+		Graphics::ManagedSurface screen(kWidth, kHeight, wm._pixelformat);
+		wm.setScreen(&screen);
+
+		Graphics::MacWindow *below = addWindow(wm, Common::Rect(30, 30, 70, 70));
+		wm.draw();
+		Graphics::MacWindow *above = addWindow(wm, Common::Rect(0, 0, kWidth, kHeight));
+		wm.draw();
+
+		// Its border changed when the window above was activated, which
+		// only the window itself can draw now
+		below->draw();
+		TS_ASSERT(!below->isDirty());
+
+		// A covered window is not drawn, and its damage is kept short
+		// until it is, without losing any part
+		uint count;
+		for (int i = 0; i < 100; i++) {
+			below->addDamage(Common::Rect(i % 6, i / 20, i % 6 + 1, i / 20 + 1));
+			wm.draw();
+			TS_ASSERT(wm.getScreenDamage().empty());
+			damageBounds(below, count);
+			TS_ASSERT_LESS_THAN_EQUALS(count, (uint)Graphics::kMaxDamageRects);
+		}
+		const Common::Rect &inner = below->getInnerDimensions();
+		TS_ASSERT_EQUALS(damageBounds(below, count), Common::Rect(inner.left, inner.top, inner.left + 6, inner.top + 5));
+
+		// The window above is still drawn
+		above->addDamage(Common::Rect(40, 40, 50, 50));
+		wm.draw();
+		TS_ASSERT_EQUALS(wm.getScreenDamage().size(), 1u);
+		TS_ASSERT(!above->isDirty());
+#endif
+	}
+};
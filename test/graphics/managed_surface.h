@@ -0,0 +1,106 @@
+#include <cxxtest/TestSuite.h>
+
+#include "graphics/managed_surface.h"
+
+#include "../random.h"
+
+class ManagedSurfaceTestSuite : public CxxTest::TestSuite {
+	static void fill(Graphics::ManagedSurface &surf, uint32 seed, uint32 key) {
+		TestRandomSource rnd(seed);
+		for (int y = 0; y < surf.h; ++y) {
+			for (int x = 0; x < surf.w; ++x) {
+				const uint32 r = rnd.next();
+				// About a third of the pixels are transparent
+				uint32 color = ((r >> 8) % 3 == 0) ? key : (r >> 4);
+				if (surf.format.bytesPerPixel == 1)
+					*(byte *)surf.getBasePtr(x, y) = color;
+				else if (surf.format.bytesPerPixel == 2)
+					*(uint16 *)surf.getBasePtr(x, y) = color;
+				else
+					*(uint32 *)surf.getBasePtr(x, y) = color;
+			}
+		}
+	}
+
+	/**
+	 * Per pixel keyed blit, picking the source pixels like transBlitFrom()
+	 */
+	static void referenceBlit(const Graphics::ManagedSurface &src, const Common::Rect &srcRect, Graphics::ManagedSurface &dst,
+	                          const Common::Rect &destRect, uint32 key, bool flipped) {
+		const int scaleX = 0x100 * srcRect.width() / destRect.width();
+		const int scaleY = 0x100 * srcRect.height() / destRect.height();
+		const Graphics::PixelFormat &format = src.format;
+		const uint32 mask = format.isCLUT8() ? 0xFF : format.ARGBToColor(0, 0xFF, 0xFF, 0xFF);
+
+		for (int y = destRect.top; y < destRect.bottom; ++y) {
+			if (y < 0 || y >= dst.h)
+				continue;
+			const int srcY = (y - destRect.top) * scaleY / 0x100 + srcRect.top;
+			for (int x = destRect.left; x < destRect.right; ++x) {
+				if (x < 0 || x >= dst.w)
+					continue;
+				int srcX = (x - destRect.left) * scaleX / 0x100;
+				srcX = flipped ? src.w - srcX - 1 : srcX;
+				const uint32 color = src.getPixel(srcRect.left + srcX, srcY);
+				if (color != key)
+					dst.setPixel(x, y, color & mask);
+			}
+		}
+	}
+
+	static void checkBlit(const Graphics::PixelFormat &format, const Common::Rect &srcRect, const Common::Rect &destRect, bool flipped) {
+		const uint32 key = format.isCLUT8() ? 5 : format.RGBToColor(255, 0, 255);
+		Graphics::ManagedSurface src(37, 21, format), dst(64, 40, format), expected(64, 40, format);
+		fill(src, srcRect.left + destRect.top * 3 + flipped, key);
+		fill(dst, 42, key);
+		expected.blitFrom(dst);
+
+		dst.transBlitFrom(src, srcRect, destRect, key, flipped);
+		referenceBlit(src, srcRect, expected, destRect, key, flipped);
+
+		int errors = 0;
+		for (int y = 0; y < dst.h && errors < 10; ++y) {
+			for (int x = 0; x < dst.w && errors < 10; ++x) {
+				if (dst.getPixel(x, y) != expected.getPixel(x, y)) {
+					TS_ASSERT_EQUALS(dst.getPixel(x, y), expected.getPixel(x, y));
+					++errors;
+				}
+			}
+		}
+	}
+
+	static void checkFormat(const Graphics::PixelFormat &format) {
+		const Common::Rect whole(37, 21);
+
+		// Unscaled, also clipped on every side
+		checkBlit(format, whole, Common::Rect(3, 2, 40, 23), false);
+		checkBlit(format, Common::Rect(5, 1, 30, 20), Common::Rect(-7, -4, 18, 15), false);
+		checkBlit(format, Common::Rect(5, 1, 30, 20), Common::Rect(50, 30, 75, 49), false);
+
+		// Flipped
+		checkBlit(format, whole, Common::Rect(1, 3, 38, 24), true);
+		checkBlit(format, whole, Common::Rect(-9, -1, 28, 20), true);
+		checkBlit(format, whole, Common::Rect(40, 25, 77, 46), true);
+
+		// Scaled by integer and other ratios
+		checkBlit(format, Common::Rect(2, 2, 18, 14), Common::Rect(0, 0, 48, 36), false);
+		checkBlit(format, whole, Common::Rect(-5, 3, 69, 24), true);
+		checkBlit(format, whole, Common::Rect(10, 10, 25, 18), false);
+		checkBlit(format, whole, Common::Rect(4, 1, 57, 38), false);
+	}
+
+public:
+	void test_keyed_clut8() {
+		checkFormat(Graphics::PixelFormat::createFormatCLUT8());
+	}
+
+	void test_keyed_16bpp() {
+		checkFormat(Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0));
+		checkFormat(Graphics::PixelFormat(2, 5, 5, 5, 0, 10, 5, 0, 0));
+	}
+
+	void test_keyed_32bpp() {
+		// The unused bits of the source are dropped
+		checkFormat(Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0));
+	}
+};
@@ -0,0 +1,141 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "graphics/palette.h"
+#include "graphics/surface.h"
+
+#include <math.h>
+
+#include "../random.h"
+
+class PaletteLookupTestSuite : public CxxTest::TestSuite {
+	/**
+	 * Search of the whole palette, as PaletteLookup did before it had the
+	 * cells
+	 */
+	static byte searchPalette(const byte *palette, uint size, byte cr, byte cg, byte cb, bool useNaiveAlg) {
+		uint bestColor = 0;
+		double min = 0xFFFFFFFF;
+
+		for (uint i = 0; i < size; ++i) {
+			int r = palette[3 * i + 0] - cr;
+			int g = palette[3 * i + 1] - cg;
+			int b = palette[3 * i + 2] - cb;
+			double dist;
+
+			if (useNaiveAlg) {
+				dist = 3 * r * r + 5 * g * g + 2 * b * b;
+			} else {
+				int rmean = (palette[3 * i + 0] + cr) / 2;
+				dist = sqrt((((512 + rmean) * r * r) >> 8) + 4 * g * g + (((767 - rmean) * b * b) >> 8));
+			}
+
+			if (min > dist) {
+				bestColor = i;
+				min = dist;
+			}
+		}
+
+		return bestColor;
+	}
+
+	static void checkPalette(const byte *palette, uint size, uint32 seed) {
+		Graphics::PaletteLookup lookup(palette, size);
+
+		TestRandomSource rnd(seed);
+		for (int i = 0; i < 20000; ++i) {
+			const uint32 color = rnd.next() >> 8;
+			const byte r = color >> 16, g = color >> 8, b = color;
+			TS_ASSERT_EQUALS(lookup.findBestColor(r, g, b), searchPalette(palette, size, r, g, b, false));
+			TS_ASSERT_EQUALS(lookup.findBestColor(r, g, b, true), searchPalette(palette, size, r, g, b, true));
+		}
+
+		// All the colors of a few cells, including the corners of the cube
+		const byte cells[4][3] = { { 0, 0, 0 }, { 248, 248, 248 }, { 120, 64, 8 }, { 200, 8, 160 } };
+		for (int c = 0; c < 4; ++c) {
+			for (int j = 0; j < 8 * 8 * 8; ++j) {
+				const byte r = cells[c][0] + (j >> 6), g = cells[c][1] + ((j >> 3) & 7), b = cells[c][2] + (j & 7);
+				TS_ASSERT_EQUALS(lookup.findBestColor(r, g, b), searchPalette(palette, size, r, g, b, false));
+				TS_ASSERT_EQUALS(lookup.findBestColor(r, g, b, true), searchPalette(palette, size, r, g, b, true));
+			}
+		}
+	}
+
+public:
+	void test_random_palette() {
+		byte palette[256 * 3];
+		TestRandomSource rnd(42);
+		for (int i = 0; i < 256 * 3; ++i)
+			palette[i] = rnd.next() >> 8;
+
+		checkPalette(palette, 256, 1);
+		checkPalette(palette, 16, 2);
+	}
+
+	void test_duplicate_entries() {
+		// The first of equally close entries is returned
+		byte palette[64 * 3];
+		for (int i = 0; i < 64; ++i) {
+			palette[i * 3 + 0] = (i & 7) * 36;
+			palette[i * 3 + 1] = (i & 3) * 85;
+			palette[i * 3 + 2] = (i & 1) * 255;
+		}
+
+		checkPalette(palette, 64, 3);
+	}
+
+	void test_set_palette() {
+		byte palette[2 * 3] = { 0, 0, 0, 255, 255, 255 };
+		Graphics::PaletteLookup lookup;
+
+		TS_ASSERT(lookup.setPalette(palette, 2));
+		TS_ASSERT(!lookup.setPalette(palette, 2));
+		TS_ASSERT_EQUALS(lookup.findBestColor(200, 200, 200), 1);
+
+		palette[3] = palette[4] = palette[5] = 100;
+		TS_ASSERT(lookup.setPalette(palette, 2));
+		TS_ASSERT_EQUALS(lookup.findBestColor(200, 200, 200), 1);
+		TS_ASSERT_EQUALS(lookup.findBestColor(20, 20, 20), 0);
+	}
+
+	void test_map_pixels() {
+		byte palette[256 * 3];
+		TestRandomSource rnd(7);
+		for (int i = 0; i < 256 * 3; ++i)
+			palette[i] = rnd.next() >> 8;
+		Graphics::PaletteLookup lookup(palette, 256);
+
+		const Graphics::PixelFormat formats[3] = {
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0),
+			Graphics::PixelFormat(3, 8, 8, 8, 0, 16, 8, 0, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0)
+		};
+
+		uint32 color = 0;
+		for (int f = 0; f < 3; ++f) {
+			Graphics::Surface src, dst;
+			src.create(23, 7, formats[f]);
+			dst.create(23, 7, Graphics::PixelFormat::createFormatCLUT8());
+			for (int y = 0; y < src.h; ++y) {
+				for (int x = 0; x < src.w; ++x) {
+					// Runs of the same color
+					if (x % 3 == 0)
+						color = rnd.next();
+					src.setPixel(x, y, formats[f].RGBToColor(color >> 16, color >> 8, color));
+				}
+			}
+
+			lookup.mapPixels(src, dst, f == 1);
+			for (int y = 0; y < src.h; ++y) {
+				for (int x = 0; x < src.w; ++x) {
+					byte r, g, b;
+					formats[f].colorToRGB(src.getPixel(x, y), r, g, b);
+					TS_ASSERT_EQUALS(dst.getPixel(x, y), searchPalette(palette, 256, r, g, b, f == 1));
+				}
+			}
+
+			src.free();
+			dst.free();
+		}
+	}
+};
@@ -0,0 +1,119 @@
+#include <cxxtest/TestSuite.h>
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include "common/array.h"
+#include "graphics/scaler/hq.h"
+#include "graphics/scaler/normal.h"
+#include "graphics/scaler/scalebit.h"
+
+#include "../random.h"
+
+class ScalerTestSuite : public CxxTest::TestSuite {
+	// Largest number of pixels read around the scaled rect
+	static const int kPadding = 4;
+	// Not a multiple of the vector sizes, and wider than a HQ pattern run
+	static const int kWidth = 77;
+	static const int kHeight = 21;
+
+	/**
+	 * Fill a source image with blocks of a few colors, so that the
+	 * neighbourhoods of the pixels match most of the scaler patterns, and
+	 * with noise of close colors, to check the HQ color thresholds.
+	 */
+	static void fillSource(Common::Array<byte> &src, const Graphics::PixelFormat &format) {
+		const uint32 colors[4] = {
+			format.RGBToColor(0, 0, 0),
+			format.RGBToColor(255, 255, 255),
+			format.RGBToColor(200, 40, 40),
+			format.RGBToColor(204, 44, 40)
+		};
+		const int pitch = (kWidth + kPadding * 2) * format.bytesPerPixel;
+
+		src.resize(pitch * (kHeight + kPadding * 2));
+		TestRandomSource rnd(12345);
+		for (int y = 0; y < kHeight + kPadding * 2; ++y) {
+			for (int x = 0; x < kWidth + kPadding * 2; ++x) {
+				const uint32 r = rnd.next();
+				uint32 color;
+				if (((r >> 16) & 7) < 5)
+					color = colors[(x / 3 + y / 2) & 3];
+				else {
+					const int grey = 96 + (r >> 8) % 72;
+					color = format.RGBToColor(grey + (r >> 3) % 40, grey + (r >> 19) % 40, grey + (r >> 25) % 40);
+				}
+				if (format.bytesPerPixel == 2)
+					*(uint16 *)&src[y * pitch + x * 2] = color;
+				else
+					*(uint32 *)&src[y * pitch + x * 4] = color;
+			}
+		}
+	}
+
+	static void scale(Scaler *scaler, const Common::Array<byte> &src, Common::Array<byte> &dst, const Graphics::PixelFormat &format, bool simd) {
+		const uint factor = scaler->getFactor();
+		const int srcPitch = (kWidth + kPadding * 2) * format.bytesPerPixel;
+		const int dstPitch = kWidth * factor * format.bytesPerPixel;
+
+		dst.clear();
+		dst.resize(dstPitch * kHeight * factor);
+		scaler->setSimd(simd);
+		scaler->scale(&src[kPadding * srcPitch + kPadding * format.bytesPerPixel], srcPitch,
+		              &dst[0], dstPitch, kWidth, kHeight, 0, 0);
+	}
+
+	/**
+	 * Check that the vectorized code paths of a scaler give the same image
+	 * as the C++ ones.
+	 */
+	static void checkScaler(Scaler *scaler, const Graphics::PixelFormat &format, uint factor) {
+		Common::Array<byte> src, expected, actual;
+		fillSource(src, format);
+
+		scaler->setFactor(factor);
+		scale(scaler, src, expected, format, false);
+		scale(scaler, src, actual, format, true);
+
+		TS_ASSERT_EQUALS(expected.size(), actual.size());
+		TS_ASSERT(expected == actual);
+		delete scaler;
+	}
+
+	static Graphics::PixelFormat format16() {
+		return Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0);
+	}
+
+	static Graphics::PixelFormat format32() {
+		return Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0);
+	}
+
+public:
+	void test_normal() {
+#ifdef USE_SCALERS
+		for (uint factor = 2; factor <= 3; ++factor) {
+			checkScaler(new NormalScaler(format16()), format16(), factor);
+			checkScaler(new NormalScaler(format32()), format32(), factor);
+		}
+#endif
+	}
+
+	void test_advmame() {
+#ifdef USE_SCALERS
+		for (uint factor = 2; factor <= 4; ++factor) {
+			checkScaler(new AdvMameScaler(format16()), format16(), factor);
+			checkScaler(new AdvMameScaler(format32()), format32(), factor);
+		}
+#endif
+	}
+
+	void test_hq() {
+#ifdef USE_HQ_SCALERS
+		for (uint factor = 2; factor <= 3; ++factor) {
+			checkScaler(new HQScaler(format16()), format16(), factor);
+			checkScaler(new HQScaler(format32()), format32(), factor);
+		}
+#endif
+	}
+};
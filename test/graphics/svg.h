@@ -0,0 +1,73 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/memstream.h"
+#include "graphics/svg.h"
+
+class SVGBitmapTestSuite : public CxxTest::TestSuite {
+	static Graphics::SVGBitmap *render(const char *svg, int w, int h) {
+		Common::MemoryReadStream stream((const byte *)svg, strlen(svg));
+		return new Graphics::SVGBitmap(&stream, w, h);
+	}
+
+	static bool equals(const Graphics::ManagedSurface &a, const Graphics::ManagedSurface &b) {
+		if (a.w != b.w || a.h != b.h)
+			return false;
+		for (int y = 0; y < a.h; ++y) {
+			for (int x = 0; x < a.w; ++x) {
+				if (a.getPixel(x, y) != b.getPixel(x, y))
+					return false;
+			}
+		}
+		return true;
+	}
+
+public:
+	void test_cached_rendering() {
+		const char *svg =
+			"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"16\" height=\"16\">"
+			"<rect x=\"0\" y=\"0\" width=\"8\" height=\"16\" fill=\"#ff0000\"/>"
+			"<circle cx=\"12\" cy=\"8\" r=\"3\" fill=\"#0000ff\"/>"
+			"</svg>";
+
+		Graphics::SVGBitmap::clearCache();
+		Graphics::SVGBitmap *first = render(svg, 32, 32);
+
+		byte a, r, g, b;
+		first->format.colorToARGB(first->getPixel(4, 16), a, r, g, b);
+		TS_ASSERT_EQUALS(a, 255);
+		TS_ASSERT_EQUALS(r, 255);
+		TS_ASSERT_EQUALS(b, 0);
+
+		// From the cache
+		Graphics::SVGBitmap *second = render(svg, 32, 32);
+		TS_ASSERT(equals(*first, *second));
+
+		// Another size is rendered again
+		Graphics::SVGBitmap *larger = render(svg, 48, 48);
+		larger->format.colorToARGB(larger->getPixel(36, 24), a, r, g, b);
+		TS_ASSERT_EQUALS(a, 255);
+		TS_ASSERT_EQUALS(b, 255);
+
+		// Other data of the same size is rendered again
+		const char *other =
+			"<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"16\" height=\"16\">"
+			"<rect x=\"0\" y=\"0\" width=\"16\" height=\"16\" fill=\"#00ff00\"/>"
+			"</svg>";
+		Graphics::SVGBitmap *green = render(other, 32, 32);
+		green->format.colorToARGB(green->getPixel(4, 16), a, r, g, b);
+		TS_ASSERT_EQUALS(r, 0);
+		TS_ASSERT_EQUALS(g, 255);
+
+		// And once the cache is gone, the rendering is the same
+		Graphics::SVGBitmap::clearCache();
+		Graphics::SVGBitmap *third = render(svg, 32, 32);
+		TS_ASSERT(equals(*first, *third));
+
+		delete first;
+		delete second;
+		delete larger;
+		delete green;
+		delete third;
+		Graphics::SVGBitmap::clearCache();
+	}
+};
@@ -0,0 +1,542 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "graphics/surface.h"
+#include "graphics/tinygl/tinygl.h"
+#include "graphics/tinygl/zgl.h"
+
+#include "../random.h"
+
+class TinyGLTestSuite : public CxxTest::TestSuite {
+	enum RenderMode {
+		kRenderSimple,
+		kRenderTiled,
+		kRenderDirtyRects
+	};
+
+	static const int kWidth = 200;
+	static const int kHeight = 150;
+
+	static void drawScene(int frame, TGLuint texture) {
+		tglClearColor(0.1f, 0.2f, 0.3f, 1.0f);
+		tglClearDepth(1.0f);
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+
+		tglMatrixMode(TGL_PROJECTION);
+		tglLoadIdentity();
+		tglOrtho(0, kWidth, kHeight, 0, -10, 10);
+		tglMatrixMode(TGL_MODELVIEW);
+		tglLoadIdentity();
+
+		tglEnable(TGL_DEPTH_TEST);
+		tglShadeModel(TGL_SMOOTH);
+
+		// Overlapping triangles across the whole buffer
+		tglBegin(TGL_TRIANGLES);
+		tglColor4f(1.0f, 0.0f, 0.0f, 1.0f);
+		tglVertex3f(-20.0f, 10.0f, 1.0f);
+		tglColor4f(0.0f, 1.0f, 0.0f, 1.0f);
+		tglVertex3f(180.0f, 140.0f, -1.0f);
+		tglColor4f(0.0f, 0.0f, 1.0f, 1.0f);
+		tglVertex3f(30.0f, 170.0f, 0.0f);
+
+		tglColor4f(1.0f, 1.0f, 0.0f, 1.0f);
+		tglVertex3f(190.0f, 5.0f, -2.0f);
+		tglColor4f(0.0f, 1.0f, 1.0f, 1.0f);
+		tglVertex3f(10.0f + frame * 7, 120.0f, 2.0f);
+		tglColor4f(1.0f, 0.0f, 1.0f, 1.0f);
+		tglVertex3f(150.0f, 100.0f, 0.5f);
+
+		// A small one, in a single band
+		tglColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+		tglVertex3f(100.0f, 2.0f, -5.0f);
+		tglVertex3f(110.0f, 12.0f, -5.0f);
+		tglVertex3f(95.0f, 14.0f, -5.0f);
+		tglEnd();
+
+		// A blended and textured quad
+		tglEnable(TGL_TEXTURE_2D);
+		tglBindTexture(TGL_TEXTURE_2D, texture);
+		tglEnable(TGL_BLEND);
+		tglBlendFunc(TGL_SRC_ALPHA, TGL_ONE_MINUS_SRC_ALPHA);
+		tglBegin(TGL_QUADS);
+		tglColor4f(1.0f, 1.0f, 1.0f, 0.5f);
+		tglTexCoord2f(0.0f, 0.0f);
+		tglVertex3f(40.0f, 40.0f + frame * 3, -3.0f);
+		tglTexCoord2f(1.0f, 0.0f);
+		tglVertex3f(120.0f, 50.0f + frame * 3, -3.0f);
+		tglTexCoord2f(1.0f, 1.0f);
+		tglVertex3f(110.0f, 130.0f, -3.0f);
+		tglTexCoord2f(0.0f, 1.0f);
+		tglVertex3f(35.0f, 110.0f, -3.0f);
+		tglEnd();
+		tglDisable(TGL_BLEND);
+		tglDisable(TGL_TEXTURE_2D);
+		tglDisable(TGL_DEPTH_TEST);
+	}
+
+	/**
+	 * Renders a few frames and returns the pixels of each of them
+	 */
+	static void render(RenderMode mode, Common::Array<uint32> &pixels) {
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		TinyGL::ContextHandle *context = TinyGL::createContext(kWidth, kHeight, format, 256, false, mode == kRenderDirtyRects);
+		TinyGL::enableTiledRendering(mode == kRenderTiled);
+
+		byte texels[8 * 8 * 4];
+		for (int i = 0; i < 8 * 8; ++i) {
+			texels[i * 4 + 0] = i * 4;
+			texels[i * 4 + 1] = 255 - i * 4;
+			texels[i * 4 + 2] = (i & 1) * 255;
+			texels[i * 4 + 3] = 128 + i;
+		}
+		TGLuint texture;
+		tglGenTextures(1, &texture);
+		tglBindTexture(TGL_TEXTURE_2D, texture);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, TGL_NEAREST);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MAG_FILTER, TGL_NEAREST);
+		tglTexImage2D(TGL_TEXTURE_2D, 0, TGL_RGBA, 8, 8, 0, TGL_RGBA, TGL_UNSIGNED_BYTE, texels);
+
+		pixels.clear();
+		for (int frame = 0; frame < 3; ++frame) {
+			drawScene(frame, texture);
+			TinyGL::presentBuffer();
+
+			Graphics::Surface surface;
+			TinyGL::getSurfaceRef(surface);
+			for (int y = 0; y < surface.h; ++y) {
+				for (int x = 0; x < surface.w; ++x)
+					pixels.push_back(*(const uint32 *)surface.getBasePtr(x, y));
+			}
+		}
+
+		tglDeleteTextures(1, &texture);
+		TinyGL::destroyContext(context);
+	}
+
+	static float randomFloat(TestRandomSource &rnd, float min, float max) {
+		return min + (max - min) * ((rnd.next() >> 8) & 0xFFFF) / 65535.0f;
+	}
+
+	/**
+	 * Random triangles, with the states the vector spans handle and a few
+	 * they leave to the per pixel code
+	 */
+	static void drawTriangles(uint32 seed, TGLuint texture) {
+		static const TGLenum depthFuncs[4] = { TGL_LESS, TGL_LEQUAL, TGL_GREATER, TGL_ALWAYS };
+		static const TGLenum blendFuncs[5][2] = {
+			{ TGL_SRC_ALPHA, TGL_ONE_MINUS_SRC_ALPHA },
+			{ TGL_ONE, TGL_ONE },
+			{ TGL_SRC_ALPHA, TGL_ONE },
+			{ TGL_ZERO, TGL_SRC_ALPHA },
+			{ TGL_DST_COLOR, TGL_ZERO }
+		};
+
+		tglClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		tglClearDepth(1.0f);
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+
+		tglMatrixMode(TGL_PROJECTION);
+		tglLoadIdentity();
+		tglOrtho(0, kWidth, kHeight, 0, -10, 10);
+		tglMatrixMode(TGL_MODELVIEW);
+		tglLoadIdentity();
+		tglEnable(TGL_DEPTH_TEST);
+
+		TestRandomSource rnd(seed);
+		for (int i = 0; i < 60; ++i) {
+			const uint32 state = rnd.next() >> 8;
+			tglShadeModel(state & 1 ? TGL_SMOOTH : TGL_FLAT);
+			tglDepthFunc(depthFuncs[(state >> 1) & 3]);
+			tglDepthMask(state & 8 ? TGL_FALSE : TGL_TRUE);
+			if (state & 16) {
+				tglEnable(TGL_TEXTURE_2D);
+				tglBindTexture(TGL_TEXTURE_2D, texture);
+			}
+			if (state & 32) {
+				const int blend = ((state >> 6) & 0xFF) % 5;
+				tglEnable(TGL_BLEND);
+				tglBlendFunc(blendFuncs[blend][0], blendFuncs[blend][1]);
+			}
+
+			tglBegin(TGL_TRIANGLES);
+			for (int j = 0; j < 3; ++j) {
+				tglColor4f(randomFloat(rnd, 0.0f, 1.0f), randomFloat(rnd, 0.0f, 1.0f),
+				           randomFloat(rnd, 0.0f, 1.0f), randomFloat(rnd, 0.0f, 1.0f));
+				tglTexCoord2f(randomFloat(rnd, -1.0f, 2.0f), randomFloat(rnd, -1.0f, 2.0f));
+				tglVertex3f(randomFloat(rnd, -30.0f, kWidth + 30.0f), randomFloat(rnd, -30.0f, kHeight + 30.0f),
+				            randomFloat(rnd, -9.0f, 9.0f));
+			}
+			tglEnd();
+
+			tglDisable(TGL_TEXTURE_2D);
+			tglDisable(TGL_BLEND);
+		}
+	}
+
+	static void renderTriangles(const Graphics::PixelFormat &format, bool vectorSpans, bool tiled, TGLenum filter,
+	                            Common::Array<uint32> &pixels) {
+		TinyGL::ContextHandle *context = TinyGL::createContext(kWidth, kHeight, format, 256, false, false);
+		TinyGL::enableTiledRendering(tiled);
+		TinyGL::gl_get_context()->fb->enableVectorSpans(vectorSpans);
+
+		byte texels[16 * 16 * 4];
+		TestRandomSource rnd(5);
+		for (int i = 0; i < 16 * 16 * 4; ++i)
+			texels[i] = rnd.next() >> 8;
+		TGLuint texture;
+		tglGenTextures(1, &texture);
+		tglBindTexture(TGL_TEXTURE_2D, texture);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, filter);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MAG_FILTER, filter);
+		tglTexImage2D(TGL_TEXTURE_2D, 0, TGL_RGBA, 16, 16, 0, TGL_RGBA, TGL_UNSIGNED_BYTE, texels);
+
+		pixels.clear();
+		for (int frame = 0; frame < 4; ++frame) {
+			drawTriangles(frame + 1, texture);
+			TinyGL::presentBuffer();
+
+			Graphics::Surface surface;
+			TinyGL::getSurfaceRef(surface);
+			for (int y = 0; y < surface.h; ++y) {
+				for (int x = 0; x < surface.w; ++x)
+					pixels.push_back(surface.getPixel(x, y));
+			}
+		}
+
+		tglDeleteTextures(1, &texture);
+		TinyGL::destroyContext(context);
+	}
+
+	static void checkSame(const Common::Array<uint32> &expected, const Common::Array<uint32> &pixels) {
+		TS_ASSERT_EQUALS(pixels.size(), expected.size());
+		int errors = 0;
+		for (uint i = 0; i < pixels.size() && i < expected.size() && errors < 10; ++i) {
+			if (pixels[i] != expected[i]) {
+				TS_ASSERT_EQUALS(pixels[i], expected[i]);
+				++errors;
+			}
+		}
+	}
+
+public:
+	void test_tiled_rendering() {
+		Common::Array<uint32> simple, tiled, dirtyRects;
+		render(kRenderSimple, simple);
+		render(kRenderTiled, tiled);
+		render(kRenderDirtyRects, dirtyRects);
+
+		checkSame(simple, tiled);
+		checkSame(simple, dirtyRects);
+
+		// Something was drawn
+		TS_ASSERT_DIFFERS(simple[kWidth * 8 + 101], simple[0]);
+	}
+
+	void test_vector_spans() {
+		// The per pixel code is the reference for the vector code
+		const Graphics::PixelFormat formats[3] = {
+			Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0),
+			Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0),
+			Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0)
+		};
+
+		for (int f = 0; f < 3; ++f) {
+			for (int tiled = 0; tiled < 2; ++tiled) {
+				const TGLenum filter = tiled ? TGL_LINEAR : TGL_NEAREST;
+				Common::Array<uint32> reference, pixels;
+				renderTriangles(formats[f], false, tiled, filter, reference);
+				renderTriangles(formats[f], true, tiled, filter, pixels);
+				checkSame(reference, pixels);
+			}
+		}
+	}
+	/**
+	 * Draws a checkerboard texture of single texels, 64 texels large, in a
+	 * square of the given size and returns the darkest and lightest pixels.
+	 * The minification filter is left to its default when minFilter is 0,
+	 * and set after the upload when filterAfterUpload is true. When
+	 * previousFilter is not 0, another texture is first uploaded with it.
+	 */
+	static void drawCheckerboard(TGLenum minFilter, int size, byte &minValue, byte &maxValue,
+	                             bool filterAfterUpload = false, TGLenum previousFilter = 0) {
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		TinyGL::ContextHandle *context = TinyGL::createContext(kWidth, kHeight, format, 256, false, false);
+
+		byte texels[64 * 64 * 3];
+		for (int i = 0; i < 64 * 64; ++i)
+			texels[i * 3 + 0] = texels[i * 3 + 1] = texels[i * 3 + 2] = ((i + i / 64) & 1) ? 255 : 0;
+		TGLuint textures[2];
+		tglGenTextures(2, textures);
+		if (previousFilter) {
+			tglBindTexture(TGL_TEXTURE_2D, textures[1]);
+			tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, previousFilter);
+			tglTexImage2D(TGL_TEXTURE_2D, 0, TGL_RGB, 64, 64, 0, TGL_RGB, TGL_UNSIGNED_BYTE, texels);
+		}
+		tglBindTexture(TGL_TEXTURE_2D, textures[0]);
+		if (minFilter && !filterAfterUpload)
+			tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, minFilter);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MAG_FILTER, TGL_NEAREST);
+		tglTexImage2D(TGL_TEXTURE_2D, 0, TGL_RGB, 64, 64, 0, TGL_RGB, TGL_UNSIGNED_BYTE, texels);
+		if (minFilter && filterAfterUpload)
+			tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, minFilter);
+
+		tglClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+		tglMatrixMode(TGL_PROJECTION);
+		tglLoadIdentity();
+		tglOrtho(0, kWidth, kHeight, 0, -10, 10);
+		tglMatrixMode(TGL_MODELVIEW);
+		tglLoadIdentity();
+		tglEnable(TGL_TEXTURE_2D);
+		tglBegin(TGL_QUADS);
+		tglColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+		tglTexCoord2f(0.0f, 0.0f);
+		tglVertex3f(0.0f, 0.0f, 0.0f);
+		tglTexCoord2f(1.0f, 0.0f);
+		tglVertex3f(size, 0.0f, 0.0f);
+		tglTexCoord2f(1.0f, 1.0f);
+		tglVertex3f(size, size, 0.0f);
+		tglTexCoord2f(0.0f, 1.0f);
+		tglVertex3f(0.0f, size, 0.0f);
+		tglEnd();
+		TinyGL::presentBuffer();
+
+		Graphics::Surface surface;
+		TinyGL::getSurfaceRef(surface);
+		minValue = 255;
+		maxValue = 0;
+		for (int y = 2; y < size - 2; ++y) {
+			for (int x = 2; x < size - 2; ++x) {
+				byte r, g, b;
+				surface.format.colorToRGB(surface.getPixel(x, y), r, g, b);
+				minValue = MIN(minValue, g);
+				maxValue = MAX(maxValue, g);
+			}
+		}
+
+		tglDeleteTextures(2, textures);
+		TinyGL::destroyContext(context);
+	}
+
+	void test_mipmaps() {
+		byte minValue, maxValue;
+
+		// Without mipmaps, a minified checkerboard is still black and white
+		drawCheckerboard(TGL_NEAREST, 16, minValue, maxValue);
+		TS_ASSERT_LESS_THAN(minValue, 10);
+		TS_ASSERT_LESS_THAN(245, maxValue);
+
+		// Nor are they built when the game keeps the default filter
+		drawCheckerboard(0, 16, minValue, maxValue);
+		TS_ASSERT_LESS_THAN(minValue, 10);
+		TS_ASSERT_LESS_THAN(245, maxValue);
+
+		// With them, its texels are averaged
+		drawCheckerboard(TGL_NEAREST_MIPMAP_NEAREST, 16, minValue, maxValue);
+		TS_ASSERT_LESS_THAN(115, minValue);
+		TS_ASSERT_LESS_THAN(maxValue, 140);
+		drawCheckerboard(TGL_LINEAR_MIPMAP_LINEAR, 16, minValue, maxValue);
+		TS_ASSERT_LESS_THAN(115, minValue);
+		TS_ASSERT_LESS_THAN(maxValue, 140);
+
+		// Also when the filter is set after the upload
+		drawCheckerboard(TGL_NEAREST_MIPMAP_NEAREST, 16, minValue, maxValue, true);
+		TS_ASSERT_LESS_THAN(115, minValue);
+		TS_ASSERT_LESS_THAN(maxValue, 140);
+
+		// The filter of a previous texture does not carry over to the next one
+		drawCheckerboard(0, 16, minValue, maxValue, false, TGL_NEAREST_MIPMAP_NEAREST);
+		TS_ASSERT_LESS_THAN(minValue, 10);
+		TS_ASSERT_LESS_THAN(245, maxValue);
+		drawCheckerboard(TGL_NEAREST, 16, minValue, maxValue, true, TGL_NEAREST_MIPMAP_NEAREST);
+		TS_ASSERT_LESS_THAN(minValue, 10);
+		TS_ASSERT_LESS_THAN(245, maxValue);
+
+		// The first level is used when the texture is not minified
+		drawCheckerboard(TGL_NEAREST_MIPMAP_NEAREST, 64, minValue, maxValue);
+		TS_ASSERT_LESS_THAN(minValue, 10);
+		TS_ASSERT_LESS_THAN(245, maxValue);
+	}
+
+	enum VertexMode {
+		kVertexImmediate,
+		kVertexArrays,
+		kVertexElements,
+		kVertexList
+	};
+
+	static const int kMeshVertices = 60;
+
+	struct Mesh {
+		float coords[kMeshVertices * 3];
+		float colors[kMeshVertices * 4];
+		float normals[kMeshVertices * 3];
+		float texCoords[kMeshVertices * 2];
+		TGLushort indices[kMeshVertices];
+	};
+
+	static void drawMesh(const Mesh &mesh, VertexMode mode, bool colors) {
+		if (mode == kVertexImmediate) {
+			tglBegin(TGL_TRIANGLES);
+			for (int i = 0; i < kMeshVertices; ++i) {
+				if (colors)
+					tglColor4fv(&mesh.colors[i * 4]);
+				tglNormal3fv(&mesh.normals[i * 3]);
+				tglTexCoord2fv(&mesh.texCoords[i * 2]);
+				tglVertex3fv(&mesh.coords[i * 3]);
+			}
+			tglEnd();
+			return;
+		}
+
+		tglEnableClientState(TGL_VERTEX_ARRAY);
+		tglEnableClientState(TGL_NORMAL_ARRAY);
+		tglEnableClientState(TGL_TEXTURE_COORD_ARRAY);
+		if (colors)
+			tglEnableClientState(TGL_COLOR_ARRAY);
+		tglVertexPointer(3, TGL_FLOAT, 0, mesh.coords);
+		tglColorPointer(4, TGL_FLOAT, 4 * sizeof(float), mesh.colors);
+		tglNormalPointer(TGL_FLOAT, 0, mesh.normals);
+		tglTexCoordPointer(2, TGL_FLOAT, 0, mesh.texCoords);
+		if (mode == kVertexArrays)
+			tglDrawArrays(TGL_TRIANGLES, 0, kMeshVertices);
+		else
+			tglDrawElements(TGL_TRIANGLES, kMeshVertices, TGL_UNSIGNED_SHORT, mesh.indices);
+		tglDisableClientState(TGL_VERTEX_ARRAY);
+		tglDisableClientState(TGL_NORMAL_ARRAY);
+		tglDisableClientState(TGL_TEXTURE_COORD_ARRAY);
+		tglDisableClientState(TGL_COLOR_ARRAY);
+	}
+
+	/**
+	 * Draws the same mesh, lit or not, over a few frames with the given
+	 * way of sending its vertices, and returns the pixels of each frame
+	 */
+	static void renderMesh(VertexMode mode, Common::Array<uint32> &pixels) {
+		const Graphics::PixelFormat format(4, 8, 8, 8, 8, 24, 16, 8, 0);
+		TinyGL::ContextHandle *context = TinyGL::createContext(kWidth, kHeight, format, 256, false, false);
+
+		Mesh mesh;
+		TestRandomSource rnd(11);
+		for (int i = 0; i < kMeshVertices; ++i) {
+			mesh.coords[i * 3 + 0] = randomFloat(rnd, -10.0f, kWidth - 20.0f);
+			mesh.coords[i * 3 + 1] = randomFloat(rnd, -10.0f, kHeight - 10.0f);
+			mesh.coords[i * 3 + 2] = randomFloat(rnd, -5.0f, 5.0f);
+			for (int j = 0; j < 4; ++j)
+				mesh.colors[i * 4 + j] = randomFloat(rnd, 0.0f, 1.0f);
+			for (int j = 0; j < 3; ++j)
+				mesh.normals[i * 3 + j] = randomFloat(rnd, -1.0f, 1.0f);
+			mesh.texCoords[i * 2 + 0] = randomFloat(rnd, 0.0f, 1.0f);
+			mesh.texCoords[i * 2 + 1] = randomFloat(rnd, 0.0f, 1.0f);
+			mesh.indices[i] = i;
+		}
+
+		const byte texels[2 * 2 * 3] = { 255, 0, 0, 0, 255, 0, 0, 0, 255, 255, 255, 255 };
+		TGLuint texture;
+		tglGenTextures(1, &texture);
+		tglBindTexture(TGL_TEXTURE_2D, texture);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MIN_FILTER, TGL_NEAREST);
+		tglTexParameteri(TGL_TEXTURE_2D, TGL_TEXTURE_MAG_FILTER, TGL_NEAREST);
+		tglTexImage2D(TGL_TEXTURE_2D, 0, TGL_RGB, 2, 2, 0, TGL_RGB, TGL_UNSIGNED_BYTE, texels);
+
+		TGLuint lists = 0;
+		if (mode == kVertexList) {
+			lists = tglGenLists(2);
+			tglNewList(lists, TGL_COMPILE);
+			drawMesh(mesh, kVertexImmediate, true);
+			tglEndList();
+			tglNewList(lists + 1, TGL_COMPILE);
+			drawMesh(mesh, kVertexImmediate, false);
+			tglEndList();
+		}
+
+		const float lightPosition[4] = { 0.3f, -0.5f, 1.0f, 0.0f };
+		tglLightfv(TGL_LIGHT0, TGL_POSITION, lightPosition);
+		tglEnable(TGL_LIGHT0);
+
+		pixels.clear();
+		for (int frame = 0; frame < 3; ++frame) {
+			tglClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+			tglClearDepth(1.0f);
+			tglClear(TGL_COLOR_BUFFER_BIT | TGL_DEPTH_BUFFER_BIT);
+			tglMatrixMode(TGL_PROJECTION);
+			tglLoadIdentity();
+			tglOrtho(0, kWidth, kHeight, 0, -10, 10);
+			tglMatrixMode(TGL_MODELVIEW);
+			tglLoadIdentity();
+			tglEnable(TGL_DEPTH_TEST);
+
+			// The first two frames are the same, the last one moves
+			tglTranslatef(frame == 2 ? 5.0f : 0.0f, 0.0f, 0.0f);
+			tglEnable(TGL_TEXTURE_2D);
+			if (mode == kVertexList)
+				tglCallList(lists);
+			else
+				drawMesh(mesh, mode, true);
+			tglDisable(TGL_TEXTURE_2D);
+
+			// Vertices without colors, which take the current one
+			tglColor4f(frame == 2 ? 0.0f : 1.0f, 0.5f, 0.2f, 1.0f);
+			tglTranslatef(20.0f, 10.0f, 0.0f);
+			if (mode == kVertexList)
+				tglCallList(lists + 1);
+			else
+				drawMesh(mesh, mode, false);
+
+			tglEnable(TGL_LIGHTING);
+			if (frame == 2)
+				tglEnable(TGL_COLOR_MATERIAL);
+			tglTranslatef(-40.0f, 5.0f, 0.0f);
+			if (mode == kVertexList)
+				tglCallList(lists);
+			else
+				drawMesh(mesh, mode, true);
+			tglDisable(TGL_COLOR_MATERIAL);
+			tglDisable(TGL_LIGHTING);
+			tglDisable(TGL_DEPTH_TEST);
+
+			TinyGL::presentBuffer();
+
+			Graphics::Surface surface;
+			TinyGL::getSurfaceRef(surface);
+			for (int y = 0; y < surface.h; ++y) {
+				for (int x = 0; x < surface.w; ++x)
+					pixels.push_back(*(const uint32 *)surface.getBasePtr(x, y));
+			}
+
+			// The list without lighting keeps its transformed vertices
+			if (mode == kVertexList) {
+				const TinyGL::GLList *list = TinyGL::gl_get_context()->find_list(lists + 1);
+				TS_ASSERT(list->first_batch != nullptr);
+				TS_ASSERT(!list->first_batch->transformed.empty());
+			}
+		}
+
+		tglDeleteTextures(1, &texture);
+		TinyGL::destroyContext(context);
+	}
+
+	void test_vertex_batches() {
+		Common::Array<uint32> expected, pixels;
+		renderMesh(kVertexImmediate, expected);
+
+		// Something is drawn, and it changes between the frames
+		const uint frameSize = kWidth * kHeight;
+		TS_ASSERT_DIFFERS(expected[kWidth * 70 + 100], 0xFFU);
+		TS_ASSERT(memcmp(&expected[frameSize], &expected[frameSize * 2], frameSize * sizeof(uint32)));
+
+		const VertexMode modes[3] = { kVertexArrays, kVertexElements, kVertexList };
+		for (int m = 0; m < 3; ++m) {
+			renderMesh(modes[m], pixels);
+			TS_ASSERT_EQUALS(pixels.size(), expected.size());
+			int errors = 0;
+			for (uint i = 0; i < expected.size() && errors < 10; ++i) {
+				if (pixels[i] != expected[i]) {
+					TS_ASSERT_EQUALS(pixels[i], expected[i]);
+					++errors;
+				}
+			}
+		}
+	}
+};
@@ -0,0 +1,151 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/util.h"
+#include "graphics/transparent_surface.h"
+
+#include "../random.h"
+
+class TransparentSurfaceTestSuite : public CxxTest::TestSuite {
+#ifdef SCUMM_LITTLE_ENDIAN
+	enum { kA = 0, kB = 1, kG = 2, kR = 3 };
+#else
+	enum { kA = 3, kB = 2, kG = 1, kR = 0 };
+#endif
+
+	static Graphics::PixelFormat format() {
+		return Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0);
+	}
+
+	static void fill(Graphics::Surface &surf, uint32 seed) {
+		TestRandomSource rnd(seed);
+		for (int y = 0; y < surf.h; ++y) {
+			byte *p = (byte *)surf.getBasePtr(0, y);
+			for (int x = 0; x < surf.w * 4; ++x) {
+				const uint32 r = rnd.next();
+				p[x] = r >> 16;
+				// Also have fully transparent and fully opaque pixels
+				if ((x & 3) == kA && (r & 0x300) == 0)
+					p[x] = (r & 0x400) ? 255 : 0;
+			}
+		}
+	}
+
+	/**
+	 * Per pixel blending, written after the description of the blend modes
+	 */
+	static void blendPixel(const byte *in, byte *out, uint32 color, Graphics::TSpriteBlendMode mode) {
+		const uint ca = color & 0xff;
+		const uint c[4] = { 0, (color >> 8) & 0xff, (color >> 16) & 0xff, color >> 24 };
+		const int index[4] = { kA, kB, kG, kR };
+		const uint ina = in[kA] * ca >> 8;
+
+		if (mode == Graphics::BLEND_SUBTRACTIVE) {
+			out[kA] = 255;
+			for (int i = 1; i < 4; ++i) {
+				const uint v = in[index[i]], o = out[index[i]];
+				out[index[i]] = o - (c[i] != 255 ? (v * c[i] * o * in[kA]) >> 24 : (v * o * in[kA]) >> 16);
+			}
+			return;
+		}
+
+		if (ina == 0)
+			return;
+
+		if (mode == Graphics::BLEND_NORMAL)
+			out[kA] = 255;
+		for (int i = 1; i < 4; ++i) {
+			const uint v = in[index[i]], o = out[index[i]];
+			const uint src = c[i] != 255 ? (v * c[i] * ina) >> 16 : (v * ina) >> 8;
+			if (mode == Graphics::BLEND_NORMAL)
+				out[index[i]] = (o * (255 - ina) >> 8) + (v * ina * c[i] >> 16);
+			else if (mode == Graphics::BLEND_ADDITIVE)
+				out[index[i]] = MIN<uint>(o + src, 255);
+			else
+				out[index[i]] = MIN<uint>(o * src >> 8, 255);
+		}
+	}
+
+	static void checkBlend(Graphics::TSpriteBlendMode mode, uint32 color, int flipping) {
+		Graphics::TransparentSurface src;
+		Graphics::Surface expected, actual;
+		src.create(13, 5, format());
+		expected.create(16, 8, format());
+		fill(src, 1 + color);
+		fill(expected, 2 + mode);
+		actual.copyFrom(expected);
+
+		for (int y = 0; y < src.h; ++y) {
+			for (int x = 0; x < src.w; ++x) {
+				const int srcX = (flipping & Graphics::FLIP_H) ? src.w - 1 - x : x;
+				const int srcY = (flipping & Graphics::FLIP_V) ? src.h - 1 - y : y;
+				blendPixel((const byte *)src.getBasePtr(srcX, srcY), (byte *)expected.getBasePtr(x + 2, y + 1), color, mode);
+			}
+		}
+		src.blit(actual, 2, 1, flipping, nullptr, color, -1, -1, mode);
+
+		for (int y = 0; y < expected.h; ++y)
+			TS_ASSERT_SAME_DATA(expected.getBasePtr(0, y), actual.getBasePtr(0, y), expected.w * 4);
+
+		src.free();
+		expected.free();
+		actual.free();
+	}
+
+	/**
+	 * Check a scaled blit against a blit of a scaled copy of the image
+	 */
+	static void checkScaledBlit(int width, int height, int posX, int posY, int flipping, Graphics::TSpriteBlendMode mode) {
+		Graphics::TransparentSurface src;
+		Graphics::Surface expected, actual;
+		src.create(11, 9, format());
+		expected.create(24, 20, format());
+		fill(src, width * 31 + height);
+		fill(expected, 7);
+		actual.copyFrom(expected);
+
+		// The part of the image is taken from the flipped image
+		const Common::Rect part(1, 2, 10, 8);
+		const int partX = (flipping & Graphics::FLIP_H) ? src.w - part.right : part.left;
+		const int partY = (flipping & Graphics::FLIP_V) ? src.h - part.bottom : part.top;
+		Graphics::TransparentSurface partSurf(src.getSubArea(Common::Rect(partX, partY, partX + part.width(), partY + part.height())), false);
+		Graphics::TransparentSurface *scaled = partSurf.scale(width, height);
+
+		Common::Rect expectedSize = scaled->blit(expected, posX, posY, flipping, nullptr, 0xC0A0FFE0, -1, -1, mode);
+		Common::Rect actualSize = src.blit(actual, posX, posY, flipping, const_cast<Common::Rect *>(&part), 0xC0A0FFE0, width, height, mode);
+
+		TS_ASSERT_EQUALS(expectedSize, actualSize);
+		for (int y = 0; y < expected.h; ++y)
+			TS_ASSERT_SAME_DATA(expected.getBasePtr(0, y), actual.getBasePtr(0, y), expected.w * 4);
+
+		scaled->free();
+		delete scaled;
+		src.free();
+		expected.free();
+		actual.free();
+	}
+
+public:
+	void test_blend_modes() {
+		const Graphics::TSpriteBlendMode modes[4] = {
+			Graphics::BLEND_NORMAL, Graphics::BLEND_ADDITIVE,
+			Graphics::BLEND_SUBTRACTIVE, Graphics::BLEND_MULTIPLY
+		};
+		const uint32 colors[4] = { 0xFFFFFFFF, 0xFFFFFF80, 0x40C0FFFF, 0xFF2080C0 };
+
+		for (int m = 0; m < 4; ++m) {
+			for (int c = 0; c < 4; ++c) {
+				checkBlend(modes[m], colors[c], Graphics::FLIP_NONE);
+				checkBlend(modes[m], colors[c], Graphics::FLIP_H);
+				checkBlend(modes[m], colors[c], Graphics::FLIP_HV);
+			}
+		}
+	}
+
+	void test_scaled_blit() {
+		checkScaledBlit(20, 15, 2, 3, Graphics::FLIP_NONE, Graphics::BLEND_NORMAL);
+		checkScaledBlit(5, 4, 2, 3, Graphics::FLIP_NONE, Graphics::BLEND_ADDITIVE);
+		checkScaledBlit(23, 7, -4, -3, Graphics::FLIP_H, Graphics::BLEND_NORMAL);
+		checkScaledBlit(30, 25, 6, 4, Graphics::FLIP_V, Graphics::BLEND_MULTIPLY);
+		checkScaledBlit(17, 13, -2, 9, Graphics::FLIP_HV, Graphics::BLEND_SUBTRACTIVE);
+	}
+};
@@ -0,0 +1,74 @@
+#include <cxxtest/TestSuite.h>
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include "common/file.h"
+#include "common/ptr.h"
+#include "graphics/font.h"
+#include "graphics/fonts/ttf.h"
+#include "graphics/surface.h"
+#include "../null_osystem.h"
+#include "../ttf_reference.h"
+
+class TTFFontTestSuite : public CxxTest::TestSuite {
+public:
+	void test_mono_glyphs_match_freetype() {
+#if defined(USE_FREETYPE2) && NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+
+		Common::File file;
+		TS_ASSERT(file.open("LiberationMono-Regular.ttf"));
+		if (!file.isOpen())
+			return;
+		Common::Array<byte> data(file.size());
+		file.read(data.data(), data.size());
+		file.seek(0);
+
+		const int size = 37;
+		Common::ScopedPtr<Graphics::Font> font(Graphics::loadTTFFont(file, size, Graphics::kTTFSizeModeCharacter, 0, Graphics::kTTFRenderModeMonochrome));
+		TS_ASSERT(font);
+		if (!font)
+			return;
+
+		Graphics::Surface surf;
+		surf.create(128, 96, Graphics::PixelFormat::createFormatCLUT8());
+
+		// Draw a string first, so that the glyphs are next to each other in
+		// the atlas
+		const char *text = "AgM@%&W#qj";
+		font->drawString(&surf, text, 0, 0, 128, 1);
+
+		for (const char *c = text; *c; ++c) {
+			surf.fillRect(Common::Rect(surf.w, surf.h), 0);
+			font->drawChar(&surf, *c, 32, 16, 1);
+
+			// The glyph rendered by FreeType alone, without the atlas
+			Graphics::Surface glyph;
+			int left, top;
+			TS_ASSERT(renderReferenceMonoGlyph(data.data(), data.size(), size, *c, glyph, left, top));
+			left += 32;
+			top = 16 + font->getFontAscent() - top;
+
+			int mismatches = 0, pixels = 0;
+			for (int y = 0; y < surf.h; ++y) {
+				for (int x = 0; x < surf.w; ++x) {
+					bool expected = false;
+					if (x >= left && y >= top && x < left + glyph.w && y < top + glyph.h)
+						expected = *(const byte *)glyph.getBasePtr(x - left, y - top) != 0;
+					const bool drawn = *(const byte *)surf.getBasePtr(x, y) != 0;
+					mismatches += (drawn != expected);
+					pixels += drawn;
+				}
+			}
+			TS_ASSERT_EQUALS(mismatches, 0);
+			TS_ASSERT(pixels > 0);
+
+			glyph.free();
+		}
+
+		surf.free();
+#endif
+	}
+};
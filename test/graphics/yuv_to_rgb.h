@@ -0,0 +1,124 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/array.h"
+#include "common/util.h"
+#include "graphics/surface.h"
+#include "graphics/yuv_to_rgb.h"
+
+#include "../random.h"
+
+class YUVToRGBTestSuite : public CxxTest::TestSuite {
+	typedef Graphics::YUVToRGBManager::LuminanceScale LuminanceScale;
+
+	static int component(int value, LuminanceScale scale) {
+		if (scale == Graphics::YUVToRGBManager::kScaleFull)
+			return CLIP(value, 0, 255);
+		return (CLIP(value, 16, 235) - 16) * 255 / 219;
+	}
+
+	/**
+	 * Per pixel conversion, with the same chroma factors as the color tables
+	 */
+	static uint32 convertPixel(const Graphics::PixelFormat &format, LuminanceScale scale, byte y, byte u, byte v, byte a) {
+		int16 CR = (v - 128), CB = (u - 128);
+		int r = y + (int16)((0.419 / 0.299) * CR);
+		int g = y + (int16)(-(0.299 / 0.419) * CR) + (int16)(-(0.114 / 0.331) * CB);
+		int b = y + (int16)((0.587 / 0.331) * CB);
+		return format.ARGBToColor(a, component(r, scale), component(g, scale), component(b, scale));
+	}
+
+	static uint32 getPixel(const Graphics::Surface &surf, int x, int y) {
+		if (surf.format.bytesPerPixel == 2)
+			return *(const uint16 *)surf.getBasePtr(x, y);
+		return *(const uint32 *)surf.getBasePtr(x, y);
+	}
+
+	/**
+	 * Convert random planes and check every pixel. With chromaShift 0, the
+	 * chroma planes may also be given, for instance to cover all chroma pairs.
+	 */
+	static void checkConvert(const Graphics::PixelFormat &format, LuminanceScale scale, int width, int height, int chromaShift, bool alpha,
+	                         const Common::Array<byte> *uPlane = nullptr, const Common::Array<byte> *vPlane = nullptr) {
+		const int yPitch = width + 5;
+		const int uvPitch = (width >> chromaShift) + 3;
+		Common::Array<byte> ySrc(yPitch * height), aSrc(yPitch * height);
+		Common::Array<byte> uSrc(uvPitch * (height >> chromaShift)), vSrc(uvPitch * (height >> chromaShift));
+		TestRandomSource(width + height).fill(ySrc.data(), ySrc.size());
+		TestRandomSource(3).fill(aSrc.data(), aSrc.size());
+		TestRandomSource(5 + scale).fill(uSrc.data(), uSrc.size());
+		TestRandomSource(7 + format.bytesPerPixel).fill(vSrc.data(), vSrc.size());
+		if (uPlane)
+			uSrc = *uPlane;
+		if (vPlane)
+			vSrc = *vPlane;
+
+		Graphics::Surface dst;
+		dst.create(width, height, format);
+
+		if (chromaShift == 0)
+			YUVToRGBMan.convert444(&dst, scale, &ySrc[0], &uSrc[0], &vSrc[0], width, height, yPitch, uvPitch);
+		else if (alpha)
+			YUVToRGBMan.convert420Alpha(&dst, scale, &ySrc[0], &uSrc[0], &vSrc[0], &aSrc[0], width, height, yPitch, uvPitch);
+		else
+			YUVToRGBMan.convert420(&dst, scale, &ySrc[0], &uSrc[0], &vSrc[0], width, height, yPitch, uvPitch);
+
+		int errors = 0;
+		for (int y = 0; y < height && errors < 10; ++y) {
+			for (int x = 0; x < width && errors < 10; ++x) {
+				const int uv = (y >> chromaShift) * uvPitch + (x >> chromaShift);
+				const byte a = alpha ? aSrc[y * yPitch + x] : 255;
+				const uint32 expected = convertPixel(format, scale, ySrc[y * yPitch + x], uSrc[uv], vSrc[uv], a);
+				if (getPixel(dst, x, y) != expected) {
+					TS_ASSERT_EQUALS(getPixel(dst, x, y), expected);
+					++errors;
+				}
+			}
+		}
+
+		dst.free();
+	}
+
+	static Graphics::PixelFormat rgb565() { return Graphics::PixelFormat(2, 5, 6, 5, 0, 11, 5, 0, 0); }
+	static Graphics::PixelFormat argb4444() { return Graphics::PixelFormat(2, 4, 4, 4, 4, 8, 4, 0, 12); }
+	static Graphics::PixelFormat rgba8888() { return Graphics::PixelFormat(4, 8, 8, 8, 8, 24, 16, 8, 0); }
+	static Graphics::PixelFormat xrgb8888() { return Graphics::PixelFormat(4, 8, 8, 8, 0, 16, 8, 0, 0); }
+
+public:
+	void test_convert444() {
+		const LuminanceScale scales[2] = { Graphics::YUVToRGBManager::kScaleFull, Graphics::YUVToRGBManager::kScaleITU };
+		for (int i = 0; i < 2; ++i) {
+			checkConvert(rgb565(), scales[i], 29, 5, 0, false);
+			checkConvert(rgba8888(), scales[i], 29, 5, 0, false);
+			checkConvert(xrgb8888(), scales[i], 29, 5, 0, false);
+		}
+	}
+
+	void test_convert420() {
+		const LuminanceScale scales[2] = { Graphics::YUVToRGBManager::kScaleFull, Graphics::YUVToRGBManager::kScaleITU };
+		for (int i = 0; i < 2; ++i) {
+			checkConvert(rgb565(), scales[i], 38, 6, 1, false);
+			checkConvert(argb4444(), scales[i], 38, 6, 1, true);
+			checkConvert(rgba8888(), scales[i], 38, 6, 1, false);
+			checkConvert(rgba8888(), scales[i], 38, 6, 1, true);
+		}
+	}
+
+	void test_all_chroma() {
+		// Every pair of chroma values, one per pixel
+		const int uvPitch = 256 + 3;
+		Common::Array<byte> u(uvPitch * 256), v(uvPitch * 256);
+		for (int y = 0; y < 256; ++y) {
+			for (int x = 0; x < 256; ++x) {
+				u[y * uvPitch + x] = x;
+				v[y * uvPitch + x] = y;
+			}
+		}
+
+		checkConvert(rgba8888(), Graphics::YUVToRGBManager::kScaleFull, 256, 256, 0, false, &u, &v);
+		checkConvert(rgb565(), Graphics::YUVToRGBManager::kScaleITU, 256, 256, 0, false, &u, &v);
+	}
+
+	void test_hd_frame() {
+		checkConvert(xrgb8888(), Graphics::YUVToRGBManager::kScaleITU, 1280, 720, 1, false);
+	}
+};
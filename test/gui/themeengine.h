@@ -0,0 +1,61 @@
+#include <cxxtest/TestSuite.h>
+
+#include "common/system.h"
+#include "graphics/managed_surface.h"
+#include "gui/ThemeEngine.h"
+
+#include "../null_osystem.h"
+
+class ThemeEngineTestSuite : public CxxTest::TestSuite {
+	class TestThemeEngine : public GUI::ThemeEngine {
+	public:
+		TestThemeEngine() : GUI::ThemeEngine("scummmodern", GUI::ThemeEngine::kGfxStandard) {
+			init();
+			// Dialogs draw clipped to their area
+			swapClipRect(Common::Rect(_screen.w, _screen.h));
+		}
+
+		bool sameArea(const TestThemeEngine &other, const Common::Rect &r) const {
+			for (int y = r.top; y < r.bottom; y++) {
+				if (memcmp(_screen.getBasePtr(r.left, y), other._screen.getBasePtr(r.left, y), r.width() * _screen.format.bytesPerPixel))
+					return false;
+			}
+			return true;
+		}
+	};
+
+	/**
+	 * Draws a gradient widget background first at the even position, and
+	 * then at the given position, where it may be copied from the cache
+	 */
+	static bool drawsLikeUncached(int x, int y) {
+		const Common::Rect even(20, 20, 160, 420);
+		const Common::Rect r(x, y, x + even.width(), y + even.height());
+		Common::Rect area = r;
+		area.grow(12);
+
+		TestThemeEngine cached;
+		cached.drawWidgetBackground(even, GUI::ThemeEngine::kWidgetBackgroundPlain);
+		cached.drawWidgetBackground(r, GUI::ThemeEngine::kWidgetBackgroundPlain);
+
+		TestThemeEngine uncached;
+		uncached.drawWidgetBackground(r, GUI::ThemeEngine::kWidgetBackgroundPlain);
+
+		return cached.sameArea(uncached, area);
+	}
+
+public:
+	void test_cached_gradient_parity() {
+#if NULL_OSYSTEM_IS_AVAILABLE
+		Common::install_null_g_system();
+		g_system->initSize(640, 480);
+
+		// The gradients are dithered by the parity of the coordinates
+		TS_ASSERT(drawsLikeUncached(302, 20));
+		TS_ASSERT(drawsLikeUncached(300, 20));
+		TS_ASSERT(drawsLikeUncached(301, 20));
+		TS_ASSERT(drawsLikeUncached(300, 21));
+		TS_ASSERT(drawsLikeUncached(301, 21));
+#endif
+	}
+};
@@ -5,7 +5,7 @@
 #
 ######################################################################
 
-TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/math/*.h $(srcdir)/test/image/*.h
+TESTS        := $(srcdir)/test/common/*.h $(srcdir)/test/audio/*.h $(srcdir)/test/math/*.h $(srcdir)/test/image/*.h $(srcdir)/test/graphics/*.h $(srcdir)/test/base/*.h $(srcdir)/test/gui/*.h
 TEST_LIBS    :=
 
 ifdef POSIX
@@ -28,7 +28,30 @@ TEST_LIBS += test/null_osystem.o \
 	backends/platform/sdl/win32/win32_wrapper.o
 endif
 
-TEST_LIBS +=	audio/libaudio.a math/libmath.a common/formats/libformats.a common/compression/libcompression.a common/libcommon.a image/libimage.a graphics/libgraphics.a
+ifdef USE_FREETYPE2
+TEST_LIBS += test/ttf_reference.o
+endif
+
+# The MIDI rendering loop of the command line
+TEST_LIBS += base/midirender.o
+
+# The GUI and the Mac GUI in libgraphics check for or pause the engine, and
+# the Mac GUI decodes images
+TEST_LIBS += test/engine_stub.o
+
+# The GUI sets up its key bindings
+TEST_LIBS += backends/keymapper/action.o \
+	backends/keymapper/hardware-input.o \
+	backends/keymapper/keymap.o \
+	backends/keymapper/keymapper.o \
+	backends/keymapper/standard-actions.o
+
+TEST_LIBS +=	gui/libgui.a audio/libaudio.a math/libmath.a image/libimage.a graphics/libgraphics.a image/libimage.a common/formats/libformats.a common/compression/libcompression.a common/libcommon.a
+
+ifdef USE_MT32EMU
+	TESTS += $(srcdir)/test/audio/softsynth/*.h
+	TEST_LIBS += audio/softsynth/mt32/libmt32.a
+endif
 
 ifeq ($(ENABLE_WINTERMUTE), STATIC_PLUGIN)
 	TESTS += $(srcdir)/test/engines/wintermute/*.h
@@ -76,13 +99,21 @@ test/runner.cpp: $(TESTS) $(srcdir)/test/module.mk
 
 clean: clean-test
 clean-test:
-	-$(RM) test/runner.cpp test/runner test/engine-data/encoding.dat test/null_osystem.o
+	-$(RM) test/runner.cpp test/runner test/engine-data/encoding.dat test/engine-data/LiberationMono-Regular.ttf test/engine-data/scummmodern.zip test/null_osystem.o test/ttf_reference.o test/engine_stub.o
 	-rmdir test/engine-data
 
 test/engine-data/encoding.dat: $(srcdir)/dists/engine-data/encoding.dat
 	$(MKDIR) test/engine-data
 	$(CP) $(srcdir)/dists/engine-data/encoding.dat test/engine-data/encoding.dat
 
-copy-dat: test/engine-data/encoding.dat
+test/engine-data/LiberationMono-Regular.ttf: $(srcdir)/gui/themes/fonts/LiberationMono-Regular.ttf
+	$(MKDIR) test/engine-data
+	$(CP) $(srcdir)/gui/themes/fonts/LiberationMono-Regular.ttf test/engine-data/LiberationMono-Regular.ttf
+
+test/engine-data/scummmodern.zip: $(srcdir)/gui/themes/scummmodern.zip
+	$(MKDIR) test/engine-data
+	$(CP) $(srcdir)/gui/themes/scummmodern.zip test/engine-data/scummmodern.zip
+
+copy-dat: test/engine-data/encoding.dat test/engine-data/LiberationMono-Regular.ttf test/engine-data/scummmodern.zip
 
 .PHONY: test clean-test copy-dat
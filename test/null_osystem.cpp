@@ -2,9 +2,93 @@
 #define NULL_DRIVER_USE_FOR_TEST 1
 #include "null_osystem.h"
 #include "../backends/platform/null/null.cpp"
+#include "backends/graphics/null/null-graphics.h"
+#include "common/timer.h"
+
+// The timers are run as the virtual clock of the tests advances
+class TestTimerManager : public Common::TimerManager {
+	struct Timer {
+		TimerProc proc;
+		void *refCon;
+		int32 interval;
+		int32 remaining;
+	};
+	Common::Array<Timer> _timers;
+
+public:
+	bool installTimerProc(TimerProc proc, int32 interval, void *refCon, const Common::String &id) override {
+		Timer timer = { proc, refCon, interval, interval };
+		_timers.push_back(timer);
+		return true;
+	}
+
+	void removeTimerProc(TimerProc proc) override {
+		for (uint i = 0; i < _timers.size(); i++) {
+			if (_timers[i].proc == proc)
+				_timers.remove_at(i--);
+		}
+	}
+
+	/** Advance the timers by a millisecond */
+	void advance() {
+		for (uint i = 0; i < _timers.size(); i++) {
+			_timers[i].remaining -= 1000;
+			if (_timers[i].remaining <= 0) {
+				_timers[i].remaining += _timers[i].interval;
+				// The timer may install or remove timers
+				const Timer timer = _timers[i];
+				timer.proc(timer.refCon);
+			}
+		}
+	}
+};
+
+// There is no user in the tests, so there are never any events
+class TestEventManager : public Common::EventManager {
+public:
+	bool pollEvent(Common::Event &event) override { return false; }
+	void pushEvent(const Common::Event &event) override {}
+	void purgeMouseEvents() override {}
+	void purgeKeyboardEvents() override {}
+	Common::Point getMousePos() const override { return Common::Point(); }
+	int getButtonState() const override { return 0; }
+	int getModifierState() const override { return 0; }
+	int shouldQuit() const override { return 0; }
+	int shouldReturnToLauncher() const override { return 0; }
+	void resetReturnToLauncher() override {}
+	void resetQuit() override {}
+	Common::Keymapper *getKeymapper() override { return nullptr; }
+	Common::Keymap *getGlobalKeymap() override { return nullptr; }
+};
+
+// Code drawing to the screen, like the Mac GUI, needs a graphics manager.
+// The time only passes with delayMillis(), so that timed code runs
+// the same on any machine.
+class OSystem_NULL_Test : public OSystem_NULL {
+public:
+	OSystem_NULL_Test() : _millis(0) {
+		_graphicsManager = new NullGraphicsManager();
+		_timerManager = new TestTimerManager();
+		_eventManager = new TestEventManager();
+	}
+
+	uint32 getMillis(bool skipRecord = false) override {
+		return _millis;
+	}
+
+	void delayMillis(uint msecs) override {
+		for (uint i = 0; i < msecs; i++) {
+			_millis++;
+			((TestTimerManager *)_timerManager)->advance();
+		}
+	}
+
+private:
+	uint32 _millis;
+};
 
 void Common::install_null_g_system() {
-	g_system = OSystem_NULL_create();
+	g_system = new OSystem_NULL_Test();
 }
 
 bool BaseBackend::setScaler(const char *name, int factor) {
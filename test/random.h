@@ -0,0 +1,31 @@
+#ifndef TEST_RANDOM_H
+#define TEST_RANDOM_H
+
+#include "common/scummsys.h"
+
+/**
+ * Reproducible pseudo-random data for the tests, from a linear
+ * congruential generator. Some tests compare hashes of the data made
+ * from it, so its sequence must not change.
+ */
+class TestRandomSource {
+public:
+	explicit TestRandomSource(uint32 seed) : _state(seed) {}
+
+	/** Steps the generator and returns its whole state. */
+	uint32 next() {
+		_state = _state * 1103515245 + 12345;
+		return _state;
+	}
+
+	/** Fills a buffer with bits 16 to 23 of the successive states. */
+	void fill(byte *buf, uint size) {
+		for (uint i = 0; i < size; ++i)
+			buf[i] = next() >> 16;
+	}
+
+private:
+	uint32 _state;
+};
+
+#endif
@@ -0,0 +1,66 @@
+/* ScummVM - Graphic Adventure Engine
+ *
+ * ScummVM is the legal property of its developers, whose names
+ * are too numerous to list here. Please refer to the COPYRIGHT
+ * file distributed with this source distribution.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// The FreeType headers contain forbidden symbols, so they cannot be included
+// by the test suites. This renders the reference glyphs for test/graphics/ttf.h.
+#define FORBIDDEN_SYMBOL_ALLOW_ALL
+
+#include "common/scummsys.h"
+#include "graphics/fonts/freetype.h"
+#include "graphics/surface.h"
+#include "ttf_reference.h"
+
+bool renderReferenceMonoGlyph(const byte *data, uint32 dataSize, int size, uint32 chr,
+                              Graphics::Surface &glyph, int &left, int &top) {
+	FT_Library library;
+	if (Graphics::FreeType::Init_FreeType(&library))
+		return false;
+
+	bool success = false;
+	FT_Face face;
+	if (!Graphics::FreeType::New_Memory_Face(library, data, dataSize, 0, &face)) {
+		FT_Glyph ftGlyph;
+		if (!Graphics::FreeType::Set_Pixel_Sizes(face, 0, size) &&
+		    !Graphics::FreeType::Load_Glyph(face, Graphics::FreeType::Get_Char_Index(face, chr), FT_LOAD_TARGET_MONO) &&
+		    !Graphics::FreeType::Get_Glyph(face->glyph, &ftGlyph)) {
+			if (!Graphics::FreeType::Glyph_To_Bitmap(&ftGlyph, FT_RENDER_MODE_MONO, nullptr, true)) {
+				const FT_BitmapGlyph bitmapGlyph = (FT_BitmapGlyph)ftGlyph;
+				const FT_Bitmap &bitmap = bitmapGlyph->bitmap;
+				left = bitmapGlyph->left;
+				top = bitmapGlyph->top;
+
+				glyph.create(bitmap.width, bitmap.rows, Graphics::PixelFormat::createFormatCLUT8());
+				for (uint y = 0; y < bitmap.rows; ++y) {
+					for (uint x = 0; x < bitmap.width; ++x) {
+						const bool set = (bitmap.buffer[y * bitmap.pitch + x / 8] & (0x80 >> (x % 8))) != 0;
+						*(byte *)glyph.getBasePtr(x, y) = set ? 255 : 0;
+					}
+				}
+				success = true;
+			}
+			Graphics::FreeType::Done_Glyph(ftGlyph);
+		}
+		Graphics::FreeType::Done_Face(face);
+	}
+
+	Graphics::FreeType::Done_FreeType(library);
+	return success;
+}
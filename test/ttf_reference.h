@@ -0,0 +1,18 @@
+#ifndef TEST_TTF_REFERENCE_H
+#define TEST_TTF_REFERENCE_H
+
+#include "common/scummsys.h"
+
+namespace Graphics {
+struct Surface;
+}
+
+/**
+ * Renders a glyph of a font in monochrome with FreeType alone, into a
+ * surface of its own with 0 and 255 as the pixel values. The offsets of
+ * the glyph from the pen position are returned in left and top.
+ */
+bool renderReferenceMonoGlyph(const byte *data, uint32 dataSize, int size, uint32 chr,
+                              Graphics::Surface &glyph, int &left, int &top);
+
+#endif